@@ -196,6 +196,91 @@ extern "C" {
   int osip_dialog_is_callee (osip_dialog_t * dialog);
 
 
+/**
+ * Structure for indexing dialogs by (Call-ID, local tag, remote tag).
+ * @var osip_dialog_table_t
+ */
+  typedef struct osip_dialog_table osip_dialog_table_t;
+
+/**
+ * Allocate a dialog table.
+ * The table grows on demand: insert, lookup and remove are O(1) on average,
+ * so matching an incoming message no longer requires walking every dialog
+ * with osip_dialog_match_as_uac/uas.
+ * NOTE: Dialogs without a remote tag (early dialogs, or dialogs created with
+ *       a non compliant UA) are indexed on (Call-ID, local tag) only and are
+ *       returned for any remote tag when no confirmed dialog matches.
+ * NOTE: The table does not own the dialogs: osip_dialog_table_free does not
+ *       release them.
+ * @param table The element to allocate.
+ * @param size_hint Expected number of dialogs (0 for a default size).
+ */
+  int osip_dialog_table_init (osip_dialog_table_t ** table, int size_hint);
+/**
+ * Free a dialog table (the dialogs it references are not released).
+ * @param table The element to free.
+ */
+  void osip_dialog_table_free (osip_dialog_table_t * table);
+/**
+ * Get the number of dialogs referenced by a dialog table.
+ * @param table The element to work on.
+ */
+  int osip_dialog_table_size (osip_dialog_table_t * table);
+/**
+ * Add a dialog in a dialog table.
+ * The key is computed from the current call_id, local_tag and remote_tag
+ * of the dialog: those fields must not be modified while the dialog is
+ * in the table (see osip_dialog_table_update_tag_as_uac).
+ * @param table The element to work on.
+ * @param dialog The dialog to add.
+ */
+  int osip_dialog_table_insert (osip_dialog_table_t * table, osip_dialog_t * dialog);
+/**
+ * Remove a dialog from a dialog table.
+ * @param table The element to work on.
+ * @param dialog The dialog to remove.
+ */
+  int osip_dialog_table_remove (osip_dialog_table_t * table, osip_dialog_t * dialog);
+/**
+ * Update the tag as UAC of a dialog referenced by a dialog table.
+ * This is osip_dialog_update_tag_as_uac with the dialog re-indexed
+ * under its new remote tag.
+ * @param table The element to work on.
+ * @param dialog The dialog to update.
+ * @param response The response received.
+ */
+  int osip_dialog_table_update_tag_as_uac (osip_dialog_table_t * table, osip_dialog_t * dialog, osip_message_t * response);
+/**
+ * Find a dialog in a dialog table.
+ * A dialog with the exact remote tag is preferred, an early dialog
+ * (without remote tag) is returned otherwise.
+ * @param table The element to work on.
+ * @param call_id The Call-ID of the dialog.
+ * @param local_tag The local tag of the dialog.
+ * @param remote_tag The remote tag of the dialog (may be NULL).
+ * @param dialog The dialog found.
+ */
+  int osip_dialog_table_find (osip_dialog_table_t * table, const char *call_id, const char *local_tag, const char *remote_tag, osip_dialog_t ** dialog);
+/**
+ * Match a response received with the dialogs of a dialog table.
+ * Same rules as osip_dialog_match_as_uac.
+ * @param table The element to work on.
+ * @param response The response received.
+ * @param dialog The dialog found.
+ */
+  int osip_dialog_table_match_as_uac (osip_dialog_table_t * table, osip_message_t * response, osip_dialog_t ** dialog);
+/**
+ * Match a request received with the dialogs of a dialog table.
+ * Same rules as osip_dialog_match_as_uas, except that a request with a
+ * To tag only matches the dialogs with this local tag. A request without
+ * To tag is checked against every dialog of the table.
+ * @param table The element to work on.
+ * @param request The request received.
+ * @param dialog The dialog found.
+ */
+  int osip_dialog_table_match_as_uas (osip_dialog_table_t * table, osip_message_t * request, osip_dialog_t ** dialog);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,6 +2,8 @@
 #include <osipparser2/osip_port.h>
 #include <osipparser2/osip_parser.h>
 #include <osipparser2/sdp_message.h>
+#include <osipparser2/osip_md5.h>
+#include <osip2/osip_dialog.h>
 
 #include "sipparser.h"
 #include "SipMessage.h"
@@ -11,8 +13,21 @@
 #include "ViaHeader.h"
 #include "FromHeader.h"
 #include "ToHeader.h"
+#include "ContactHeader.h"
 #include "SubjectHeader.h"
 #include "ContentTypeHeader.h"
+#include "SdpBody.h"
+#include "SdpRewriter.h"
+#include "ProxyForwarder.h"
+#include "ViaChain.h"
+#include "GenericHeader.h"
+#include "RouteHeader.h"
+#include "AuthorizationHeader.h"
+#include "WwwAuthenticateHeader.h"
+#include "DatagramParser.h"
+#include "Prefilter.h"
+#include "MessageProcessor.h"
+#include "Utility.h"
 
 #include <stdlib.h>
 #include <time.h>
@@ -20,6 +35,16 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <new>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
 
 unsigned long mhash(const char* str)
 {
@@ -94,6 +119,9 @@ SipHeader* CreateSipHeader(const char* hname, int len)
 }
 
 
+/* forwarding test works on header positions only */
+static int parse_headers_on_complete = 1;
+
 /* Message handler callback to be invoked when a complete message received during parsing */
 void HandleReceivedMessage(SipMessage* msg)
 {
@@ -105,6 +133,10 @@ void HandleReceivedMessage(SipMessage* msg)
   std::cout << buff.str() << std::endl;
   std::cout << "\n............................. >HANDLE RECEIVED MESSAGE< ......................\n";
 #endif
+  if (!parse_headers_on_complete)
+  {
+    return;
+  }
   /* Parse headers to provide same functionality of osip parser for a fair compare */
   for (int i = 0; i < msg->num_headers; i++)
   {
@@ -372,6 +404,10 @@ int on_header_value(sip_parser* p, const char* at, size_t length) {
     sipmsg->headers[sipmsg->num_headers - 1].valuepos.length += tlen;
   }
   sipmsg->headers[sipmsg->num_headers - 1].valuepos.length += length;
+  if (p->flags & F_FOLDED)
+  {
+    sipmsg->folded.set(sipmsg->num_headers - 1);
+  }
 
   sipmsg->last_header_element = VALUE;
 
@@ -625,62 +661,2650 @@ int test_sip(sip_parser* parser, const sip_parser_settings* settings, char* msg,
   return 0;
 }
 
-#define FILE_NAME "../../src/osiptest/res/sip12x3"
-#define LOOP_COUNT 1000000
+static osip_dialog_t* new_bench_dialog(const char* call_id, const char* local_tag, const char* remote_tag)
+{
+  osip_dialog_t* dlg = (osip_dialog_t*)osip_malloc(sizeof(osip_dialog_t));
+  memset(dlg, 0, sizeof(osip_dialog_t));
+  dlg->call_id = osip_strdup(call_id);
+  dlg->local_tag = osip_strdup(local_tag);
+  dlg->remote_tag = (remote_tag != NULL) ? osip_strdup(remote_tag) : NULL;
+  dlg->type = CALLEE;
+  dlg->state = DIALOG_CONFIRMED;
+  return dlg;
+}
 
-//#define OSIP_TEST
+/* Matches an in-dialog request (msg, with a To tag added) against 'dialogcount'
+   dialogs: once with the dialog table and once with the linear scan over
+   osip_dialog_match_as_uas that applications had to do before. */
+int test_dialog(char* msg, int msglen, int dialogcount, int loopcount)
+{
+  osip_message_t* sip;
+  osip_dialog_table_t* table;
+  osip_dialog_t** dialogs;
+  osip_dialog_t* found = NULL;
+  char* callid = NULL;
+  osip_generic_param_t* fromtag = NULL;
+  osip_generic_param_t* totag = NULL;
+  char callidbuf[64], ltag[32], rtag[32];
+  int i, j, err, matched = 0;
+  clock_t begin, end;
+
+  osip_message_init(&sip);
+  err = osip_message_parse(sip, msg, msglen);
+  if (err != 0 || sip->call_id == NULL || sip->to == NULL || sip->from == NULL
+      || osip_from_get_tag(sip->from, &fromtag) != 0)
+  {
+    fprintf(stdout, "ERROR: message can not be used for dialog matching!\n");
+    osip_message_free(sip);
+    return -1;
+  }
+  /* an initial request has no To tag yet: make it an in-dialog one */
+  if (osip_to_get_tag(sip->to, &totag) != 0)
+    osip_to_set_tag(sip->to, osip_strdup("bench-local-tag"));
+  osip_call_id_to_str(sip->call_id, &callid);
 
-int main(int argc, char* argv[]) 
+  dialogs = (osip_dialog_t**)osip_malloc((dialogcount + 1) * sizeof(osip_dialog_t*));
+  for (i = 0; i < dialogcount; i++)
+  {
+    snprintf(callidbuf, sizeof(callidbuf), "%d-%x@bench.example.com", i, i * 2654435761u);
+    snprintf(ltag, sizeof(ltag), "l%d", i);
+    snprintf(rtag, sizeof(rtag), "r%d", i);
+    /* every 16th dialog is early (no remote tag yet) */
+    dialogs[i] = new_bench_dialog(callidbuf, ltag, (i % 16) ? rtag : NULL);
+  }
+  osip_to_get_tag(sip->to, &totag);
+  /* UAS side: local tag is in To, remote tag in From */
+  dialogs[dialogcount] = new_bench_dialog(callid, totag->gvalue, fromtag->gvalue);
+
+  osip_dialog_table_init(&table, 0);
+
+  fprintf(stdout, "Inserting %i dialogs\n", dialogcount + 1);
+  begin = clock();
+  for (i = 0; i <= dialogcount; i++)
+    osip_dialog_table_insert(table, dialogs[i]);
+  end = clock();
+  printf("  insert: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  begin = clock();
+  for (i = 0; i <= dialogcount; i++)
+  {
+    if (osip_dialog_table_find(table, dialogs[i]->call_id, dialogs[i]->local_tag, dialogs[i]->remote_tag, &found) == 0
+        && found == dialogs[i])
+      matched++;
+  }
+  end = clock();
+  printf("  find (all): %f, matched %i\n", (double)(end - begin) / CLOCKS_PER_SEC, matched);
+
+  fprintf(stdout, "Trying %i sequentials calls to osip_dialog_table_match_as_uas()\n", loopcount);
+  matched = 0;
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    if (osip_dialog_table_match_as_uas(table, sip, &found) == 0)
+      matched++;
+  }
+  end = clock();
+  printf("  table match: %f, matched %i\n", (double)(end - begin) / CLOCKS_PER_SEC, matched);
+
+  /* linear scan is O(n) per message: keep the loop count small */
+  int scancount = loopcount / 100000 + 1;
+  fprintf(stdout, "Trying %i linear scans with osip_dialog_match_as_uas()\n", scancount);
+  matched = 0;
+  begin = clock();
+  for (j = 0; j < scancount; j++)
+  {
+    for (i = 0; i <= dialogcount; i++)
+    {
+      if (osip_dialog_match_as_uas(dialogs[i], sip) == 0)
+      {
+        matched++;
+        break;
+      }
+    }
+  }
+  end = clock();
+  printf("  linear match: %f, matched %i\n", (double)(end - begin) / CLOCKS_PER_SEC, matched);
+
+  begin = clock();
+  for (i = 0; i <= dialogcount; i++)
+    osip_dialog_table_remove(table, dialogs[i]);
+  end = clock();
+  printf("  remove: %f, left %i\n", (double)(end - begin) / CLOCKS_PER_SEC, osip_dialog_table_size(table));
+
+  osip_dialog_table_free(table);
+  for (i = 0; i <= dialogcount; i++)
+    osip_dialog_free(dialogs[i]);
+  osip_free(dialogs);
+  osip_free(callid);
+  osip_message_free(sip);
+  return 0;
+}
+
+#define SDP_DIR "../../src/siptest/res/"
+#define SDP_FILE_COUNT 16
+
+/* Loads sdp0..sdp15 as C strings, leaving out the ones rejected by
+   sdp_message_parse() so that both parsers are compared on the same work.
+   Returns the number of bodies loaded */
+int load_sdp_corpus(char** bodies, int* lengths)
 {
-  int result = 0;
-  char* filename = (char*)FILE_NAME;
-  char* msg = NULL;
-  int msglen = 0;
+  char filename[256];
+  int count = 0;
 
-  if (argc >= 2) 
+  for (int i = 0; i < SDP_FILE_COUNT; i++)
   {
-    filename = argv[1];
+    char* data = NULL;
+    int length = 0;
+    sdp_message_t* sdp;
+
+    snprintf(filename, sizeof(filename), SDP_DIR "sdp%d", i);
+    if (read_message(filename, &data, &length) != 0)
+    {
+      continue;
+    }
+    /* sdp_message_parse() expects a C string */
+    bodies[count] = (char*)malloc(length + 1);
+    memcpy(bodies[count], data, length);
+    bodies[count][length] = '\0';
+    lengths[count] = length;
+    free(data);
+
+    sdp_message_init(&sdp);
+    if (sdp_message_parse(sdp, bodies[count]) != 0)
+    {
+      fprintf(stdout, "sdp%d is rejected by sdp_message_parse, skipped\n", i);
+      free(bodies[count]);
+    }
+    else
+    {
+      count++;
+    }
+    sdp_message_free(sdp);
   }
-  unsigned long h1 = nhash("Via");
-  unsigned long h2 = lhash("Via:", 3);
-  unsigned long h3 = mhash("via");
+  return count;
+}
 
-  std::cout << "h1=" << h1 << "\nh2=" << h2 << "\nh3=" << h3 << std::endl;
+/* Parses the sdp0..sdp15 corpus 'loopcount' times with sdp_message_parse()
+   and with SdpBody::ParseBody() */
+int test_sdp(int loopcount)
+{
+  char* bodies[SDP_FILE_COUNT];
+  int lengths[SDP_FILE_COUNT];
+  int count = load_sdp_corpus(bodies, lengths);
+  int i, j;
+  clock_t begin, end;
+
+  fprintf(stdout, "Trying %i sequentials calls to sdp_message_init(), sdp_message_parse() and sdp_message_free() on %i files\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      sdp_message_t* sdp;
+      sdp_message_init(&sdp);
+      sdp_message_parse(sdp, bodies[i]);
+      sdp_message_free(sdp);
+    }
+  }
+  end = clock();
+  printf("  osip: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
 
-  unsigned long h11 = nhash("Content-Type");
-  unsigned long h21 = lhash("Content-Type:", 12);
-  unsigned long h31 = mhash("Content-Type");
+  fprintf(stdout, "Trying %i sequentials calls to SdpBody::ParseBody() on %i files\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      SdpBody sdp;
+      sdp.ParseBody(bodies[i], 0, lengths[i]);
+      if (sdp.parsing_stat != PARSED_SUCCESSFULLY)
+      {
+        fprintf(stdout, "ERROR: SdpBody parsing failed (%s)\n", SipHeader::GetParsingStatInText(sdp.parsing_stat));
+        return -1;
+      }
+    }
+  }
+  end = clock();
+  printf("  sdpbody: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
 
-  std::cout << "h1=" << h11 << "\nh2=" << h21 << "\nh3=" << h31 << std::endl;
+  for (i = 0; i < count; i++)
+  {
+    free(bodies[i]);
+  }
+  return 0;
+}
 
-  result = read_message(filename, &msg, &msglen);
-  if (result != 0)
+#define RELAY_ADDRESS "203.0.113.10"
+
+/* Media anchoring on the sdp corpus: every c= address and m= port replaced.
+   osip does a parse, modify, sdp_message_to_str() round trip; SdpRewriter
+   patches the spans of the original body into an output buffer */
+int test_sdp_rewrite(int loopcount)
+{
+  char* bodies[SDP_FILE_COUNT];
+  int lengths[SDP_FILE_COUNT];
+  int count = load_sdp_corpus(bodies, lengths);
+  char out[4096];
+  int i, j, k, pos;
+  clock_t begin, end;
+
+  fprintf(stdout, "Trying %i sdp_message_parse(), c=/m= update and sdp_message_to_str() on %i files\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
   {
-    return result;
+    for (i = 0; i < count; i++)
+    {
+      sdp_message_t* sdp;
+      sdp_connection_t* conn;
+      char* result = NULL;
+
+      sdp_message_init(&sdp);
+      sdp_message_parse(sdp, bodies[i]);
+      for (k = -1; k == -1 || sdp_message_m_media_get(sdp, k) != NULL; k++)
+      {
+        /* session level has one c= only: 'pos' is not used for it */
+        for (pos = 0; (conn = sdp_message_connection_get(sdp, k, pos)) != NULL; pos++)
+        {
+          osip_free(conn->c_addr);
+          conn->c_addr = osip_strdup(RELAY_ADDRESS);
+          if (k == -1)
+          {
+            break;
+          }
+        }
+        if (k >= 0)
+        {
+          char* port = (char*)osip_malloc(8);
+          snprintf(port, 8, "%u", 40000 + 2 * k);
+          sdp_message_m_port_set(sdp, k, port);
+        }
+      }
+      sdp_message_to_str(sdp, &result);
+      osip_free(result);
+      sdp_message_free(sdp);
+    }
   }
+  end = clock();
+  printf("  osip: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
 
-#ifdef OSIP_TEST
-  /* initialize parser */
-  parser_init();
-#else
-  sip_parser_settings settings;
-  memset(&settings, 0, sizeof(settings));
-  settings.on_message_begin = on_message_begin;
-  settings.on_url = on_url;
-  settings.on_status = on_response_status;
-  settings.on_header_field = on_header_field;
-  settings.on_header_value = on_header_value;
-  settings.on_headers_complete = on_headers_complete;
-  settings.on_body = on_body;
-  settings.on_message_complete = on_message_complete;
+  fprintf(stdout, "Trying %i SdpBody::ParseBody(), SdpRewriter and WriteBody() on %i files\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      SdpBody sdp;
+      sdp.ParseBody(bodies[i], 0, lengths[i]);
+
+      SdpRewriter rewriter(sdp);
+      rewriter.SetConnectionAddress(SDP_SESSION_LEVEL, RELAY_ADDRESS, sizeof(RELAY_ADDRESS) - 1);
+      for (k = 0; k < (int)sdp.num_media; k++)
+      {
+        rewriter.SetConnectionAddress(k, RELAY_ADDRESS, sizeof(RELAY_ADDRESS) - 1);
+        rewriter.SetMediaPort(k, (uint16_t)(40000 + 2 * k));
+      }
+      if (rewriter.WriteBody(out, sizeof(out)) < 0)
+      {
+        fprintf(stdout, "ERROR: SdpRewriter output does not fit\n");
+        return -1;
+      }
+    }
+  }
+  end = clock();
+  printf("  sdprewriter: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
 
-  sip_parser parser;
-  sip_parser_init(&parser, SIP_BOTH);
-#endif
+  for (i = 0; i < count; i++)
+  {
+    free(bodies[i]);
+  }
+  return 0;
+}
 
-  clock_t begin = clock();
+#define FWD_DIR "../../src/siptest/res/"
+#define FWD_FILE_COUNT 97
+#define FWD_MAX_FILES 64
+#define PROXY_HOST "proxy.example.com"
+#define PROXY_PORT 5060
+
+/* Loads the requests of sip0..sip96 accepted by both osip_message_parse() and
+   sip_parser_execute(). Returns the number of messages loaded */
+int load_fwd_corpus(sip_parser* parser, const sip_parser_settings* settings, char** msgs, int* lengths)
+{
+  char filename[256];
+  int count = 0;
+
+  for (int i = 0; i < FWD_FILE_COUNT && count < FWD_MAX_FILES; i++)
+  {
+    char* data = NULL;
+    int length = 0;
+    osip_message_t* sip;
+    int accepted;
+
+    snprintf(filename, sizeof(filename), FWD_DIR "sip%d", i);
+    if (read_message(filename, &data, &length) != 0)
+    {
+      continue;
+    }
+    osip_message_init(&sip);
+    accepted = (osip_message_parse(sip, data, length) == 0 && MSG_IS_REQUEST(sip) && sip->vias.nb_elt > 0);
+    osip_message_free(sip);
+
+    if (accepted)
+    {
+      SipMessage* currentmsg = new SipMessage();
+      currentmsg->v1.resize(length);
+      memcpy(&currentmsg->v1[0], data, length);
+      sip_parser_init(parser, SIP_BOTH);
+      parser->currmsg = currentmsg;
+      accepted = (sip_parser_execute(parser, settings, &currentmsg->v1[0], length) == (size_t)length &&
+                  currentmsg->message_complete_cb_called && currentmsg->request_url.length > 0);
+      delete currentmsg;
+    }
+    if (accepted)
+    {
+      msgs[count] = data;
+      lengths[count++] = length;
+    }
+    else
+    {
+      free(data);
+    }
+  }
+  return count;
+}
+
+/* Stateless forwarding of the request corpus: Route pop, Max-Forwards decrement,
+   Record-Route and Via push, output in a send buffer. osip does parse, modify and
+   osip_message_to_str(); ProxyForwarder works on the positions found by
+   sip_parser_execute() and writes only the new/changed parts */
+int test_forward(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  char* msgs[FWD_MAX_FILES];
+  int lengths[FWD_MAX_FILES];
+  static char out[131072];
+  int count, i, j, n;
+  long total = 0;
+  clock_t begin, end;
+
+  parse_headers_on_complete = 0;
+  count = load_fwd_corpus(parser, settings, msgs, lengths);
+
+  fprintf(stdout, "Trying %i osip_message_parse(), forwarding updates and osip_message_to_str() on %i requests\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      osip_message_t* sip;
+      osip_header_t* maxfwd = NULL;
+      osip_route_t* route = NULL;
+      osip_record_route_t* rr = NULL;
+      osip_via_t* via = NULL;
+      char* result = NULL;
+      size_t length = 0;
+      char value[8];
+
+      osip_message_init(&sip);
+      osip_message_parse(sip, msgs[i], lengths[i]);
+
+      osip_message_get_route(sip, 0, &route);
+      if (route != NULL && route->url != NULL && route->url->host != NULL &&
+          0 == osip_strcasecmp(route->url->host, PROXY_HOST))
+      {
+        osip_list_remove(&sip->routes, 0);
+        osip_route_free(route);
+      }
+      if (osip_message_get_max_forwards(sip, 0, &maxfwd) >= 0 && maxfwd->hvalue != NULL)
+      {
+        snprintf(value, sizeof(value), "%d", atoi(maxfwd->hvalue) - 1);
+        osip_free(maxfwd->hvalue);
+        maxfwd->hvalue = osip_strdup(value);
+      }
+      else
+      {
+        osip_message_set_max_forwards(sip, "70");
+      }
+      osip_record_route_init(&rr);
+      osip_record_route_parse(rr, "<sip:" PROXY_HOST ":5060;lr>");
+      osip_list_add(&sip->record_routes, rr, 0);
+      osip_via_init(&via);
+      osip_via_parse(via, "SIP/2.0/UDP " PROXY_HOST ":5060;branch=z9hG4bK0123456789abcdef");
+      osip_list_add(&sip->vias, via, 0);
+
+      osip_message_to_str(sip, &result, &length);
+      total += (long)length;
+      osip_free(result);
+      osip_message_free(sip);
+    }
+  }
+  end = clock();
+  printf("  osip: %f (%ld bytes)\n", (double)(end - begin) / CLOCKS_PER_SEC, total);
+
+  proxy_identity_t identity = { "UDP", PROXY_HOST, PROXY_PORT };
+  total = 0;
+  fprintf(stdout, "Trying %i sip_parser_execute(), ProxyForwarder::Forward() and Flatten() on %i requests\n", loopcount, count);
+  begin = clock();
+  for (j = 0; j < loopcount; j++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      SipMessage* currentmsg = new SipMessage();
+      currentmsg->v1.resize(lengths[i]);
+      memcpy(&currentmsg->v1[0], msgs[i], lengths[i]);
+      sip_parser_init(parser, SIP_BOTH);
+      parser->currmsg = currentmsg;
+      /* positions of folded values are calculated over 'v1': parse it in place */
+      sip_parser_execute(parser, settings, &currentmsg->v1[0], lengths[i]);
+
+      ProxyForwarder forwarder(currentmsg, identity);
+      if (forwarder.Forward(true) != 0)
+      {
+        fprintf(stdout, "ERROR: forwarding of request %i failed\n", i);
+        return -1;
+      }
+      if ((n = forwarder.Flatten(out, sizeof(out))) < 0)
+      {
+        fprintf(stdout, "ERROR: forwarded request %i does not fit\n", i);
+        return -1;
+      }
+      total += n;
+      delete currentmsg;
+    }
+  }
+  end = clock();
+  printf("  forwarder: %f (%ld bytes)\n", (double)(end - begin) / CLOCKS_PER_SEC, total);
+
+  for (i = 0; i < count; i++)
+  {
+    free(msgs[i]);
+  }
+  parse_headers_on_complete = 1;
+  return 0;
+}
+
+#define URLS_FILE "../../src/osipuritest/urls.txt"
+#define MAX_NUM_URLS 128
+
+/* The way URIs were compared before SipUri::Equals: a canonical copy with
+   lowercased scheme/host/params, unescaped userinfo and sorted params/headers */
+static void append_unescaped(std::string& out, const char* s, uint32_t length, bool lower)
+{
+  for (uint32_t i = 0; i < length; i++)
+  {
+    char c = s[i];
+    if (c == '%' && i + 2 < length && IS_HEX(s[i + 1]) && IS_HEX(s[i + 2]))
+    {
+      char hex[3] = { s[i + 1], s[i + 2], 0 };
+      c = (char)strtol(hex, NULL, 16);
+      i += 2;
+    }
+    out += lower ? (char)tolower(c) : c;
+  }
+}
+
+std::string normalize_uri(const SipUri& uri)
+{
+  const char* s = (const char*)uri.rawdata._data;
+  std::string out;
+  std::vector<std::string> params;
+  std::vector<std::string> headers;
+
+  append_unescaped(out, s + uri.uri.scheme.start, uri.uri.scheme.length, true);
+  out += ':';
+  append_unescaped(out, s + uri.uri.username.start, uri.uri.username.length, false);
+  out += ':';
+  append_unescaped(out, s + uri.uri.password.start, uri.uri.password.length, false);
+  out += '@';
+  append_unescaped(out, s + uri.uri.host.start, uri.uri.host.length, true);
+  out += ':';
+  out.append(s + uri.uri.port.start, uri.uri.port.length);
+  for (uint32_t i = 0; i < uri.GetParamCount(); i++)
+  {
+    const param_pos_t& p = uri.GetParam(i);
+    std::string param;
+    append_unescaped(param, s + p.type.start, p.type.length, true);
+    if (param == "user" || param == "ttl" || param == "method" || param == "maddr" || param == "transport")
+    {
+      param += '=';
+      append_unescaped(param, s + p.value.start, p.value.length, true);
+      params.push_back(param);
+    }
+  }
+  for (uint32_t i = 0; i < uri.GetHeaderCount(); i++)
+  {
+    const header_pos_t& h = uri.GetHeader(i);
+    std::string header;
+    append_unescaped(header, s + h.fieldpos.start, h.fieldpos.length, true);
+    header += '=';
+    append_unescaped(header, s + h.valuepos.start, h.valuepos.length, false);
+    headers.push_back(header);
+  }
+  std::sort(params.begin(), params.end());
+  std::sort(headers.begin(), headers.end());
+  for (size_t i = 0; i < params.size(); i++)
+  {
+    out += ';';
+    out += params[i];
+  }
+  for (size_t i = 0; i < headers.size(); i++)
+  {
+    out += '?';
+    out += headers[i];
+  }
+  return out;
+}
+
+/* Loads the URIs of urls.txt that SipUri parses. Returns the number loaded */
+int load_urls(char** urls, SipUri** uris)
+{
+  char line[256];
+  int count = 0;
+  FILE* file = fopen(URLS_FILE, "r");
+
+  if (file == NULL)
+  {
+    perror("fopen");
+    return 0;
+  }
+  while (count < MAX_NUM_URLS && fgets(line, sizeof(line), file) != NULL)
+  {
+    size_t length = strcspn(line, "\r\n");
+    line[length] = '\0';
+    if (length == 0 || line[0] == '#')
+    {
+      continue;
+    }
+    urls[count] = strdup(line);
+    uris[count] = new SipUri();
+    if (uris[count]->ParseUri(urls[count], 0, length) != 0)
+    {
+      delete uris[count];
+      free(urls[count]);
+      continue;
+    }
+    count++;
+  }
+  fclose(file);
+  return count;
+}
+
+/* All-pairs comparison of urls.txt: canonical std::string copies compared
+   against SipUri::Equals, and canonical copies against SipUri::Hash */
+int test_uri_compare(int loopcount)
+{
+  char* urls[MAX_NUM_URLS];
+  SipUri* uris[MAX_NUM_URLS];
+  int count = load_urls(urls, uris);
+  int i, j, k;
+  long matched = 0;
+  uint64_t hashsum = 0;
+  clock_t begin, end;
+
+  fprintf(stdout, "Trying %i all-pairs comparisons with normalized std::string copies on %i URIs\n", loopcount, count);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      for (j = 0; j < count; j++)
+      {
+        matched += (normalize_uri(*uris[i]) == normalize_uri(*uris[j]));
+      }
+    }
+  }
+  end = clock();
+  printf("  normalized: %f, matched %ld\n", (double)(end - begin) / CLOCKS_PER_SEC, matched);
+
+  matched = 0;
+  fprintf(stdout, "Trying %i all-pairs comparisons with SipUri::Equals() on %i URIs\n", loopcount, count);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      for (j = 0; j < count; j++)
+      {
+        matched += uris[i]->Equals(*uris[j]);
+      }
+    }
+  }
+  end = clock();
+  printf("  equals: %f, matched %ld\n", (double)(end - begin) / CLOCKS_PER_SEC, matched);
+
+  fprintf(stdout, "Trying %i normalizations and SipUri::Hash() on %i URIs\n", loopcount * 100, count);
+  begin = clock();
+  for (k = 0; k < loopcount * 100; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      hashsum += normalize_uri(*uris[i]).length();
+    }
+  }
+  end = clock();
+  printf("  normalize: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  begin = clock();
+  for (k = 0; k < loopcount * 100; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      hashsum += uris[i]->Hash();
+    }
+  }
+  end = clock();
+  printf("  hash: %f (%llu)\n", (double)(end - begin) / CLOCKS_PER_SEC, (unsigned long long)hashsum);
+
+  for (i = 0; i < count; i++)
+  {
+    delete uris[i];
+    free(urls[i]);
+  }
+  return 0;
+}
+
+#define REGISTER_CONTACTS "<sip:alice@192.0.2.1:5060;transport=udp;ob>;expires=3600, " \
+  "<sip:alice@192.0.2.2:5060;transport=tcp>;q=0.5, <sip:alice@192.0.2.3;lr>, " \
+  "<sip:alice@192.0.2.4;user=ip;maddr=10.0.0.1;ttl=5;method=INVITE>, " \
+  "<sip:alice@example.com;a=1;b=2;c=3;d=4;e=5>, <sip:alice@192.0.2.6>, " \
+  "<sips:alice@192.0.2.7:5061>, <sip:alice@192.0.2.8?subject=x&priority=urgent>"
+
+#define MAX_NUM_CORPUS_URIS 512
+
+/* keeps a copy of the addr-spec at 'span' of 'data', without angle quotes */
+static void add_corpus_uri(char** uris, int* count, const char* data, str_pos_t span)
+{
+  if (span.length > 2 && data[span.start] == '<')
+  {
+    span.start++;
+    span.length -= 2;
+  }
+  if (span.length > 0 && *count < MAX_NUM_CORPUS_URIS)
+  {
+    uris[*count] = strndup(data + span.start, span.length);
+    (*count)++;
+  }
+}
+
+/* Collects Request-URI, From, To and Contact URIs of the messages sip0..sip96.
+   Returns the number of URIs collected */
+int load_corpus_uris(sip_parser* parser, const sip_parser_settings* settings, char** uris)
+{
+  char filename[256];
+  int count = 0;
+
+  parse_headers_on_complete = 0;
+  for (int i = 0; i < FWD_FILE_COUNT; i++)
+  {
+    char* data = NULL;
+    int length = 0;
+
+    snprintf(filename, sizeof(filename), FWD_DIR "sip%d", i);
+    if (read_message(filename, &data, &length) != 0)
+    {
+      continue;
+    }
+    SipMessage* currentmsg = new SipMessage();
+    currentmsg->v1.resize(length);
+    memcpy(&currentmsg->v1[0], data, length);
+    sip_parser_init(parser, SIP_BOTH);
+    parser->currmsg = currentmsg;
+    sip_parser_execute(parser, settings, &currentmsg->v1[0], length);
+
+    const char* msgdata = &currentmsg->v1[0];
+    add_corpus_uri(uris, &count, msgdata, currentmsg->request_url);
+    const char* names[] = { "From", "To" };
+    for (int n = 0; n < 2; n++)
+    {
+      int idx = currentmsg->GetHeaderIndex(names[n]);
+      if (idx >= 0)
+      {
+        const str_pos_t& value = currentmsg->headers[idx].valuepos;
+        FromHeader from;
+        from.ParseHeader(msgdata, value.start, value.start + value.length);
+        if (from.parsing_stat == PARSED_SUCCESSFULLY)
+        {
+          add_corpus_uri(uris, &count, msgdata, from.url_str);
+        }
+      }
+    }
+    for (uint32_t k = 0; k < 8; k++)
+    {
+      int idx = currentmsg->GetHeaderIndex("Contact", k);
+      if (idx < 0)
+      {
+        break;
+      }
+      const str_pos_t& value = currentmsg->headers[idx].valuepos;
+      ContactHeader contact;
+      contact.ParseHeader(msgdata, value.start, value.start + value.length);
+      if (contact.parsing_stat == PARSED_SUCCESSFULLY)
+      {
+        for (uint32_t c = 0; c < contact.num_contact_parms; c++)
+        {
+          add_corpus_uri(uris, &count, msgdata, contact.contact_parms[c].url_str);
+        }
+      }
+    }
+    delete currentmsg;
+    free(data);
+  }
+  parse_headers_on_complete = 1;
+  return count;
+}
+
+/* URI parsing of urls.txt and the URIs of the message corpus with SipUri on
+   stack and on heap, and URIs of a REGISTER with 8 contacts where spill areas
+   are on heap or in an arena */
+int test_uri_parse(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  char* urls[MAX_NUM_URLS];
+  SipUri* uris[MAX_NUM_URLS];
+  int count = load_urls(urls, uris);
+  char* corpus[MAX_NUM_CORPUS_URIS];
+  int corpuscount = load_corpus_uris(parser, settings, corpus);
+  int parsed = 0;
+  const char* contacts = REGISTER_CONTACTS;
+  uint32_t length = (uint32_t)strlen(contacts);
+  int i, k;
+  long failed = 0;
+  clock_t begin, end;
+
+  fprintf(stdout, "sizeof(SipUri)=%u, sizeof(ContactHeader)=%u\n", (unsigned)sizeof(SipUri), (unsigned)sizeof(ContactHeader));
+  fprintf(stdout, "Trying %i parses of %i URIs on stack\n", loopcount, count);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      SipUri uri;
+      failed += uri.ParseUri(urls[i], 0, strlen(urls[i]));
+    }
+  }
+  end = clock();
+  printf("  stack: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  fprintf(stdout, "Trying %i parses of %i URIs on heap\n", loopcount, count);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      SipUri* uri = new SipUri();
+      failed += uri->ParseUri(urls[i], 0, strlen(urls[i]));
+      delete uri;
+    }
+  }
+  end = clock();
+  printf("  heap: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  for (i = 0; i < corpuscount; i++)
+  {
+    SipUri uri;
+    parsed += (uri.ParseUri(corpus[i], 0, strlen(corpus[i])) == 0);
+  }
+  fprintf(stdout, "Trying %i parses of %i URIs of the message corpus (%i parsed)\n", loopcount, corpuscount, parsed);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < corpuscount; i++)
+    {
+      SipUri uri;
+      failed += uri.ParseUri(corpus[i], 0, strlen(corpus[i]));
+    }
+  }
+  end = clock();
+  printf("  corpus: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  fprintf(stdout, "Trying %i REGISTER contacts\n", loopcount * 10);
+  begin = clock();
+  for (k = 0; k < loopcount * 10; k++)
+  {
+    ContactHeader contact;
+    contact.ParseHeader(contacts, 0, length);
+    failed += contact.ParseUrlPart();
+  }
+  end = clock();
+  printf("  contacts: %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  begin = clock();
+  for (k = 0; k < loopcount * 10; k++)
+  {
+    UriArena arena;
+    ContactHeader contact;
+    contact.ParseHeader(contacts, 0, length);
+    failed += contact.ParseUrlPart(&arena);
+  }
+  end = clock();
+  printf("  contacts in arena: %f (%ld)\n", (double)(end - begin) / CLOCKS_PER_SEC, failed);
+
+  for (i = 0; i < count; i++)
+  {
+    delete uris[i];
+    free(urls[i]);
+  }
+  for (i = 0; i < corpuscount; i++)
+  {
+    free(corpus[i]);
+  }
+  return 0;
+}
+
+#define FROMS_FILE "../../src/siptest/res/froms.txt"
+#define CONTACTS_FILE "../../src/siptest/res/contacts.txt"
+#define MAX_NUM_ADDR_LINES 256
 
-#ifdef OSIP_TEST
+/* heap allocations, counted by operator new when URI_LAZY_TEST is set */
+static unsigned long num_allocs = 0;
+
+/* Loads the lines of 'filename' accepted by header parser 'T'. Returns the number loaded */
+template <class T>
+int load_addr_lines(const char* filename, char** lines)
+{
+  char line[1024];
+  int count = 0;
+  FILE* file = fopen(filename, "r");
+
+  if (file == NULL)
+  {
+    perror("fopen");
+    return 0;
+  }
+  while (count < MAX_NUM_ADDR_LINES && fgets(line, sizeof(line), file) != NULL)
+  {
+    size_t length = strcspn(line, "\r\n");
+    line[length] = '\0';
+    if (length == 0 || line[0] == '#')
+    {
+      continue;
+    }
+    T header;
+    header.ParseHeader(line, 0, (uint32_t)length);
+    if (header.parsing_stat == PARSED_SUCCESSFULLY)
+    {
+      lines[count++] = strdup(line);
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+static void print_addr_result(const char* name, clock_t begin, clock_t end, unsigned long allocs, long count)
+{
+  printf("  %s: %f, %.2f allocations per header\n", name, (double)(end - begin) / CLOCKS_PER_SEC, (double)allocs / count);
+}
+
+/* From and Contact header values of froms.txt and contacts.txt parsed with
+   URIs in separate heap objects as ParseUrlPart() used to do, with inline URIs
+   parsed eagerly and with URIs left to GetUri() which is never called, i.e.
+   a proxy only looking at tag or expires */
+int test_uri_lazy(int loopcount)
+{
+  char* froms[MAX_NUM_ADDR_LINES];
+  char* contacts[MAX_NUM_ADDR_LINES];
+  int fromcount = load_addr_lines<FromHeader>(FROMS_FILE, froms);
+  int contactcount = load_addr_lines<ContactHeader>(CONTACTS_FILE, contacts);
+  int i, k;
+  long sum = 0;
+  unsigned long allocs;
+  clock_t begin, end;
+
+  fprintf(stdout, "Trying %i parses of %i From values\n", loopcount, fromcount);
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < fromcount; i++)
+    {
+      FromHeader from;
+      from.ParseHeader(froms[i], 0, (uint32_t)strlen(froms[i]));
+      const char* url = froms[i] + from.url_str.start;
+      SipUri* uri = new SipUri();
+      sum += (*url == '<') ? uri->ParseUri(url + 1, 0, from.url_str.length - 2) : uri->ParseUri(url, 0, from.url_str.length);
+      delete uri;
+    }
+  }
+  end = clock();
+  print_addr_result("eager, heap SipUri", begin, end, num_allocs - allocs, (long)loopcount * fromcount);
+
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < fromcount; i++)
+    {
+      FromHeader from;
+      from.ParseHeader(froms[i], 0, (uint32_t)strlen(froms[i]));
+      sum += from.ParseUrlPart();
+    }
+  }
+  end = clock();
+  print_addr_result("eager, inline SipUri", begin, end, num_allocs - allocs, (long)loopcount * fromcount);
+
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < fromcount; i++)
+    {
+      FromHeader from;
+      from.ParseHeader(froms[i], 0, (uint32_t)strlen(froms[i]));
+      sum += from.tag.length;
+    }
+  }
+  end = clock();
+  print_addr_result("lazy, GetUri() not called", begin, end, num_allocs - allocs, (long)loopcount * fromcount);
+
+  fprintf(stdout, "Trying %i parses of %i Contact values\n", loopcount, contactcount);
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < contactcount; i++)
+    {
+      ContactHeader contact;
+      contact.ParseHeader(contacts[i], 0, (uint32_t)strlen(contacts[i]));
+      for (uint32_t c = 0; c < contact.num_contact_parms; c++)
+      {
+        const str_pos_t& url_str = contact.contact_parms[c].url_str;
+        const char* url = contacts[i] + url_str.start;
+        SipUri* uri = new SipUri();
+        sum += (*url == '<') ? uri->ParseUri(url + 1, 0, url_str.length - 2) : uri->ParseUri(url, 0, url_str.length);
+        delete uri;
+      }
+    }
+  }
+  end = clock();
+  print_addr_result("eager, heap SipUri", begin, end, num_allocs - allocs, (long)loopcount * contactcount);
+
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < contactcount; i++)
+    {
+      ContactHeader contact;
+      contact.ParseHeader(contacts[i], 0, (uint32_t)strlen(contacts[i]));
+      sum += contact.ParseUrlPart();
+    }
+  }
+  end = clock();
+  print_addr_result("eager, inline SipUri", begin, end, num_allocs - allocs, (long)loopcount * contactcount);
+
+  allocs = num_allocs;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < contactcount; i++)
+    {
+      ContactHeader contact;
+      contact.ParseHeader(contacts[i], 0, (uint32_t)strlen(contacts[i]));
+      sum += contact.contact_parms[0].num_params;
+    }
+  }
+  end = clock();
+  print_addr_result("lazy, GetUri() not called", begin, end, num_allocs - allocs, (long)loopcount * contactcount);
+  printf("  (%ld)\n", sum);
+
+  for (i = 0; i < fromcount; i++)
+  {
+    free(froms[i]);
+  }
+  for (i = 0; i < contactcount; i++)
+  {
+    free(contacts[i]);
+  }
+  return 0;
+}
+
+#define VIAS_FILE "../../src/siptest/res/vias.txt"
+
+/* Value of parsed headers 'hdrs' taken in each way. Modified ones are marked
+   so with SetModified() beforehand */
+static void test_header_values(SipHeader** hdrs, int count, int loopcount, bool modified)
+{
+  static char buf[4096];
+  long total = 0;
+  int i, k;
+  clock_t begin, end;
+
+  for (i = 0; i < count; i++)
+  {
+    if (modified)
+    {
+      hdrs[i]->SetModified();
+    }
+  }
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      total += hdrs[i]->GetHeaderValue().length();
+    }
+  }
+  end = clock();
+  printf("  %s GetHeaderValue() std::string: %f\n", modified ? "modified" : "unmodified", (double)(end - begin) / CLOCKS_PER_SEC);
+
+  if (!modified)
+  {
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        RawData value;
+        hdrs[i]->GetHeaderValue(value);
+        total += value._length - value._pos;
+      }
+    }
+    end = clock();
+    printf("  unmodified GetHeaderValue(RawData&): %f\n", (double)(end - begin) / CLOCKS_PER_SEC);
+  }
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      total += hdrs[i]->WriteHeaderValue(buf, sizeof(buf));
+    }
+  }
+  end = clock();
+  printf("  %s WriteHeaderValue(): %f (%ld)\n", modified ? "modified" : "unmodified", (double)(end - begin) / CLOCKS_PER_SEC, total);
+}
+
+/* Values of Via, From and Contact headers of vias.txt, froms.txt and
+   contacts.txt: re-formatted into a std::string as all of them used to be,
+   served from received bytes when unmodified, or re-formatted into a buffer */
+int test_header_value(int loopcount)
+{
+  char* lines[3][MAX_NUM_ADDR_LINES];
+  SipHeader* hdrs[MAX_NUM_ADDR_LINES];
+  const char* names[3] = { "Via", "From", "Contact" };
+  int counts[3];
+  int i, n;
+
+  counts[0] = load_addr_lines<ViaHeader>(VIAS_FILE, lines[0]);
+  counts[1] = load_addr_lines<FromHeader>(FROMS_FILE, lines[1]);
+  counts[2] = load_addr_lines<ContactHeader>(CONTACTS_FILE, lines[2]);
+
+  for (n = 0; n < 3; n++)
+  {
+    for (i = 0; i < counts[n]; i++)
+    {
+      hdrs[i] = (n == 0) ? (SipHeader*)new ViaHeader() : (n == 1) ? (SipHeader*)new FromHeader() : (SipHeader*)new ContactHeader();
+      hdrs[i]->ParseHeader(lines[n][i], 0, (uint32_t)strlen(lines[n][i]));
+    }
+    fprintf(stdout, "Trying %i values of %i %s headers\n", loopcount, counts[n], names[n]);
+    test_header_values(hdrs, counts[n], loopcount, false);
+    test_header_values(hdrs, counts[n], loopcount, true);
+    for (i = 0; i < counts[n]; i++)
+    {
+      delete hdrs[i];
+      free(lines[n][i]);
+    }
+  }
+  return 0;
+}
+
+/* lookup of a parameter as it is done without the slot table of ParamParser.h */
+static const param_pos_t* find_param(const char* buf, const param_pos_t* params, uint32_t num, const char* name, uint32_t length)
+{
+  for (uint32_t i = 0; i < num; i++)
+  {
+    if (params[i].type.length == length && 0 == _strnicmp_(buf + params[i].type.start, name, length))
+    {
+      return &params[i];
+    }
+  }
+  return NULL;
+}
+
+/* header values as a proxy and a registrar see them, most values of vias.txt
+   and contacts.txt have few parameters */
+static const char* typical_vias[] =
+{
+  "SIP/2.0/UDP 192.0.2.1:5060;rport=5060;received=198.51.100.7;branch=z9hG4bK776asdhds",
+  "SIP/2.0/TLS client.example.com:5061;alias;keep;branch=z9hG4bKnashds7;rport",
+  "SIP/2.0/UDP proxy.example.com;branch=z9hG4bK2d4790.1;received=192.0.2.2;rport=5062;ttl=1, "
+    "SIP/2.0/UDP 192.0.2.1:5060;received=198.51.100.7;branch=z9hG4bK776asdhds;rport=5060",
+};
+static const char* typical_contacts[] =
+{
+  "<sip:alice@192.0.2.1:5060;transport=tcp;ob>;reg-id=1;"
+    "+sip.instance=\"<urn:uuid:00000000-0000-1000-8000-AABBCCDDEEFF>\";expires=3600;q=0.9",
+  "<sip:bob@192.0.2.4>;methods=\"INVITE, BYE\";audio;video;expires=600;q=0.5",
+  "<sip:carol@192.0.2.5:5062>;expires=300, <sip:carol@198.51.100.5>;q=0.1;expires=300",
+};
+
+/* branch, received and rport of each via-parm in vias.txt, q and expires of
+   each contact-param in contacts.txt, typical values included: compared by name over all parameters,
+   and taken from the slot table filled during parsing */
+int test_param_lookup(int loopcount)
+{
+  char* vias[MAX_NUM_ADDR_LINES];
+  char* contacts[MAX_NUM_ADDR_LINES];
+  ViaHeader* vhdrs[MAX_NUM_ADDR_LINES];
+  ContactHeader* chdrs[MAX_NUM_ADDR_LINES];
+  int viacount = load_addr_lines<ViaHeader>(VIAS_FILE, vias);
+  int contactcount = load_addr_lines<ContactHeader>(CONTACTS_FILE, contacts);
+  for (size_t n = 0; n < sizeof(typical_vias) / sizeof(typical_vias[0]) && viacount < MAX_NUM_ADDR_LINES; n++)
+  {
+    vias[viacount++] = strdup(typical_vias[n]);
+  }
+  for (size_t n = 0; n < sizeof(typical_contacts) / sizeof(typical_contacts[0]) && contactcount < MAX_NUM_ADDR_LINES; n++)
+  {
+    contacts[contactcount++] = strdup(typical_contacts[n]);
+  }
+  unsigned long found = 0, total = 0;
+  uint32_t value;
+  clock_t begin, end;
+  int i, k;
+  uint32_t j;
+
+  for (i = 0; i < viacount; i++)
+  {
+    vhdrs[i] = new ViaHeader();
+    vhdrs[i]->ParseHeader(vias[i], 0, (uint32_t)strlen(vias[i]));
+  }
+  for (i = 0; i < contactcount; i++)
+  {
+    chdrs[i] = new ContactHeader();
+    chdrs[i]->ParseHeader(contacts[i], 0, (uint32_t)strlen(contacts[i]));
+  }
+  fprintf(stdout, "Trying %i lookups on %i Via and %i Contact headers\n", loopcount, viacount, contactcount);
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < viacount; i++)
+    {
+      for (j = 0; j < vhdrs[i]->num_via_parms; j++)
+      {
+        const via_param_t& via = vhdrs[i]->via_parms[j];
+        found += find_param(vias[i], &via.params[0], via.num_params, "branch", 6) != NULL;
+        found += find_param(vias[i], &via.params[0], via.num_params, "received", 8) != NULL;
+        found += find_param(vias[i], &via.params[0], via.num_params, "rport", 5) != NULL;
+      }
+    }
+    for (i = 0; i < contactcount; i++)
+    {
+      for (j = 0; j < chdrs[i]->num_contact_parms; j++)
+      {
+        const contact_param_t& cont = chdrs[i]->contact_parms[j];
+        const param_pos_t* q = find_param(contacts[i], &cont.params[0], cont.num_params, "q", 1);
+        const param_pos_t* expires = find_param(contacts[i], &cont.params[0], cont.num_params, "expires", 7);
+        if (q != NULL && q->value.length)
+        {
+          total += (unsigned long)(atof(std::string(contacts[i] + q->value.start, q->value.length).c_str()) * 1000);
+        }
+        if (expires != NULL && expires->value.length)
+        {
+          total += strtoul(std::string(contacts[i] + expires->value.start, expires->value.length).c_str(), NULL, 10);
+        }
+      }
+    }
+  }
+  end = clock();
+  printf("  by name: %f (%lu, %lu)\n", (double)(end - begin) / CLOCKS_PER_SEC, found, total);
+
+  found = total = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < viacount; i++)
+    {
+      for (j = 0; j < vhdrs[i]->num_via_parms; j++)
+      {
+        found += vhdrs[i]->GetParam(PARAM_BRANCH, j) != NULL;
+        found += vhdrs[i]->GetParam(PARAM_RECEIVED, j) != NULL;
+        found += vhdrs[i]->GetParam(PARAM_RPORT, j) != NULL;
+      }
+    }
+    for (i = 0; i < contactcount; i++)
+    {
+      for (j = 0; j < chdrs[i]->num_contact_parms; j++)
+      {
+        if (chdrs[i]->GetParamU32(PARAM_Q, &value, j) == 0)
+        {
+          total += value;
+        }
+        if (chdrs[i]->GetParamU32(PARAM_EXPIRES, &value, j) == 0)
+        {
+          total += value;
+        }
+      }
+    }
+  }
+  end = clock();
+  printf("  by id  : %f (%lu, %lu)\n", (double)(end - begin) / CLOCKS_PER_SEC, found, total);
+
+  for (i = 0; i < viacount; i++)
+  {
+    delete vhdrs[i];
+    free(vias[i]);
+  }
+  for (i = 0; i < contactcount; i++)
+  {
+    delete chdrs[i];
+    free(contacts[i]);
+  }
+  return 0;
+}
+
+#define MAX_NUM_CHAIN_MSGS 64
+
+static bool is_via(const SipMessage* msg, uint32_t i)
+{
+  const str_pos_t& field = msg->headers[i].fieldpos;
+  const char* name = &msg->v1[field.start];
+  return (field.length == 3 && 0 == _strnicmp_(name, "Via", 3)) || (field.length == 1 && LOWERC(name[0]) == 'v');
+}
+
+/* Messages of sip0..sip96 with more than one Via hop, i.e. sip79 has 34 of
+   them. A leading description line of a file is skipped. Returns the number of messages loaded */
+int load_chain_corpus(sip_parser* parser, const sip_parser_settings* settings, SipMessage** msgs)
+{
+  char filename[256];
+  int count = 0;
+
+  parse_headers_on_complete = 0;
+  for (int i = 0; i < FWD_FILE_COUNT && count < MAX_NUM_CHAIN_MSGS; i++)
+  {
+    char* data = NULL;
+    int length = 0;
+    int skip = 0;
+
+    snprintf(filename, sizeof(filename), FWD_DIR "sip%d", i);
+    if (read_message(filename, &data, &length) != 0)
+    {
+      continue;
+    }
+    if (length > 15 && 0 == strncmp(data, "expected_error:", 15))
+    {
+      const char* eol = (const char*)memchr(data, '\n', length);
+      skip = eol ? (int)(eol - data) + 1 : length;
+    }
+    SipMessage* currentmsg = new SipMessage();
+    currentmsg->v1.resize(length - skip + 1);
+    memcpy(&currentmsg->v1[0], data + skip, length - skip);
+    sip_parser_init(parser, SIP_BOTH);
+    parser->currmsg = currentmsg;
+    sip_parser_execute(parser, settings, &currentmsg->v1[0], length - skip);
+    free(data);
+
+    ViaChain chain(currentmsg);
+    uint32_t hops = 0;
+    while (chain.Next())
+    {
+      hops++;
+    }
+    /* a malformed hop ends the chain, the hops before it are still there */
+    if (hops > 1)
+    {
+      msgs[count++] = currentmsg;
+    }
+    else
+    {
+      delete currentmsg;
+    }
+  }
+  parse_headers_on_complete = 1;
+  return count;
+}
+
+/* Via hops of the multi-Via messages of the corpus: the top hop and all hops,
+   each Via line parsed into a ViaHeader as before, and with ViaChain */
+int test_via_chain(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  SipMessage* msgs[MAX_NUM_CHAIN_MSGS];
+  int count = load_chain_corpus(parser, settings, msgs);
+  unsigned long hops = 0;
+  clock_t begin, end;
+  int i, k;
+  uint32_t h;
+
+  fprintf(stdout, "Trying %i loops on %i messages, ViaHeader is %u bytes, ViaChain %u bytes\n",
+          loopcount, count, (unsigned)sizeof(ViaHeader), (unsigned)sizeof(ViaChain));
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      for (h = 0; h < msgs[i]->num_headers; h++)
+      {
+        if (is_via(msgs[i], h))
+        {
+          const str_pos_t& value = msgs[i]->headers[h].valuepos;
+          ViaHeader vhdr;
+          vhdr.ParseHeader(&msgs[i]->v1[0], value.start, value.start + value.length);
+          hops += (vhdr.parsing_stat == PARSED_SUCCESSFULLY) ? 1 : 0;
+          break;
+        }
+      }
+    }
+  }
+  end = clock();
+  printf("  top Via, ViaHeader: %f (%lu hops)\n", (double)(end - begin) / CLOCKS_PER_SEC, hops);
+
+  hops = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      ViaChain chain(msgs[i]);
+      hops += chain.Next() ? 1 : 0;
+    }
+  }
+  end = clock();
+  printf("  top Via, ViaChain : %f (%lu hops)\n", (double)(end - begin) / CLOCKS_PER_SEC, hops);
+
+  hops = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      for (h = 0; h < msgs[i]->num_headers; h++)
+      {
+        if (is_via(msgs[i], h))
+        {
+          const str_pos_t& value = msgs[i]->headers[h].valuepos;
+          ViaHeader vhdr;
+          vhdr.ParseHeader(&msgs[i]->v1[0], value.start, value.start + value.length);
+          hops += (vhdr.parsing_stat == PARSED_SUCCESSFULLY) ? vhdr.num_via_parms : 0;
+        }
+      }
+    }
+  }
+  end = clock();
+  printf("  all Vias, ViaHeader: %f (%lu hops)\n", (double)(end - begin) / CLOCKS_PER_SEC, hops);
+
+  hops = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      ViaChain chain(msgs[i]);
+      while (chain.Next())
+      {
+        hops++;
+      }
+    }
+  }
+  end = clock();
+  printf("  all Vias, ViaChain : %f (%lu hops)\n", (double)(end - begin) / CLOCKS_PER_SEC, hops);
+
+  for (i = 0; i < count; i++)
+  {
+    delete msgs[i];
+  }
+  return 0;
+}
+
+#define ROUTES_FILE "../../src/siptest/res/routes.txt"
+#define RECORDROUTES_FILE "../../src/siptest/res/recordroutes.txt"
+
+/* osipparser2 equivalents of the generated parsers. Headers without a parser
+   in osip are kept as a copied name and value, as osip_message_set_header() does */
+static int osip_route_bench(const char* name, const char* value)
+{
+  osip_route_t* route;
+  osip_route_init(&route);
+  int err = osip_route_parse(route, value);
+  osip_route_free(route);
+  return err;
+}
+
+static int osip_record_route_bench(const char* name, const char* value)
+{
+  osip_record_route_t* rroute;
+  osip_record_route_init(&rroute);
+  int err = osip_record_route_parse(rroute, value);
+  osip_record_route_free(rroute);
+  return err;
+}
+
+static int osip_call_info_bench(const char* name, const char* value)
+{
+  osip_call_info_t* info;
+  osip_call_info_init(&info);
+  int err = osip_call_info_parse(info, value);
+  osip_call_info_free(info);
+  return err;
+}
+
+static int osip_content_disposition_bench(const char* name, const char* value)
+{
+  osip_content_disposition_t* disp;
+  osip_content_disposition_init(&disp);
+  int err = osip_content_disposition_parse(disp, value);
+  osip_content_disposition_free(disp);
+  return err;
+}
+
+static int osip_content_encoding_bench(const char* name, const char* value)
+{
+  osip_content_encoding_t* enc;
+  osip_content_encoding_init(&enc);
+  int err = osip_content_encoding_parse(enc, value);
+  osip_content_encoding_free(enc);
+  return err;
+}
+
+static int osip_header_bench(const char* name, const char* value)
+{
+  osip_header_t* header;
+  osip_header_init(&header);
+  header->hname = osip_strdup(name);
+  header->hvalue = osip_strdup(value);
+  osip_header_free(header);
+  return 0;
+}
+
+static const struct
+{
+  const char* name;
+  const char* value;
+  int (*osip_parse)(const char* name, const char* value);
+} typical_generic_values[] =
+{
+  { "Route", NULL, osip_route_bench },
+  { "Record-Route", NULL, osip_record_route_bench },
+  { "Call-Info", "<http://www.example.com/alice/photo.jpg> ;purpose=icon", osip_call_info_bench },
+  { "Alert-Info", "<http://www.example.com/sounds/moo.wav>", osip_call_info_bench },
+  { "Error-Info", "<sip:not-in-service-recording@atlanta.com>", osip_call_info_bench },
+  { "Content-Disposition", "session;handling=required", osip_content_disposition_bench },
+  { "Content-Encoding", "gzip", osip_content_encoding_bench },
+  { "Supported", "replaces, 100rel, timer, gruu", osip_header_bench },
+  { "Session-Expires", "1800;refresher=uac", osip_header_bench },
+  { "Event", "presence;id=1", osip_header_bench },
+  { "Subscription-State", "active;expires=3600", osip_header_bench },
+  { "P-Asserted-Identity", "\"Alice\" <sip:alice@atlanta.example.com>", osip_header_bench },
+  { "Replaces", "425928@bobster.example.org;to-tag=7743;from-tag=6472", osip_header_bench },
+  { "Retry-After", "120 (I'm in a meeting);duration=3600", osip_header_bench },
+  { "User-Agent", "Softphone Beta1.5", osip_header_bench },
+};
+
+/* Per header throughput of the parsers generated from SIP_GENERIC_HEADER_MAP:
+   into an instance kept by the caller, into a new one from CreateGenericHeader()
+   and by osipparser2. Route and Record-Route values are the lines of
+   routes.txt and recordroutes.txt */
+int test_generic_header(int loopcount)
+{
+  char* values[MAX_NUM_ADDR_LINES];
+  uint32_t lengths[MAX_NUM_ADDR_LINES];
+  unsigned long parsed;
+  clock_t begin, end;
+  int count, i, k;
+
+  fprintf(stdout, "Trying %i loops per header, GenericHeader is %u bytes\n", loopcount, (unsigned)sizeof(GenericHeader));
+  for (size_t n = 0; n < sizeof(typical_generic_values) / sizeof(typical_generic_values[0]); n++)
+  {
+    const char* name = typical_generic_values[n].name;
+    uint32_t namelen = (uint32_t)strlen(name);
+
+    if (typical_generic_values[n].value != NULL)
+    {
+      values[0] = strdup(typical_generic_values[n].value);
+      count = 1;
+    }
+    else if (n == 0)
+    {
+      count = load_addr_lines<RouteHeader>(ROUTES_FILE, values);
+    }
+    else
+    {
+      count = load_addr_lines<RecordRouteHeader>(RECORDROUTES_FILE, values);
+    }
+    for (i = 0; i < count; i++)
+    {
+      lengths[i] = (uint32_t)strlen(values[i]);
+    }
+
+    GenericHeader* hdr = CreateGenericHeader(name, namelen);
+    parsed = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        hdr->ParseHeader(values[i], 0, lengths[i]);
+        parsed += (hdr->parsing_stat == PARSED_SUCCESSFULLY) ? 1 : 0;
+      }
+    }
+    end = clock();
+    delete hdr;
+    printf("  %-20s %2i values: %f (%lu)", name, count, (double)(end - begin) / CLOCKS_PER_SEC, parsed);
+
+    parsed = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        hdr = CreateGenericHeader(name, namelen);
+        hdr->ParseHeader(values[i], 0, lengths[i]);
+        parsed += (hdr->parsing_stat == PARSED_SUCCESSFULLY) ? 1 : 0;
+        delete hdr;
+      }
+    }
+    end = clock();
+    printf(", created: %f (%lu)", (double)(end - begin) / CLOCKS_PER_SEC, parsed);
+
+    parsed = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        parsed += (typical_generic_values[n].osip_parse(name, values[i]) == 0) ? 1 : 0;
+      }
+    }
+    end = clock();
+    printf(", osip: %f (%lu)\n", (double)(end - begin) / CLOCKS_PER_SEC, parsed);
+
+    for (i = 0; i < count; i++)
+    {
+      free(values[i]);
+    }
+  }
+  return 0;
+}
+
+/* The top hop of osip: host, port and lr of the first route as a proxy needs */
+static int osip_top_hop(osip_list_t* routes, unsigned long* lr)
+{
+  osip_route_t* route = (osip_route_t*)osip_list_get(routes, 0);
+  osip_uri_param_t* param = NULL;
+
+  if (route == NULL || route->url == NULL || route->url->host == NULL)
+  {
+    return -1;
+  }
+  if (osip_uri_uparam_get_byname(route->url, (char*)"lr", &param) == 0)
+  {
+    (*lr)++;
+  }
+  return (route->url->port != NULL) ? atoi(route->url->port) : 5060;
+}
+
+/* Route and Record-Route values of routes.txt and recordroutes.txt: all hops
+   of RouteHeader, the top hop only by ParseTop() and osipparser2 with the
+   host, port and lr parameter of the top hop picked up in each */
+template <class T>
+static void test_route_file(const char* name, const char* filename, int loopcount)
+{
+  char* values[MAX_NUM_ADDR_LINES];
+  uint32_t lengths[MAX_NUM_ADDR_LINES];
+  unsigned long hops = 0, lr = 0, ports = 0;
+  clock_t begin, end;
+  int count, i, k;
+  char hname[16];
+  T hdr;
+
+  /* lower case as osip_message_set_multiple_header() makes it in place */
+  snprintf(hname, sizeof(hname), "%s", name);
+  osip_tolower(hname);
+  count = load_addr_lines<T>(filename, values);
+  for (i = 0; i < count; i++)
+  {
+    lengths[i] = (uint32_t)strlen(values[i]);
+  }
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      hdr.ParseHeader(values[i], 0, lengths[i]);
+      for (uint32_t n = 0; n < hdr.num_elements; n++)
+      {
+        ports += hdr.GetHop(n).port + hdr.GetHop(n).host.length;
+        lr += hdr.IsLooseRouting(n) ? 1 : 0;
+        hops++;
+      }
+    }
+  }
+  end = clock();
+  printf("  %-12s %2i values, all hops: %f (%lu hops, %lu lr)\n", name, count, (double)(end - begin) / CLOCKS_PER_SEC, hops, lr);
+
+  hops = lr = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      hdr.ParseTop(values[i], 0, lengths[i]);
+      if (hdr.parsing_stat == PARSED_SUCCESSFULLY)
+      {
+        ports += hdr.GetHop().port + hdr.GetHop().host.length;
+        lr += hdr.IsLooseRouting() ? 1 : 0;
+        hops++;
+      }
+    }
+  }
+  end = clock();
+  printf("  %-12s %2i values, top hop : %f (%lu hops, %lu lr)\n", name, count, (double)(end - begin) / CLOCKS_PER_SEC, hops, lr);
+
+  hops = lr = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      osip_message_t* sip;
+      osip_message_init(&sip);
+      if (osip_message_set_multiple_header(sip, hname, values[i]) == 0)
+      {
+        osip_list_t* routes = (hdr.id == GHDR_ROUTE) ? &sip->routes : &sip->record_routes;
+        int port = osip_top_hop(routes, &lr);
+        if (port >= 0)
+        {
+          ports += port;
+          hops++;
+        }
+      }
+      osip_message_free(sip);
+    }
+  }
+  end = clock();
+  printf("  %-12s %2i values, osip    : %f (%lu hops, %lu lr)\n", name, count, (double)(end - begin) / CLOCKS_PER_SEC, hops, lr);
+
+  if (ports == 0)
+  {
+    printf("  no ports\n");
+  }
+  for (i = 0; i < count; i++)
+  {
+    free(values[i]);
+  }
+}
+
+int test_route(int loopcount)
+{
+  fprintf(stdout, "Trying %i loops per value\n", loopcount);
+  test_route_file<RouteHeader>("Route", ROUTES_FILE, loopcount);
+  test_route_file<RecordRouteHeader>("Record-Route", RECORDROUTES_FILE, loopcount);
+  return 0;
+}
+
+#define AUTHS_FILE "../../src/siptest/res/auths.txt"
+
+/* Digest credentials of RFC 2617 3.5 and RFC 2069 2.4 */
+static const char* typical_credentials[] =
+{
+  "Digest username=\"Mufasa\", realm=\"testrealm@host.com\", nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+  "uri=\"/dir/index.html\", qop=auth, nc=00000001, cnonce=\"0a4f113b\", response=\"6629fae49393a05397450978507c4ef1\", "
+  "opaque=\"5ccc069c403ebaf9f0171e9517f40e41\"",
+  "Digest username=\"Mufasa\", realm=\"testrealm@host.com\", nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+  "uri=\"/dir/index.html\", response=\"1949323746fe6a43ef61f9606e7febea\", opaque=\"5ccc069c403ebaf9f0171e9517f40e41\"",
+};
+
+static void osip_md5_hex(osip_MD5_CTX* ctx, char hex[MD5_HEX_SIZE])
+{
+  unsigned char digest[MD5_DIGEST_SIZE];
+  osip_MD5Final(digest, ctx);
+  md5_to_hex(digest, hex);
+}
+
+static void osip_md5_str(osip_MD5_CTX* ctx, const char* s)
+{
+  osip_MD5Update(ctx, (unsigned char*)s, (unsigned int)strlen(s));
+}
+
+/* verification as done over osipparser2: parameters are copied without
+   their double quotes, then hashed by osip_md5c.c. Returns 0 on match */
+static int osip_verify_digest(const char* value, const char* ha1, const char* method)
+{
+  osip_authorization_t* auth;
+  char ha2[MD5_HEX_SIZE], expected[MD5_HEX_SIZE];
+  osip_MD5_CTX ctx;
+  int result = 1;
+
+  osip_authorization_init(&auth);
+  if (osip_authorization_parse(auth, value) == 0 && auth->nonce && auth->uri && auth->response)
+  {
+    char* nonce = osip_strdup_without_quote(auth->nonce);
+    char* uri = osip_strdup_without_quote(auth->uri);
+    char* response = osip_strdup_without_quote(auth->response);
+    char* cnonce = auth->cnonce ? osip_strdup_without_quote(auth->cnonce) : NULL;
+    char* qop = auth->message_qop ? osip_strdup_without_quote(auth->message_qop) : NULL;
+
+    osip_MD5Init(&ctx);
+    osip_md5_str(&ctx, method);
+    osip_md5_str(&ctx, ":");
+    osip_md5_str(&ctx, uri);
+    osip_md5_hex(&ctx, ha2);
+
+    osip_MD5Init(&ctx);
+    osip_MD5Update(&ctx, (unsigned char*)ha1, MD5_HEX_SIZE);
+    osip_md5_str(&ctx, ":");
+    osip_md5_str(&ctx, nonce);
+    osip_md5_str(&ctx, ":");
+    if (qop != NULL && cnonce != NULL && auth->nonce_count != NULL)
+    {
+      osip_md5_str(&ctx, auth->nonce_count);
+      osip_md5_str(&ctx, ":");
+      osip_md5_str(&ctx, cnonce);
+      osip_md5_str(&ctx, ":");
+      osip_md5_str(&ctx, qop);
+      osip_md5_str(&ctx, ":");
+    }
+    osip_MD5Update(&ctx, (unsigned char*)ha2, MD5_HEX_SIZE);
+    osip_md5_hex(&ctx, expected);
+    result = (strlen(response) == MD5_HEX_SIZE && osip_strncasecmp(response, expected, MD5_HEX_SIZE) == 0) ? 0 : 1;
+
+    osip_free(nonce);
+    osip_free(uri);
+    osip_free(response);
+    osip_free(cnonce);
+    osip_free(qop);
+  }
+  osip_authorization_free(auth);
+  return result;
+}
+
+/* Authorization and WWW-Authenticate values of auths.txt parsed into spans
+   and by osipparser2, then parsing and verification of digest credentials
+   against a cached HA1 */
+int test_auth(int loopcount)
+{
+  char* values[MAX_NUM_ADDR_LINES];
+  uint32_t lengths[MAX_NUM_ADDR_LINES];
+  unsigned long parsed;
+  clock_t begin, end;
+  int count, i, k;
+  char ha1[MD5_HEX_SIZE];
+
+  fprintf(stdout, "Trying %i loops per value\n", loopcount);
+  for (int www = 0; www < 2; www++)
+  {
+    count = www ? load_addr_lines<WwwAuthenticateHeader>(AUTHS_FILE, values) : load_addr_lines<AuthorizationHeader>(AUTHS_FILE, values);
+    for (i = 0; i < count; i++)
+    {
+      lengths[i] = (uint32_t)strlen(values[i]);
+    }
+
+    AuthorizationHeader auth;
+    WwwAuthenticateHeader challenge;
+    AuthHeader* hdr = www ? (AuthHeader*)&challenge : (AuthHeader*)&auth;
+    parsed = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        hdr->ParseHeader(values[i], 0, lengths[i]);
+        parsed += (hdr->parsing_stat == PARSED_SUCCESSFULLY) ? 1 : 0;
+      }
+    }
+    end = clock();
+    printf("  %-16s %2i values: %f (%lu)", hdr->GetName(), count, (double)(end - begin) / CLOCKS_PER_SEC, parsed);
+
+    parsed = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      for (i = 0; i < count; i++)
+      {
+        int err;
+        if (www)
+        {
+          osip_www_authenticate_t* wwwa;
+          osip_www_authenticate_init(&wwwa);
+          err = osip_www_authenticate_parse(wwwa, values[i]);
+          osip_www_authenticate_free(wwwa);
+        }
+        else
+        {
+          osip_authorization_t* autha;
+          osip_authorization_init(&autha);
+          err = osip_authorization_parse(autha, values[i]);
+          osip_authorization_free(autha);
+        }
+        parsed += (err == 0) ? 1 : 0;
+      }
+    }
+    end = clock();
+    printf(", osip: %f (%lu)\n", (double)(end - begin) / CLOCKS_PER_SEC, parsed);
+
+    for (i = 0; i < count; i++)
+    {
+      free(values[i]);
+    }
+  }
+
+  count = sizeof(typical_credentials) / sizeof(typical_credentials[0]);
+  for (i = 0; i < count; i++)
+  {
+    lengths[i] = (uint32_t)strlen(typical_credentials[i]);
+  }
+  for (i = 0; i < count; i++)
+  {
+    AuthorizationHeader auth;
+    const char* password = (i == 0) ? "Circle Of Life" : "CircleOfLife";
+    unsigned long verified = 0;
+
+    digest_calc_ha1("Mufasa", "testrealm@host.com", password, ha1);
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      auth.ParseHeader(typical_credentials[i], 0, lengths[i]);
+      verified += (auth.VerifyDigest(ha1, "GET", 3) == 0) ? 1 : 0;
+    }
+    end = clock();
+    printf("  verify %s: %f (%lu)", (i == 0) ? "qop=auth" : "no qop  ", (double)(end - begin) / CLOCKS_PER_SEC, verified);
+
+    verified = 0;
+    begin = clock();
+    for (k = 0; k < loopcount; k++)
+    {
+      verified += (osip_verify_digest(typical_credentials[i], ha1, "GET") == 0) ? 1 : 0;
+    }
+    end = clock();
+    printf(", osip: %f (%lu)\n", (double)(end - begin) / CLOCKS_PER_SEC, verified);
+  }
+  return 0;
+}
+
+#define MAX_NUM_DATAGRAMS 128
+
+/* clears what the parsing fills in, the bytes are kept */
+static void reset_message(SipMessage* msg)
+{
+  for (uint32_t i = 0; i < msg->num_headers; i++)
+  {
+    msg->headers[i] = header_pos_t();
+  }
+  msg->type = SIP_BOTH;
+  msg->method = SIP_ACK;
+  msg->status_code = 0;
+  msg->response_status = { 0, 0 };
+  msg->request_method = { 0, 0 };
+  msg->request_url = { 0, 0 };
+  msg->msg_body = { 0, 0 };
+  msg->num_headers = 0;
+  msg->folded.reset();
+  msg->unfolded.clear();
+  msg->unfolded_values.clear();
+  msg->last_header_element = NONE;
+  msg->sip_major = msg->sip_minor = 0;
+  msg->message_begin_cb_called = msg->headers_complete_cb_called = msg->message_complete_cb_called = 0;
+  msg->message_begin_pos = msg->headers_complete_pos = msg->message_complete_pos = 0;
+  msg->status_cb_called = msg->body_is_final = 0;
+}
+
+/* loads the messages of sip0..sip96 that sip_parser_execute() completes in one
+   call, returns the count of them */
+static int load_complete_messages(sip_parser* parser, const sip_parser_settings* settings,
+                                  SipMessage** msgs, unsigned long* bytes)
+{
+  char filename[256];
+  int count = 0;
+
+  *bytes = 0;
+  for (int i = 0; i < FWD_FILE_COUNT && count < MAX_NUM_DATAGRAMS; i++)
+  {
+    char* data = NULL;
+    int length = 0;
+
+    snprintf(filename, sizeof(filename), FWD_DIR "sip%d", i);
+    if (read_message(filename, &data, &length) != 0)
+    {
+      continue;
+    }
+    SipMessage* currentmsg = new SipMessage();
+    currentmsg->v1.assign(data, data + length);
+    free(data);
+    sip_parser_init(parser, SIP_BOTH);
+    parser->currmsg = currentmsg;
+    if (sip_parser_execute(parser, settings, &currentmsg->v1[0], length) == (size_t)length &&
+        currentmsg->message_complete_cb_called && parser->currmsg == NULL)
+    {
+      *bytes += length;
+      msgs[count++] = currentmsg;
+    }
+    else
+    {
+      delete currentmsg;
+    }
+  }
+  return count;
+}
+
+/* Header index of the complete messages of sip0..sip96, as datagrams: by
+   sip_parser_execute() with the callbacks and by DatagramParser */
+int test_datagram(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  SipMessage* msgs[MAX_NUM_DATAGRAMS];
+  DatagramParser dparser;
+  unsigned long bytes = 0;
+  unsigned long headers = 0;
+  clock_t begin, end;
+  int count;
+  int i, k;
+
+  parse_headers_on_complete = 0;
+  count = load_complete_messages(parser, settings, msgs, &bytes);
+
+  fprintf(stdout, "Trying %i loops on %i messages of %lu bytes\n", loopcount, count, bytes);
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      reset_message(msgs[i]);
+      sip_parser_init(parser, SIP_BOTH);
+      parser->currmsg = msgs[i];
+      sip_parser_execute(parser, settings, &msgs[i]->v1[0], msgs[i]->v1.size());
+      headers += msgs[i]->num_headers;
+    }
+  }
+  end = clock();
+  printf("  sip_parser_execute: %f (%lu headers, %.1f MB/s)\n", (double)(end - begin) / CLOCKS_PER_SEC, headers,
+         (double)bytes * loopcount / (1 << 20) / ((double)(end - begin) / CLOCKS_PER_SEC));
+
+  headers = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      reset_message(msgs[i]);
+      dparser.Execute(msgs[i], &msgs[i]->v1[0], msgs[i]->v1.size());
+      headers += msgs[i]->num_headers;
+    }
+  }
+  end = clock();
+  printf("  DatagramParser    : %f (%lu headers, %.1f MB/s)\n", (double)(end - begin) / CLOCKS_PER_SEC, headers,
+         (double)bytes * loopcount / (1 << 20) / ((double)(end - begin) / CLOCKS_PER_SEC));
+
+  for (i = 0; i < count; i++)
+  {
+    delete msgs[i];
+  }
+  parse_headers_on_complete = 1;
+  return 0;
+}
+
+/* The same messages by sip_parser_execute() with the callbacks filling SipMessage
+   and by sip_parser_pull() filling a header table */
+int test_pull(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  SipMessage* msgs[MAX_NUM_DATAGRAMS];
+  sip_header_span headers[MAX_NUM_HEADERS];
+  sip_parse_result result;
+  unsigned long bytes = 0;
+  unsigned long nheaders = 0;
+  clock_t begin, end;
+  double elapsed;
+  int count;
+  int i, k;
+
+  parse_headers_on_complete = 0;
+  count = load_complete_messages(parser, settings, msgs, &bytes);
+
+  fprintf(stdout, "Trying %i loops on %i messages of %lu bytes\n", loopcount, count, bytes);
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      reset_message(msgs[i]);
+      sip_parser_init(parser, SIP_BOTH);
+      parser->currmsg = msgs[i];
+      sip_parser_execute(parser, settings, &msgs[i]->v1[0], msgs[i]->v1.size());
+      nheaders += msgs[i]->num_headers;
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  sip_parser_execute: %f (%lu headers, %.1f ns/message)\n", elapsed, nheaders,
+         elapsed * 1e9 / ((double)loopcount * count));
+
+  nheaders = 0;
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      sip_parser_init(parser, SIP_BOTH);
+      result.offset = 0;
+      sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+      sip_parser_pull(parser, &result, &msgs[i]->v1[0], msgs[i]->v1.size());
+      nheaders += result.num_headers;
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  sip_parser_pull   : %f (%lu headers, %.1f ns/message)\n", elapsed, nheaders,
+         elapsed * 1e9 / ((double)loopcount * count));
+
+  for (i = 0; i < count; i++)
+  {
+    delete msgs[i];
+  }
+  parse_headers_on_complete = 1;
+  return 0;
+}
+
+/* Branch misses of this thread where the kernel provides the counter, the
+   descriptor is -1 otherwise (other than Linux, virtual machines) */
+static int open_branch_misses()
+{
+#if defined(__linux__)
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+static void start_branch_misses(int fd)
+{
+#if defined(__linux__)
+  if (fd >= 0)
+  {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+static void print_branch_misses(int fd, double count)
+{
+#if defined(__linux__)
+  long long misses = 0;
+
+  if (fd >= 0)
+  {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &misses, sizeof(misses)) == sizeof(misses))
+    {
+      printf("                      %lld branch misses, %.1f/message\n", misses, misses / count);
+      return;
+    }
+  }
+#endif
+  printf("                      branch misses: n/a\n");
+}
+
+/* State dispatch of sip_parser_execute(), build all with and without
+   -DSIP_PARSER_COMPUTED_GOTO=1 to compare */
+int test_dispatch(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  SipMessage* msgs[MAX_NUM_DATAGRAMS];
+  sip_header_span headers[MAX_NUM_HEADERS];
+  sip_parse_result result;
+  unsigned long bytes = 0;
+  clock_t begin, end;
+  double elapsed;
+  int fd = open_branch_misses();
+  int count;
+  int i, k;
+
+  parse_headers_on_complete = 0;
+  count = load_complete_messages(parser, settings, msgs, &bytes);
+
+  fprintf(stdout, "Trying %i loops on %i messages of %lu bytes, %s dispatch\n", loopcount, count, bytes,
+          SIP_PARSER_COMPUTED_GOTO ? "computed-goto" : "switch");
+
+  start_branch_misses(fd);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      reset_message(msgs[i]);
+      sip_parser_init(parser, SIP_BOTH);
+      parser->currmsg = msgs[i];
+      sip_parser_execute(parser, settings, &msgs[i]->v1[0], msgs[i]->v1.size());
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  sip_parser_execute: %f (%.1f ns/message, %.1f MB/s)\n", elapsed, elapsed * 1e9 / ((double)loopcount * count),
+         (double)bytes * loopcount / (1 << 20) / elapsed);
+  print_branch_misses(fd, (double)loopcount * count);
+
+  start_branch_misses(fd);
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      sip_parser_init(parser, SIP_BOTH);
+      result.offset = 0;
+      sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+      sip_parser_pull(parser, &result, &msgs[i]->v1[0], msgs[i]->v1.size());
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  sip_parser_pull   : %f (%.1f ns/message, %.1f MB/s)\n", elapsed, elapsed * 1e9 / ((double)loopcount * count),
+         (double)bytes * loopcount / (1 << 20) / elapsed);
+  print_branch_misses(fd, (double)loopcount * count);
+
+#if defined(__linux__)
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+#endif
+  for (i = 0; i < count; i++)
+  {
+    delete msgs[i];
+  }
+  parse_headers_on_complete = 1;
+  return 0;
+}
+
+/* the messages parsed 'loopcount' times by a parser variant: for 'datagram'
+   transport or not, of the message type or SIP_BOTH, 'pull' or with the
+   callbacks */
+static void time_variant(sip_parser* parser, const sip_parser_settings* settings, SipMessage** msgs,
+                         const enum sip_parser_type* types, int count, int loopcount,
+                         int datagram, int typed, int pull, const char* name)
+{
+  sip_header_span headers[MAX_NUM_HEADERS];
+  sip_parse_result result;
+  clock_t begin, end;
+  double elapsed;
+  int i, k;
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      enum sip_parser_type type = typed ? types[i] : SIP_BOTH;
+      if (datagram)
+      {
+        sip_parser_init_datagram(parser, type);
+      }
+      else
+      {
+        sip_parser_init(parser, type);
+      }
+      if (pull)
+      {
+        result.offset = 0;
+        sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+        sip_parser_pull(parser, &result, &msgs[i]->v1[0], msgs[i]->v1.size());
+      }
+      else
+      {
+        reset_message(msgs[i]);
+        parser->currmsg = msgs[i];
+        sip_parser_execute(parser, settings, &msgs[i]->v1[0], msgs[i]->v1.size());
+      }
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  %-40s: %f (%.1f ns/message)\n", name, elapsed, elapsed * 1e9 / ((double)loopcount * count));
+}
+
+/* The parser variants chosen at init, build with and without
+   -DSIP_PARSER_VARIANTS=1 to compare with one copy of the parser checking
+   them while parsing */
+int test_variants(sip_parser* parser, const sip_parser_settings* settings, int loopcount)
+{
+  SipMessage* msgs[MAX_NUM_DATAGRAMS];
+  enum sip_parser_type types[MAX_NUM_DATAGRAMS];
+  sip_header_span headers[MAX_NUM_HEADERS];
+  sip_parse_result result;
+  unsigned long bytes = 0;
+  int count;
+  int i;
+
+  parse_headers_on_complete = 0;
+  count = load_complete_messages(parser, settings, msgs, &bytes);
+  for (i = 0; i < count; i++)
+  {
+    sip_parser_init(parser, SIP_BOTH);
+    result.offset = 0;
+    sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+    sip_parser_pull(parser, &result, &msgs[i]->v1[0], msgs[i]->v1.size());
+    types[i] = (enum sip_parser_type)parser->type;
+  }
+
+  fprintf(stdout, "Trying %i loops on %i messages of %lu bytes, %s\n", loopcount, count, bytes,
+          SIP_PARSER_VARIANTS ? "parser variants" : "one parser");
+
+  time_variant(parser, settings, msgs, types, count, loopcount, 0, 0, 0, "sip_parser_execute, stream, SIP_BOTH");
+  time_variant(parser, settings, msgs, types, count, loopcount, 1, 0, 0, "sip_parser_execute, datagram, SIP_BOTH");
+  time_variant(parser, settings, msgs, types, count, loopcount, 1, 1, 0, "sip_parser_execute, datagram, typed");
+  time_variant(parser, settings, msgs, types, count, loopcount, 0, 0, 1, "sip_parser_pull, stream, SIP_BOTH");
+  time_variant(parser, settings, msgs, types, count, loopcount, 1, 0, 1, "sip_parser_pull, datagram, SIP_BOTH");
+  time_variant(parser, settings, msgs, types, count, loopcount, 1, 1, 1, "sip_parser_pull, datagram, typed");
+
+  for (i = 0; i < count; i++)
+  {
+    delete msgs[i];
+  }
+  parse_headers_on_complete = 1;
+  return 0;
+}
+
+static void time_method(sip_parser* parser, const std::vector<std::string>& requests, int loopcount,
+                        size_t split, const char* name)
+{
+  sip_header_span headers[MAX_NUM_HEADERS];
+  sip_parse_result result;
+  clock_t begin, end;
+  double elapsed;
+  size_t i;
+  int k;
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < requests.size(); i++)
+    {
+      const char* data = requests[i].data();
+      size_t length = requests[i].size();
+      size_t first = split ? split : length;
+      sip_parser_init(parser, SIP_BOTH);
+      result.offset = 0;
+      sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+      sip_parser_pull(parser, &result, data, first);
+      if (first < length)
+      {
+        result.offset = (uint32_t)first;
+        sip_parser_pull(parser, &result, data + first, length - first);
+      }
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  %-40s: %f (%.1f ns/request)\n", name, elapsed, elapsed * 1e9 / ((double)loopcount * requests.size()));
+}
+
+/* Requests of each known method and of extension ones, their methods are
+   matched from the first 8 bytes when the Request-Line is all there and byte
+   by byte when it is received after the first byte */
+int test_method(sip_parser* parser, int loopcount)
+{
+  static const char* methods[] = {
+    "ACK", "BYE", "CANCEL", "INFO", "INVITE", "MESSAGE", "NOTIFY", "OPTIONS",
+    "PRACK", "PUBLISH", "REFER", "REGISTER", "SUBSCRIBE", "UPDATE"
+  };
+  static const char* extensions[] = { "FOO", "INVITEX", "REGISTRAR", "X-CUSTOM-METHOD" };
+  std::vector<std::string> known, extension;
+  size_t i;
+
+  for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++)
+  {
+    known.push_back(std::string(methods[i]) + " sip:bob@biloxi.com SIP/2.0\r\nl: 0\r\n\r\n");
+  }
+  for (i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+  {
+    extension.push_back(std::string(extensions[i]) + " sip:bob@biloxi.com SIP/2.0\r\nl: 0\r\n\r\n");
+  }
+
+  fprintf(stdout, "Trying %i loops on %i known and %i extension methods\n", loopcount,
+          (int)known.size(), (int)extension.size());
+
+  time_method(parser, known, loopcount, 0, "known, whole request");
+  time_method(parser, known, loopcount, 1, "known, split after the first byte");
+  time_method(parser, extension, loopcount, 0, "extension, whole request");
+  time_method(parser, extension, loopcount, 1, "extension, split after the first byte");
+  return 0;
+}
+
+#define MALFORMED_FILE_COUNT 20
+
+/* loads the files of 'format' as datagrams, all of them */
+static void load_datagrams(const char* format, int filecount, std::vector<SipMessage*>& msgs)
+{
+  char filename[256];
+
+  for (int i = 0; i < filecount; i++)
+  {
+    char* data = NULL;
+    int length = 0;
+
+    snprintf(filename, sizeof(filename), format, i);
+    if (read_message(filename, &data, &length) != 0 || length == 0)
+    {
+      free(data);
+      continue;
+    }
+    SipMessage* msg = new SipMessage();
+    msg->v1.assign(data, data + length);
+    free(data);
+    msgs.push_back(msg);
+  }
+}
+
+static void time_prefilter(const std::vector<SipMessage*>& msgs, int loopcount, const char* name)
+{
+  Prefilter prefilter;
+  DatagramParser dparser;
+  unsigned long rejected = 0;
+  clock_t begin, end;
+  double elapsed[3];
+  double count = (double)loopcount * msgs.size();
+  size_t i;
+  int k;
+
+  for (i = 0; i < msgs.size(); i++)
+  {
+    rejected += (prefilter.Check(&msgs[i]->v1[0], msgs[i]->v1.size()) != SPE_OK) ? 1 : 0;
+  }
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < msgs.size(); i++)
+    {
+      prefilter.Check(&msgs[i]->v1[0], msgs[i]->v1.size());
+    }
+  }
+  end = clock();
+  elapsed[0] = (double)(end - begin) / CLOCKS_PER_SEC;
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < msgs.size(); i++)
+    {
+      reset_message(msgs[i]);
+      dparser.Execute(msgs[i], &msgs[i]->v1[0], msgs[i]->v1.size());
+    }
+  }
+  end = clock();
+  elapsed[1] = (double)(end - begin) / CLOCKS_PER_SEC;
+
+  begin = clock();
+  for (k = 0; k < loopcount; k++)
+  {
+    for (i = 0; i < msgs.size(); i++)
+    {
+      if (prefilter.Check(&msgs[i]->v1[0], msgs[i]->v1.size()) == SPE_OK)
+      {
+        reset_message(msgs[i]);
+        dparser.Execute(msgs[i], &msgs[i]->v1[0], msgs[i]->v1.size());
+      }
+    }
+  }
+  end = clock();
+  elapsed[2] = (double)(end - begin) / CLOCKS_PER_SEC;
+
+  printf("  %-10s: %3lu of %3u rejected, Prefilter %.1f ns, DatagramParser %.1f ns, both %.1f ns/message\n", name,
+         rejected, (unsigned)msgs.size(), elapsed[0] * 1e9 / count, elapsed[1] * 1e9 / count, elapsed[2] * 1e9 / count);
+}
+
+/* Reject rate and cost of Prefilter in front of DatagramParser for the files
+   of sip0..sip96 as traffic, of sip-malformed0..19 and of both mixed */
+int test_prefilter(int loopcount)
+{
+  std::vector<SipMessage*> traffic, malformed, mixed;
+  size_t i;
+
+  load_datagrams(FWD_DIR "sip%d", FWD_FILE_COUNT, traffic);
+  load_datagrams(FWD_DIR "sip-malformed%d", MALFORMED_FILE_COUNT, malformed);
+  /* the malformed ones interleaved with the first traffic ones, as a flood mixed with calls */
+  for (i = 0; i < traffic.size() || i < malformed.size(); i++)
+  {
+    if (i < traffic.size())
+    {
+      mixed.push_back(traffic[i]);
+    }
+    if (i < malformed.size())
+    {
+      mixed.push_back(malformed[i]);
+    }
+  }
+
+  fprintf(stdout, "Trying %i loops on %i traffic and %i malformed datagrams\n", loopcount,
+          (int)traffic.size(), (int)malformed.size());
+
+  time_prefilter(traffic, loopcount, "traffic");
+  time_prefilter(malformed, loopcount, "malformed");
+  time_prefilter(mixed, loopcount, "mixed");
+
+  for (i = 0; i < mixed.size(); i++)
+  {
+    delete mixed[i];
+  }
+  return 0;
+}
+
+#define KEEPALIVE_CONNECTIONS 100000
+
+/* RFC 5626 pings on 100k connections, each of them with a MessageProcessor
+   answering with pongs; every 16th ping is split over two reads. Against
+   what a ping cost before: a SipMessage for it and sip_parser_execute() on
+   a parser of the connection */
+int test_keepalive(int rounds)
+{
+  static unsigned char ping[] = "\r\n\r\n";
+  MessageProcessor* conns = new MessageProcessor[KEEPALIVE_CONNECTIONS];
+  sip_parser* parsers = new sip_parser[KEEPALIVE_CONNECTIONS];
+  sip_parser_settings settings;
+  unsigned long pongs = 0;
+  unsigned long pings = 0;
+  clock_t begin, end;
+  double elapsed;
+  double count = (double)rounds * KEEPALIVE_CONNECTIONS;
+  int i, k;
+
+  fprintf(stdout, "Trying %i rounds of pings on %i connections\n", rounds, KEEPALIVE_CONNECTIONS);
+
+  for (i = 0; i < KEEPALIVE_CONNECTIONS; i++)
+  {
+    conns[i].queue_pongs = true;
+  }
+  begin = clock();
+  for (k = 0; k < rounds; k++)
+  {
+    for (i = 0; i < KEEPALIVE_CONNECTIONS; i++)
+    {
+      if ((i & 15) == (k & 15))
+      {
+        conns[i].MessageReceived(ping, 2, k);
+        conns[i].MessageReceived(ping + 2, 2, k);
+      }
+      else
+      {
+        conns[i].MessageReceived(ping, 4, k);
+      }
+      pongs += conns[i].TakePongs();
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  for (i = 0; i < KEEPALIVE_CONNECTIONS; i++)
+  {
+    pings += conns[i].keepalive.pings;
+  }
+  printf("  MessageProcessor : %f (%.1f ns/ping, %lu pings, %lu pongs)\n", elapsed, elapsed * 1e9 / count, pings, pongs);
+
+  memset(&settings, 0, sizeof(settings));
+  for (i = 0; i < KEEPALIVE_CONNECTIONS; i++)
+  {
+    sip_parser_init(&parsers[i], SIP_BOTH);
+  }
+  begin = clock();
+  for (k = 0; k < rounds; k++)
+  {
+    for (i = 0; i < KEEPALIVE_CONNECTIONS; i++)
+    {
+      SipMessage* msg = new SipMessage();
+      msg->v1.assign(ping, ping + 4);
+      parsers[i].currmsg = msg;
+      sip_parser_execute(&parsers[i], &settings, &msg->v1[0], 4);
+      delete msg;
+    }
+  }
+  end = clock();
+  elapsed = (double)(end - begin) / CLOCKS_PER_SEC;
+  printf("  SipMessage+parser: %f (%.1f ns/ping)\n", elapsed, elapsed * 1e9 / count);
+
+  delete[] conns;
+  delete[] parsers;
+  return 0;
+}
+
+#define FILE_NAME "../../src/osiptest/res/sip12x3"
+#define LOOP_COUNT 1000000
+#define DIALOG_COUNT 1000000
+
+//#define OSIP_TEST
+//#define DIALOG_TEST
+//#define SDP_TEST
+//#define SDP_REWRITE_TEST
+//#define FORWARD_TEST
+//#define URI_COMPARE_TEST
+//#define URI_PARSE_TEST
+//#define URI_LAZY_TEST
+//#define HEADER_VALUE_TEST
+//#define PARAM_LOOKUP_TEST
+//#define VIA_CHAIN_TEST
+//#define GENERIC_HEADER_TEST
+//#define ROUTE_TEST
+//#define AUTH_TEST
+//#define DATAGRAM_TEST
+//#define PULL_TEST
+//#define DISPATCH_TEST
+//#define VARIANTS_TEST
+//#define METHOD_TEST
+//#define PREFILTER_TEST
+//#define KEEPALIVE_TEST
+
+#if defined(URI_LAZY_TEST)
+void* operator new(size_t size)
+{
+  void* p = malloc(size);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  num_allocs++;
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+#endif
+
+int main(int argc, char* argv[]) 
+{
+  int result = 0;
+  char* filename = (char*)FILE_NAME;
+  char* msg = NULL;
+  int msglen = 0;
+
+  if (argc >= 2) 
+  {
+    filename = argv[1];
+  }
+  unsigned long h1 = nhash("Via");
+  unsigned long h2 = lhash("Via:", 3);
+  unsigned long h3 = mhash("via");
+
+  std::cout << "h1=" << h1 << "\nh2=" << h2 << "\nh3=" << h3 << std::endl;
+
+  unsigned long h11 = nhash("Content-Type");
+  unsigned long h21 = lhash("Content-Type:", 12);
+  unsigned long h31 = mhash("Content-Type");
+
+  std::cout << "h1=" << h11 << "\nh2=" << h21 << "\nh3=" << h31 << std::endl;
+
+  result = read_message(filename, &msg, &msglen);
+  if (result != 0)
+  {
+    return result;
+  }
+
+#if defined(OSIP_TEST) || defined(DIALOG_TEST) || defined(SDP_TEST) || defined(SDP_REWRITE_TEST)
+  /* initialize parser */
+  parser_init();
+#else
+  sip_parser_settings settings;
+  memset(&settings, 0, sizeof(settings));
+  settings.on_message_begin = on_message_begin;
+  settings.on_url = on_url;
+  settings.on_status = on_response_status;
+  settings.on_header_field = on_header_field;
+  settings.on_header_value = on_header_value;
+  settings.on_headers_complete = on_headers_complete;
+  settings.on_body = on_body;
+  settings.on_message_complete = on_message_complete;
+
+  sip_parser parser;
+  sip_parser_init(&parser, SIP_BOTH);
+#endif
+
+  clock_t begin = clock();
+
+#if defined(DIALOG_TEST)
+  test_dialog(msg, msglen, DIALOG_COUNT, LOOP_COUNT);
+#elif defined(SDP_TEST)
+  test_sdp(LOOP_COUNT / 10);
+#elif defined(SDP_REWRITE_TEST)
+  test_sdp_rewrite(LOOP_COUNT / 10);
+#elif defined(FORWARD_TEST)
+  parser_init();
+  test_forward(&parser, &settings, LOOP_COUNT / 100);
+#elif defined(URI_COMPARE_TEST)
+  test_uri_compare(LOOP_COUNT / 1000);
+#elif defined(HEADER_VALUE_TEST)
+  test_header_value(LOOP_COUNT / 10);
+#elif defined(PARAM_LOOKUP_TEST)
+  test_param_lookup(LOOP_COUNT / 10);
+#elif defined(VIA_CHAIN_TEST)
+  test_via_chain(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(GENERIC_HEADER_TEST)
+  test_generic_header(LOOP_COUNT / 10);
+#elif defined(ROUTE_TEST)
+  parser_init();
+  test_route(LOOP_COUNT / 10);
+#elif defined(AUTH_TEST)
+  parser_init();
+  test_auth(LOOP_COUNT / 10);
+#elif defined(DATAGRAM_TEST)
+  test_datagram(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(PULL_TEST)
+  test_pull(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(DISPATCH_TEST)
+  test_dispatch(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(VARIANTS_TEST)
+  test_variants(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(METHOD_TEST)
+  test_method(&parser, LOOP_COUNT);
+#elif defined(PREFILTER_TEST)
+  test_prefilter(LOOP_COUNT / 10);
+#elif defined(KEEPALIVE_TEST)
+  test_keepalive(LOOP_COUNT / 10000);
+#elif defined(URI_LAZY_TEST)
+  test_uri_lazy(LOOP_COUNT / 100);
+#elif defined(URI_PARSE_TEST)
+  test_uri_parse(&parser, &settings, LOOP_COUNT / 10);
+#elif defined(OSIP_TEST)
   test_osip(msg, msglen, LOOP_COUNT);
 #else
   test_sip(&parser, &settings, msg, msglen, LOOP_COUNT);
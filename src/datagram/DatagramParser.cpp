@@ -0,0 +1,616 @@
+/*
+ * DatagramParser.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "DatagramParser.h"
+#include "SipHeader.h"
+#include "Utility.h"
+
+#include <string.h>
+
+#ifndef ULLONG_MAX
+# define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
+#endif
+
+/* the ones of sip_parser_limits_init() */
+static const sip_parser_limits default_limits = {
+  SIP_MAX_HEADER_SIZE, (uint32_t)-1, (uint32_t)-1, ULLONG_MAX
+};
+
+/* token chars of header names as sip_parser_execute() accepts them, SP is one
+   of them when not strict */
+static inline bool is_field_char(unsigned char ch)
+{
+  if (IS_ALPHANUM(ch))
+  {
+    return true;
+  }
+  switch (ch)
+  {
+    case ' ': case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+    case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+      return true;
+  }
+  return false;
+}
+
+/* "Content-Length" or "l", both followed only by SPs, in any case */
+static bool is_content_length(const char* name, uint32_t length)
+{
+  uint32_t n;
+
+  if (LOWER(name[0]) == 'l')
+  {
+    n = 1;
+  }
+  else if (length >= 14 && 0 == _strnicmp_(name, "content-length", 14))
+  {
+    n = 14;
+  }
+  else
+  {
+    return false;
+  }
+  while (n < length && name[n] == ' ')
+  {
+    n++;
+  }
+  return n == length;
+}
+
+/* The followings keep SipMessage as the callbacks of MessageProcessor do
+   for the data of the callbacks */
+
+static void add_field(SipMessage* msg, const char* data, uint32_t start, uint32_t length,
+                      unsigned short major, unsigned short minor)
+{
+  if (msg->num_headers == 0)
+  {
+    msg->sip_major = major;
+    msg->sip_minor = minor;
+  }
+  if (msg->last_header_element != FIELD)
+  {
+    msg->num_headers++;
+  }
+  header_pos_t* currpos = &msg->headers[msg->num_headers - 1];
+  if (currpos->fieldpos.start == 0)
+  {
+    currpos->fieldpos.start = start;
+  }
+  currpos->fieldpos.length += length;
+  /* spaces between header-name and ":" are not a part of the name */
+  while (length > 0 && data[start + length - 1] == ' ')
+  {
+    currpos->fieldpos.length--;
+    length--;
+  }
+  msg->last_header_element = FIELD;
+}
+
+static void add_value(SipMessage* msg, uint32_t start, uint32_t length)
+{
+  header_pos_t* currpos = &msg->headers[msg->num_headers - 1];
+
+  if (currpos->valuepos.start == 0)
+  {
+    currpos->valuepos.start = start;
+  }
+  else
+  {
+    /* folding, the CRLF before the continuation line is in the value */
+    if (start != currpos->valuepos.start + currpos->valuepos.length)
+    {
+      msg->folded.set(msg->num_headers - 1);
+    }
+    currpos->valuepos.length = start - currpos->valuepos.start;
+  }
+  currpos->valuepos.length += length;
+  msg->last_header_element = VALUE;
+}
+
+static void add_span(str_pos_t* span, uint32_t start, uint32_t length)
+{
+  if (span->start == 0)
+  {
+    span->start = start;
+  }
+  span->length += length;
+}
+
+size_t DatagramParser::Execute(SipMessage* msg, const char* data, size_t length)
+{
+  const sip_parser_limits* lim = (this->limits != NULL) ? this->limits : &default_limits;
+  /* the header index of SipMessage is a limit too */
+  uint32_t max_headers = (lim->max_headers < MAX_NUM_HEADERS) ? lim->max_headers : MAX_NUM_HEADERS;
+  /* state kept by sip_parser during the parsing */
+  enum sip_method method = (enum sip_method)0;
+  unsigned int status_code = 0;
+  unsigned short major = 0;
+  unsigned short minor = 0;
+  uint64_t content_length = ULLONG_MAX;
+  uint32_t len = (uint32_t)length;
+  /* bytes up to the end of headers are limited as with max_header_size */
+  uint32_t hend = (len > lim->max_header_size) ? lim->max_header_size : len;
+  uint32_t p = 0;
+  uint32_t mark;
+  unsigned char ch;
+
+  this->sip_error = SPE_OK;
+  this->index.Build(data, hend);
+
+#define DGRAM_ERROR(e, pos)                                          \
+  do {                                                               \
+    this->sip_error = (e);                                           \
+    return (pos);                                                    \
+  } while (0)
+
+  /* end of the headers part without a terminating line, the message is not
+     complete unless it is too long */
+#define DGRAM_HEADERS_END()                                          \
+  do {                                                               \
+    if (hend < len)                                                  \
+    {                                                                \
+      DGRAM_ERROR(SPE_HEADER_OVERFLOW, hend);                        \
+    }                                                                \
+    return len;                                                      \
+  } while (0)
+
+  while (p < hend && (data[p] == CR || data[p] == LF))
+  {
+    p++;
+  }
+  if (p >= hend)
+  {
+    DGRAM_HEADERS_END();
+  }
+
+  /* Request-Line / Status-Line */
+  ch = (unsigned char)data[p];
+  if (ch == 'S' && (p + 1 >= hend || data[p + 1] == 'I'))
+  {
+    msg->message_begin_cb_called = 1;
+    msg->message_begin_pos = p;
+    msg->type = SIP_BOTH;
+    if (++p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    {
+      /* "SIP/" is not checked further */
+      p += 3;
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (!IS_DIGIT(data[p]))
+      {
+        DGRAM_ERROR(SPE_INVALID_VERSION, p);
+      }
+      major = data[p] - '0';
+      if (++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] != '.')
+      {
+        DGRAM_ERROR(SPE_INVALID_VERSION, p);
+      }
+      if (++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (!IS_DIGIT(data[p]))
+      {
+        DGRAM_ERROR(SPE_INVALID_VERSION, p);
+      }
+      minor = data[p] - '0';
+      if (++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] != ' ')
+      {
+        DGRAM_ERROR(SPE_INVALID_VERSION, p);
+      }
+      for (p++; p < hend && data[p] == ' '; p++)
+        ;
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (!IS_DIGIT(data[p]))
+      {
+        DGRAM_ERROR(SPE_INVALID_STATUS, p);
+      }
+      for (; p < hend && IS_DIGIT(data[p]); p++)
+      {
+        status_code = status_code * 10 + (data[p] - '0');
+        if (status_code > 999)
+        {
+          DGRAM_ERROR(SPE_INVALID_STATUS, p);
+        }
+      }
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] == ' ')
+      {
+        if (++p >= hend)
+        {
+          DGRAM_HEADERS_END();
+        }
+      }
+      else if (data[p] != CR && data[p] != LF)
+      {
+        DGRAM_ERROR(SPE_INVALID_STATUS, p);
+      }
+      /* Reason-Phrase, may be empty */
+      mark = p;
+      p = this->index.NextLineEnd(p, hend);
+      msg->type = SIP_RESPONSE;
+      add_span(&msg->response_status, mark, p - mark);
+      msg->status_cb_called = 1;
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] == CR && ++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      p++;
+    }
+  }
+  else
+  {
+    if (ch == ' ' || !is_field_char(ch))
+    {
+      DGRAM_ERROR(SPE_INVALID_METHOD, p);
+    }
+    switch (ch)
+    {
+      case 'A': method = SIP_ACK; break;
+      case 'B': method = SIP_BYE; break;
+      case 'C': method = SIP_CANCEL; break;
+      case 'I': method = SIP_INFO; /* or INVITE */ break;
+      case 'M': method = SIP_MESSAGE; break;
+      case 'N': method = SIP_NOTIFY; break;
+      case 'O': method = SIP_OPTIONS; break;
+      case 'P': method = SIP_PRACK;  /* or PUBLISH */ break;
+      case 'R': method = SIP_REFER; /* or REGISTER */ break;
+      case 'S': method = SIP_SUBSCRIBE; break;
+      case 'U': method = SIP_UPDATE; break;
+      default: method = SIP_EXTENSION; break;
+    }
+    msg->message_begin_cb_called = 1;
+    msg->message_begin_pos = p;
+    msg->type = SIP_REQUEST;
+    p++;
+
+    /* the method is matched while it is read, the only ones sharing a prefix
+       are INFO/INVITE, PRACK/PUBLISH and REFER/REGISTER, any other token is
+       an extension method */
+    for (uint32_t idx = 1; ; idx++, p++)
+    {
+      if (p >= hend)
+      {
+        add_span(&msg->request_method, msg->message_begin_pos, p - msg->message_begin_pos);
+        DGRAM_HEADERS_END();
+      }
+      ch = (unsigned char)data[p];
+      if (ch == ' ')
+      {
+        if (method != SIP_EXTENSION && sip_method_str(method)[idx] != '\0')
+        {
+          method = SIP_EXTENSION;
+        }
+        break;
+      }
+      if (!is_field_char(ch))
+      {
+        DGRAM_ERROR(SPE_INVALID_METHOD, p);
+      }
+      if (method == SIP_EXTENSION || ch == (unsigned char)sip_method_str(method)[idx])
+      {
+        continue;
+      }
+      if (method == SIP_INFO && idx == 2 && ch == 'V')
+      {
+        method = SIP_INVITE;
+      }
+      else if (method == SIP_PRACK && idx == 1 && ch == 'U')
+      {
+        method = SIP_PUBLISH;
+      }
+      else if (method == SIP_REFER && idx == 2 && ch == 'G')
+      {
+        method = SIP_REGISTER;
+      }
+      else
+      {
+        method = SIP_EXTENSION;
+      }
+    }
+    add_span(&msg->request_method, msg->message_begin_pos, p - msg->message_begin_pos);
+
+    /* Request-URI, anything up to the next SP */
+    for (p++; p < hend && data[p] == ' '; p++)
+      ;
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    mark = p;
+    const char* sp = (const char*)memchr(data + p + 1, ' ', hend - p - 1);
+    p = (sp != NULL) ? (uint32_t)(sp - data) : hend;
+    if (p >= hend && hend < len)
+    {
+      /* not reported as the ones after max_header_size are not */
+      DGRAM_ERROR(SPE_HEADER_OVERFLOW, hend);
+    }
+    if (p < hend && p - mark > lim->max_url_length)
+    {
+      DGRAM_ERROR(SPE_URL_OVERFLOW, p);
+    }
+    add_span(&msg->request_url, mark, p - mark);
+    msg->method = method;
+    msg->type = SIP_REQUEST;
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+
+    /* SIP-Version, "SIP/" is not checked further */
+    for (p++; p < hend && data[p] == ' '; p++)
+      ;
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    if (data[p] != 'S')
+    {
+      DGRAM_ERROR(SPE_INVALID_CONSTANT, p);
+    }
+    p += 4;
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    if (!IS_DIGIT(data[p]))
+    {
+      DGRAM_ERROR(SPE_INVALID_VERSION, p);
+    }
+    major = data[p] - '0';
+    if (++p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    if (data[p] != '.')
+    {
+      DGRAM_ERROR(SPE_INVALID_VERSION, p);
+    }
+    if (++p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    if (!IS_DIGIT(data[p]))
+    {
+      DGRAM_ERROR(SPE_INVALID_VERSION, p);
+    }
+    minor = data[p] - '0';
+    if (++p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    if (data[p] == CR)
+    {
+      if (++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] != LF)
+      {
+        DGRAM_ERROR(SPE_LF_EXPECTED, p);
+      }
+    }
+    else if (data[p] != LF)
+    {
+      DGRAM_ERROR(SPE_INVALID_VERSION, p);
+    }
+    p++;
+  }
+
+  /* message-header lines up to the empty line */
+  for (;;)
+  {
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    ch = (unsigned char)data[p];
+    if (ch == CR || ch == LF)
+    {
+      /* the char after CR is taken as LF */
+      if (ch == CR && ++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      break;
+    }
+    if (!is_field_char(ch))
+    {
+      DGRAM_ERROR(SPE_INVALID_HEADER_TOKEN, p);
+    }
+    if (msg->num_headers == max_headers)
+    {
+      DGRAM_ERROR(SPE_HEADER_OVERFLOW, p);
+    }
+
+    /* header-name HCOLON */
+    mark = p;
+    for (p++; p < hend && is_field_char((unsigned char)data[p]); p++)
+      ;
+    if (p < hend && data[p] != ':')
+    {
+      DGRAM_ERROR(SPE_INVALID_HEADER_TOKEN, p);
+    }
+    add_field(msg, data, mark, p - mark, major, minor);
+    if (p >= hend)
+    {
+      DGRAM_HEADERS_END();
+    }
+    bool is_cl = is_content_length(data + mark, p - mark);
+    bool cl_ws = false;
+
+    /* leading LWS of the value, a value may be empty or start in a continuation line */
+    for (p++; ; )
+    {
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      ch = (unsigned char)data[p];
+      if (ch == ' ' || ch == '\t')
+      {
+        p++;
+        continue;
+      }
+      if (ch != CR && ch != LF)
+      {
+        break;
+      }
+      p += (ch == CR) ? 2 : 1;
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] == ' ' || data[p] == '\t')
+      {
+        p++;
+        continue;
+      }
+      if (is_cl)
+      {
+        DGRAM_ERROR(SPE_INVALID_CONTENT_LENGTH, p);
+      }
+      /* empty value, its position is the start of the next line */
+      add_value(msg, p, 0);
+      goto next_header;
+    }
+
+    if (is_cl)
+    {
+      if (!IS_DIGIT(ch))
+      {
+        DGRAM_ERROR(SPE_INVALID_CONTENT_LENGTH, p);
+      }
+      if (content_length != ULLONG_MAX)
+      {
+        DGRAM_ERROR(SPE_UNEXPECTED_CONTENT_LENGTH, p);
+      }
+      content_length = ch - '0';
+    }
+
+    /* the value and its continuation lines, the first char of each is not checked */
+    for (mark = p++; ; mark = p++)
+    {
+      uint32_t eol = this->index.NextLineEnd(p, hend);
+      uint32_t ctl = this->index.Next(SC_CTL, p, eol);
+
+      if (is_cl)
+      {
+        for (; p < ctl; p++)
+        {
+          ch = (unsigned char)data[p];
+          if (ch == ' ')
+          {
+            cl_ws = true;
+          }
+          else if (cl_ws || !IS_DIGIT(ch) || (ULLONG_MAX - 10) / 10 < content_length)
+          {
+            DGRAM_ERROR(SPE_INVALID_CONTENT_LENGTH, p);
+          }
+          else
+          {
+            content_length = content_length * 10 + (ch - '0');
+          }
+        }
+      }
+      if (ctl < eol)
+      {
+        DGRAM_ERROR(SPE_INVALID_HEADER_TOKEN, ctl);
+      }
+      add_value(msg, mark, eol - mark);
+      p = eol;
+      if (p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] == CR)
+      {
+        if (++p >= hend)
+        {
+          DGRAM_HEADERS_END();
+        }
+        if (data[p] != LF)
+        {
+          DGRAM_ERROR(SPE_LF_EXPECTED, p);
+        }
+      }
+      if (++p >= hend)
+      {
+        DGRAM_HEADERS_END();
+      }
+      if (data[p] != ' ' && data[p] != '\t')
+      {
+        break;
+      }
+      /* obsolete line folding, a folded Content-Length takes no more digits */
+      cl_ws = true;
+    }
+next_header:
+    ;
+  }
+
+  /* 'p' is at the LF of the empty line */
+  if (content_length != ULLONG_MAX && content_length > lim->max_body_size)
+  {
+    DGRAM_ERROR(SPE_BODY_OVERFLOW, p);
+  }
+  msg->method = method;
+  msg->status_code = status_code;
+  msg->sip_major = major;
+  msg->sip_minor = minor;
+  msg->headers_complete_cb_called = 1;
+  msg->headers_complete_pos = p;
+  msg->should_keep_alive = 1;
+
+  /* a message without Content-Length is taken as one without a body */
+  if (content_length != 0 && content_length != ULLONG_MAX)
+  {
+    if (++p >= len)
+    {
+      return len;
+    }
+    if (content_length > len - p)
+    {
+      add_span(&msg->msg_body, p, len - p);
+      msg->body_is_final = 0;
+      return len;
+    }
+    add_span(&msg->msg_body, p, (uint32_t)content_length);
+    msg->body_is_final = 1;
+    p += (uint32_t)content_length - 1;
+  }
+  msg->message_complete_cb_called = 1;
+  msg->message_complete_pos = p;
+
+#undef DGRAM_HEADERS_END
+#undef DGRAM_ERROR
+
+  return p + 1;
+}
@@ -0,0 +1,64 @@
+/*
+ * DatagramParser.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _DATAGRAM_PARSER_H_
+#define _DATAGRAM_PARSER_H_
+//---------------------------------------------------------------------------
+#include "SipMessage.h"
+#include "StructuralIndex.h"
+
+/*
+  Parses a SIP message received as a whole, i.e. in a UDP datagram, in two
+  phases: StructuralIndex::Build() classifies all bytes first, then the start
+  line and the header lines are located from the CR/LF and ':' bitmaps and
+  SipMessage is filled in the way sip_parser_execute() with the callbacks of
+  MessageProcessor does, with the same positions, leniencies and sip_errno
+  values, so the two can be used interchangeably for datagrams:
+
+      DatagramParser dparser;
+      SipMessage* msg = new SipMessage();
+      msg->v1.assign(data, data + length);
+      size_t nparsed = dparser.Execute(msg, &msg->v1[0], length);
+      if (dparser.sip_error != SPE_OK) ... malformed, 'nparsed' is the position of the error
+      else if (!msg->message_complete_cb_called) ... truncated message
+
+  Only the first message is parsed. On success the return value is the length
+  of it, bytes after the body of Content-Length are not looked at (RFC 3261
+  18.3). 'msg' is expected to be a new SipMessage as the header index is added
+  to, as it is with the callbacks. SetLimits() gives the limits as
+  sip_parser_set_limits() does and, as with MessageProcessor, more than
+  MAX_NUM_HEADERS headers is reported as SPE_HEADER_OVERFLOW. More than
+  max_header_size bytes are reported at the limit, sip_parser_execute() may
+  report them at the end of the line instead.
+
+  It is not a part of the sipmsg library: on the sip0..sip96 corpus it is
+  slower than sip_parser_execute() (DATAGRAM_TEST of benchmain.cpp) and it
+  repeats the leniencies of sipparser.c, so it is built only into siptest,
+  which compares the two on the corpus, and benchmark.
+ */
+
+class DatagramParser
+{
+public:
+  DatagramParser() : sip_error(SPE_OK), limits(NULL) {}
+
+  size_t Execute(SipMessage* msg, const char* data, size_t length);
+
+  /* NULL for the defaults of sip_parser_limits_init() */
+  void SetLimits(const sip_parser_limits* limits) { this->limits = limits; }
+
+  /* bitmaps of the last parsed datagram up to max_header_size bytes,
+     positions are relative to 'data' */
+  const StructuralIndex& GetIndex() const { return index; }
+
+  enum sip_errno sip_error;
+
+private:
+  const sip_parser_limits* limits;
+  StructuralIndex index;
+};
+
+//---------------------------------------------------------------------------
+#endif // _DATAGRAM_PARSER_H_
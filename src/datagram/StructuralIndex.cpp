@@ -0,0 +1,180 @@
+/*
+ * StructuralIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "StructuralIndex.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRUCTURAL_INDEX_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline uint32_t trailing_zeros(uint64_t word)
+{
+#if defined(__GNUC__)
+  return (uint32_t)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long idx;
+  _BitScanForward64(&idx, word);
+  return (uint32_t)idx;
+#else
+  uint32_t idx = 0;
+  while (!(word & 1))
+  {
+    word >>= 1;
+    idx++;
+  }
+  return idx;
+#endif
+}
+
+#ifdef STRUCTURAL_INDEX_SSE2
+
+/* one bit for each of the 16 bytes equal to 'ch' */
+#define EQ_MASK(v, ch) _mm_cmpeq_epi8((v), _mm_set1_epi8(ch))
+
+static void classify_block(const char* block, uint64_t* words)
+{
+  memset(words, 0, NUM_STRUCTURAL_CHARS * sizeof(uint64_t));
+  for (int i = 0; i < 4; i++)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+    __m128i cr = EQ_MASK(v, '\r');
+    __m128i lf = EQ_MASK(v, '\n');
+    __m128i ht = EQ_MASK(v, '\t');
+    /* bytes up to 0x1F, compared unsigned */
+    __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v);
+    __m128i ctl = _mm_or_si128(_mm_andnot_si128(_mm_or_si128(_mm_or_si128(cr, lf), ht), low), EQ_MASK(v, 0x7F));
+    int shift = 16 * i;
+
+    words[SC_CR] |= (uint64_t)(uint16_t)_mm_movemask_epi8(cr) << shift;
+    words[SC_LF] |= (uint64_t)(uint16_t)_mm_movemask_epi8(lf) << shift;
+    words[SC_COLON] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, ':')) << shift;
+    words[SC_SEMICOLON] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, ';')) << shift;
+    words[SC_COMMA] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, ',')) << shift;
+    words[SC_DQUOTE] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, '"')) << shift;
+    words[SC_LAQUOT] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, '<')) << shift;
+    words[SC_RAQUOT] |= (uint64_t)(uint16_t)_mm_movemask_epi8(EQ_MASK(v, '>')) << shift;
+    words[SC_WSP] |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_or_si128(EQ_MASK(v, ' '), ht)) << shift;
+    words[SC_CTL] |= (uint64_t)(uint16_t)_mm_movemask_epi8(ctl) << shift;
+  }
+}
+
+#else
+
+static void classify_block(const char* block, uint64_t* words)
+{
+  memset(words, 0, NUM_STRUCTURAL_CHARS * sizeof(uint64_t));
+  for (int i = 0; i < 64; i++)
+  {
+    uint64_t bit = (uint64_t)1 << i;
+    unsigned char ch = (unsigned char)block[i];
+
+    switch (ch)
+    {
+      case '\r': words[SC_CR] |= bit; break;
+      case '\n': words[SC_LF] |= bit; break;
+      case ':': words[SC_COLON] |= bit; break;
+      case ';': words[SC_SEMICOLON] |= bit; break;
+      case ',': words[SC_COMMA] |= bit; break;
+      case '"': words[SC_DQUOTE] |= bit; break;
+      case '<': words[SC_LAQUOT] |= bit; break;
+      case '>': words[SC_RAQUOT] |= bit; break;
+      case ' ':
+      case '\t': words[SC_WSP] |= bit; break;
+      default:
+        if (ch < 0x20 || ch == 0x7F)
+        {
+          words[SC_CTL] |= bit;
+        }
+        break;
+    }
+  }
+}
+
+#endif
+
+void StructuralIndex::Build(const char* data, uint32_t length)
+{
+  uint32_t nblocks = (length + 63) / 64;
+  uint32_t full = length / 64;
+
+  this->length = length;
+  if (this->bits.size() < (size_t)nblocks * NUM_STRUCTURAL_CHARS)
+  {
+    this->bits.resize((size_t)nblocks * NUM_STRUCTURAL_CHARS);
+  }
+  for (uint32_t b = 0; b < full; b++)
+  {
+    classify_block(data + 64 * b, &this->bits[b * NUM_STRUCTURAL_CHARS]);
+  }
+  if (full < nblocks)
+  {
+    /* the last partial block is classified in a copy, its bits after the end
+       of the data are cleared not to be taken as delimiters */
+    char tail[64];
+    uint32_t rest = length - 64 * full;
+    uint64_t mask = ((uint64_t)1 << rest) - 1;
+    uint64_t* words = &this->bits[full * NUM_STRUCTURAL_CHARS];
+
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, data + 64 * full, rest);
+    classify_block(tail, words);
+    for (int sc = 0; sc < NUM_STRUCTURAL_CHARS; sc++)
+    {
+      words[sc] &= mask;
+    }
+  }
+}
+
+uint32_t StructuralIndex::Next(structural_char_t sc, uint32_t pos, uint32_t end) const
+{
+  if (pos >= end)
+  {
+    return end;
+  }
+  uint32_t b = pos >> 6;
+  uint64_t word = this->bits[b * NUM_STRUCTURAL_CHARS + sc] & (~(uint64_t)0 << (pos & 63));
+
+  while (word == 0)
+  {
+    if ((++b << 6) >= end)
+    {
+      return end;
+    }
+    word = this->bits[b * NUM_STRUCTURAL_CHARS + sc];
+  }
+  pos = (b << 6) + trailing_zeros(word);
+  return (pos < end) ? pos : end;
+}
+
+uint32_t StructuralIndex::NextLineEnd(uint32_t pos, uint32_t end) const
+{
+  if (pos >= end)
+  {
+    return end;
+  }
+  uint32_t b = pos >> 6;
+  const uint64_t* words = &this->bits[b * NUM_STRUCTURAL_CHARS];
+  uint64_t word = (words[SC_CR] | words[SC_LF]) & (~(uint64_t)0 << (pos & 63));
+
+  while (word == 0)
+  {
+    if ((++b << 6) >= end)
+    {
+      return end;
+    }
+    words = &this->bits[b * NUM_STRUCTURAL_CHARS];
+    word = words[SC_CR] | words[SC_LF];
+  }
+  pos = (b << 6) + trailing_zeros(word);
+  return (pos < end) ? pos : end;
+}
@@ -0,0 +1,72 @@
+/*
+ * StructuralIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _STRUCTURAL_INDEX_H_
+#define _STRUCTURAL_INDEX_H_
+//---------------------------------------------------------------------------
+#include <stdint.h>
+#include <vector>
+
+/*
+  Bitmaps of the characters delimiting the parts of a SIP message, one bit per
+  byte of the message and one 64-bit word per 64 bytes for each class. They are
+  built in a single pass over the whole buffer (16 bytes at a time with SSE2),
+  after that the next delimiter of a class is found by skipping 64 bytes with
+  a word compare instead of testing each byte, i.e.
+
+      StructuralIndex index;
+      index.Build(data, length);
+      uint32_t eol = index.NextLineEnd(pos, length);
+      uint32_t semi = index.Next(SC_SEMICOLON, value.start, value.start + value.length);
+
+  DatagramParser locates the start line, the header lines, folded lines and the
+  empty line ending the headers with them; header parsers may use the same
+  index to find the separators in a header value.
+ */
+
+enum structural_char_t
+{
+  SC_CR = 0,
+  SC_LF,
+  SC_COLON,
+  SC_SEMICOLON,
+  SC_COMMA,
+  SC_DQUOTE,
+  SC_LAQUOT,
+  SC_RAQUOT,
+  SC_WSP,            /**< SP and HTAB */
+  SC_CTL,            /**< %x00-1F except HTAB, CR and LF, and %x7F, not allowed in a header value */
+  NUM_STRUCTURAL_CHARS
+};
+
+class StructuralIndex
+{
+public:
+  StructuralIndex() : length(0) {}
+
+  /* Classifies 'length' bytes of 'data'. Storage is kept between the calls, so
+     an index reused for each received datagram does not allocate */
+  void Build(const char* data, uint32_t length);
+
+  /* Position of the first 'sc' in [pos, end), 'end' if there is none */
+  uint32_t Next(structural_char_t sc, uint32_t pos, uint32_t end) const;
+
+  /* Position of the first CR or LF in [pos, end), 'end' if there is none */
+  uint32_t NextLineEnd(uint32_t pos, uint32_t end) const;
+
+  bool Is(structural_char_t sc, uint32_t pos) const
+  {
+    return (this->bits[(pos >> 6) * NUM_STRUCTURAL_CHARS + sc] >> (pos & 63)) & 1;
+  }
+
+  uint32_t GetLength() const { return length; }
+
+private:
+  uint32_t length;
+  std::vector<uint64_t> bits;   /**< NUM_STRUCTURAL_CHARS words for each 64 bytes */
+};
+
+//---------------------------------------------------------------------------
+#endif // _STRUCTURAL_INDEX_H_
@@ -498,3 +498,373 @@ osip_dialog_free (osip_dialog_t * dialog)
   osip_free (dialog->call_id);
   osip_free (dialog);
 }
+
+/* Dialog table: dialogs indexed by (Call-ID, local tag, remote tag).
+   Chained hash table with a power of two number of buckets; each node
+   keeps the hash of its key so that growing never recomputes it.
+   Dialogs without remote tag (early dialogs) are indexed with an empty
+   remote part and used as a fallback when no confirmed dialog matches. */
+
+#define DIALOG_TABLE_MIN_SIZE 64
+
+typedef struct osip_dialog_node osip_dialog_node_t;
+
+struct osip_dialog_node {
+  osip_dialog_node_t *next;
+  unsigned int hash;
+  osip_dialog_t *dialog;
+};
+
+struct osip_dialog_table {
+  osip_dialog_node_t **buckets;
+  unsigned int mask;
+  int count;
+};
+
+/* FNV-1a, updated string by string so that "number" + "@" + "host"
+   hashes exactly like the Call-ID string stored in the dialog. */
+static unsigned int
+__osip_dialog_hash_str (unsigned int hash, const char *str)
+{
+  const unsigned char *p = (const unsigned char *) str;
+
+  while (*p) {
+    hash ^= *p++;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static unsigned int
+__osip_dialog_hash (const char *call_number, const char *call_host, const char *local_tag, const char *remote_tag)
+{
+  unsigned int hash = 2166136261U;
+
+  hash = __osip_dialog_hash_str (hash, call_number);
+  if (call_host != NULL) {
+    hash = __osip_dialog_hash_str (hash, "@");
+    hash = __osip_dialog_hash_str (hash, call_host);
+  }
+  /* separators can not appear in tokens: keep fields apart */
+  hash = (hash ^ 0x01) * 16777619U;
+  hash = __osip_dialog_hash_str (hash, local_tag);
+  hash = (hash ^ 0x02) * 16777619U;
+  if (remote_tag != NULL)
+    hash = __osip_dialog_hash_str (hash, remote_tag);
+
+  /* final avalanche: buckets are selected with the low bits only */
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+/* compare dialog->call_id with a Call-ID given as number and host
+   (as built by osip_call_id_to_str) without building the string */
+static int
+__osip_dialog_call_id_cmp (const char *call_id, const char *call_number, const char *call_host)
+{
+  size_t len = strlen (call_number);
+
+  if (0 != strncmp (call_id, call_number, len))
+    return -1;
+  call_id += len;
+  if (call_host == NULL)
+    return (*call_id == '\0') ? 0 : -1;
+  if (*call_id != '@')
+    return -1;
+  return strcmp (call_id + 1, call_host);
+}
+
+/* remote_tag==NULL only matches early dialogs (no remote tag) */
+static osip_dialog_node_t *
+__osip_dialog_table_lookup (osip_dialog_table_t * table, const char *call_number, const char *call_host, const char *local_tag, const char *remote_tag, osip_dialog_node_t * from)
+{
+  osip_dialog_node_t *node;
+  unsigned int hash;
+
+  hash = __osip_dialog_hash (call_number, call_host, local_tag, remote_tag);
+  node = (from != NULL) ? from->next : table->buckets[hash & table->mask];
+  for (; node != NULL; node = node->next) {
+    osip_dialog_t *dlg = node->dialog;
+
+    if (node->hash != hash)
+      continue;
+    if (remote_tag == NULL) {
+      if (dlg->remote_tag != NULL)
+        continue;
+    }
+    else if (dlg->remote_tag == NULL || 0 != strcmp (dlg->remote_tag, remote_tag))
+      continue;
+    if (0 != strcmp (dlg->local_tag, local_tag))
+      continue;
+    if (0 != __osip_dialog_call_id_cmp (dlg->call_id, call_number, call_host))
+      continue;
+    return node;
+  }
+  return NULL;
+}
+
+static int
+__osip_dialog_table_grow (osip_dialog_table_t * table)
+{
+  osip_dialog_node_t **buckets;
+  unsigned int size = (table->mask + 1) * 2;
+  unsigned int i;
+
+  buckets = (osip_dialog_node_t **) osip_malloc (size * sizeof (osip_dialog_node_t *));
+  if (buckets == NULL)
+    return OSIP_NOMEM;
+  memset (buckets, 0, size * sizeof (osip_dialog_node_t *));
+
+  for (i = 0; i <= table->mask; i++) {
+    osip_dialog_node_t *node = table->buckets[i];
+
+    while (node != NULL) {
+      osip_dialog_node_t *next = node->next;
+
+      node->next = buckets[node->hash & (size - 1)];
+      buckets[node->hash & (size - 1)] = node;
+      node = next;
+    }
+  }
+  osip_free (table->buckets);
+  table->buckets = buckets;
+  table->mask = size - 1;
+  return OSIP_SUCCESS;
+}
+
+int
+osip_dialog_table_init (osip_dialog_table_t ** table, int size_hint)
+{
+  unsigned int size = DIALOG_TABLE_MIN_SIZE;
+
+  if (table == NULL)
+    return OSIP_BADPARAMETER;
+  while (size_hint > 0 && size < (unsigned int) size_hint && size < 0x40000000U)
+    size <<= 1;
+
+  *table = (osip_dialog_table_t *) osip_malloc (sizeof (osip_dialog_table_t));
+  if (*table == NULL)
+    return OSIP_NOMEM;
+  (*table)->buckets = (osip_dialog_node_t **) osip_malloc (size * sizeof (osip_dialog_node_t *));
+  if ((*table)->buckets == NULL) {
+    osip_free (*table);
+    *table = NULL;
+    return OSIP_NOMEM;
+  }
+  memset ((*table)->buckets, 0, size * sizeof (osip_dialog_node_t *));
+  (*table)->mask = size - 1;
+  (*table)->count = 0;
+  return OSIP_SUCCESS;
+}
+
+void
+osip_dialog_table_free (osip_dialog_table_t * table)
+{
+  unsigned int i;
+
+  if (table == NULL)
+    return;
+  for (i = 0; i <= table->mask; i++) {
+    osip_dialog_node_t *node = table->buckets[i];
+
+    while (node != NULL) {
+      osip_dialog_node_t *next = node->next;
+
+      osip_free (node);
+      node = next;
+    }
+  }
+  osip_free (table->buckets);
+  osip_free (table);
+}
+
+int
+osip_dialog_table_size (osip_dialog_table_t * table)
+{
+  if (table == NULL)
+    return OSIP_BADPARAMETER;
+  return table->count;
+}
+
+int
+osip_dialog_table_insert (osip_dialog_table_t * table, osip_dialog_t * dialog)
+{
+  osip_dialog_node_t *node;
+  int i;
+
+  if (table == NULL || dialog == NULL || dialog->call_id == NULL || dialog->local_tag == NULL)
+    return OSIP_BADPARAMETER;
+
+  if ((unsigned int) table->count > table->mask) {
+    i = __osip_dialog_table_grow (table);
+    if (i != 0)
+      return i;
+  }
+
+  node = (osip_dialog_node_t *) osip_malloc (sizeof (osip_dialog_node_t));
+  if (node == NULL)
+    return OSIP_NOMEM;
+  node->dialog = dialog;
+  node->hash = __osip_dialog_hash (dialog->call_id, NULL, dialog->local_tag, dialog->remote_tag);
+  node->next = table->buckets[node->hash & table->mask];
+  table->buckets[node->hash & table->mask] = node;
+  table->count++;
+  return OSIP_SUCCESS;
+}
+
+int
+osip_dialog_table_remove (osip_dialog_table_t * table, osip_dialog_t * dialog)
+{
+  osip_dialog_node_t **prev;
+  unsigned int hash;
+
+  if (table == NULL || dialog == NULL || dialog->call_id == NULL || dialog->local_tag == NULL)
+    return OSIP_BADPARAMETER;
+
+  hash = __osip_dialog_hash (dialog->call_id, NULL, dialog->local_tag, dialog->remote_tag);
+  for (prev = &table->buckets[hash & table->mask]; *prev != NULL; prev = &(*prev)->next) {
+    osip_dialog_node_t *node = *prev;
+
+    if (node->dialog == dialog) {
+      *prev = node->next;
+      osip_free (node);
+      table->count--;
+      return OSIP_SUCCESS;
+    }
+  }
+  return OSIP_NOTFOUND;
+}
+
+int
+osip_dialog_table_update_tag_as_uac (osip_dialog_table_t * table, osip_dialog_t * dialog, osip_message_t * response)
+{
+  int i;
+
+  i = osip_dialog_table_remove (table, dialog);
+  if (i != 0)
+    return i;
+  i = osip_dialog_update_tag_as_uac (dialog, response);
+  /* re-index in any case: the dialog is left unchanged on error */
+  if (i != 0) {
+    osip_dialog_table_insert (table, dialog);
+    return i;
+  }
+  return osip_dialog_table_insert (table, dialog);
+}
+
+int
+osip_dialog_table_find (osip_dialog_table_t * table, const char *call_id, const char *local_tag, const char *remote_tag, osip_dialog_t ** dialog)
+{
+  osip_dialog_node_t *node = NULL;
+
+  if (dialog != NULL)
+    *dialog = NULL;
+  if (table == NULL || call_id == NULL || local_tag == NULL || dialog == NULL)
+    return OSIP_BADPARAMETER;
+
+  if (remote_tag != NULL)
+    node = __osip_dialog_table_lookup (table, call_id, NULL, local_tag, remote_tag, NULL);
+  if (node == NULL)
+    node = __osip_dialog_table_lookup (table, call_id, NULL, local_tag, NULL, NULL);
+  if (node == NULL)
+    return OSIP_NOTFOUND;
+  *dialog = node->dialog;
+  return OSIP_SUCCESS;
+}
+
+/* shared by uac/uas matching: local_hdr carries the local tag, remote_hdr
+   the (optional) remote tag, as described in osip_dialog_match_as_uac/uas */
+static int
+__osip_dialog_table_match (osip_dialog_table_t * table, osip_message_t * msg, osip_from_t * local_hdr, osip_from_t * remote_hdr, int as_uac, osip_dialog_t ** dialog)
+{
+  osip_generic_param_t *tag_param_local;
+  osip_generic_param_t *tag_param_remote;
+  osip_dialog_node_t *node;
+  int i;
+
+  if (dialog != NULL)
+    *dialog = NULL;
+  if (table == NULL || dialog == NULL)
+    return OSIP_BADPARAMETER;
+  if (msg == NULL || msg->call_id == NULL || msg->call_id->number == NULL || local_hdr == NULL || remote_hdr == NULL)
+    return OSIP_BADPARAMETER;
+
+  i = osip_from_get_tag (local_hdr, &tag_param_local);
+  if (i != 0 || tag_param_local->gvalue == NULL) {
+    unsigned int b;
+
+    if (as_uac)
+      return OSIP_NOTFOUND;     /* local tag always exists in a response */
+    /* request without To tag: osip_dialog_match_as_uas does not use the
+       local tag, so the key is incomplete and every dialog is checked */
+    for (b = 0; b <= table->mask; b++) {
+      for (node = table->buckets[b]; node != NULL; node = node->next) {
+        if (0 != __osip_dialog_call_id_cmp (node->dialog->call_id, msg->call_id->number, msg->call_id->host))
+          continue;
+        if (0 == osip_dialog_match_as_uas (node->dialog, msg)) {
+          *dialog = node->dialog;
+          return OSIP_SUCCESS;
+        }
+      }
+    }
+    return OSIP_NOTFOUND;
+  }
+
+  i = osip_from_get_tag (remote_hdr, &tag_param_remote);
+  if (i == 0 && tag_param_remote->gvalue != NULL) {
+    /* both tags recognized: it's enough.. */
+    node = __osip_dialog_table_lookup (table, msg->call_id->number, msg->call_id->host, tag_param_local->gvalue, tag_param_remote->gvalue, NULL);
+    if (node != NULL) {
+      *dialog = node->dialog;
+      return OSIP_SUCCESS;
+    }
+  }
+
+  /* dialog without remote tag: old mechanism, compare uris */
+  node = NULL;
+  while ((node = __osip_dialog_table_lookup (table, msg->call_id->number, msg->call_id->host, tag_param_local->gvalue, NULL, node)) != NULL) {
+    osip_dialog_t *dlg = node->dialog;
+
+    if (as_uac) {
+      if (0 == osip_from_compare ((osip_from_t *) dlg->local_uri, local_hdr)
+          && 0 == osip_from_compare (dlg->remote_uri, remote_hdr)) {
+        *dialog = dlg;
+        return OSIP_SUCCESS;
+      }
+    }
+    else {
+      if (0 == osip_from_compare ((osip_from_t *) dlg->remote_uri, remote_hdr)
+          && 0 == osip_from_compare (dlg->local_uri, local_hdr)) {
+        *dialog = dlg;
+        return OSIP_SUCCESS;
+      }
+    }
+  }
+  return OSIP_NOTFOUND;
+}
+
+int
+osip_dialog_table_match_as_uac (osip_dialog_table_t * table, osip_message_t * response, osip_dialog_t ** dialog)
+{
+  /* for INCOMING RESPONSE:
+     To: remote_uri;remote_tag
+     From: local_uri;local_tag
+   */
+  if (response == NULL)
+    return OSIP_BADPARAMETER;
+  return __osip_dialog_table_match (table, response, response->from, (osip_from_t *) response->to, 1, dialog);
+}
+
+int
+osip_dialog_table_match_as_uas (osip_dialog_table_t * table, osip_message_t * request, osip_dialog_t ** dialog)
+{
+  /* for INCOMING REQUEST:
+     To: local_uri;local_tag
+     From: remote_uri;remote_tag
+   */
+  if (request == NULL)
+    return OSIP_BADPARAMETER;
+  return __osip_dialog_table_match (table, request, (osip_from_t *) request->to, request->from, 0, dialog);
+}
@@ -223,6 +223,10 @@ const char* AcceptEncodingHeader::ParseHeader(const char* buf, uint32_t pos, uin
    subparts or represents a multiple-header */
 std::string AcceptEncodingHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -255,9 +259,6 @@ std::string AcceptEncodingHeader::GetHeaderValue()
       return "";
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    //std::string sbuf;
-    sbuf.reserve(length);
     sbuf.append((const char*)this->rawdata._data + aencoding->coding.start, aencoding->coding.length);
     for (int i = 0; i < aencoding->num_params; i++)
     {
@@ -275,6 +276,11 @@ std::string AcceptEncodingHeader::GetHeaderValue()
 
 int AcceptEncodingHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -309,8 +315,6 @@ int AcceptEncodingHeader::GetHeaderValue(std::string& value)
       return 1;
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    value.reserve(length);
     value.append((const char*)this->rawdata._data + aencoding->coding.start, aencoding->coding.length);
     for (int i = 0; i < aencoding->num_params; i++)
     {
@@ -330,7 +334,7 @@ int AcceptEncodingHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int AcceptEncodingHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
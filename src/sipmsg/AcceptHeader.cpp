@@ -286,6 +286,10 @@ const char* AcceptHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t bu
    subparts or represents a multiple-header */
 std::string AcceptHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -318,8 +322,6 @@ std::string AcceptHeader::GetHeaderValue()
       return "";
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    sbuf.reserve(length);
     sbuf.append((const char*)this->rawdata._data + accrange->m_type.start, accrange->m_type.length);
     sbuf.append(1, '/');
     sbuf.append((const char*)this->rawdata._data + accrange->m_subtype.start, accrange->m_subtype.length);
@@ -339,6 +341,11 @@ std::string AcceptHeader::GetHeaderValue()
 
 int AcceptHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -373,8 +380,6 @@ int AcceptHeader::GetHeaderValue(std::string& value)
       return 1;
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    value.reserve(length);
     value.append((const char*)this->rawdata._data + accrange->m_type.start, accrange->m_type.length);
     value.append(1, '/');
     value.append((const char*)this->rawdata._data + accrange->m_subtype.start, accrange->m_subtype.length);
@@ -396,7 +401,7 @@ int AcceptHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int AcceptHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
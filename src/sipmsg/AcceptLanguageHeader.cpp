@@ -223,6 +223,10 @@ const char* AcceptLanguageHeader::ParseHeader(const char* buf, uint32_t pos, uin
    subparts or represents a multiple-header */
 std::string AcceptLanguageHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -255,8 +259,6 @@ std::string AcceptLanguageHeader::GetHeaderValue()
       return "";
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    sbuf.reserve(length);
     sbuf.append((const char*)this->rawdata._data + lang->language_range.start, lang->language_range.length);
     for (int i = 0; i < lang->num_params; i++)
     {
@@ -274,6 +276,11 @@ std::string AcceptLanguageHeader::GetHeaderValue()
 
 int AcceptLanguageHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -308,8 +315,6 @@ int AcceptLanguageHeader::GetHeaderValue(std::string& value)
       return 1;
     }
 
-    size_t length = (size_t)this->rawdata._length;
-    value.reserve(length);
     value.append((const char*)this->rawdata._data + lang->language_range.start, lang->language_range.length);
     for (int i = 0; i < lang->num_params; i++)
     {
@@ -329,7 +334,7 @@ int AcceptLanguageHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int AcceptLanguageHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
@@ -130,6 +130,10 @@ new_method:
    subparts or represents a multiple-header */
 std::string AllowHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -162,6 +166,11 @@ std::string AllowHeader::GetHeaderValue()
 
 int AllowHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -197,7 +206,7 @@ int AllowHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int AllowHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
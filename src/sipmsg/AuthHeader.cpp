@@ -0,0 +1,300 @@
+/*
+ * AuthHeader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "AuthHeader.h"
+#include "Utility.h"
+
+#include <string.h>
+
+AuthParamId_t classify_auth_param(const char* name, uint32_t length)
+{
+  /* length and first char reject most of the names without a comparison */
+  switch (length)
+  {
+    case 2:
+      return (0 == _strnicmp_(name, "nc", 2)) ? AUTH_PARAM_NC : AUTH_PARAM_OTHER;
+
+    case 3:
+      if (LOWER(name[0]) == 'u')
+      {
+        return (0 == _strnicmp_(name, "uri", 3)) ? AUTH_PARAM_URI : AUTH_PARAM_OTHER;
+      }
+      return (0 == _strnicmp_(name, "qop", 3)) ? AUTH_PARAM_QOP : AUTH_PARAM_OTHER;
+
+    case 5:
+      switch (LOWER(name[0]))
+      {
+        case 'r': return (0 == _strnicmp_(name, "realm", 5)) ? AUTH_PARAM_REALM : AUTH_PARAM_OTHER;
+        case 'n': return (0 == _strnicmp_(name, "nonce", 5)) ? AUTH_PARAM_NONCE : AUTH_PARAM_OTHER;
+        case 's': return (0 == _strnicmp_(name, "stale", 5)) ? AUTH_PARAM_STALE : AUTH_PARAM_OTHER;
+      }
+      break;
+
+    case 6:
+      switch (LOWER(name[0]))
+      {
+        case 'c': return (0 == _strnicmp_(name, "cnonce", 6)) ? AUTH_PARAM_CNONCE : AUTH_PARAM_OTHER;
+        case 'o': return (0 == _strnicmp_(name, "opaque", 6)) ? AUTH_PARAM_OPAQUE : AUTH_PARAM_OTHER;
+        case 'd': return (0 == _strnicmp_(name, "domain", 6)) ? AUTH_PARAM_DOMAIN : AUTH_PARAM_OTHER;
+      }
+      break;
+
+    case 8:
+      if (LOWER(name[0]) == 'u')
+      {
+        return (0 == _strnicmp_(name, "username", 8)) ? AUTH_PARAM_USERNAME : AUTH_PARAM_OTHER;
+      }
+      return (0 == _strnicmp_(name, "response", 8)) ? AUTH_PARAM_RESPONSE : AUTH_PARAM_OTHER;
+
+    case 9:
+      return (0 == _strnicmp_(name, "algorithm", 9)) ? AUTH_PARAM_ALGORITHM : AUTH_PARAM_OTHER;
+  }
+  return AUTH_PARAM_OTHER;
+}
+
+#define IS_AUTH_LWS(p, end) ((p) < (end) && IS_LWS(*(p)))
+
+/* Parsing utility */
+const char* AuthHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  const char* p = buf + pos;
+  const char* end = buf + buflen;
+  const char* mark;
+
+  this->rawdata._data = (unsigned char*)buf;
+  this->rawdata._length = (unsigned int)buflen;
+  this->rawdata._pos = (unsigned int)pos;
+  this->modified = false;
+  this->scheme = { 0, 0 };
+  this->num_params = 0;
+  memset(this->slots, 0, sizeof(this->slots));
+
+  while (IS_AUTH_LWS(p, end))
+  {
+    p++;
+  }
+  if (p >= end)
+  {
+    this->parsing_stat = PARSING_FAILED_NO_DATA;
+    return p;
+  }
+
+  /* auth-scheme and at least one LWS before the first parameter */
+  for (mark = p; p < end && IS_TOKEN(*p); p++)
+    ;
+  if (p == mark || !IS_AUTH_LWS(p, end))
+  {
+    this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+    return p;
+  }
+  this->scheme.start = mark - buf;
+  this->scheme.length = p - mark;
+
+  for (;;)
+  {
+    while (IS_AUTH_LWS(p, end))
+    {
+      p++;
+    }
+    if (this->num_params == MAX_NUM_AUTH_PARAMS)
+    {
+      this->parsing_stat = PARSING_FAILED_MAX_RANGE;
+      return p;
+    }
+    auth_param_t* param = &this->params[this->num_params];
+    *param = auth_param_t();
+
+    /* auth-param-name EQUAL */
+    for (mark = p; p < end && IS_TOKEN(*p); p++)
+      ;
+    if (p == mark)
+    {
+      this->parsing_stat = (p >= end) ? PARSING_FAILED_NO_DATA : PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    param->name.start = mark - buf;
+    param->name.length = p - mark;
+    while (IS_AUTH_LWS(p, end))
+    {
+      p++;
+    }
+    if (p >= end || *p != '=')
+    {
+      this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    for (p++; IS_AUTH_LWS(p, end); p++)
+      ;
+
+    /* token / quoted-string, the value of a quoted-string is the part
+       between the double quotes with its quoted-pairs as they are */
+    if (p < end && *p == '"')
+    {
+      for (mark = ++p; p < end && *p != '"'; p++)
+      {
+        if (*p == '\\' && ++p >= end)
+        {
+          break;
+        }
+      }
+      if (p >= end)
+      {
+        this->parsing_stat = PARSING_FAILED_NO_DATA;
+        return p;
+      }
+      param->value.start = mark - buf;
+      param->value.length = p - mark;
+      param->quoted = true;
+      p++;
+    }
+    else
+    {
+      for (mark = p; p < end && IS_TOKEN(*p); p++)
+        ;
+      if (p == mark)
+      {
+        this->parsing_stat = (p >= end) ? PARSING_FAILED_NO_DATA : PARSING_FAILED_UNEXPECTED_CHAR;
+        return p;
+      }
+      param->value.start = mark - buf;
+      param->value.length = p - mark;
+    }
+
+    /* only the first occurrence of a well-known parameter is kept */
+    AuthParamId_t pid = classify_auth_param(buf + param->name.start, param->name.length);
+    if (pid != AUTH_PARAM_OTHER && this->slots[pid] == 0)
+    {
+      this->slots[pid] = (uint8_t)(this->num_params + 1);
+    }
+    this->num_params++;
+
+    while (IS_AUTH_LWS(p, end))
+    {
+      p++;
+    }
+    if (p >= end)
+    {
+      break;
+    }
+    if (*p != ',')
+    {
+      this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    p++;
+  }
+
+  if (this->IsDigest() && !this->HasDigestParams())
+  {
+    this->parsing_stat = PARSING_FAILED_NO_DATA;
+    return p;
+  }
+  this->parsing_stat = PARSED_SUCCESSFULLY;
+  return p;
+}
+
+bool AuthHeader::IsDigest() const
+{
+  return this->scheme.length == 6 && 0 == _strnicmp_((const char*)this->rawdata._data + this->scheme.start, "Digest", 6);
+}
+
+bool AuthHeader::IsParamValue(AuthParamId_t pid, const char* value) const
+{
+  const auth_param_t* param = this->GetParam(pid);
+  size_t length = strlen(value);
+
+  return param != NULL && param->value.length == length &&
+    0 == _strnicmp_((const char*)this->rawdata._data + param->value.start, value, length);
+}
+
+/* both provide the value part, which can be re-formatted if the header has
+   subparts or represents a multiple-header */
+std::string AuthHeader::GetHeaderValue()
+{
+  std::string value;
+  this->GetHeaderValue(value);
+  return value;
+}
+
+int AuthHeader::GetHeaderValue(std::string& value)
+{
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
+  if (!this->rawdata._length || this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    value = "";
+    return 1;
+  }
+  /* parts are never longer than the received value, separators may be added
+     to each parameter by re-formatting */
+  uint32_t length = this->rawdata._length - this->rawdata._pos + 1 + 5 * this->num_params;
+  value.resize(length);
+  int result = this->FormatValue(&value[0], length);
+  value.resize((result < 0) ? 0 : (size_t)result);
+  return (result < 0) ? 1 : 0;
+}
+
+int AuthHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  uint32_t pos = 0;
+
+  if (!this->AppendValue(buf, buflen, pos, this->scheme.start, this->scheme.length) ||
+      !this->AppendChar(buf, buflen, pos, ' '))
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < this->num_params; i++)
+  {
+    const auth_param_t& param = this->params[i];
+    if ((i > 0 && (!this->AppendChar(buf, buflen, pos, ',') || !this->AppendChar(buf, buflen, pos, ' '))) ||
+        !this->AppendValue(buf, buflen, pos, param.name.start, param.name.length) ||
+        !this->AppendChar(buf, buflen, pos, '=') ||
+        (param.quoted && !this->AppendChar(buf, buflen, pos, '"')) ||
+        !this->AppendValue(buf, buflen, pos, param.value.start, param.value.length) ||
+        (param.quoted && !this->AppendChar(buf, buflen, pos, '"')))
+    {
+      return -1;
+    }
+  }
+  return (int)pos;
+}
+
+/* provides the pointer to value part of the header in question.
+   No any additional copy applied. */
+int AuthHeader::GetHeaderValue(RawData& value)
+{
+  if (!this->rawdata._length || this->modified)
+  {
+    return 1;
+  }
+  value._data = this->rawdata._data;
+  value._length = this->rawdata._length;
+  value._pos = this->rawdata._pos;
+
+  return 0;
+}
+
+void AuthHeader::PrintOut(std::ostringstream& buf)
+{
+  buf << "-------- " << this->GetName() << " Header DUMP [parsing-stat=" << this->parsing_stat << "-" << SipHeader::GetParsingStatInText(this->parsing_stat) << "] ----------\n";
+  if (this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    buf << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
+    return;
+  }
+  buf << "scheme  : " << std::string((const char*)this->rawdata._data + this->scheme.start, this->scheme.length) << std::endl;
+  for (uint32_t i = 0; i < this->num_params; i++)
+  {
+    buf << "     " << std::string((const char*)this->rawdata._data + this->params[i].name.start, this->params[i].name.length)
+      << " = " << std::string((const char*)this->rawdata._data + this->params[i].value.start, this->params[i].value.length) << std::endl;
+  }
+  buf << "----------------\n";
+  buf << this->GetName() << ": " << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
+  buf << "---------------------------------------\n";
+}
@@ -0,0 +1,123 @@
+/*
+ * AuthHeader.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _AUTH_HEADER_H_
+#define _AUTH_HEADER_H_
+//---------------------------------------------------------------------------
+#include "SipMessage.h"
+#include "SipHeader.h"
+
+#include <array>
+
+/*
+   Authorization, Proxy-Authorization, WWW-Authenticate and Proxy-Authenticate
+   share the same shape: an auth scheme followed by a comma separated list of
+   auth-params, RFC 3261 25.1 and RFC 2617.
+
+   credentials      =  ("Digest" LWS digest-response) / other-response
+   digest-response  =  dig-resp *(COMMA dig-resp)
+   challenge        =  ("Digest" LWS digest-cln *(COMMA digest-cln))
+                       / other-challenge
+   other-response   =  auth-scheme LWS auth-param *(COMMA auth-param)
+   auth-param       =  auth-param-name EQUAL ( token / quoted-string )
+
+   Example:
+      Authorization: Digest username="Alice", realm="atlanta.com",
+       nonce="84a4cc6f3082121f32b42a2187831a9e",
+       response="7587245234b3434cc3412213e5f113a5432"
+
+   Values are kept as spans of the received bytes, without the double quotes
+   of a quoted-string. Well-known parameter names are classified while parsing,
+   so GetParam() is a single array access as ParamParser.h does for the
+   parameters of the other headers.
+ */
+
+typedef enum
+{
+  AUTH_PARAM_USERNAME = 0,
+  AUTH_PARAM_REALM,
+  AUTH_PARAM_NONCE,
+  AUTH_PARAM_URI,
+  AUTH_PARAM_RESPONSE,
+  AUTH_PARAM_ALGORITHM,
+  AUTH_PARAM_CNONCE,
+  AUTH_PARAM_OPAQUE,
+  AUTH_PARAM_QOP,
+  AUTH_PARAM_NC,
+  AUTH_PARAM_STALE,
+  AUTH_PARAM_DOMAIN,
+  MAX_NUM_AUTH_PARAM_IDS,
+  AUTH_PARAM_OTHER = MAX_NUM_AUTH_PARAM_IDS
+} AuthParamId_t;
+
+#define MAX_NUM_AUTH_PARAMS 16
+
+typedef struct auth_param
+{
+  str_pos_t name;
+  str_pos_t value;       /**< without the double quotes of a quoted-string */
+  bool quoted;
+} auth_param_t;
+
+/* id of the auth-param named 'name', AUTH_PARAM_OTHER for any other name */
+AuthParamId_t classify_auth_param(const char* name, uint32_t length);
+
+class AuthHeader : public SipHeader
+{
+public:
+  AuthHeader()
+    : scheme({ 0, 0 }), num_params(0), params(), slots()
+  {}
+
+  /* Parsing utility. Consider the value part of header starts from 'pos' with length 'buflen'.
+     On return, 'parsing_stat' attribute of class instance reflects parsing status.
+     Function returns the current position which may indicate the position of
+     problem in case of failure
+  */
+  const char* ParseHeader(const char* buf, uint32_t pos, uint32_t buflen);
+
+  /* both provide the value part, which can be re-formatted if the header has
+     subparts or represents a multiple-header */
+  std::string GetHeaderValue();
+  int GetHeaderValue(std::string& value);
+
+  /* provides the pointer to value part of the header in question.
+     No any additional copy applied. */
+  int GetHeaderValue(RawData& value);
+
+  void PrintOut(std::ostringstream& buf);
+
+  virtual const char* GetName() const = 0;
+
+  bool IsDigest() const;
+
+  /* well-known parameter without any comparison, NULL if it does not exist */
+  const auth_param_t* GetParam(AuthParamId_t pid) const
+  {
+    return (pid < MAX_NUM_AUTH_PARAM_IDS && this->slots[pid]) ? &this->params[this->slots[pid] - 1] : NULL;
+  }
+
+  /* true if the value of parameter 'pid' equals 'value' ignoring case, i.e.
+     algorithm "MD5" or qop "auth" */
+  bool IsParamValue(AuthParamId_t pid, const char* value) const;
+
+  str_pos_t scheme;
+  uint32_t num_params;
+  std::array<auth_param_t, MAX_NUM_AUTH_PARAMS> params;
+
+protected:
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
+
+  /* mandatory parameters of the digest scheme */
+  virtual bool HasDigestParams() const = 0;
+
+  /* position of each well-known parameter in 'params' plus one, zero if it
+     does not exist */
+  uint8_t slots[MAX_NUM_AUTH_PARAM_IDS];
+};
+
+//---------------------------------------------------------------------------
+#endif // _AUTH_HEADER_H_
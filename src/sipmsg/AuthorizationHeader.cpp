@@ -0,0 +1,153 @@
+/*
+ * AuthorizationHeader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "AuthorizationHeader.h"
+
+#include <string.h>
+
+bool AuthorizationHeader::HasDigestParams() const
+{
+  if (this->GetParam(AUTH_PARAM_USERNAME) == NULL || this->GetParam(AUTH_PARAM_REALM) == NULL ||
+      this->GetParam(AUTH_PARAM_NONCE) == NULL || this->GetParam(AUTH_PARAM_URI) == NULL ||
+      this->GetParam(AUTH_PARAM_RESPONSE) == NULL)
+  {
+    return false;
+  }
+  return this->GetParam(AUTH_PARAM_QOP) == NULL ||
+    (this->GetParam(AUTH_PARAM_CNONCE) != NULL && this->GetParam(AUTH_PARAM_NC) != NULL);
+}
+
+/* hashes the value of 'param' as unq() of RFC 2617 does: the backslash of a
+   quoted-pair is not a part of the value */
+static void md5_update_param(md5_ctx_t* ctx, const char* buf, const auth_param_t* param)
+{
+  const char* p = buf + param->value.start;
+  const char* end = p + param->value.length;
+  const char* bs;
+
+  while (param->quoted && (bs = (const char*)memchr(p, '\\', end - p)) != NULL && bs + 1 < end)
+  {
+    md5_update(ctx, p, bs - p);
+    md5_update(ctx, bs + 1, 1);
+    p = bs + 2;
+  }
+  md5_update(ctx, p, end - p);
+}
+
+static void md5_final_hex(md5_ctx_t* ctx, char hex[MD5_HEX_SIZE])
+{
+  uint8_t digest[MD5_DIGEST_SIZE];
+  md5_final(ctx, digest);
+  md5_to_hex(digest, hex);
+}
+
+int AuthorizationHeader::VerifyDigest(const char* ha1, const char* method, uint32_t methodlen,
+                                      const char* body, uint32_t bodylen) const
+{
+  const char* data = (const char*)this->rawdata._data;
+  const auth_param_t* response = this->GetParam(AUTH_PARAM_RESPONSE);
+  const auth_param_t* qop = this->GetParam(AUTH_PARAM_QOP);
+  bool auth_int = false;
+  char ha1sess[MD5_HEX_SIZE];
+  char ha2[MD5_HEX_SIZE];
+  char expected[MD5_HEX_SIZE];
+  md5_ctx_t ctx;
+
+  if (this->parsing_stat != PARSED_SUCCESSFULLY || !this->IsDigest() ||
+      response->value.length != MD5_HEX_SIZE)
+  {
+    return 1;
+  }
+  if (qop != NULL && !this->IsParamValue(AUTH_PARAM_QOP, "auth"))
+  {
+    if (!this->IsParamValue(AUTH_PARAM_QOP, "auth-int"))
+    {
+      return 1;
+    }
+    auth_int = true;
+  }
+
+  /* H(A1), A1 = H(username ":" realm ":" password) ":" nonce ":" cnonce
+     for MD5-sess */
+  if (this->IsParamValue(AUTH_PARAM_ALGORITHM, "MD5-sess"))
+  {
+    const auth_param_t* cnonce = this->GetParam(AUTH_PARAM_CNONCE);
+    if (cnonce == NULL)
+    {
+      return 1;
+    }
+    md5_init(&ctx);
+    md5_update(&ctx, ha1, MD5_HEX_SIZE);
+    md5_update(&ctx, ":", 1);
+    md5_update_param(&ctx, data, this->GetParam(AUTH_PARAM_NONCE));
+    md5_update(&ctx, ":", 1);
+    md5_update_param(&ctx, data, cnonce);
+    md5_final_hex(&ctx, ha1sess);
+    ha1 = ha1sess;
+  }
+  else if (this->GetParam(AUTH_PARAM_ALGORITHM) != NULL && !this->IsParamValue(AUTH_PARAM_ALGORITHM, "MD5"))
+  {
+    return 1;
+  }
+
+  /* H(A2), A2 = Method ":" digest-uri-value [ ":" H(entity-body) ] */
+  md5_init(&ctx);
+  md5_update(&ctx, method, methodlen);
+  md5_update(&ctx, ":", 1);
+  md5_update_param(&ctx, data, this->GetParam(AUTH_PARAM_URI));
+  if (auth_int)
+  {
+    char hbody[MD5_HEX_SIZE];
+    md5_ctx_t bctx;
+    md5_init(&bctx);
+    md5_update(&bctx, body, (body != NULL) ? bodylen : 0);
+    md5_final_hex(&bctx, hbody);
+    md5_update(&ctx, ":", 1);
+    md5_update(&ctx, hbody, MD5_HEX_SIZE);
+  }
+  md5_final_hex(&ctx, ha2);
+
+  /* request-digest = KD(H(A1), nonce ":" [ nc ":" cnonce ":" qop ":" ] H(A2)) */
+  md5_init(&ctx);
+  md5_update(&ctx, ha1, MD5_HEX_SIZE);
+  md5_update(&ctx, ":", 1);
+  md5_update_param(&ctx, data, this->GetParam(AUTH_PARAM_NONCE));
+  md5_update(&ctx, ":", 1);
+  if (qop != NULL)
+  {
+    md5_update_param(&ctx, data, this->GetParam(AUTH_PARAM_NC));
+    md5_update(&ctx, ":", 1);
+    md5_update_param(&ctx, data, this->GetParam(AUTH_PARAM_CNONCE));
+    md5_update(&ctx, ":", 1);
+    md5_update_param(&ctx, data, qop);
+    md5_update(&ctx, ":", 1);
+  }
+  md5_update(&ctx, ha2, MD5_HEX_SIZE);
+  md5_final_hex(&ctx, expected);
+
+  /* LHEX of the response may be in upper case, all digits are compared not
+     to reveal the position of the first difference */
+  const char* p = data + response->value.start;
+  unsigned char diff = 0;
+  for (int i = 0; i < MD5_HEX_SIZE; i++)
+  {
+    diff |= (unsigned char)(LOWER(p[i]) ^ expected[i]);
+  }
+  return (diff == 0) ? 0 : 1;
+}
+
+void digest_calc_ha1(const char* username, const char* realm, const char* password, char ha1[MD5_HEX_SIZE])
+{
+  md5_ctx_t ctx;
+
+  md5_init(&ctx);
+  md5_update(&ctx, username, strlen(username));
+  md5_update(&ctx, ":", 1);
+  md5_update(&ctx, realm, strlen(realm));
+  md5_update(&ctx, ":", 1);
+  md5_update(&ctx, password, strlen(password));
+  md5_final_hex(&ctx, ha1);
+}
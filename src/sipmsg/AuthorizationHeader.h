@@ -0,0 +1,61 @@
+/*
+ * AuthorizationHeader.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _AUTHORIZATION_HEADER_H_
+#define _AUTHORIZATION_HEADER_H_
+//---------------------------------------------------------------------------
+#include "AuthHeader.h"
+#include "Md5.h"
+
+/*
+   The Authorization header field contains authentication credentials of
+   a UA, Proxy-Authorization the ones for a proxy requiring authentication.
+
+   dig-resp          =  username / realm / nonce / digest-uri
+                        / dresponse / algorithm / cnonce
+                        / opaque / message-qop
+                        / nonce-count / auth-param
+   username          =  "username" EQUAL username-value
+   digest-uri        =  "uri" EQUAL LDQUOT digest-uri-value RDQUOT
+   message-qop       =  "qop" EQUAL qop-value
+   cnonce            =  "cnonce" EQUAL cnonce-value
+   nonce-count       =  "nc" EQUAL nc-value
+   dresponse         =  "response" EQUAL request-digest
+   request-digest    =  LDQUOT 32LHEX RDQUOT
+
+   Digest credentials without username, realm, nonce, uri or response are
+   not accepted, neither the ones with a qop but without cnonce and nc.
+ */
+
+class AuthorizationHeader : public AuthHeader
+{
+public:
+  AuthorizationHeader(bool proxy = false)
+    : proxy(proxy)
+  {}
+
+  const char* GetName() const { return proxy ? "Proxy-Authorization" : "Authorization"; }
+
+  /* Checks the request-digest of RFC 2617 3.2.2.1 against 'ha1', the 32 hex
+     digits of MD5(username ":" realm ":" password) kept by a registrar instead
+     of the password. Algorithm MD5 and MD5-sess with qop auth, auth-int or
+     none are supported, 'body' is the message body for auth-int. Digests are
+     computed over the spans of the header, no intermediate string is built.
+     Returns 0 if the response matches, 1 otherwise */
+  int VerifyDigest(const char* ha1, const char* method, uint32_t methodlen,
+                   const char* body = NULL, uint32_t bodylen = 0) const;
+
+protected:
+  bool HasDigestParams() const;
+
+private:
+  bool proxy;
+};
+
+/* HA1 of RFC 2617 3.2.2.2 for MD5, as 32 lower case hex digits */
+void digest_calc_ha1(const char* username, const char* realm, const char* password, char ha1[MD5_HEX_SIZE]);
+
+//---------------------------------------------------------------------------
+#endif // _AUTHORIZATION_HEADER_H_
@@ -291,6 +291,10 @@ const char* CSeqHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t bufl
    subparts or represents a multiple-header */
 std::string CSeqHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   if (!(this->rawdata._length) || !(this->number.length) || !(this->method.length))
   {
     return "";
@@ -307,6 +311,11 @@ std::string CSeqHeader::GetHeaderValue()
 
 int CSeqHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   if (!(this->rawdata._length) || !(this->number.length) || !(this->method.length))
   {
     return 1;
@@ -320,11 +329,24 @@ int CSeqHeader::GetHeaderValue(std::string& value)
   return 0;
 }
 
+int CSeqHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  uint32_t pos = 0;
+
+  if (!this->AppendValue(buf, buflen, pos, this->number.start, this->number.length) ||
+      !this->AppendChar(buf, buflen, pos, ' ') ||
+      !this->AppendValue(buf, buflen, pos, this->method.start, this->method.length))
+  {
+    return -1;
+  }
+  return (int)pos;
+}
+
 /* provides the pointer to value part of the header in question.
    No any additional copy applied. */
 int CSeqHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
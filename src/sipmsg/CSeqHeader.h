@@ -45,6 +45,10 @@ public:
   str_pos_t number;
   str_pos_t method;
 
+protected:
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
+
 private:
   uint32_t cseqNum;
   enum sip_method sipMethod;
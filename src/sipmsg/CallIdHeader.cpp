@@ -186,6 +186,10 @@ const char* CallIdHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t bu
    subparts or represents a multiple-header */
 std::string CallIdHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   if (!(this->rawdata._length) || !(this->localId.length))
   {
     return "";
@@ -205,6 +209,11 @@ std::string CallIdHeader::GetHeaderValue()
 
 int CallIdHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   if (!(this->rawdata._length) || !(this->localId.length))
   {
     return 1;
@@ -225,7 +234,7 @@ int CallIdHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int CallIdHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
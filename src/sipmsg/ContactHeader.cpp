@@ -20,6 +20,11 @@ const char* ContactHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t b
 
   for (p = buf + pos; p < buf + buflen; p++)
   {
+    if (this->num_contact_parms >= MAX_NUM_CONTPARMS)
+    {
+      this->parsing_stat = PARSING_FAILED_MAX_RANGE;
+      return p;
+    }
     contact_param_t* contparam = &this->contact_parms[this->num_contact_parms++];
     p = parse_name_addr_part(buf, p - buf, buflen, &contparam->displayName, &contparam->url_str, &parse_error, 1);
     if (parse_error != 0)
@@ -52,7 +57,7 @@ const char* ContactHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t b
       {
         p++; /* skip ';' */
         parse_error = 0; /* reset */
-        p = parse_param_part(buf, p - buf, buflen, &contparam->params[0], MAX_NUM_PARAMS, &contparam->num_params, &parse_error, 1);
+        p = parse_param_part(buf, p - buf, buflen, &contparam->params[0], MAX_NUM_PARAMS, &contparam->num_params, &parse_error, 1, &contparam->slots);
         if (parse_error)
         {
           /* TODO: Map parse_error to 'ParsingStatus_t" */
@@ -85,10 +90,53 @@ const char* ContactHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t b
   return p;
 }
 
+/* parses URI part of each contact-param if main parsing is done. Spill areas
+   of URIs with many parameters are taken from 'arena' if given */
+int ContactHeader::ParseUrlPart(UriArena* arena)
+{
+  if ((this->rawdata._data == NULL) || (this->rawdata._length == 0))
+  {
+    return 1;
+  }
+  for (uint32_t i = 0; i < this->num_contact_parms; i++)
+  {
+    /* i.e. "Contact: *" has no URI */
+    if (this->contact_parms[i].url_str.length && this->GetUri(i, arena) == NULL)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+SipUri* ContactHeader::GetUri(uint32_t index, UriArena* arena)
+{
+  if ((this->rawdata._data == NULL) || (index >= this->num_contact_parms))
+  {
+    return NULL;
+  }
+  contact_param_t* contparam = &this->contact_parms[index];
+  if (contparam->url_stat == NOT_PARSED_YET && contparam->url_str.length)
+  {
+    const char* url = (const char*)this->rawdata._data + contparam->url_str.start;
+    int result;
+
+    contparam->uri.SetArena(arena);
+    result = (*url == '<') ? contparam->uri.ParseUri(url + 1, 0, contparam->url_str.length - 2)
+                           : contparam->uri.ParseUri(url, 0, contparam->url_str.length);
+    contparam->url_stat = (result == 0) ? PARSED_SUCCESSFULLY : PARSING_FAILED_UNCLEAR_REASON;
+  }
+  return (contparam->url_stat == PARSED_SUCCESSFULLY) ? &contparam->uri : NULL;
+}
+
 /* both provide the value part, which can be re-formatted if the header has
    subparts or represents a multiple-header */
 std::string ContactHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -138,6 +186,11 @@ std::string ContactHeader::GetHeaderValue()
 
 int ContactHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -185,11 +238,43 @@ int ContactHeader::GetHeaderValue(std::string& value)
   return 0;
 }
 
+int ContactHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  uint32_t pos = 0;
+
+  for (uint32_t i = 0; i < this->num_contact_parms; i++)
+  {
+    const contact_param_t* contparam = &this->contact_parms[i];
+
+    if ((i > 0 && !this->AppendChar(buf, buflen, pos, ',')) ||
+        (contparam->displayName.length &&
+         (!this->AppendValue(buf, buflen, pos, contparam->displayName.start, contparam->displayName.length) ||
+          !this->AppendChar(buf, buflen, pos, ' '))) ||
+        !this->AppendValue(buf, buflen, pos, contparam->url_str.start, contparam->url_str.length))
+    {
+      return -1;
+    }
+    for (uint32_t j = 0; j < contparam->num_params; j++)
+    {
+      const param_pos_t& param = contparam->params[j];
+      if (!this->AppendChar(buf, buflen, pos, ';') ||
+          !this->AppendValue(buf, buflen, pos, param.type.start, param.type.length) ||
+          (param.value.length &&
+           (!this->AppendChar(buf, buflen, pos, '=') ||
+            !this->AppendValue(buf, buflen, pos, param.value.start, param.value.length))))
+      {
+        return -1;
+      }
+    }
+  }
+  return (int)pos;
+}
+
 /* provides the pointer to value part of the header in question.
    No any additional copy applied. */
 int ContactHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
@@ -233,10 +318,10 @@ void ContactHeader::PrintOut(std::ostringstream& buf)
         buf << std::endl;
       }
     }
-    if (contparam->url)
+    if (contparam->url_stat == PARSED_SUCCESSFULLY)
     {
       buf << "......Detailed URI.......\n";
-      contparam->url->PrintOut(buf);
+      contparam->uri.PrintOut(buf);
     }
     buf << "----------------\n";
     buf << "Contact: " << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
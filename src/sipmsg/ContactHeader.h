@@ -10,6 +10,7 @@
 #include "SipHeader.h"
 #include "SipMessage.h"
 #include "SipUri.h"
+#include "ParamParser.h"
 
 /*
    The Contact header field provides a SIP or SIPS URI that can be used
@@ -80,10 +81,12 @@ typedef struct contact_param_t
   str_pos_t displayName;
 
   str_pos_t url_str;
-  SipUri* url;
+  SipUri uri;                 /**< valid if 'url_stat' is PARSED_SUCCESSFULLY, see GetUri() */
+  ParsingStatus_t url_stat;
 
   uint32_t  num_params;
   SipParamArray_t params;  /**< Contact parameters */
+  param_slots_t slots;     /**< well-known ones of 'params', i.e. q and expires */
 }contact_param_t;
 
 #define MAX_NUM_CONTPARMS 8
@@ -96,22 +99,16 @@ public:
     : num_contact_parms(0), contact_parms()
   {}
 
-  virtual ~ContactHeader() {
-    for (uint32_t i = 0; i < num_contact_parms; i++)
-    {
-      if (contact_parms[i].url)
-      {
-        delete contact_parms[i].url;
-        contact_parms[i].url = NULL;
-      }
-    }
-  }
-
   /* Parsing utility */
   const char* ParseHeader(const char* buf, uint32_t pos, uint32_t buflen);
 
-  /* parses URI part of Contact header if main parsing is done. */
-  int ParseUrlPart();
+  /* parses URI part of Contact header if main parsing is done. URIs with many
+     parameters are kept in 'arena' when given, see SipUri */
+  int ParseUrlPart(UriArena* arena = NULL);
+
+  /* URI of the 'index'th contact-param, parsed into the header instance on
+     first call. NULL if there is no such contact or URI parsing fails */
+  SipUri* GetUri(uint32_t index, UriArena* arena = NULL);
 
   /* both provide the value part, which can be re-formatted if the header has
      subparts or represents a multiple-header */
@@ -122,11 +119,28 @@ public:
      No any additional copy applied. */
   int GetHeaderValue(RawData& value);
 
+  /* well-known parameter of the 'index'th contact-param without any
+     comparison, NULL if it does not exist. See ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t id, uint32_t index = 0) const
+  {
+    return (index < this->num_contact_parms) ? get_param(this->contact_parms[index].slots, &this->contact_parms[index].params[0], id) : NULL;
+  }
+
+  /* numeric value of a well-known parameter, q is multiplied by 1000.
+     Returns 0 on success, 1 if it does not exist or is not a number */
+  int GetParamU32(ParamId_t id, uint32_t* value, uint32_t index = 0) const
+  {
+    return get_param_u32((const char*)this->rawdata._data, this->GetParam(id, index), id, value);
+  }
+
   void PrintOut(std::ostringstream& buf);
 
   uint32_t  num_contact_parms;
   contact_param_array_t contact_parms;
 
+protected:
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
 };
 
 //---------------------------------------------------------------------------
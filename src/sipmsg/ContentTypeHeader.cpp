@@ -246,6 +246,10 @@ const char* ContentTypeHeader::ParseHeader(const char* buf, uint32_t pos, uint32
    subparts or represents a multiple-header */
 std::string ContentTypeHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   if (!(this->rawdata._length) || !(this->m_type.length) || !(this->m_subtype.length))
   {
     return "";
@@ -281,6 +285,11 @@ std::string ContentTypeHeader::GetHeaderValue()
 
 int ContentTypeHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   if (!(this->rawdata._length) || !(this->m_type.length) || !(this->m_subtype.length))
   {
     return 1;
@@ -317,7 +326,7 @@ int ContentTypeHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int ContentTypeHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
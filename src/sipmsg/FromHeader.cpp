@@ -361,13 +361,17 @@ reparse:
         }
 
         p++; // skip ';'
-        p = parse_param_part(buf, p - buf, buflen, &this->params[0], MAX_NUM_PARAMS, &this->num_params, &parse_error, 0);
+        p = parse_param_part(buf, p - buf, buflen, &this->params[0], MAX_NUM_PARAMS, &this->num_params, &parse_error, 0, &this->slots);
         if (parse_error)
         {
           /* TODO: Map parse_error to parsing_stat */
           this->parsing_stat = PARSING_FAILED_UNCLEAR_REASON;
           return p;
         }
+        if (this->GetParam(PARAM_TAG) != NULL)
+        {
+          this->tag = this->GetParam(PARAM_TAG)->value;
+        }
         //printf("Number of parameters = %u and pos = %s", this->num_params, p);
         break;
 
@@ -405,7 +409,7 @@ reparse:
 }
 
 /* parses URI part of From header if main parsing is done. */
-int FromHeader::ParseUrlPart()
+int FromHeader::ParseUrlPart(UriArena* arena)
 {
   if ((this->rawdata._data == NULL) || (this->rawdata._length == 0))
   {
@@ -415,24 +419,34 @@ int FromHeader::ParseUrlPart()
   {
     return 2;
   }
-  if (this->url)
+  if (this->url_stat == NOT_PARSED_YET)
   {
-    /* Consider it has already been parsed */
-    return 0;
-  }
-  this->url = new SipUri();
-  if (*(this->rawdata._data + this->url_str.start) == '<')
-  {
-    /* addr-spec encapsulated with '<' and '>' */
-    return this->url->ParseUri((const char*)this->rawdata._data + this->url_str.start + 1, 0, this->url_str.length - 2);
+    const char* url = (const char*)this->rawdata._data + this->url_str.start;
+    int result;
+
+    this->uri.SetArena(arena);
+    if (*url == '<')
+    {
+      /* addr-spec encapsulated with '<' and '>' */
+      result = this->uri.ParseUri(url + 1, 0, this->url_str.length - 2);
+    }
+    else
+    {
+      result = this->uri.ParseUri(url, 0, this->url_str.length);
+    }
+    this->url_stat = (result == 0) ? PARSED_SUCCESSFULLY : PARSING_FAILED_UNCLEAR_REASON;
   }
-  return this->url->ParseUri((const char*)this->rawdata._data + this->url_str.start, 0, this->url_str.length);
+  return (this->url_stat == PARSED_SUCCESSFULLY) ? 0 : 1;
 }
 
 /* both provide the value part, which can be re-formatted if the header has
    subparts or represents a multiple-header */
 std::string FromHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!(this->rawdata._length) || !(this->url_str.length))
   {
@@ -472,6 +486,11 @@ std::string FromHeader::GetHeaderValue()
 
 int FromHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!(this->rawdata._length) || !(this->url_str.length))
   {
@@ -510,11 +529,40 @@ int FromHeader::GetHeaderValue(std::string& value)
   return 0;
 }
 
+int FromHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  uint32_t pos = 0;
+
+  if (this->displayName.length &&
+      (!this->AppendValue(buf, buflen, pos, this->displayName.start, this->displayName.length) ||
+       !this->AppendChar(buf, buflen, pos, ' ')))
+  {
+    return -1;
+  }
+  if (!this->AppendValue(buf, buflen, pos, this->url_str.start, this->url_str.length))
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < this->num_params; i++)
+  {
+    const param_pos_t& param = this->params[i];
+    if (!this->AppendChar(buf, buflen, pos, ';') ||
+        !this->AppendValue(buf, buflen, pos, param.type.start, param.type.length) ||
+        (param.value.length &&
+         (!this->AppendChar(buf, buflen, pos, '=') ||
+          !this->AppendValue(buf, buflen, pos, param.value.start, param.value.length))))
+    {
+      return -1;
+    }
+  }
+  return (int)pos;
+}
+
 /* provides the pointer to value part of the header in question.
    No any additional copy applied. */
 int FromHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
@@ -550,10 +598,10 @@ void FromHeader::PrintOut(std::ostringstream& buf)
       buf << std::endl;
     }
   }
-  if (this->url)
+  if (this->url_stat == PARSED_SUCCESSFULLY)
   {
     buf << "......Detailed URI.......\n";
-    this->url->PrintOut(buf);
+    this->uri.PrintOut(buf);
   }
   buf << "----------------\n";
   buf << this->hdrName << ": " << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
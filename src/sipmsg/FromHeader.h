@@ -11,6 +11,7 @@
 #include "SipMessage.h"
 #include "SipHeader.h"
 #include "SipUri.h"
+#include "ParamParser.h"
 
 /* 
    The From header field indicates the initiator of the request.  This
@@ -66,21 +67,22 @@ class FromHeader : public SipHeader
 {
 public:
   FromHeader()
-    : displayName({ 0, 0 }), url_str({ 0, 0 }), url(NULL), tag({ 0, 0 }), num_params(0), params(), addrType(ADDR_NONE), hdrName("From")
+    : displayName({ 0, 0 }), url_str({ 0, 0 }), uri(), url_stat(NOT_PARSED_YET), tag({ 0, 0 }), num_params(0), params(), slots(), addrType(ADDR_NONE), hdrName("From")
   {}
 
-  virtual ~FromHeader() {
-    if (url) {
-      delete url;
-      url = NULL;
-    }
-  }
-
   /* Parsing utility */
   const char* ParseHeader(const char* buf, uint32_t pos, uint32_t buflen);
 
-  /* parses URI part of From header if main parsing is done. */
-  int ParseUrlPart();
+  /* parses URI part of From header if main parsing is done. URIs with many
+     parameters are kept in 'arena' when given, see SipUri */
+  int ParseUrlPart(UriArena* arena = NULL);
+
+  /* URI of the address, parsed into the header instance on first call.
+     NULL if the header is not parsed or URI parsing fails */
+  SipUri* GetUri(UriArena* arena = NULL)
+  {
+    return (this->ParseUrlPart(arena) == 0) ? &this->uri : NULL;
+  }
 
   /* both provide the value part, which can be re-formatted if the header has
      subparts or represents a multiple-header */
@@ -91,16 +93,35 @@ public:
      No any additional copy applied. */
   int GetHeaderValue(RawData& value);
 
+  /* well-known parameter without any comparison, NULL if it does not exist.
+     See ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t id) const
+  {
+    return get_param(this->slots, &this->params[0], id);
+  }
+
+  /* numeric value of a well-known parameter. Returns 0 on success, 1 if it
+     does not exist or is not a number */
+  int GetParamU32(ParamId_t id, uint32_t* value) const
+  {
+    return get_param_u32((const char*)this->rawdata._data, this->GetParam(id), id, value);
+  }
+
   void PrintOut(std::ostringstream& buf);
 
   str_pos_t displayName;
   str_pos_t url_str;
-  SipUri* url;
+  SipUri uri;              /**< valid if 'url_stat' is PARSED_SUCCESSFULLY, see GetUri() */
+  ParsingStatus_t url_stat;
   str_pos_t tag;           /**< tag parameter for quick access */
   uint32_t  num_params;
   SipParamArray_t params;  /**< From parameters */
+  param_slots_t slots;     /**< well-known ones of 'params' */
 
 protected:
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
+
   AddressType_t addrType;
 
   const char* hdrName; /* this class' implementation can be shared with 'To' header implementation */
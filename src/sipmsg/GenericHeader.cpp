@@ -0,0 +1,434 @@
+/*
+ * GenericHeader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "GenericHeader.h"
+#include "RouteHeader.h"
+#include "Utility.h"
+
+#include <string.h>
+
+const header_grammar_t generic_header_grammars[MAX_NUM_GENERIC_HEADERS] =
+{
+#define XX(id, cls, name, compact, shape, multi) { name, sizeof(name) - 1, compact, HDR_SHAPE_##shape, multi != 0 },
+  SIP_GENERIC_HEADER_MAP(XX)
+  SIP_DERIVED_HEADER_MAP(XX)
+#undef XX
+};
+
+GenericHeaderId_t find_generic_header(const char* name, uint32_t length)
+{
+  if (length == 1)
+  {
+    for (uint32_t i = 0; i < MAX_NUM_GENERIC_HEADERS; i++)
+    {
+      if (generic_header_grammars[i].compact && LOWER(name[0]) == generic_header_grammars[i].compact)
+      {
+        return (GenericHeaderId_t)i;
+      }
+    }
+    return MAX_NUM_GENERIC_HEADERS;
+  }
+  for (uint32_t i = 0; i < MAX_NUM_GENERIC_HEADERS; i++)
+  {
+    /* length and first char reject most of the names without a comparison */
+    const header_grammar_t& grammar = generic_header_grammars[i];
+    if (grammar.length == length && LOWER(grammar.name[0]) == LOWER(name[0]) &&
+        0 == _strnicmp_(name, grammar.name, length))
+    {
+      return (GenericHeaderId_t)i;
+    }
+  }
+  return MAX_NUM_GENERIC_HEADERS;
+}
+
+GenericHeader* CreateGenericHeader(const char* name, uint32_t length)
+{
+  switch (find_generic_header(name, length))
+  {
+#define XX(id, cls, name, compact, shape, multi) case GHDR_##id: return new cls##Header();
+    SIP_GENERIC_HEADER_MAP(XX)
+    SIP_DERIVED_HEADER_MAP(XX)
+#undef XX
+    default:
+      return NULL;
+  }
+}
+
+const char* GenericHeader::ParseElement(const char* buf, const char* p, uint32_t buflen, header_element_t* element)
+{
+  const char* end = buf + buflen;
+  const char* mark = p;
+  const char* tmp;
+  int parse_error = 0;
+
+  switch (this->GetShape())
+  {
+    case HDR_SHAPE_NUMBER:
+      while (p < end && IS_DIGIT(*p))
+      {
+        p++;
+      }
+      element->value.start = mark - buf;
+      element->value.length = p - mark;
+
+      /* comment of Retry-After, i.e. "120 (I'm in a meeting)", nested ones included */
+      for (tmp = p; tmp < end && IS_LWS(*tmp); tmp++)
+        ;
+      if (tmp < end && *tmp == '(')
+      {
+        int depth = 0;
+        for (mark = tmp; tmp < end; tmp++)
+        {
+          if (*tmp == '\\' && tmp + 1 < end)
+          {
+            tmp++; /* quoted-pair */
+          }
+          else if (*tmp == '(')
+          {
+            depth++;
+          }
+          else if (*tmp == ')' && --depth == 0)
+          {
+            break;
+          }
+        }
+        if (tmp >= end)
+        {
+          this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+          return tmp;
+        }
+        p = tmp + 1;
+        element->comment.start = mark - buf;
+        element->comment.length = p - mark;
+      }
+      break;
+
+    case HDR_SHAPE_TOKEN:
+      while (p < end && IS_TOKEN(*p))
+      {
+        p++;
+      }
+      element->value.start = mark - buf;
+      element->value.length = p - mark;
+      break;
+
+    case HDR_SHAPE_WORD:
+      while (p < end && (IS_WORD(*p) || *p == '@'))
+      {
+        p++;
+      }
+      element->value.start = mark - buf;
+      element->value.length = p - mark;
+      break;
+
+    case HDR_SHAPE_NAME_ADDR:
+      p = parse_name_addr_part(buf, p - buf, buflen, &element->displayName, &element->value, &parse_error, 1);
+      if (parse_error != 0 || element->value.length == 0)
+      {
+        this->parsing_stat = PARSING_FAILED_UNCLEAR_REASON;
+        return p;
+      }
+      mark = buf + element->value.start;
+      if (*mark == '<')
+      {
+        /* URI without angle quotes, the closing one is there by name-addr parsing */
+        element->value.start++;
+        element->value.length -= 2;
+      }
+      else if (generic_header_grammars[this->id].multi &&
+               (tmp = (const char*)memchr(mark, ',', element->value.length)) != NULL)
+      {
+        /* addr-spec is collected up to LWS or ';', the next element may follow */
+        element->value.length = tmp - mark;
+        p = tmp;
+      }
+      return p;
+
+    default:
+      break;
+  }
+  if (element->value.length == 0)
+  {
+    this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+  }
+  return p;
+}
+
+/* Parsing utility */
+const char* GenericHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  return this->ParseElements(buf, pos, buflen, MAX_NUM_HDR_ELEMENTS + 1);
+}
+
+const char* GenericHeader::ParseTop(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  return this->ParseElements(buf, pos, buflen, 1);
+}
+
+const char* GenericHeader::ParseElements(const char* buf, uint32_t pos, uint32_t buflen, uint32_t maxnum)
+{
+  const header_grammar_t& grammar = generic_header_grammars[this->id];
+  const char* end = buf + buflen;
+  const char* p;
+  int parse_error = 0;
+
+  if (buflen == 0)
+  {
+    this->parsing_stat = PARSING_FAILED_NO_DATA;
+    return buf;
+  }
+
+  this->rawdata._data = (unsigned char*)buf;
+  this->rawdata._length = buflen;
+  this->rawdata._pos = pos;
+  this->num_elements = 0;
+  this->num_params = 0;
+  this->rest.start = this->rest.length = 0;
+  this->parsing_stat = NOT_PARSED_YET;
+
+  for (p = buf + pos; p < end && IS_LWS(*p); p++)
+    ;
+  if (grammar.shape == HDR_SHAPE_TEXT)
+  {
+    const char* last = end;
+    while (last > p && IS_LWS(*(last - 1)))
+    {
+      last--;
+    }
+    header_element_t* element = &this->elements[this->num_elements++];
+    *element = header_element_t();
+    element->value.start = p - buf;
+    element->value.length = last - p;
+    this->parsing_stat = PARSED_SUCCESSFULLY;
+    return end;
+  }
+  if (p >= end)
+  {
+    /* an empty list is valid, i.e. "Supported:" */
+    this->parsing_stat = (grammar.multi && grammar.shape == HDR_SHAPE_TOKEN) ? PARSED_SUCCESSFULLY : PARSING_FAILED_NO_DATA;
+    return p;
+  }
+
+  for (;;)
+  {
+    if (this->num_elements >= MAX_NUM_HDR_ELEMENTS)
+    {
+      this->parsing_stat = PARSING_FAILED_MAX_RANGE;
+      return p;
+    }
+    header_element_t* element = &this->elements[this->num_elements++];
+    *element = header_element_t();
+    element->first_param = this->num_params;
+
+    p = this->ParseElement(buf, p, buflen, element);
+    if (this->parsing_stat != NOT_PARSED_YET)
+    {
+      return p;
+    }
+    while (p < end && IS_LWS(*p))
+    {
+      p++;
+    }
+    if (p < end && *p == ';')
+    {
+      p++; /* skip ';' */
+      p = parse_param_part(buf, p - buf, buflen, &this->params[0], MAX_NUM_PARAMS, &this->num_params, &parse_error, grammar.multi, &element->slots);
+      if (parse_error)
+      {
+        /* TODO: Map parse_error to parsing_stat */
+        this->parsing_stat = (parse_error == 5) ? PARSING_FAILED_MAX_RANGE : PARSING_FAILED_UNCLEAR_REASON;
+        return p;
+      }
+      element->num_params = this->num_params - element->first_param;
+      while (p < end && IS_LWS(*p))
+      {
+        p++;
+      }
+    }
+    if (p >= end)
+    {
+      break;
+    }
+    if (*p != ',' || !grammar.multi)
+    {
+      this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    /* skip ',' and the spaces before the next element, which must exist */
+    for (p++; p < end && IS_LWS(*p); p++)
+      ;
+    if (p >= end)
+    {
+      this->parsing_stat = PARSING_FAILED_NO_DATA;
+      return p;
+    }
+    if (this->num_elements == maxnum)
+    {
+      this->rest.start = p - buf;
+      this->rest.length = end - p;
+      break;
+    }
+  }
+  this->parsing_stat = PARSED_SUCCESSFULLY;
+  return p;
+}
+
+int GenericHeader::GetNumber(uint32_t* value) const
+{
+  if (this->parsing_stat != PARSED_SUCCESSFULLY || this->GetShape() != HDR_SHAPE_NUMBER || this->num_elements == 0)
+  {
+    return 1;
+  }
+  const char* p = (const char*)this->rawdata._data + this->elements[0].value.start;
+  uint32_t result = 0;
+
+  for (uint32_t i = 0; i < this->elements[0].value.length; i++)
+  {
+    if (result > (0xFFFFFFFFU - (p[i] - '0')) / 10)
+    {
+      return 1;
+    }
+    result = result * 10 + (p[i] - '0');
+  }
+  *value = result;
+  return 0;
+}
+
+std::string GenericHeader::GetHeaderValue()
+{
+  std::string value;
+  this->GetHeaderValue(value);
+  return value;
+}
+
+int GenericHeader::GetHeaderValue(std::string& value)
+{
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
+  if (!this->rawdata._length || this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    value = "";
+    return 1;
+  }
+  /* parts are never longer than the received value, separators and angle
+     quotes may be added to each of them by re-formatting */
+  uint32_t length = this->rawdata._length - this->rawdata._pos + 4 * this->num_elements + 2 * this->num_params;
+  value.resize(length);
+  int result = this->FormatValue(&value[0], length);
+  value.resize((result < 0) ? 0 : (size_t)result);
+  return (result < 0) ? 1 : 0;
+}
+
+int GenericHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  bool name_addr = (this->GetShape() == HDR_SHAPE_NAME_ADDR);
+  uint32_t pos = 0;
+
+  for (uint32_t i = 0; i < this->num_elements; i++)
+  {
+    const header_element_t& element = this->elements[i];
+    if (i > 0 && (!this->AppendChar(buf, buflen, pos, ',') || !this->AppendChar(buf, buflen, pos, ' ')))
+    {
+      return -1;
+    }
+    if (element.displayName.length &&
+        (!this->AppendValue(buf, buflen, pos, element.displayName.start, element.displayName.length) ||
+         !this->AppendChar(buf, buflen, pos, ' ')))
+    {
+      return -1;
+    }
+    if ((name_addr && !this->AppendChar(buf, buflen, pos, '<')) ||
+        !this->AppendValue(buf, buflen, pos, element.value.start, element.value.length) ||
+        (name_addr && !this->AppendChar(buf, buflen, pos, '>')))
+    {
+      return -1;
+    }
+    if (element.comment.length &&
+        (!this->AppendChar(buf, buflen, pos, ' ') ||
+         !this->AppendValue(buf, buflen, pos, element.comment.start, element.comment.length)))
+    {
+      return -1;
+    }
+    for (uint32_t k = element.first_param; k < element.first_param + element.num_params; k++)
+    {
+      const param_pos_t& param = this->params[k];
+      if (!this->AppendChar(buf, buflen, pos, ';') ||
+          !this->AppendValue(buf, buflen, pos, param.type.start, param.type.length) ||
+          (param.value.length &&
+           (!this->AppendChar(buf, buflen, pos, '=') ||
+            !this->AppendValue(buf, buflen, pos, param.value.start, param.value.length))))
+      {
+        return -1;
+      }
+    }
+  }
+  if (this->rest.length &&
+      (!this->AppendChar(buf, buflen, pos, ',') || !this->AppendChar(buf, buflen, pos, ' ') ||
+       !this->AppendValue(buf, buflen, pos, this->rest.start, this->rest.length)))
+  {
+    return -1;
+  }
+  return (int)pos;
+}
+
+/* provides the pointer to value part of the header in question.
+   No any additional copy applied. */
+int GenericHeader::GetHeaderValue(RawData& value)
+{
+  if (!this->rawdata._length || this->modified)
+  {
+    return 1;
+  }
+  value._data = this->rawdata._data;
+  value._length = this->rawdata._length;
+  value._pos = this->rawdata._pos;
+
+  return 0;
+}
+
+void GenericHeader::PrintOut(std::ostringstream& buf)
+{
+  buf << "-------- " << this->GetName() << " Header DUMP [parsing-stat=" << this->parsing_stat << "-" << SipHeader::GetParsingStatInText(this->parsing_stat) << "] ----------\n";
+  if (this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    buf << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
+    return;
+  }
+  for (uint32_t i = 0; i < this->num_elements; i++)
+  {
+    const header_element_t& element = this->elements[i];
+    buf << '[' << i << "]: ";
+    if (element.displayName.length)
+    {
+      buf << "display-name=" << std::string((const char*)this->rawdata._data + element.displayName.start, element.displayName.length) << ' ';
+    }
+    buf << std::string((const char*)this->rawdata._data + element.value.start, element.value.length);
+    if (element.comment.length)
+    {
+      buf << ' ' << std::string((const char*)this->rawdata._data + element.comment.start, element.comment.length);
+    }
+    buf << std::endl;
+    for (uint32_t k = element.first_param; k < element.first_param + element.num_params; k++)
+    {
+      buf << "     " << std::string((const char*)this->rawdata._data + this->params[k].type.start, this->params[k].type.length);
+      if (this->params[k].value.length)
+      {
+        buf << " = " << std::string((const char*)this->rawdata._data + this->params[k].value.start, this->params[k].value.length);
+      }
+      buf << std::endl;
+    }
+  }
+  if (this->rest.length)
+  {
+    buf << "not parsed: " << std::string((const char*)this->rawdata._data + this->rest.start, this->rest.length) << std::endl;
+  }
+  buf << "----------------\n";
+  buf << this->GetName() << ": " << std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos) << std::endl;
+  buf << "---------------------------------------\n";
+}
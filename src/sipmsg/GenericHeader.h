@@ -0,0 +1,284 @@
+/*
+ * GenericHeader.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _GENERIC_HEADER_H_
+#define _GENERIC_HEADER_H_
+//---------------------------------------------------------------------------
+#include "SipMessage.h"
+#include "SipHeader.h"
+#include "ParamParser.h"
+
+#include <array>
+
+/*
+  Headers without a hand-written parser are described by a single line of
+  SIP_GENERIC_HEADER_MAP below: the class to be generated, header name, compact
+  form, grammar shape of a value element and whether the value is a comma
+  separated list of elements. Grammar shapes cover the header fields of the
+  IANA SIP parameters registry:
+
+    HDR_SHAPE_TEXT      : the value as a whole, i.e. Date, User-Agent, Warning
+    HDR_SHAPE_NUMBER    : 1*DIGIT [ comment ] *( SEMI generic-param )
+    HDR_SHAPE_TOKEN     : token *( SEMI generic-param )
+    HDR_SHAPE_WORD      : callid *( SEMI generic-param )
+                          callid = word [ "@" word ]
+    HDR_SHAPE_NAME_ADDR : ( name-addr / addr-spec ) *( SEMI generic-param )
+
+  Every line generates a class, i.e. XX(PATH, Path, "Path", 0, NAME_ADDR, 1)
+  gives PathHeader, so supporting a new header is adding one more line here.
+  Lines of SIP_DERIVED_HEADER_MAP are parsed the same way but their classes
+  are written by hand on top of GenericHeader, to provide more than spans,
+  i.e. RouteHeader.h.
+  All of them share the parser of GenericHeader which emits spans of the
+  received value only, over the name-addr and param primitives of Utility.cpp.
+
+  Headers of their own grammar are not described here: the ones having a
+  class already, i.e. Via, Contact, CSeq, Accept, and the authentication ones,
+  nor the ones deprecated in the registry: Encryption, Hide, Response-Key and
+  Identity-Info.
+ */
+
+#define SIP_GENERIC_HEADER_MAP(XX) \
+  XX(ACCEPT_CONTACT,          AcceptContact,          "Accept-Contact",          'a', TOKEN,     1) \
+  XX(ACCEPT_RESOURCE_PRIORITY, AcceptResourcePriority, "Accept-Resource-Priority", 0, TOKEN,     1) \
+  XX(ADDITIONAL_IDENTITY,     AdditionalIdentity,     "Additional-Identity",     0,   TEXT,      0) \
+  XX(ALERT_INFO,              AlertInfo,              "Alert-Info",              0,   NAME_ADDR, 1) \
+  XX(ALLOW_EVENTS,            AllowEvents,            "Allow-Events",            'u', TOKEN,     1) \
+  XX(ANSWER_MODE,             AnswerMode,             "Answer-Mode",             0,   TOKEN,     0) \
+  XX(ATTESTATION_INFO,        AttestationInfo,        "Attestation-Info",        0,   TOKEN,     0) \
+  XX(CALL_INFO,               CallInfo,               "Call-Info",               0,   NAME_ADDR, 1) \
+  XX(CELLULAR_NETWORK_INFO,   CellularNetworkInfo,    "Cellular-Network-Info",   0,   TOKEN,     1) \
+  XX(CONTENT_DISPOSITION,     ContentDisposition,     "Content-Disposition",     0,   TOKEN,     0) \
+  XX(CONTENT_ENCODING,        ContentEncoding,        "Content-Encoding",        'e', TOKEN,     1) \
+  XX(CONTENT_ID,              ContentId,              "Content-ID",              0,   TEXT,      0) \
+  XX(CONTENT_LANGUAGE,        ContentLanguage,        "Content-Language",        0,   TOKEN,     1) \
+  XX(DATE,                    Date,                   "Date",                    0,   TEXT,      0) \
+  XX(ERROR_INFO,              ErrorInfo,              "Error-Info",              0,   NAME_ADDR, 1) \
+  XX(EVENT,                   Event,                  "Event",                   'o', TOKEN,     0) \
+  XX(EXPIRES,                 Expires,                "Expires",                 0,   NUMBER,    0) \
+  XX(FEATURE_CAPS,            FeatureCaps,            "Feature-Caps",            0,   TOKEN,     1) \
+  XX(FLOW_TIMER,              FlowTimer,              "Flow-Timer",              0,   NUMBER,    0) \
+  XX(GEOLOCATION,             Geolocation,            "Geolocation",             0,   NAME_ADDR, 1) \
+  XX(GEOLOCATION_ERROR,       GeolocationError,       "Geolocation-Error",       0,   TOKEN,     0) \
+  XX(GEOLOCATION_ROUTING,     GeolocationRouting,     "Geolocation-Routing",     0,   TOKEN,     0) \
+  XX(HISTORY_INFO,            HistoryInfo,            "History-Info",            0,   NAME_ADDR, 1) \
+  XX(IDENTITY,                Identity,               "Identity",                'y', TEXT,      0) \
+  XX(INFO_PACKAGE,            InfoPackage,            "Info-Package",            0,   TOKEN,     0) \
+  XX(IN_REPLY_TO,             InReplyTo,              "In-Reply-To",             0,   WORD,      1) \
+  XX(JOIN,                    Join,                   "Join",                    0,   WORD,      0) \
+  XX(MAX_BREADTH,             MaxBreadth,             "Max-Breadth",             0,   NUMBER,    0) \
+  XX(MIME_VERSION,            MimeVersion,            "MIME-Version",            0,   TEXT,      0) \
+  XX(MIN_EXPIRES,             MinExpires,             "Min-Expires",             0,   NUMBER,    0) \
+  XX(MIN_SE,                  MinSE,                  "Min-SE",                  0,   NUMBER,    0) \
+  XX(ORGANIZATION,            Organization,           "Organization",            0,   TEXT,      0) \
+  XX(ORIGINATION_ID,          OriginationId,          "Origination-Id",          0,   TEXT,      0) \
+  XX(P_ACCESS_NETWORK_INFO,   PAccessNetworkInfo,     "P-Access-Network-Info",   0,   TOKEN,     1) \
+  XX(P_ANSWER_STATE,          PAnswerState,           "P-Answer-State",          0,   TOKEN,     0) \
+  XX(P_ASSERTED_IDENTITY,     PAssertedIdentity,      "P-Asserted-Identity",     0,   NAME_ADDR, 1) \
+  XX(P_ASSERTED_SERVICE,      PAssertedService,       "P-Asserted-Service",      0,   TEXT,      0) \
+  XX(P_ASSOCIATED_URI,        PAssociatedUri,         "P-Associated-URI",        0,   NAME_ADDR, 1) \
+  XX(P_CALLED_PARTY_ID,       PCalledPartyId,         "P-Called-Party-ID",       0,   NAME_ADDR, 0) \
+  XX(P_CHARGE_INFO,           PChargeInfo,            "P-Charge-Info",           0,   NAME_ADDR, 0) \
+  XX(P_CHARGING_FUNCTION_ADDRESSES, PChargingFunctionAddresses, "P-Charging-Function-Addresses", 0,   TEXT,      0) \
+  XX(P_CHARGING_VECTOR,       PChargingVector,        "P-Charging-Vector",       0,   TEXT,      0) \
+  XX(P_DCS_BILLING_INFO,      PDcsBillingInfo,        "P-DCS-Billing-Info",      0,   TEXT,      0) \
+  XX(P_DCS_LAES,              PDcsLaes,               "P-DCS-LAES",              0,   TEXT,      0) \
+  XX(P_DCS_OSPS,              PDcsOsps,               "P-DCS-OSPS",              0,   TOKEN,     0) \
+  XX(P_DCS_REDIRECT,          PDcsRedirect,           "P-DCS-Redirect",          0,   TEXT,      0) \
+  XX(P_DCS_TRACE_PARTY_ID,    PDcsTracePartyId,       "P-DCS-Trace-Party-ID",    0,   NAME_ADDR, 0) \
+  XX(P_EARLY_MEDIA,           PEarlyMedia,            "P-Early-Media",           0,   TOKEN,     1) \
+  XX(P_MEDIA_AUTHORIZATION,   PMediaAuthorization,    "P-Media-Authorization",   0,   TOKEN,     1) \
+  XX(P_PREFERRED_IDENTITY,    PPreferredIdentity,     "P-Preferred-Identity",    0,   NAME_ADDR, 1) \
+  XX(P_PREFERRED_SERVICE,     PPreferredService,      "P-Preferred-Service",     0,   TEXT,      0) \
+  XX(P_PRIVATE_NETWORK_INDICATION, PPrivateNetworkIndication, "P-Private-Network-Indication", 0,   TOKEN,     0) \
+  XX(P_PROFILE_KEY,           PProfileKey,            "P-Profile-Key",           0,   NAME_ADDR, 0) \
+  XX(P_REFUSED_URI_LIST,      PRefusedUriList,        "P-Refused-URI-List",      0,   NAME_ADDR, 1) \
+  XX(P_SERVED_USER,           PServedUser,            "P-Served-User",           0,   NAME_ADDR, 0) \
+  XX(P_USER_DATABASE,         PUserDatabase,          "P-User-Database",         0,   NAME_ADDR, 0) \
+  XX(P_VISITED_NETWORK_ID,    PVisitedNetworkId,      "P-Visited-Network-ID",    0,   TEXT,      0) \
+  XX(PATH,                    Path,                   "Path",                    0,   NAME_ADDR, 1) \
+  XX(PERMISSION_MISSING,      PermissionMissing,      "Permission-Missing",      0,   NAME_ADDR, 1) \
+  XX(POLICY_CONTACT,          PolicyContact,          "Policy-Contact",          0,   NAME_ADDR, 1) \
+  XX(POLICY_ID,               PolicyId,               "Policy-ID",               0,   TEXT,      0) \
+  XX(PRIORITY,                Priority,               "Priority",                0,   TOKEN,     0) \
+  XX(PRIORITY_SHARE,          PriorityShare,          "Priority-Share",          0,   TOKEN,     0) \
+  XX(PRIORITY_VERSTAT,        PriorityVerstat,        "Priority-Verstat",        0,   TOKEN,     0) \
+  XX(PRIV_ANSWER_MODE,        PrivAnswerMode,         "Priv-Answer-Mode",        0,   TOKEN,     0) \
+  XX(PRIVACY,                 Privacy,                "Privacy",                 0,   TEXT,      0) \
+  XX(PROXY_REQUIRE,           ProxyRequire,           "Proxy-Require",           0,   TOKEN,     1) \
+  XX(RACK,                    RAck,                   "RAck",                    0,   TEXT,      0) \
+  XX(REASON,                  Reason,                 "Reason",                  0,   TOKEN,     1) \
+  XX(RECV_INFO,               RecvInfo,               "Recv-Info",               0,   TOKEN,     1) \
+  XX(REFER_EVENTS_AT,         ReferEventsAt,          "Refer-Events-At",         0,   NAME_ADDR, 0) \
+  XX(REFER_SUB,               ReferSub,               "Refer-Sub",               0,   TOKEN,     0) \
+  XX(REFER_TO,                ReferTo,                "Refer-To",                'r', NAME_ADDR, 0) \
+  XX(REFERRED_BY,             ReferredBy,             "Referred-By",             'b', NAME_ADDR, 0) \
+  XX(REJECT_CONTACT,          RejectContact,          "Reject-Contact",          'j', TOKEN,     1) \
+  XX(RELAYED_CHARGE,          RelayedCharge,          "Relayed-Charge",          0,   TEXT,      0) \
+  XX(REPLACES,                Replaces,               "Replaces",                0,   WORD,      0) \
+  XX(REPLY_TO,                ReplyTo,                "Reply-To",                0,   NAME_ADDR, 0) \
+  XX(REQUEST_DISPOSITION,     RequestDisposition,     "Request-Disposition",     'd', TOKEN,     1) \
+  XX(REQUIRE,                 Require,                "Require",                 0,   TOKEN,     1) \
+  XX(RESOURCE_PRIORITY,       ResourcePriority,       "Resource-Priority",       0,   TOKEN,     1) \
+  XX(RESOURCE_SHARE,          ResourceShare,          "Resource-Share",          0,   TOKEN,     0) \
+  XX(RESPONSE_SOURCE,         ResponseSource,         "Response-Source",         0,   TEXT,      0) \
+  XX(RESTORATION_INFO,        RestorationInfo,        "Restoration-Info",        0,   TEXT,      0) \
+  XX(RETRY_AFTER,             RetryAfter,             "Retry-After",             0,   NUMBER,    0) \
+  XX(RSEQ,                    RSeq,                   "RSeq",                    0,   NUMBER,    0) \
+  XX(SECURITY_CLIENT,         SecurityClient,         "Security-Client",         0,   TOKEN,     1) \
+  XX(SECURITY_SERVER,         SecurityServer,         "Security-Server",         0,   TOKEN,     1) \
+  XX(SECURITY_VERIFY,         SecurityVerify,         "Security-Verify",         0,   TOKEN,     1) \
+  XX(SERVER,                  Server,                 "Server",                  0,   TEXT,      0) \
+  XX(SERVICE_INTERACT_INFO,   ServiceInteractInfo,    "Service-Interact-Info",   0,   TEXT,      0) \
+  XX(SERVICE_ROUTE,           ServiceRoute,           "Service-Route",           0,   NAME_ADDR, 1) \
+  XX(SESSION_EXPIRES,         SessionExpires,         "Session-Expires",         'x', NUMBER,    0) \
+  XX(SESSION_ID,              SessionId,              "Session-ID",              0,   TEXT,      0) \
+  XX(SIP_ETAG,                SipETag,                "SIP-ETag",                0,   TOKEN,     0) \
+  XX(SIP_IF_MATCH,            SipIfMatch,             "SIP-If-Match",            0,   TOKEN,     0) \
+  XX(SUBSCRIPTION_STATE,      SubscriptionState,      "Subscription-State",      0,   TOKEN,     0) \
+  XX(SUPPORTED,               Supported,              "Supported",               'k', TOKEN,     1) \
+  XX(SUPPRESS_IF_MATCH,       SuppressIfMatch,        "Suppress-If-Match",       0,   TOKEN,     0) \
+  XX(TARGET_DIALOG,           TargetDialog,           "Target-Dialog",           0,   WORD,      0) \
+  XX(TIMESTAMP,               Timestamp,              "Timestamp",               0,   TEXT,      0) \
+  XX(TRIGGER_CONSENT,         TriggerConsent,         "Trigger-Consent",         0,   NAME_ADDR, 1) \
+  XX(UNSUPPORTED,             Unsupported,            "Unsupported",             0,   TOKEN,     1) \
+  XX(USER_AGENT,              UserAgent,              "User-Agent",              0,   TEXT,      0) \
+  XX(USER_TO_USER,            UserToUser,             "User-to-User",            0,   TEXT,      0) \
+  XX(WARNING,                 Warning,                "Warning",                 0,   TEXT,      0)
+
+#define SIP_DERIVED_HEADER_MAP(XX) \
+  XX(RECORD_ROUTE,            RecordRoute,            "Record-Route",            0,   NAME_ADDR, 1) \
+  XX(ROUTE,                   Route,                  "Route",                   0,   NAME_ADDR, 1)
+
+typedef enum
+{
+  HDR_SHAPE_TEXT,
+  HDR_SHAPE_NUMBER,
+  HDR_SHAPE_TOKEN,
+  HDR_SHAPE_WORD,
+  HDR_SHAPE_NAME_ADDR
+} HeaderShape_t;
+
+typedef enum
+{
+#define XX(id, cls, name, compact, shape, multi) GHDR_##id,
+  SIP_GENERIC_HEADER_MAP(XX)
+  SIP_DERIVED_HEADER_MAP(XX)
+#undef XX
+  MAX_NUM_GENERIC_HEADERS
+} GenericHeaderId_t;
+
+typedef struct header_grammar
+{
+  const char* name;
+  uint32_t length;
+  char compact;          /**< 0 if the header has no compact form */
+  HeaderShape_t shape;
+  bool multi;            /**< value may be a comma separated list */
+} header_grammar_t;
+
+extern const header_grammar_t generic_header_grammars[MAX_NUM_GENERIC_HEADERS];
+
+/* id of the header named 'name' in long or compact form, MAX_NUM_GENERIC_HEADERS
+   if it is not described in SIP_GENERIC_HEADER_MAP or SIP_DERIVED_HEADER_MAP */
+GenericHeaderId_t find_generic_header(const char* name, uint32_t length);
+
+#define MAX_NUM_HDR_ELEMENTS 16
+
+/* a value element, i.e. a route-param of Route, an option-tag of Supported */
+typedef struct header_element
+{
+  str_pos_t displayName; /**< name-addr only */
+  str_pos_t value;       /**< token, number, callid, text or URI without angle quotes */
+  str_pos_t comment;     /**< number only, i.e. "(in a meeting)" of Retry-After */
+  uint32_t first_param;  /**< position of its parameters in GenericHeader::params */
+  uint32_t num_params;
+  param_slots_t slots;   /**< well-known ones of its parameters */
+} header_element_t;
+
+class GenericHeader : public SipHeader
+{
+public:
+  GenericHeader(GenericHeaderId_t headerId)
+    : id(headerId), num_elements(0), elements(), num_params(0), params(), rest({ 0, 0 })
+  {}
+
+  /* Parsing utility */
+  const char* ParseHeader(const char* buf, uint32_t pos, uint32_t buflen);
+
+  /* Parses only the first element of a list, i.e. the top route of Route.
+     The others are kept as a single span in 'rest' */
+  const char* ParseTop(const char* buf, uint32_t pos, uint32_t buflen);
+
+  /* both provide the value part, which can be re-formatted if the header has
+     subparts or represents a multiple-header */
+  std::string GetHeaderValue();
+  int GetHeaderValue(std::string& value);
+
+  /* provides the pointer to value part of the header in question.
+     No any additional copy applied. */
+  int GetHeaderValue(RawData& value);
+
+  void PrintOut(std::ostringstream& buf);
+
+  const char* GetName() const { return generic_header_grammars[this->id].name; }
+  HeaderShape_t GetShape() const { return generic_header_grammars[this->id].shape; }
+
+  /* well-known parameter of element 'index' without any comparison, NULL if it
+     does not exist. See ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t pid, uint32_t index = 0) const
+  {
+    return (index < this->num_elements) ? get_param(this->elements[index].slots, &this->params[0], pid) : NULL;
+  }
+
+  /* numeric value of a well-known parameter of element 'index'. Returns 0 on
+     success, 1 if it does not exist or is not a number */
+  int GetParamU32(ParamId_t pid, uint32_t* value, uint32_t index = 0) const
+  {
+    return get_param_u32((const char*)this->rawdata._data, this->GetParam(pid, index), pid, value);
+  }
+
+  /* value of a NUMBER shaped header, i.e. 3600 of "Expires: 3600". Returns 0
+     on success, 1 if it is not parsed or the number does not fit */
+  int GetNumber(uint32_t* value) const;
+
+  GenericHeaderId_t id;
+  uint32_t num_elements;
+  std::array<header_element_t, MAX_NUM_HDR_ELEMENTS> elements;
+  uint32_t num_params;
+  SipParamArray_t params;  /**< parameters of all elements, in order */
+  str_pos_t rest;          /**< elements left by ParseTop(), from the one after the first */
+
+protected:
+  /* parses up to 'maxnum' elements, the others are left in 'rest' */
+  const char* ParseElements(const char* buf, uint32_t pos, uint32_t buflen, uint32_t maxnum);
+
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
+
+  /* parses the part of an element before its parameters */
+  const char* ParseElement(const char* buf, const char* p, uint32_t buflen, header_element_t* element);
+};
+
+/* A class per line of SIP_GENERIC_HEADER_MAP, i.e. RouteHeader */
+template <GenericHeaderId_t ID>
+class GeneratedHeader : public GenericHeader
+{
+public:
+  GeneratedHeader()
+    : GenericHeader(ID)
+  {}
+};
+
+#define XX(id, cls, name, compact, shape, multi) typedef GeneratedHeader<GHDR_##id> cls##Header;
+SIP_GENERIC_HEADER_MAP(XX)
+#undef XX
+
+/* parser instance of header 'name', NULL if it is not described in
+   SIP_GENERIC_HEADER_MAP or SIP_DERIVED_HEADER_MAP. The caller owns the instance */
+GenericHeader* CreateGenericHeader(const char* name, uint32_t length);
+
+//---------------------------------------------------------------------------
+#endif // _GENERIC_HEADER_H_
@@ -155,6 +155,10 @@ const char* MaxForwardsHeader::ParseHeader(const char* buf, uint32_t pos, uint32
 
 std::string MaxForwardsHeader::GetHeaderValue()
 {
+	if (this->IsReceivedValueValid())
+	{
+		return this->GetReceivedValue();
+	}
 	if (!(this->rawdata._length) || !(this->number.length))
 	{
 		return "";
@@ -164,6 +168,11 @@ std::string MaxForwardsHeader::GetHeaderValue()
 
 int MaxForwardsHeader::GetHeaderValue(std::string& value)
 {
+	if (this->IsReceivedValueValid())
+	{
+		value = this->GetReceivedValue();
+		return 0;
+	}
 	if (!(this->rawdata._length) || !(this->number.length))
 	{
 		return 1;
@@ -176,7 +185,7 @@ int MaxForwardsHeader::GetHeaderValue(std::string& value)
 
 int MaxForwardsHeader::GetHeaderValue(RawData& value)
 {
-	if (!this->rawdata._length)
+	if (!this->rawdata._length || this->modified)
 	{
 		return 1;
 	}
@@ -31,6 +31,9 @@ public:
 
 	uint16_t GetMaxForwards();
 
+	/* position of the number in parsed buffer, i.e. to replace it on forwarding */
+	str_pos_t GetNumberPos() { return number; }
+
 	void PrintOut(std::ostringstream& buf);
 
 	bool operator==(const MaxForwardsHeader& other);
@@ -0,0 +1,181 @@
+/*
+ * Md5.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Md5.h"
+
+#include <string.h>
+
+#define MD5_F(x, y, z) (((x) & (y)) | (~(x) & (z)))
+#define MD5_G(x, y, z) (((x) & (z)) | ((y) & ~(z)))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+#define MD5_ROTATE(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define MD5_STEP(f, a, b, c, d, x, s, ac) \
+  { (a) += f((b), (c), (d)) + (x) + (uint32_t)(ac); (a) = MD5_ROTATE((a), (s)) + (b); }
+
+static void md5_transform(uint32_t state[4], const uint8_t block[64])
+{
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t x[16];
+
+  for (int i = 0; i < 16; i++)
+  {
+    x[i] = (uint32_t)block[i * 4] | ((uint32_t)block[i * 4 + 1] << 8) |
+      ((uint32_t)block[i * 4 + 2] << 16) | ((uint32_t)block[i * 4 + 3] << 24);
+  }
+
+  /* Round 1 */
+  MD5_STEP(MD5_F, a, b, c, d, x[0], 7, 0xd76aa478);
+  MD5_STEP(MD5_F, d, a, b, c, x[1], 12, 0xe8c7b756);
+  MD5_STEP(MD5_F, c, d, a, b, x[2], 17, 0x242070db);
+  MD5_STEP(MD5_F, b, c, d, a, x[3], 22, 0xc1bdceee);
+  MD5_STEP(MD5_F, a, b, c, d, x[4], 7, 0xf57c0faf);
+  MD5_STEP(MD5_F, d, a, b, c, x[5], 12, 0x4787c62a);
+  MD5_STEP(MD5_F, c, d, a, b, x[6], 17, 0xa8304613);
+  MD5_STEP(MD5_F, b, c, d, a, x[7], 22, 0xfd469501);
+  MD5_STEP(MD5_F, a, b, c, d, x[8], 7, 0x698098d8);
+  MD5_STEP(MD5_F, d, a, b, c, x[9], 12, 0x8b44f7af);
+  MD5_STEP(MD5_F, c, d, a, b, x[10], 17, 0xffff5bb1);
+  MD5_STEP(MD5_F, b, c, d, a, x[11], 22, 0x895cd7be);
+  MD5_STEP(MD5_F, a, b, c, d, x[12], 7, 0x6b901122);
+  MD5_STEP(MD5_F, d, a, b, c, x[13], 12, 0xfd987193);
+  MD5_STEP(MD5_F, c, d, a, b, x[14], 17, 0xa679438e);
+  MD5_STEP(MD5_F, b, c, d, a, x[15], 22, 0x49b40821);
+
+  /* Round 2 */
+  MD5_STEP(MD5_G, a, b, c, d, x[1], 5, 0xf61e2562);
+  MD5_STEP(MD5_G, d, a, b, c, x[6], 9, 0xc040b340);
+  MD5_STEP(MD5_G, c, d, a, b, x[11], 14, 0x265e5a51);
+  MD5_STEP(MD5_G, b, c, d, a, x[0], 20, 0xe9b6c7aa);
+  MD5_STEP(MD5_G, a, b, c, d, x[5], 5, 0xd62f105d);
+  MD5_STEP(MD5_G, d, a, b, c, x[10], 9, 0x02441453);
+  MD5_STEP(MD5_G, c, d, a, b, x[15], 14, 0xd8a1e681);
+  MD5_STEP(MD5_G, b, c, d, a, x[4], 20, 0xe7d3fbc8);
+  MD5_STEP(MD5_G, a, b, c, d, x[9], 5, 0x21e1cde6);
+  MD5_STEP(MD5_G, d, a, b, c, x[14], 9, 0xc33707d6);
+  MD5_STEP(MD5_G, c, d, a, b, x[3], 14, 0xf4d50d87);
+  MD5_STEP(MD5_G, b, c, d, a, x[8], 20, 0x455a14ed);
+  MD5_STEP(MD5_G, a, b, c, d, x[13], 5, 0xa9e3e905);
+  MD5_STEP(MD5_G, d, a, b, c, x[2], 9, 0xfcefa3f8);
+  MD5_STEP(MD5_G, c, d, a, b, x[7], 14, 0x676f02d9);
+  MD5_STEP(MD5_G, b, c, d, a, x[12], 20, 0x8d2a4c8a);
+
+  /* Round 3 */
+  MD5_STEP(MD5_H, a, b, c, d, x[5], 4, 0xfffa3942);
+  MD5_STEP(MD5_H, d, a, b, c, x[8], 11, 0x8771f681);
+  MD5_STEP(MD5_H, c, d, a, b, x[11], 16, 0x6d9d6122);
+  MD5_STEP(MD5_H, b, c, d, a, x[14], 23, 0xfde5380c);
+  MD5_STEP(MD5_H, a, b, c, d, x[1], 4, 0xa4beea44);
+  MD5_STEP(MD5_H, d, a, b, c, x[4], 11, 0x4bdecfa9);
+  MD5_STEP(MD5_H, c, d, a, b, x[7], 16, 0xf6bb4b60);
+  MD5_STEP(MD5_H, b, c, d, a, x[10], 23, 0xbebfbc70);
+  MD5_STEP(MD5_H, a, b, c, d, x[13], 4, 0x289b7ec6);
+  MD5_STEP(MD5_H, d, a, b, c, x[0], 11, 0xeaa127fa);
+  MD5_STEP(MD5_H, c, d, a, b, x[3], 16, 0xd4ef3085);
+  MD5_STEP(MD5_H, b, c, d, a, x[6], 23, 0x04881d05);
+  MD5_STEP(MD5_H, a, b, c, d, x[9], 4, 0xd9d4d039);
+  MD5_STEP(MD5_H, d, a, b, c, x[12], 11, 0xe6db99e5);
+  MD5_STEP(MD5_H, c, d, a, b, x[15], 16, 0x1fa27cf8);
+  MD5_STEP(MD5_H, b, c, d, a, x[2], 23, 0xc4ac5665);
+
+  /* Round 4 */
+  MD5_STEP(MD5_I, a, b, c, d, x[0], 6, 0xf4292244);
+  MD5_STEP(MD5_I, d, a, b, c, x[7], 10, 0x432aff97);
+  MD5_STEP(MD5_I, c, d, a, b, x[14], 15, 0xab9423a7);
+  MD5_STEP(MD5_I, b, c, d, a, x[5], 21, 0xfc93a039);
+  MD5_STEP(MD5_I, a, b, c, d, x[12], 6, 0x655b59c3);
+  MD5_STEP(MD5_I, d, a, b, c, x[3], 10, 0x8f0ccc92);
+  MD5_STEP(MD5_I, c, d, a, b, x[10], 15, 0xffeff47d);
+  MD5_STEP(MD5_I, b, c, d, a, x[1], 21, 0x85845dd1);
+  MD5_STEP(MD5_I, a, b, c, d, x[8], 6, 0x6fa87e4f);
+  MD5_STEP(MD5_I, d, a, b, c, x[15], 10, 0xfe2ce6e0);
+  MD5_STEP(MD5_I, c, d, a, b, x[6], 15, 0xa3014314);
+  MD5_STEP(MD5_I, b, c, d, a, x[13], 21, 0x4e0811a1);
+  MD5_STEP(MD5_I, a, b, c, d, x[4], 6, 0xf7537e82);
+  MD5_STEP(MD5_I, d, a, b, c, x[11], 10, 0xbd3af235);
+  MD5_STEP(MD5_I, c, d, a, b, x[2], 15, 0x2ad7d2bb);
+  MD5_STEP(MD5_I, b, c, d, a, x[9], 21, 0xeb86d391);
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+void md5_init(md5_ctx_t* ctx)
+{
+  ctx->state[0] = 0x67452301;
+  ctx->state[1] = 0xefcdab89;
+  ctx->state[2] = 0x98badcfe;
+  ctx->state[3] = 0x10325476;
+  ctx->count = 0;
+}
+
+void md5_update(md5_ctx_t* ctx, const void* data, size_t length)
+{
+  const uint8_t* input = (const uint8_t*)data;
+  size_t index = (size_t)(ctx->count & 63);
+
+  /* empty values may come with a NULL pointer */
+  if (length == 0)
+  {
+    return;
+  }
+  ctx->count += length;
+  if (index > 0)
+  {
+    size_t fill = 64 - index;
+    if (length < fill)
+    {
+      memcpy(ctx->buffer + index, input, length);
+      return;
+    }
+    memcpy(ctx->buffer + index, input, fill);
+    md5_transform(ctx->state, ctx->buffer);
+    input += fill;
+    length -= fill;
+  }
+  /* whole blocks are hashed from the input directly */
+  for (; length >= 64; input += 64, length -= 64)
+  {
+    md5_transform(ctx->state, input);
+  }
+  memcpy(ctx->buffer, input, length);
+}
+
+void md5_final(md5_ctx_t* ctx, uint8_t digest[MD5_DIGEST_SIZE])
+{
+  static const uint8_t padding[64] = { 0x80 };
+  uint64_t bits = ctx->count << 3;
+  uint8_t length[8];
+  size_t index = (size_t)(ctx->count & 63);
+
+  for (int i = 0; i < 8; i++)
+  {
+    length[i] = (uint8_t)(bits >> (8 * i));
+  }
+  md5_update(ctx, padding, (index < 56) ? (56 - index) : (120 - index));
+  md5_update(ctx, length, 8);
+
+  for (int i = 0; i < 4; i++)
+  {
+    digest[i * 4] = (uint8_t)ctx->state[i];
+    digest[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 8);
+    digest[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 16);
+    digest[i * 4 + 3] = (uint8_t)(ctx->state[i] >> 24);
+  }
+}
+
+void md5_to_hex(const uint8_t digest[MD5_DIGEST_SIZE], char hex[MD5_HEX_SIZE])
+{
+  static const char digits[] = "0123456789abcdef";
+
+  for (int i = 0; i < MD5_DIGEST_SIZE; i++)
+  {
+    hex[i * 2] = digits[digest[i] >> 4];
+    hex[i * 2 + 1] = digits[digest[i] & 0x0f];
+  }
+}
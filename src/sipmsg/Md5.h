@@ -0,0 +1,37 @@
+/*
+ * Md5.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _SIP_MD5_H_
+#define _SIP_MD5_H_
+//---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  MD5 message digest of RFC 1321, as needed by HTTP digest authentication of
+  RFC 2617. The context lives on the stack of the caller and input is hashed
+  in place, so digests of header spans are computed without building the
+  intermediate strings, i.e. "username:realm:password".
+ */
+
+#define MD5_DIGEST_SIZE 16
+#define MD5_HEX_SIZE    32
+
+typedef struct md5_ctx
+{
+  uint32_t state[4];
+  uint64_t count;        /**< number of bytes hashed so far */
+  uint8_t buffer[64];
+} md5_ctx_t;
+
+void md5_init(md5_ctx_t* ctx);
+void md5_update(md5_ctx_t* ctx, const void* data, size_t length);
+void md5_final(md5_ctx_t* ctx, uint8_t digest[MD5_DIGEST_SIZE]);
+
+/* writes 'digest' as 32 lower case hex digits, not null terminated */
+void md5_to_hex(const uint8_t digest[MD5_DIGEST_SIZE], char hex[MD5_HEX_SIZE]);
+
+//---------------------------------------------------------------------------
+#endif // _SIP_MD5_H_
@@ -29,7 +29,7 @@ void HandleReceivedMessage(SipMessage* msg, void* owner)
 }
 
 
-int on_message_begin(sip_parser* p) {
+static int on_message_begin(sip_parser* p) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -69,7 +69,21 @@ int on_message_begin(sip_parser* p) {
 	return 0;
 }
 
-int on_url(sip_parser* p, const char* at, size_t length) {
+static int on_method(sip_parser* p, const char* /*at*/, size_t length) {
+
+	SipMessage* sipmsg = (SipMessage*)p->currmsg;
+	/* the method starts the Request-Line, 'at' may not be in the parsed data
+	 * when it is split after the first char */
+	if (sipmsg->request_method.length == 0)
+	{
+		sipmsg->request_method.start = sipmsg->message_begin_pos;
+	}
+	sipmsg->request_method.length += length;
+
+	return 0;
+}
+
+static int on_url(sip_parser* p, const char* at, size_t length) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -119,7 +133,7 @@ int on_url(sip_parser* p, const char* at, size_t length) {
 	return 0;
 }
 
-int on_response_status(sip_parser* p, const char* buf, size_t len)
+static int on_response_status(sip_parser* p, const char* buf, size_t len)
 {
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -157,7 +171,7 @@ int on_response_status(sip_parser* p, const char* buf, size_t len)
 	return 0;
 }
 
-int on_header_field(sip_parser* p, const char* at, size_t length) {
+static int on_header_field(sip_parser* p, const char* at, size_t length) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -236,7 +250,7 @@ int on_header_field(sip_parser* p, const char* at, size_t length) {
 	return 0;
 }
 
-int on_header_value(sip_parser* p, const char* at, size_t length) {
+static int on_header_value(sip_parser* p, const char* at, size_t length) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -299,6 +313,10 @@ int on_header_value(sip_parser* p, const char* at, size_t length) {
 		currpos->valuepos.length += tlength;
 	}
 	currpos->valuepos.length += length;
+	if (p->flags & F_FOLDED)
+	{
+		sipmsg->folded.set(sipmsg->num_headers - 1);
+	}
 
 	sipmsg->last_header_element = VALUE;
 
@@ -309,7 +327,7 @@ int on_header_value(sip_parser* p, const char* at, size_t length) {
 	return 0;
 }
 
-int on_headers_complete(sip_parser* p) {
+static int on_headers_complete(sip_parser* p) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -351,7 +369,7 @@ int on_headers_complete(sip_parser* p) {
 	return 0;
 }
 
-int on_message_complete(sip_parser* p) {
+static int on_message_complete(sip_parser* p) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -383,6 +401,20 @@ int on_message_complete(sip_parser* p) {
 	/* Possibly we have a new mesage appended to this message. We need
 		 re-initialize the parser for some points */
 	p->type = SIP_BOTH;
+
+	MessageProcessor* msgproc = reinterpret_cast<MessageProcessor*>(p->data);
+	if (msgproc)
+	{
+		/* parsing stops here and MessageReceived() hands the message over after
+		   sip_parser_execute() returns, as the callback may delete it while its
+		   'v1' is the data being parsed. The rest of the data is parsed into a
+		   new message by MessageReceived() */
+		msgproc->current_message = sipmsg;
+		p->currmsg = NULL;
+		sip_parser_pause(p, 1);
+		return 0;
+	}
+
 	const char* new_data = (*p->position) + 1;
 	if (new_data < p->parsing_data + p->parsing_len)
 	{
@@ -410,7 +442,7 @@ int on_message_complete(sip_parser* p) {
 	return 0;
 }
 
-int on_body(sip_parser* p, const char* at, size_t length) {
+static int on_body(sip_parser* p, const char* at, size_t length) {
 
 #ifdef SIP_DETAILED_DEBUG
 	std::ostringstream buff;
@@ -459,27 +491,91 @@ int on_body(sip_parser* p, const char* at, size_t length) {
 }
 
 
+/* bits of MessageProcessor::crlf_state */
+#define CRLF_FIRST 1  /* the first CRLF of a ping is received */
+#define CRLF_PONG  2  /* and counted as a pong until the second one comes */
+
+long MessageProcessor::KeepAliveReceived(const unsigned char* data, long size, uint64_t now)
+{
+	long i;
+
+	for (i = 0; i < size && (data[i] == '\r' || data[i] == '\n'); i++)
+	{
+		if (data[i] != '\n')
+		{
+			continue;
+		}
+		if (!(this->crlf_state & CRLF_FIRST))
+		{
+			this->crlf_state = CRLF_FIRST;
+			continue;
+		}
+		/* the pong was the first half of this ping, split over the reads */
+		if (this->crlf_state & CRLF_PONG)
+		{
+			this->keepalive.pongs--;
+		}
+		this->crlf_state = 0;
+		this->keepalive.pings++;
+		if (this->queue_pongs)
+		{
+			this->pending_pongs++;
+		}
+	}
+	if (i > 0)
+	{
+		this->keepalive.last_keepalive = now;
+		if (this->crlf_state == CRLF_FIRST)
+		{
+			this->keepalive.pongs++;
+			this->crlf_state |= CRLF_PONG;
+		}
+	}
+	if (i < size)
+	{
+		/* a message starts */
+		this->crlf_state = 0;
+	}
+	return i;
+}
+
 /* returns number of bystes processed */
 int MessageProcessor::MessageReceived(unsigned char* msg, long msgsize)
+{
+	return MessageReceived(msg, msgsize, 0);
+}
+
+int MessageProcessor::MessageReceived(unsigned char* msg, long msgsize, uint64_t now)
 {
 	SipMessage* currmsg = NULL;
 	uint32_t new_datapos = 0;
+	long skipped = 0;
 
 	if (msgsize <= 0)
 	{
 		return 0;
 	}
 
+	/* keep-alives are only between messages */
+	if (this->parser == NULL || this->parser->currmsg == NULL)
+	{
+		skipped = KeepAliveReceived(msg, msgsize, now);
+		if (skipped == msgsize)
+		{
+			return (int)msgsize;
+		}
+		msg += skipped;
+		msgsize -= skipped;
+	}
+	this->keepalive.last_message = now;
+
 	std::cout << "MessageReceived: Received message part with length " << msgsize << std::endl;
 	printf("Message:\n %.*s \n", msgsize, msg);
 	if (this->parser == NULL)
 	{
 		/* everything just starts */
 		std::cout << "MessageReceived: Creating the parser...\n";
-		this->parser = new sip_parser;
-		//this->parser->data = NULL;
-		this->parser->data = (void*)this;
-		sip_parser_init(this->parser, SIP_BOTH);
+		CreateParser();
 		currmsg = new SipMessage();
 		this->parser->currmsg = currmsg;
 		new_datapos = 0;
@@ -507,9 +603,35 @@ int MessageProcessor::MessageReceived(unsigned char* msg, long msgsize)
 	size_t prevsize = currmsg->v1.size();
 	currmsg->v1.resize(prevsize + msgsize);
 	memcpy(&currmsg->v1[prevsize], msg, msgsize);
+	/* positions of the callbacks are offsets in v1 */
+	currmsg->bias = (int)prevsize;
 
 	int nparsed = 0;
 	nparsed = sip_parser_execute(this->parser, &settings, &currmsg->v1[new_datapos], msgsize);
+	/* bytes of the messages completed in this read and of the keep-alives after them */
+	long completed_len = 0;
+	while (this->parser->sip_errno == SPE_PAUSED && this->current_message)
+	{
+		/* a message is completed, see on_message_complete() */
+		SipMessage* completed = this->current_message;
+		this->current_message = NULL;
+		sip_parser_pause(this->parser, 0);
+		HandleReceivedMessage(completed, this);
+
+		completed_len += nparsed;
+		/* CR/LFs after the message are keep-alives */
+		completed_len += KeepAliveReceived(msg + completed_len, msgsize - completed_len, now);
+		nparsed = 0;
+		if (completed_len == msgsize)
+		{
+			break;
+		}
+		currmsg = new SipMessage();
+		currmsg->v1.assign(msg + completed_len, msg + msgsize);
+		this->parser->currmsg = currmsg;
+		nparsed = sip_parser_execute(this->parser, &settings, &currmsg->v1[0], msgsize - completed_len);
+	}
+	nparsed += (int)completed_len;
 	if ((nparsed != msgsize) || (this->parser->sip_errno != SPE_OK))
 	{
 		std::cerr << "MessageReceived: Someting wrong with parsing, received msg-length="
@@ -519,24 +641,56 @@ int MessageProcessor::MessageReceived(unsigned char* msg, long msgsize)
 		this->parser->sip_errno = SPE_OK;
 		delete this->parser->currmsg;
 		this->parser->currmsg = NULL;
-		return nparsed;
+		return (int)skipped + nparsed;
 	}
-	/* Success path. Collect un-reported part of data message, if there are */
-	currmsg = (SipMessage*)this->parser->currmsg;
+	/* Success path. The message left incomplete, if there is, is continued
+	   with the next data, also by another MessageProcessor with MoveTo() */
+	std::cout << "MessageReceived: Processed of " << nparsed << " SIP message with length " << msgsize << std::endl;
 
-	if (currmsg)
+	return (int)skipped + nparsed;
+}
+
+void MessageProcessor::CreateParser(void)
+{
+	this->parser = new sip_parser;
+	this->parser->data = (void*)this;
+	sip_parser_init(this->parser, SIP_BOTH);
+	sip_parser_set_limits(this->parser, &this->limits);
+	this->parser->currmsg = NULL;
+}
+
+void MessageProcessor::MoveTo(MessageProcessor& other)
+{
+	if (this->parser != NULL)
 	{
-		currmsg->bias += msgsize;
-	}
-	std::cout << "MessageReceived: Processed of " << nparsed << " SIP message with length " << msgsize << std::endl;
+		sip_parser_state state;
+
+		sip_parser_snapshot(this->parser, &state);
+		if (other.parser == NULL)
+		{
+			other.CreateParser();
+		}
+		delete (SipMessage*)other.parser->currmsg;
+		sip_parser_restore(other.parser, &state);
+		other.parser->currmsg = this->parser->currmsg;
 
-	return nparsed;
+		this->parser->currmsg = NULL;
+		sip_parser_init(this->parser, SIP_BOTH);
+		sip_parser_set_limits(this->parser, &this->limits);
+	}
+	other.keepalive = this->keepalive;
+	other.pending_pongs = this->pending_pongs;
+	other.crlf_state = this->crlf_state;
+	this->keepalive = keepalive_stats_t();
+	this->pending_pongs = 0;
+	this->crlf_state = 0;
 }
 
 void MessageProcessor::Initialize(void)
 {
 	memset(&this->settings, 0, sizeof(settings));
 	this->settings.on_message_begin = on_message_begin;
+	this->settings.on_method = on_method;
 	this->settings.on_url = on_url;
 	this->settings.on_status = on_response_status;
 	this->settings.on_header_field = on_header_field;
@@ -544,4 +698,7 @@ void MessageProcessor::Initialize(void)
 	this->settings.on_headers_complete = on_headers_complete;
 	this->settings.on_body = on_body;
 	this->settings.on_message_complete = on_message_complete;
+
+	sip_parser_limits_init(&this->limits);
+	this->limits.max_headers = MAX_NUM_HEADERS;
 }
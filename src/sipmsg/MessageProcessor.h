@@ -27,17 +27,32 @@
    cases too. Keep simple at the moment to report complete messages. */
 typedef int (*msgproc_cb) (SipMessage*);
 
+/* RFC 5626 keep-alives received on the connection between messages: a double
+   CRLF is a ping, a single CRLF a pong. A CRLF followed by another one in the
+   next read is taken as a ping split over the reads, not as two pongs. The
+   times are the 'now' given to MessageReceived(), in the units of the clock
+   of the caller, 0 without it */
+typedef struct keepalive_stats
+{
+  uint64_t pings;
+  uint64_t pongs;
+  uint64_t last_keepalive;   /**< of the last ping or pong */
+  uint64_t last_message;     /**< of the last bytes of a message */
+} keepalive_stats_t;
+
 class MessageProcessor
 {
 public:
   MessageProcessor()
-    : parser(NULL), settings(), current_message(NULL), callback(NULL)
+    : parser(NULL), settings(), limits(), current_message(NULL), callback(NULL), keepalive(),
+      queue_pongs(false), pending_pongs(0), crlf_state(0)
   {
     Initialize();
   }
 
   MessageProcessor(msgproc_cb cb)
-    : parser(NULL), settings(), current_message(NULL), callback(cb)
+    : parser(NULL), settings(), limits(), current_message(NULL), callback(cb), keepalive(),
+      queue_pongs(false), pending_pongs(0), crlf_state(0)
   {
     Initialize();
   }
@@ -48,16 +63,58 @@ public:
 
   int MessageReceived(unsigned char* msg, long msgsize);
 
+  /* 'now' is kept in 'keepalive' for the liveness of the connection. CR/LFs
+     between messages are counted there without a parser, a SipMessage or a
+     log line, they do not reach sip_parser_execute() */
+  int MessageReceived(unsigned char* msg, long msgsize, uint64_t now);
+
+  /* Hands the connection over to 'other', e.g. of another worker thread, also
+     in the middle of a message: the parser state by sip_parser_snapshot() and
+     sip_parser_restore(), the incomplete SipMessage as it is, its positions
+     are offsets in its v1. 'other' is expected to be between messages, this
+     one is left as a new one */
+  void MoveTo(MessageProcessor& other);
+
+  /* Pongs to send for the pings received since the last call, a CRLF for
+     each, when 'queue_pongs' is set */
+  uint32_t TakePongs(void)
+  {
+    uint32_t count = this->pending_pongs;
+    this->pending_pongs = 0;
+    return count;
+  }
+
 //private:
   sip_parser* parser;
 
   sip_parser_settings settings;
 
+  /* of the parser, 'max_headers' is the size of the header index of SipMessage */
+  sip_parser_limits limits;
+
   /* To be used to save the last obtained SipMessage instance to report (or return) upper layer.
-     This approach will be modified later to use an event-driven mechanism. */
+     This approach will be modified later to use an event-driven mechanism.
+     The message completed in sip_parser_execute() is kept here until it returns, the
+     callback gets it after that, so it may take the message over and delete it */
   SipMessage* current_message;
 
   msgproc_cb callback;
+
+  keepalive_stats_t keepalive;
+
+  /* count a pong to send for each ping, see TakePongs() */
+  bool queue_pongs;
+
+private:
+  void CreateParser(void);
+
+  /* Counts the CR/LFs at the start of 'data', returns the count of them */
+  long KeepAliveReceived(const unsigned char* data, long size, uint64_t now);
+
+  uint32_t pending_pongs;
+
+  /* CRLF_* bits of the CR/LFs received since the last message or ping */
+  uint8_t crlf_state;
 };
 //---------------------------------------------------------------------------------------
 #endif // _MESSAGE_PROCESSOR_H_
@@ -0,0 +1,235 @@
+/*
+ * MessageSerializer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "MessageSerializer.h"
+
+#include <string.h>
+
+MessageSerializer::MessageSerializer(SipMessage* message)
+  : msg(message), msg_start(message->message_begin_pos), msg_end((uint32_t)message->v1.size()),
+    num_edits(0), delta(0), scratch_used(0)
+{
+  /* 'v1' may keep the beginning of next message in the stream */
+  if (message->message_complete_cb_called)
+  {
+    this->msg_end = message->message_complete_pos + 1;
+  }
+}
+
+int MessageSerializer::Replace(const str_pos_t& span, const char* data, uint32_t length)
+{
+  uint32_t i;
+
+  if (this->num_edits >= MAX_NUM_MSG_EDITS ||
+      span.start < this->msg_start || span.start + span.length > this->msg_end)
+  {
+    return 1;
+  }
+
+  /* insertions at the same position are kept in calling order and
+     placed before a replacement starting at that position */
+  for (i = this->num_edits; i > 0; i--)
+  {
+    const msg_edit_t& e = this->edits[i - 1];
+    if (e.span.start < span.start || (e.span.start == span.start && e.span.length == 0))
+    {
+      break;
+    }
+  }
+  if (i > 0 && this->edits[i - 1].span.start + this->edits[i - 1].span.length > span.start)
+  {
+    return 1;
+  }
+  if (i < this->num_edits && span.length > 0 && this->edits[i].span.start < span.start + span.length)
+  {
+    return 1;
+  }
+
+  memmove(&this->edits[i + 1], &this->edits[i], (this->num_edits - i) * sizeof(msg_edit_t));
+  this->edits[i].span = span;
+  this->edits[i].data = data;
+  this->edits[i].length = length;
+  this->num_edits++;
+  this->delta += (int32_t)length - (int32_t)span.length;
+
+  return 0;
+}
+
+int MessageSerializer::Insert(uint32_t pos, const char* data, uint32_t length)
+{
+  str_pos_t span = { pos, 0 };
+  return this->Replace(span, data, length);
+}
+
+int MessageSerializer::Remove(const str_pos_t& span)
+{
+  return this->Replace(span, NULL, 0);
+}
+
+str_pos_t MessageSerializer::GetHeaderLine(uint32_t index) const
+{
+  str_pos_t line = { 0, 0 };
+
+  if (index >= this->msg->num_headers)
+  {
+    return line;
+  }
+  const header_pos_t& hdr = this->msg->headers[index];
+  const char* data = &this->msg->v1[0];
+  uint32_t end = (hdr.valuepos.length > 0) ? hdr.valuepos.start + hdr.valuepos.length
+                                           : hdr.fieldpos.start + hdr.fieldpos.length;
+
+  /* value does not include trailing spaces and line end */
+  while (end < this->msg_end && data[end] != LF)
+  {
+    end++;
+  }
+  if (end < this->msg_end)
+  {
+    end++;
+  }
+  line.start = hdr.fieldpos.start;
+  line.length = end - hdr.fieldpos.start;
+
+  return line;
+}
+
+int MessageSerializer::InsertLineBefore(uint32_t index, const char* line, uint32_t length)
+{
+  if (index >= this->msg->num_headers)
+  {
+    return 1;
+  }
+  return this->Insert(this->msg->headers[index].fieldpos.start, line, length);
+}
+
+int MessageSerializer::RemoveHeader(uint32_t index)
+{
+  if (index >= this->msg->num_headers)
+  {
+    return 1;
+  }
+  return this->Remove(this->GetHeaderLine(index));
+}
+
+int MessageSerializer::ReplaceHeaderValue(uint32_t index, const char* value, uint32_t length)
+{
+  if (index >= this->msg->num_headers)
+  {
+    return 1;
+  }
+  return this->Replace(this->msg->headers[index].valuepos, value, length);
+}
+
+const char* MessageSerializer::CopyFragment(const char* data, uint32_t length)
+{
+  if (length > MSG_SCRATCH_SIZE - this->scratch_used)
+  {
+    return NULL;
+  }
+  char* copy = &this->scratch[this->scratch_used];
+  memcpy(copy, data, length);
+  this->scratch_used += length;
+
+  return copy;
+}
+
+int MessageSerializer::GetSegments(io_segment_t* segs, uint32_t maxsegs) const
+{
+  const char* data = &this->msg->v1[0];
+  uint32_t pos = this->msg_start;
+  uint32_t n = 0;
+
+  if (maxsegs < this->GetSegmentCount())
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < this->num_edits; i++)
+  {
+    const msg_edit_t& e = this->edits[i];
+    /* empty segments are skipped, i.e. consecutive edits */
+    if (e.span.start > pos)
+    {
+      segs[n].data = data + pos;
+      segs[n++].length = e.span.start - pos;
+    }
+    if (e.length > 0)
+    {
+      segs[n].data = e.data;
+      segs[n++].length = e.length;
+    }
+    pos = e.span.start + e.span.length;
+  }
+  if (this->msg_end > pos)
+  {
+    segs[n].data = data + pos;
+    segs[n++].length = this->msg_end - pos;
+  }
+  return (int)n;
+}
+
+#ifndef WIN32
+int MessageSerializer::GetSegments(struct iovec* iov, uint32_t maxiov) const
+{
+  const char* data = &this->msg->v1[0];
+  uint32_t pos = this->msg_start;
+  uint32_t n = 0;
+
+  if (maxiov < this->GetSegmentCount())
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < this->num_edits; i++)
+  {
+    const msg_edit_t& e = this->edits[i];
+    if (e.span.start > pos)
+    {
+      iov[n].iov_base = (void*)(data + pos);
+      iov[n++].iov_len = e.span.start - pos;
+    }
+    if (e.length > 0)
+    {
+      iov[n].iov_base = (void*)e.data;
+      iov[n++].iov_len = e.length;
+    }
+    pos = e.span.start + e.span.length;
+  }
+  if (this->msg_end > pos)
+  {
+    iov[n].iov_base = (void*)(data + pos);
+    iov[n++].iov_len = this->msg_end - pos;
+  }
+  return (int)n;
+}
+#endif
+
+int MessageSerializer::Flatten(char* out, uint32_t outlen) const
+{
+  const char* data = &this->msg->v1[0];
+  uint32_t pos = this->msg_start;
+  char* o = out;
+
+  if (this->GetLength() > outlen)
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < this->num_edits; i++)
+  {
+    const msg_edit_t& e = this->edits[i];
+    memcpy(o, data + pos, e.span.start - pos);
+    o += e.span.start - pos;
+    if (e.length > 0)
+    {
+      memcpy(o, e.data, e.length);
+      o += e.length;
+    }
+    pos = e.span.start + e.span.length;
+  }
+  memcpy(o, data + pos, this->msg_end - pos);
+  o += this->msg_end - pos;
+
+  return (int)(o - out);
+}
@@ -0,0 +1,112 @@
+/*
+ * MessageSerializer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _MESSAGE_SERIALIZER_H_
+#define _MESSAGE_SERIALIZER_H_
+//---------------------------------------------------------------------------
+#include "SipMessage.h"
+#include "SipHeader.h"
+
+#ifndef WIN32
+  #include <sys/uio.h>
+#endif
+
+/*
+  Outgoing path for a parsed SipMessage with small edits, i.e. a proxy pushing
+  or popping a Via, decrementing Max-Forwards or adding a Record-Route.
+
+  The outgoing message is kept as the original bytes of the message in 'v1'
+  with a sorted list of edits: each edit replaces a span of the original
+  (an insertion is an edit with an empty span). Output is either a segment
+  list, where unmodified parts point into 'v1' and are never copied, to be
+  passed to writev/sendmsg (WSASend), or a single flattened copy.
+
+  Edit data is not copied: it must stay valid until the output is consumed.
+  CopyFragment can be used for short-lived data, it keeps a copy in the
+  serializer's own scratch buffer.
+ */
+
+#define MAX_NUM_MSG_EDITS       32
+#define MSG_SCRATCH_SIZE        1024
+
+typedef struct io_segment
+{
+  const char* data;
+  uint32_t length;
+} io_segment_t;
+
+typedef struct msg_edit
+{
+  str_pos_t span;         /**< replaced part of the original message in 'v1' */
+  const char* data;       /**< new content */
+  uint32_t length;
+} msg_edit_t;
+
+class MessageSerializer
+{
+public:
+  MessageSerializer(SipMessage* message);
+
+  /* Replaces 'span' (position in 'v1') with 'data'. Returns 0 on success,
+     1 if the span is out of the message, overlaps with a previous edit or
+     there is no room for more edits */
+  int Replace(const str_pos_t& span, const char* data, uint32_t length);
+  int Insert(uint32_t pos, const char* data, uint32_t length);
+  int Remove(const str_pos_t& span);
+
+  /* Header level edits. 'index' is a position in SipMessage::headers, see
+     SipMessage::GetHeaderIndex. 'line' must be a complete header line,
+     CRLF included */
+  int InsertLineBefore(uint32_t index, const char* line, uint32_t length);
+  int RemoveHeader(uint32_t index);
+  int ReplaceHeaderValue(uint32_t index, const char* value, uint32_t length);
+
+  /* Span of the whole line of the header, folded lines and CRLF included */
+  str_pos_t GetHeaderLine(uint32_t index) const;
+
+  /* Keeps a copy of 'data' in serializer scratch buffer. NULL if it is full */
+  const char* CopyFragment(const char* data, uint32_t length);
+
+  /* Drops all edits */
+  void Reset() { num_edits = 0; delta = 0; scratch_used = 0; }
+
+  /* Span of the message in 'v1' */
+  uint32_t GetMessageStart() const { return msg_start; }
+  uint32_t GetMessageEnd() const { return msg_end; }
+
+  /* Length of the message after edits */
+  uint32_t GetLength() const { return (uint32_t)((int64_t)(msg_end - msg_start) + delta); }
+
+  /* Number of segments needed for output */
+  uint32_t GetSegmentCount() const { return 2 * num_edits + 1; }
+
+  /* Fills 'segs' with the outgoing message. Returns the number of segments,
+     -1 if 'maxsegs' is not enough */
+  int GetSegments(io_segment_t* segs, uint32_t maxsegs) const;
+#ifndef WIN32
+  int GetSegments(struct iovec* iov, uint32_t maxiov) const;
+#endif
+
+  /* Writes the outgoing message into 'out'. Returns the number of bytes
+     written, -1 if 'outlen' is not enough */
+  int Flatten(char* out, uint32_t outlen) const;
+
+  uint32_t GetEditCount() const { return num_edits; }
+
+private:
+  SipMessage* msg;
+  uint32_t msg_start;
+  uint32_t msg_end;
+
+  msg_edit_t edits[MAX_NUM_MSG_EDITS];  /**< sorted by span.start */
+  uint32_t num_edits;
+  int32_t delta;
+
+  char scratch[MSG_SCRATCH_SIZE];
+  uint32_t scratch_used;
+};
+
+//---------------------------------------------------------------------------
+#endif // _MESSAGE_SERIALIZER_H_
@@ -0,0 +1,125 @@
+/*
+ * ParamParser.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ParamParser.h"
+#include "SipHeader.h"
+#include "Utility.h"
+
+ParamId_t classify_param(const char* name, uint32_t length)
+{
+  /* length and first char reject most of the names without a comparison */
+  switch (length)
+  {
+    case 1:
+      return (LOWER(name[0]) == 'q') ? PARAM_Q : PARAM_OTHER;
+
+    case 2:
+      return (0 == _strnicmp_(name, "lr", 2)) ? PARAM_LR : PARAM_OTHER;
+
+    case 3:
+      if (LOWER(name[0]) == 't')
+      {
+        if (0 == _strnicmp_(name, "tag", 3))
+        {
+          return PARAM_TAG;
+        }
+        if (0 == _strnicmp_(name, "ttl", 3))
+        {
+          return PARAM_TTL;
+        }
+      }
+      break;
+
+    case 4:
+      return (0 == _strnicmp_(name, "user", 4)) ? PARAM_USER : PARAM_OTHER;
+
+    case 5:
+      if (LOWER(name[0]) == 'm')
+      {
+        return (0 == _strnicmp_(name, "maddr", 5)) ? PARAM_MADDR : PARAM_OTHER;
+      }
+      return (0 == _strnicmp_(name, "rport", 5)) ? PARAM_RPORT : PARAM_OTHER;
+
+    case 6:
+      if (LOWER(name[0]) == 'b')
+      {
+        return (0 == _strnicmp_(name, "branch", 6)) ? PARAM_BRANCH : PARAM_OTHER;
+      }
+      return (0 == _strnicmp_(name, "method", 6)) ? PARAM_METHOD : PARAM_OTHER;
+
+    case 7:
+      return (0 == _strnicmp_(name, "expires", 7)) ? PARAM_EXPIRES : PARAM_OTHER;
+
+    case 8:
+      return (0 == _strnicmp_(name, "received", 8)) ? PARAM_RECEIVED : PARAM_OTHER;
+
+    case 9:
+      return (0 == _strnicmp_(name, "transport", 9)) ? PARAM_TRANSPORT : PARAM_OTHER;
+  }
+  return PARAM_OTHER;
+}
+
+void fill_param_slots(param_slots_t* slots, const char* buf, const param_pos_t* params, uint32_t first, uint32_t num)
+{
+  for (uint32_t i = first; i < num; i++)
+  {
+    set_param_slot(slots, classify_param(buf + params[i].type.start, params[i].type.length), i);
+  }
+}
+
+int get_param_u32(const char* buf, const param_pos_t* param, ParamId_t id, uint32_t* value)
+{
+  if (param == NULL || param->value.length == 0)
+  {
+    return 1;
+  }
+  const char* p = buf + param->value.start;
+  const char* end = p + param->value.length;
+  uint32_t result = 0;
+
+  if (id == PARAM_Q)
+  {
+    /* qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] ) */
+    if (*p != '0' && *p != '1')
+    {
+      return 1;
+    }
+    result = (*p++ - '0') * 1000;
+    if (p < end)
+    {
+      uint32_t scale = 100;
+      if (*p++ != '.' || end - p > 3)
+      {
+        return 1;
+      }
+      for (; p < end; p++, scale /= 10)
+      {
+        if (!IS_DIGIT(*p))
+        {
+          return 1;
+        }
+        result += (*p - '0') * scale;
+      }
+    }
+    if (result > 1000)
+    {
+      return 1;
+    }
+    *value = result;
+    return 0;
+  }
+
+  for (; p < end; p++)
+  {
+    if (!IS_DIGIT(*p) || result > (0xFFFFFFFFU - (*p - '0')) / 10)
+    {
+      return 1;
+    }
+    result = result * 10 + (*p - '0');
+  }
+  *value = result;
+  return 0;
+}
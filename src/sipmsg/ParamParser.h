@@ -8,7 +8,73 @@
 #define _PARAM_PARSER_H_
 //---------------------------------------------------------------------------
 /* Implements the common behavior on parsing of SIP params included in headers. */
+#include "SipMessage.h"
 
+/*
+  Well-known parameter names are classified while parameters are parsed and
+  the position of each one in the parameter array is kept in a small table
+  indexed by its id. A lookup is then a single array access instead of a
+  string comparison over all parameters:
+
+    via-params   : ttl, maddr, received, branch, rport (RFC 3581)
+    from/to-param: tag
+    contact-params: q, expires
+    uri-parameters: transport, user, method, ttl, maddr, lr
+
+  Only the first occurrence of a parameter is kept in the table, as the
+  grammar does not allow it twice.
+ */
+
+typedef enum
+{
+  PARAM_TAG = 0,
+  PARAM_BRANCH,
+  PARAM_RECEIVED,
+  PARAM_RPORT,
+  PARAM_MADDR,
+  PARAM_TTL,
+  PARAM_TRANSPORT,
+  PARAM_USER,
+  PARAM_METHOD,
+  PARAM_LR,
+  PARAM_EXPIRES,
+  PARAM_Q,
+  MAX_NUM_PARAM_IDS,
+  PARAM_OTHER = MAX_NUM_PARAM_IDS
+} ParamId_t;
+
+/* 'index' keeps the position in the parameter array plus one, so a zero
+   initialized table is an empty one */
+typedef struct param_slots
+{
+  uint8_t index[MAX_NUM_PARAM_IDS];
+} param_slots_t;
+
+/* id of the parameter named 'name', PARAM_OTHER for any other name */
+ParamId_t classify_param(const char* name, uint32_t length);
+
+/* Classifies 'params[first]' .. 'params[num - 1]' of 'buf' into 'slots' */
+void fill_param_slots(param_slots_t* slots, const char* buf, const param_pos_t* params, uint32_t first, uint32_t num);
+
+inline void set_param_slot(param_slots_t* slots, ParamId_t id, uint32_t index)
+{
+  if (id != PARAM_OTHER && slots->index[id] == 0)
+  {
+    slots->index[id] = (uint8_t)(index + 1);
+  }
+}
+
+/* parameter 'id' in 'params', NULL if it does not exist */
+inline const param_pos_t* get_param(const param_slots_t& slots, const param_pos_t* params, ParamId_t id)
+{
+  return (id < MAX_NUM_PARAM_IDS && slots.index[id]) ? &params[slots.index[id] - 1] : NULL;
+}
+
+/* Numeric value of a parameter: decimal digits for expires, ttl, rport, and
+   the qvalue multiplied by 1000 for q, i.e. "0.5" gives 500. Returns 0 on
+   success, 1 if the parameter does not exist, has no value or the value is
+   not a valid number */
+int get_param_u32(const char* buf, const param_pos_t* param, ParamId_t id, uint32_t* value);
 
 //---------------------------------------------------------------------------
-#endif // _PARAM_PARSER_H_
\ No newline at end of file
+#endif // _PARAM_PARSER_H_
@@ -0,0 +1,267 @@
+/*
+ * Prefilter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Prefilter.h"
+#include "SipHeader.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PREFILTER_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifndef ULLONG_MAX
+# define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
+#endif
+
+/* the ones of sip_parser_limits_init() */
+static const sip_parser_limits default_limits = {
+  SIP_MAX_HEADER_SIZE, (uint32_t)-1, (uint32_t)-1, ULLONG_MAX
+};
+
+static inline uint32_t trailing_zeros(uint32_t word)
+{
+#if defined(__GNUC__)
+  return (uint32_t)__builtin_ctz(word);
+#elif defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, word);
+  return (uint32_t)idx;
+#else
+  uint32_t idx = 0;
+  while (!(word & 1))
+  {
+    word >>= 1;
+    idx++;
+  }
+  return idx;
+#endif
+}
+
+/* token chars of methods as sip_parser_execute() accepts them */
+static inline bool is_method_char(unsigned char ch)
+{
+  if (IS_ALPHANUM(ch))
+  {
+    return true;
+  }
+  switch (ch)
+  {
+    case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+':
+    case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+      return true;
+  }
+  return false;
+}
+
+#ifdef PREFILTER_SSE2
+/* one bit for each of the 16 bytes equal to 'ch' */
+#define EQ_MASK(v, ch) _mm_cmpeq_epi8((v), _mm_set1_epi8(ch))
+#endif
+
+/* Position of the first SP, CR or LF in [pos, end), 'end' if there is none */
+static uint32_t next_delimiter(const char* data, uint32_t pos, uint32_t end)
+{
+#ifdef PREFILTER_SSE2
+  for (; pos + 16 <= end; pos += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(
+      _mm_or_si128(_mm_or_si128(EQ_MASK(v, ' '), EQ_MASK(v, '\r')), EQ_MASK(v, '\n')));
+    if (mask != 0)
+    {
+      return pos + trailing_zeros(mask);
+    }
+  }
+#endif
+  for (; pos < end; pos++)
+  {
+    char ch = data[pos];
+    if (ch == ' ' || ch == CR || ch == LF)
+    {
+      return pos;
+    }
+  }
+  return end;
+}
+
+/* Position of the first LF in [pos, end) followed by CR or LF, i.e. the end of
+   the last line of the headers, 'end' if there is none */
+static uint32_t headers_end(const char* data, uint32_t pos, uint32_t end)
+{
+#ifdef PREFILTER_SSE2
+  /* the byte after each LF is at the same place of the load one byte later */
+  for (; pos + 17 <= end; pos += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)(data + pos));
+    __m128i next = _mm_loadu_si128((const __m128i*)(data + pos + 1));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(
+      _mm_and_si128(EQ_MASK(v, '\n'), _mm_or_si128(EQ_MASK(next, '\r'), EQ_MASK(next, '\n'))));
+    if (mask != 0)
+    {
+      return pos + trailing_zeros(mask);
+    }
+  }
+#endif
+  while (pos + 1 < end)
+  {
+    const char* lf = (const char*)memchr(data + pos, LF, end - pos - 1);
+    if (lf == NULL)
+    {
+      break;
+    }
+    pos = (uint32_t)(lf - data);
+    if (data[pos + 1] == CR || data[pos + 1] == LF)
+    {
+      return pos;
+    }
+    pos++;
+  }
+  return end;
+}
+
+enum sip_errno Prefilter::Check(const char* data, size_t length)
+{
+  const sip_parser_limits* lim = (this->limits != NULL) ? this->limits : &default_limits;
+  uint32_t len = (length > (uint32_t)-1) ? (uint32_t)-1 : (uint32_t)length;
+  /* bytes up to the end of headers are limited as with max_header_size */
+  uint32_t hend = (len > lim->max_header_size) ? lim->max_header_size : len;
+  uint32_t p = 0;
+  uint32_t mark;
+
+  this->type = SIP_BOTH;
+
+  /* the start line or the headers run up to 'hend' */
+#define PREFILTER_TRUNCATED() ((hend < len) ? SPE_HEADER_OVERFLOW : SPE_INVALID_EOF_STATE)
+
+  while (p < hend && (data[p] == CR || data[p] == LF))
+  {
+    p++;
+  }
+  if (p == len)
+  {
+    /* CRLF keep-alives and empty datagrams */
+    return SPE_OK;
+  }
+  if (p == hend)
+  {
+    return SPE_HEADER_OVERFLOW;
+  }
+
+  /* only "SIP/" starts a Status-Line, "SIGN sip:..." is a Request-Line */
+  if (hend - p >= 4 && memcmp(data + p, "SIP/", 4) == 0)
+  {
+    /* Status-Line = SIP-Version SP Status-Code SP Reason-Phrase CRLF */
+    if (p + 8 > hend)
+    {
+      return PREFILTER_TRUNCATED();
+    }
+    if (memcmp(data + p + 4, "2.0 ", 4) != 0)
+    {
+      return SPE_INVALID_VERSION;
+    }
+    p += 8;
+    while (p < hend && data[p] == ' ')
+    {
+      p++;
+    }
+    if (p + 4 > hend)
+    {
+      return PREFILTER_TRUNCATED();
+    }
+    if (!IS_DIGIT(data[p]) || !IS_DIGIT(data[p + 1]) || !IS_DIGIT(data[p + 2]) ||
+        (data[p + 3] != ' ' && data[p + 3] != CR && data[p + 3] != LF))
+    {
+      return SPE_INVALID_STATUS;
+    }
+    this->type = SIP_RESPONSE;
+    /* the Reason-Phrase is not looked at, its LF is found with the rest */
+    p += 3;
+  }
+  else
+  {
+    /* Request-Line = Method SP Request-URI SP SIP-Version CRLF */
+    mark = p;
+    while (p < hend && is_method_char((unsigned char)data[p]))
+    {
+      p++;
+    }
+    if (p == hend)
+    {
+      return PREFILTER_TRUNCATED();
+    }
+    if (p == mark || data[p] != ' ')
+    {
+      return SPE_INVALID_METHOD;
+    }
+    while (p < hend && data[p] == ' ')
+    {
+      p++;
+    }
+    mark = p;
+    p = next_delimiter(data, p, hend);
+    if (p == hend)
+    {
+      return PREFILTER_TRUNCATED();
+    }
+    if (data[p] != ' ')
+    {
+      return SPE_INVALID_URL;
+    }
+    if (p - mark > lim->max_url_length)
+    {
+      return SPE_URL_OVERFLOW;
+    }
+    while (p < hend && data[p] == ' ')
+    {
+      p++;
+    }
+    if (p + 8 > hend)
+    {
+      return PREFILTER_TRUNCATED();
+    }
+    if (memcmp(data + p, "SIP/", 4) != 0)
+    {
+      return SPE_INVALID_CONSTANT;
+    }
+    if (memcmp(data + p + 4, "2.0", 3) != 0)
+    {
+      return SPE_INVALID_VERSION;
+    }
+    p += 7;
+    if (data[p] == CR)
+    {
+      if (++p == hend)
+      {
+        return PREFILTER_TRUNCATED();
+      }
+      if (data[p] != LF)
+      {
+        return SPE_LF_EXPECTED;
+      }
+    }
+    else if (data[p] != LF)
+    {
+      return SPE_INVALID_VERSION;
+    }
+    this->type = SIP_REQUEST;
+  }
+
+  /* an empty line in the first max_header_size bytes */
+  if (headers_end(data, p, hend) == hend)
+  {
+    this->type = SIP_BOTH;
+    return PREFILTER_TRUNCATED();
+  }
+  return SPE_OK;
+
+#undef PREFILTER_TRUNCATED
+}
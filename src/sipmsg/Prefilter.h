@@ -0,0 +1,56 @@
+/*
+ * Prefilter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _PREFILTER_H_
+#define _PREFILTER_H_
+//---------------------------------------------------------------------------
+#include "sipparser.h"
+
+#include <stddef.h>
+
+/*
+  Cheap check of a received datagram before sip_parser_execute(), to drop
+  scanner floods and garbage without a full parse. It looks at the shape of
+  the start line, the "SIP/2.0" version, the Request-URI length and that the
+  empty line ending the headers is in the first max_header_size bytes, with
+  two SSE2 scans: one for the delimiters of the start line and one for the end
+  of the headers.
+
+      Prefilter prefilter;
+      if (prefilter.Check(data, length) != SPE_OK) ... drop, the reason is the return value
+      else sip_parser_init_datagram(&parser, prefilter.type) ...
+
+  The reasons are the sip_errno values the parser reports for the same
+  defect: SPE_INVALID_METHOD, SPE_INVALID_CONSTANT, SPE_INVALID_VERSION,
+  SPE_INVALID_STATUS, SPE_INVALID_URL (CR or LF in the Request-URI),
+  SPE_LF_EXPECTED, SPE_URL_OVERFLOW and SPE_HEADER_OVERFLOW, or
+  SPE_INVALID_EOF_STATE when the datagram ends before the headers do. It is
+  stricter than the parser: only SIP/2.0, 3-digit status codes and headers
+  ended by an LF followed by CR or LF pass, a lone CR the parser takes as a
+  line end when lenient does not. Passing does not mean the message is
+  well-formed; the headers and the body are left to the parser. A datagram of
+  only CR/LF passes as SIP_BOTH.
+ */
+
+class Prefilter
+{
+public:
+  Prefilter() : type(SIP_BOTH), limits(NULL) {}
+
+  enum sip_errno Check(const char* data, size_t length);
+
+  /* NULL for the defaults of sip_parser_limits_init() */
+  void SetLimits(const sip_parser_limits* limits) { this->limits = limits; }
+
+  /* SIP_REQUEST or SIP_RESPONSE by the start line of the last checked datagram,
+     SIP_BOTH when it did not pass or had no start line */
+  enum sip_parser_type type;
+
+private:
+  const sip_parser_limits* limits;
+};
+
+//---------------------------------------------------------------------------
+#endif // _PREFILTER_H_
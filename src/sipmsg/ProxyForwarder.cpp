@@ -0,0 +1,288 @@
+/*
+ * ProxyForwarder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ProxyForwarder.h"
+#include "MaxForwardsHeader.h"
+#include "RouteHeader.h"
+#include "ViaChain.h"
+#include "Utility.h"
+
+#include <string.h>
+
+#define VIA_MAGIC_COOKIE    "z9hG4bK"
+
+ProxyForwarder::ProxyForwarder(SipMessage* message, const proxy_identity_t& identity)
+  : msg(message), self(identity), serializer(message), located(false),
+    via_idx(-1), maxfwd_idx(-1), route_idx(-1), rroute_idx(-1)
+{
+  this->branch[0] = '\0';
+}
+
+static inline bool is_header(const char* name, uint32_t length, const char* lname, uint32_t llength, char sname)
+{
+  if (length == 1)
+  {
+    return sname && LOWER(name[0]) == sname;
+  }
+  return length == llength && 0 == _strnicmp_(name, lname, llength);
+}
+
+void ProxyForwarder::LocateHeaders()
+{
+  const char* data = &this->msg->v1[0];
+
+  for (uint32_t i = 0; i < this->msg->num_headers; i++)
+  {
+    const str_pos_t& field = this->msg->headers[i].fieldpos;
+    const char* name = data + field.start;
+
+    if (this->via_idx < 0 && is_header(name, field.length, "Via", 3, 'v'))
+    {
+      this->via_idx = (int)i;
+    }
+    else if (this->maxfwd_idx < 0 && is_header(name, field.length, "Max-Forwards", 12, 0))
+    {
+      this->maxfwd_idx = (int)i;
+    }
+    else if (this->route_idx < 0 && is_header(name, field.length, "Route", 5, 0))
+    {
+      this->route_idx = (int)i;
+    }
+    else if (this->rroute_idx < 0 && is_header(name, field.length, "Record-Route", 12, 0))
+    {
+      this->rroute_idx = (int)i;
+    }
+  }
+  this->located = true;
+}
+
+/* appends 'length' bytes of 'src' at 'pos' of 'buf', keeping room for the terminating nul */
+static inline uint32_t append(char* buf, uint32_t pos, const char* src, uint32_t length)
+{
+  if (pos + length >= MAX_FWD_LINE_SIZE)
+  {
+    length = MAX_FWD_LINE_SIZE - 1 - pos;
+  }
+  memcpy(buf + pos, src, length);
+  return pos + length;
+}
+
+static inline uint32_t append_uint(char* buf, uint32_t pos, uint32_t value)
+{
+  char digits[10];
+  uint32_t n = 0;
+
+  do
+  {
+    digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  return append(buf, pos, digits + sizeof(digits) - n, n);
+}
+
+int ProxyForwarder::PopRoute()
+{
+  const char* data = &this->msg->v1[0];
+
+  if (!this->located)
+  {
+    this->LocateHeaders();
+  }
+  if (this->route_idx < 0)
+  {
+    return 1;
+  }
+
+  /* only the top route is parsed, others are kept as they are */
+  const str_pos_t& value = this->msg->headers[this->route_idx].valuepos;
+  RouteHeader route;
+  route.ParseTop(data, value.start, value.start + value.length);
+  if (route.parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    return 1;
+  }
+  const route_hop_t& hop = route.GetHop();
+  uint32_t port = hop.port ? hop.port : 5060;
+  if (hop.host.length != strlen(this->self.host) ||
+      0 != _strnicmp_(data + hop.host.start, this->self.host, hop.host.length) ||
+      port != this->self.port)
+  {
+    return 1;
+  }
+
+  if (route.rest.length == 0)
+  {
+    return this->serializer.RemoveHeader((uint32_t)this->route_idx) ? FWD_SERVER_ERROR : 0;
+  }
+  /* another route value follows the comma */
+  str_pos_t first = { value.start, route.rest.start - value.start };
+  return this->serializer.Remove(first) ? FWD_SERVER_ERROR : 0;
+}
+
+int ProxyForwarder::DecrementMaxForwards()
+{
+  if (!this->located)
+  {
+    this->LocateHeaders();
+  }
+  if (this->maxfwd_idx < 0)
+  {
+    /* RFC 3261 16.6 step 3: added with 70 when missing */
+    static const char line[] = "Max-Forwards: 70\r\n";
+    int idx = (this->via_idx >= 0) ? this->via_idx : 0;
+    if (this->msg->num_headers == 0)
+    {
+      return FWD_BAD_REQUEST;
+    }
+    return this->serializer.InsertLineBefore((uint32_t)idx, line, sizeof(line) - 1) ? FWD_SERVER_ERROR : 0;
+  }
+
+  const str_pos_t& value = this->msg->headers[this->maxfwd_idx].valuepos;
+  MaxForwardsHeader maxfwd;
+  maxfwd.ParseHeader(&this->msg->v1[0], value.start, value.start + value.length);
+  if (maxfwd.parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    return FWD_BAD_REQUEST;
+  }
+  if (maxfwd.GetMaxForwards() == 0)
+  {
+    return FWD_TOO_MANY_HOPS;
+  }
+
+  uint32_t n = append_uint(this->maxfwd_value, 0, maxfwd.GetMaxForwards() - 1);
+  return this->serializer.Replace(maxfwd.GetNumberPos(), this->maxfwd_value, n) ? FWD_SERVER_ERROR : 0;
+}
+
+int ProxyForwarder::AddRecordRoute()
+{
+  static const char prefix[] = "Record-Route: <sip:";
+  uint32_t n = 0;
+  int idx;
+
+  if (!this->located)
+  {
+    this->LocateHeaders();
+  }
+  /* the new entry goes on top of existing ones */
+  idx = (this->rroute_idx >= 0) ? this->rroute_idx : this->via_idx;
+  if (idx < 0)
+  {
+    return FWD_BAD_REQUEST;
+  }
+
+  n = append(this->rr_line, n, prefix, sizeof(prefix) - 1);
+  n = append(this->rr_line, n, this->self.host, (uint32_t)strlen(this->self.host));
+  n = append(this->rr_line, n, ":", 1);
+  n = append_uint(this->rr_line, n, this->self.port);
+  if (0 != _strnicmp_(this->self.transport, "UDP", 4))
+  {
+    n = append(this->rr_line, n, ";transport=", 11);
+    for (const char* t = this->self.transport; *t && n < MAX_FWD_LINE_SIZE - 1; t++)
+    {
+      this->rr_line[n++] = (char)LOWER(*t);
+    }
+  }
+  n = append(this->rr_line, n, ";lr>\r\n", 6);
+
+  return this->serializer.InsertLineBefore((uint32_t)idx, this->rr_line, n) ? FWD_SERVER_ERROR : 0;
+}
+
+int ProxyForwarder::PushVia()
+{
+  static const char prefix[] = "Via: SIP/2.0/";
+  static const char hexchars[] = "0123456789abcdef";
+  const char* data = &this->msg->v1[0];
+  uint64_t hash = 14695981039346656037ULL;
+  uint32_t n = 0;
+
+  if (!this->located)
+  {
+    this->LocateHeaders();
+  }
+  if (this->via_idx < 0)
+  {
+    return FWD_BAD_REQUEST;
+  }
+
+  /* RFC 3261 16.11: a stateless proxy derives the branch from the received
+     top Via and Request-URI so every retransmission gets the same one. Only
+     the top via-parm is taken, a CANCEL has just that one of the request
+     (RFC 3261 9.1). Own sent-by is included for a spiral through the same
+     top Via */
+  ViaChain chain(this->msg);
+  if (!chain.Next())
+  {
+    return FWD_BAD_REQUEST;
+  }
+  str_pos_t topvia = chain.GetHopValue();
+  while (topvia.length > 0 && IS_LWS(data[topvia.start + topvia.length - 1]))
+  {
+    topvia.length--;
+  }
+  const str_pos_t& ruri = this->msg->request_url;
+  for (uint32_t i = 0; i < topvia.length; i++)
+  {
+    hash = (hash ^ (unsigned char)data[topvia.start + i]) * 1099511628211ULL;
+  }
+  for (uint32_t i = 0; i < ruri.length; i++)
+  {
+    hash = (hash ^ (unsigned char)data[ruri.start + i]) * 1099511628211ULL;
+  }
+  for (const char* h = this->self.host; *h; h++)
+  {
+    hash = (hash ^ (unsigned char)*h) * 1099511628211ULL;
+  }
+  hash = (hash ^ this->self.port) * 1099511628211ULL;
+
+  memcpy(this->branch, VIA_MAGIC_COOKIE, sizeof(VIA_MAGIC_COOKIE) - 1);
+  for (int i = 0; i < 16; i++)
+  {
+    this->branch[sizeof(VIA_MAGIC_COOKIE) - 1 + i] = hexchars[(hash >> (60 - 4 * i)) & 0xF];
+  }
+  this->branch[sizeof(VIA_MAGIC_COOKIE) - 1 + 16] = '\0';
+
+  n = append(this->via_line, n, prefix, sizeof(prefix) - 1);
+  n = append(this->via_line, n, this->self.transport, (uint32_t)strlen(this->self.transport));
+  n = append(this->via_line, n, " ", 1);
+  n = append(this->via_line, n, this->self.host, (uint32_t)strlen(this->self.host));
+  n = append(this->via_line, n, ":", 1);
+  n = append_uint(this->via_line, n, this->self.port);
+  n = append(this->via_line, n, ";branch=", 8);
+  n = append(this->via_line, n, this->branch, sizeof(VIA_MAGIC_COOKIE) - 1 + 16);
+  n = append(this->via_line, n, "\r\n", 2);
+
+  return this->serializer.InsertLineBefore((uint32_t)this->via_idx, this->via_line, n) ? FWD_SERVER_ERROR : 0;
+}
+
+int ProxyForwarder::Forward(bool record_route)
+{
+  int result;
+
+  if (this->msg->request_url.length == 0)
+  {
+    return FWD_BAD_REQUEST;
+  }
+  this->LocateHeaders();
+  if (this->via_idx < 0)
+  {
+    return FWD_BAD_REQUEST;
+  }
+
+  if (this->PopRoute() == FWD_SERVER_ERROR)
+  {
+    return FWD_SERVER_ERROR;
+  }
+  if ((result = this->DecrementMaxForwards()) != 0)
+  {
+    return result;
+  }
+  if (record_route && (result = this->AddRecordRoute()) != 0)
+  {
+    return result;
+  }
+  return this->PushVia();
+}
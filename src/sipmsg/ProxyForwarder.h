@@ -0,0 +1,86 @@
+/*
+ * ProxyForwarder.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _PROXY_FORWARDER_H_
+#define _PROXY_FORWARDER_H_
+//---------------------------------------------------------------------------
+#include "MessageSerializer.h"
+
+/*
+  Stateless forwarding of a parsed request (RFC 3261 16.4, 16.6, 16.11) without
+  re-parsing or re-building the message:
+
+    - the top Route is popped if it points to this proxy
+    - Max-Forwards is decremented (added with 70 if missing), 483 when exhausted
+    - a Record-Route with this proxy's URI is added on request
+    - a new top Via is pushed with a branch generated from the top Via and the
+      Request-URI of the received request, so a retransmission (or the CANCEL
+      of an INVITE) gets the same branch as stateless proxies need
+
+  Only the touched header lines are written, everything else is sent from the
+  bytes of the received message through MessageSerializer.
+ */
+
+#define MAX_FORWARDS_DEFAULT      70
+#define MAX_FWD_LINE_SIZE         256
+
+/* Status codes returned by ProxyForwarder besides 0 */
+#define FWD_BAD_REQUEST           400
+#define FWD_TOO_MANY_HOPS         483
+#define FWD_SERVER_ERROR          500
+
+typedef struct proxy_identity
+{
+  const char* transport;      /**< "UDP", "TCP", ... of the pushed Via */
+  const char* host;           /**< sent-by host, also used for Record-Route */
+  uint16_t port;
+} proxy_identity_t;
+
+class ProxyForwarder
+{
+public:
+  ProxyForwarder(SipMessage* message, const proxy_identity_t& identity);
+
+  /* Applies all forwarding steps to the request. Returns 0 on success,
+     FWD_TOO_MANY_HOPS when Max-Forwards is 0, FWD_BAD_REQUEST if message is
+     not a request, has no Via or a malformed top Via or Max-Forwards and
+     FWD_SERVER_ERROR if the serializer is out of edits */
+  int Forward(bool record_route = false);
+
+  /* Single steps of Forward(), in the order Forward() applies them */
+  int PopRoute();             /* 0 if popped, 1 if top Route is not this proxy */
+  int DecrementMaxForwards();
+  int AddRecordRoute();
+  int PushVia();
+
+  /* Branch of the pushed Via, magic cookie included. Empty before PushVia() */
+  const char* GetBranch() const { return branch; }
+
+  /* Output of the forwarded message, see MessageSerializer */
+  const MessageSerializer& GetSerializer() const { return serializer; }
+  int Flatten(char* out, uint32_t outlen) const { return serializer.Flatten(out, outlen); }
+
+private:
+  /* finds the top Via, Max-Forwards, Route and Record-Route in a single pass */
+  void LocateHeaders();
+
+  SipMessage* msg;
+  const proxy_identity_t& self;
+  MessageSerializer serializer;
+
+  bool located;
+  int via_idx;
+  int maxfwd_idx;
+  int route_idx;
+  int rroute_idx;
+
+  char branch[32];
+  char maxfwd_value[24];
+  char via_line[MAX_FWD_LINE_SIZE];
+  char rr_line[MAX_FWD_LINE_SIZE];
+};
+
+//---------------------------------------------------------------------------
+#endif // _PROXY_FORWARDER_H_
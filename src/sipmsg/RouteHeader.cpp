@@ -0,0 +1,101 @@
+/*
+ * RouteHeader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RouteHeader.h"
+#include "Utility.h"
+
+#include <string.h>
+
+/* Parsing utility */
+const char* RouteHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  const char* p = GenericHeader::ParseHeader(buf, pos, buflen);
+  if (this->parsing_stat == PARSED_SUCCESSFULLY)
+  {
+    this->ParseHops();
+  }
+  return p;
+}
+
+const char* RouteHeader::ParseTop(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  const char* p = GenericHeader::ParseTop(buf, pos, buflen);
+  if (this->parsing_stat == PARSED_SUCCESSFULLY)
+  {
+    this->ParseHops();
+  }
+  return p;
+}
+
+void RouteHeader::ParseHops()
+{
+  const char* data = (const char*)this->rawdata._data;
+
+  for (uint32_t i = 0; i < this->num_elements; i++)
+  {
+    route_hop_t* hop = &this->hops[i];
+    const char* p = data + this->elements[i].value.start;
+    const char* end = p + this->elements[i].value.length;
+    const char* tmp;
+
+    *hop = route_hop_t();
+    /* scheme, then userinfo which may have ';' of user parameters but no '@'
+       before the headers part */
+    if ((tmp = (const char*)memchr(p, ':', end - p)) == NULL)
+    {
+      continue;
+    }
+    p = tmp + 1;
+    const char* hend = (const char*)memchr(p, '?', end - p);
+    if ((tmp = (const char*)memchr(p, '@', (hend ? hend : end) - p)) != NULL)
+    {
+      p = tmp + 1;
+    }
+
+    hop->host.start = p - data;
+    if (p < end && *p == '[')
+    {
+      while (p < end && *p++ != ']')
+        ;
+    }
+    else
+    {
+      while (p < end && *p != ':' && *p != ';' && *p != '?')
+      {
+        p++;
+      }
+    }
+    hop->host.length = (p - data) - hop->host.start;
+
+    if (p < end && *p == ':')
+    {
+      for (p++; p < end && IS_DIGIT(*p) && hop->port < 65536; p++)
+      {
+        hop->port = hop->port * 10 + (*p - '0');
+      }
+    }
+
+    /* uri-parameters up to the headers part, "lr" may have a value as
+       "lr=on" of some older implementations */
+    while (p < end && *p == ';')
+    {
+      const char* name = ++p;
+      while (p < end && *p != '=' && *p != ';' && *p != '?')
+      {
+        p++;
+      }
+      if (p - name == 2 && 0 == _strnicmp_(name, "lr", 2))
+      {
+        hop->lr = true;
+        break;
+      }
+      while (p < end && *p != ';' && *p != '?')
+      {
+        p++;
+      }
+    }
+  }
+}
@@ -0,0 +1,72 @@
+/*
+ * RouteHeader.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _ROUTE_HEADER_H_
+#define _ROUTE_HEADER_H_
+//---------------------------------------------------------------------------
+#include "GenericHeader.h"
+
+/*
+   Route          =  "Route" HCOLON route-param *(COMMA route-param)
+   route-param    =  name-addr *( SEMI rr-param )
+   Record-Route   =  "Record-Route" HCOLON rec-route *(COMMA rec-route)
+   rec-route      =  name-addr *( SEMI rr-param )
+   rr-param       =  generic-param
+
+   Examples:
+      Route: <sip:bigbox3.site3.atlanta.com;lr>,
+             <sip:server10.biloxi.com;lr>
+      Record-Route: <sip:server10.biloxi.com;lr>,
+             <sip:bigbox3.site3.atlanta.com;lr>
+
+   Each route-param is an element of GenericHeader with the URI in 'value'.
+   Forwarding needs only the host, port and lr parameter of the URI, so they
+   are picked out of it into 'hops' without parsing the URI as a whole.
+   ParseTop() parses only the top route, which is the one a proxy looks at:
+   the others are copied as they are when the header is modified.
+ */
+
+typedef struct route_hop
+{
+  str_pos_t host;        /**< brackets included for an IPv6 reference */
+  uint32_t port;         /**< 0 if the URI has no port */
+  bool lr;               /**< loose routing, RFC 3261 16.12 */
+} route_hop_t;
+
+class RouteHeader : public GenericHeader
+{
+public:
+  RouteHeader(GenericHeaderId_t headerId = GHDR_ROUTE)
+    : GenericHeader(headerId), hops()
+  {}
+
+  /* Parsing utility */
+  const char* ParseHeader(const char* buf, uint32_t pos, uint32_t buflen);
+  const char* ParseTop(const char* buf, uint32_t pos, uint32_t buflen);
+
+  /* host, port and lr flag of route 'index', valid for the parsed ones */
+  const route_hop_t& GetHop(uint32_t index = 0) const { return hops[index]; }
+  bool IsLooseRouting(uint32_t index = 0) const
+  {
+    return index < this->num_elements && this->hops[index].lr;
+  }
+
+  std::array<route_hop_t, MAX_NUM_HDR_ELEMENTS> hops;
+
+private:
+  /* fills 'hops' from the URIs of the parsed elements */
+  void ParseHops();
+};
+
+class RecordRouteHeader : public RouteHeader
+{
+public:
+  RecordRouteHeader()
+    : RouteHeader(GHDR_RECORD_ROUTE)
+  {}
+};
+
+//---------------------------------------------------------------------------
+#endif // _ROUTE_HEADER_H_
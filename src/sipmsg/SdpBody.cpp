@@ -0,0 +1,406 @@
+/*
+ * SdpBody.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SdpBody.h"
+
+#include <string.h>
+
+/* Collects the next SP separated field of a line value into 'field'.
+   Returns the position after the separator, or NULL if field is empty */
+static const char* sdp_next_field(const char* buf, const char* p, const char* end, str_pos_t* field)
+{
+  const char* mark = p;
+
+  while (p < end && *p != ' ')
+  {
+    p++;
+  }
+  if (p == mark)
+  {
+    return NULL;
+  }
+  field->start = (uint32_t)(mark - buf);
+  field->length = (uint32_t)(p - mark);
+
+  return (p < end) ? p + 1 : p;
+}
+
+/* Splits 'field' at the first 'sep' char: 'field' keeps the left part and
+   'right' gets the rest (empty if 'sep' does not exist) */
+static void sdp_split_field(const char* buf, str_pos_t* field, char sep, str_pos_t* right)
+{
+  const char* s = (const char*)memchr(buf + field->start, sep, field->length);
+
+  right->start = 0;
+  right->length = 0;
+  if (s != NULL)
+  {
+    right->start = (uint32_t)(s + 1 - buf);
+    right->length = field->length - (right->start - field->start);
+    field->length = (uint32_t)(s - (buf + field->start));
+  }
+}
+
+static inline bool sdp_span_equals(const char* buf, const str_pos_t& span, const char* str)
+{
+  size_t len = strlen(str);
+  return (span.length == len) && (0 == memcmp(buf + span.start, str, len));
+}
+
+/* o=<username> <sess-id> <sess-version> <nettype> <addrtype> <unicast-address> */
+ParsingStatus_t SdpBody::ParseOrigin(const char* buf, const str_pos_t& value)
+{
+  const char* p = buf + value.start;
+  const char* end = p + value.length;
+
+  if (((p = sdp_next_field(buf, p, end, &this->origin.username)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &this->origin.sess_id)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &this->origin.sess_version)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &this->origin.nettype)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &this->origin.addrtype)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &this->origin.address)) == NULL))
+  {
+    return PARSING_FAILED_UNEXPECTED_CHAR;
+  }
+
+  return PARSED_SUCCESSFULLY;
+}
+
+/* c=<nettype> <addrtype> <connection-address>[/<ttl>][/<number of addresses>] */
+ParsingStatus_t SdpBody::ParseConnection(const char* buf, const str_pos_t& value)
+{
+  const char* p = buf + value.start;
+  const char* end = p + value.length;
+
+  if (this->num_conns >= MAX_NUM_SDP_CONNS)
+  {
+    return PARSING_FAILED_MAX_RANGE;
+  }
+  sdp_conn_t* conn = &this->conns[this->num_conns];
+  if (((p = sdp_next_field(buf, p, end, &conn->nettype)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &conn->addrtype)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &conn->address)) == NULL))
+  {
+    return PARSING_FAILED_UNEXPECTED_CHAR;
+  }
+  sdp_split_field(buf, &conn->address, '/', &conn->ttl_num);
+  conn->media = (int)this->num_media - 1;
+
+  if (this->num_media == 0)
+  {
+    this->session_conns.num++;
+  }
+  else
+  {
+    this->media[this->num_media - 1].conns.num++;
+  }
+  this->num_conns++;
+
+  return PARSED_SUCCESSFULLY;
+}
+
+/* m=<media> <port>[/<number of ports>] <proto> <fmt> ... */
+ParsingStatus_t SdpBody::ParseMedia(const char* buf, const str_pos_t& value)
+{
+  const char* p = buf + value.start;
+  const char* end = p + value.length;
+
+  if (this->num_media >= MAX_NUM_SDP_MEDIA)
+  {
+    return PARSING_FAILED_MAX_RANGE;
+  }
+  sdp_media_desc_t* m = &this->media[this->num_media];
+  m->line = value;
+  if (((p = sdp_next_field(buf, p, end, &m->media)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &m->port)) == NULL) ||
+      ((p = sdp_next_field(buf, p, end, &m->proto)) == NULL) ||
+      (p >= end))
+  {
+    return PARSING_FAILED_UNEXPECTED_CHAR;
+  }
+  sdp_split_field(buf, &m->port, '/', &m->num_ports);
+  m->fmts.start = (uint32_t)(p - buf);
+  m->fmts.length = (uint32_t)(end - p);
+
+  m->conns.first = this->num_conns;
+  m->conns.num = 0;
+  m->attrs.first = this->num_attrs;
+  m->attrs.num = 0;
+  m->rtpmaps.first = this->num_rtpmaps;
+  m->rtpmaps.num = 0;
+  this->num_media++;
+
+  return PARSED_SUCCESSFULLY;
+}
+
+/* a=<attribute> | a=<attribute>:<value>
+   a=rtpmap:<payload type> <encoding name>/<clock rate>[/<encoding parameters>] */
+ParsingStatus_t SdpBody::ParseAttribute(const char* buf, const str_pos_t& value)
+{
+  if (this->num_attrs >= MAX_NUM_SDP_ATTRS)
+  {
+    return PARSING_FAILED_MAX_RANGE;
+  }
+  sdp_attr_t* attr = &this->attrs[this->num_attrs];
+  attr->name = value;
+  sdp_split_field(buf, &attr->name, ':', &attr->value);
+  if (attr->name.length == 0)
+  {
+    return PARSING_FAILED_UNEXPECTED_CHAR;
+  }
+  attr->media = (int)this->num_media - 1;
+
+  if (this->num_media > 0 && sdp_span_equals(buf, attr->name, "rtpmap"))
+  {
+    const char* p = buf + attr->value.start;
+    const char* end = p + attr->value.length;
+
+    if (this->num_rtpmaps >= MAX_NUM_SDP_RTPMAPS)
+    {
+      return PARSING_FAILED_MAX_RANGE;
+    }
+    sdp_rtpmap_t* rtpmap = &this->rtpmaps[this->num_rtpmaps];
+    if (((p = sdp_next_field(buf, p, end, &rtpmap->payload)) == NULL) ||
+        ((p = sdp_next_field(buf, p, end, &rtpmap->encoding)) == NULL))
+    {
+      return PARSING_FAILED_UNEXPECTED_CHAR;
+    }
+    /* clock rate is mandatory in RFC 4566 but some implementations omit it */
+    sdp_split_field(buf, &rtpmap->encoding, '/', &rtpmap->clockrate);
+    sdp_split_field(buf, &rtpmap->clockrate, '/', &rtpmap->encparams);
+    rtpmap->media = attr->media;
+    this->media[this->num_media - 1].rtpmaps.num++;
+    this->num_rtpmaps++;
+  }
+
+  if (this->num_media == 0)
+  {
+    this->session_attrs.num++;
+  }
+  else
+  {
+    this->media[this->num_media - 1].attrs.num++;
+  }
+  this->num_attrs++;
+
+  return PARSED_SUCCESSFULLY;
+}
+
+const char* SdpBody::ParseBody(const char* buf, uint32_t pos, uint32_t buflen)
+{
+  const char* p = buf + pos;
+  const char* end = buf + buflen;
+  ParsingStatus_t stat = PARSED_SUCCESSFULLY;
+
+  this->num_lines = this->num_media = this->num_conns = 0;
+  this->num_attrs = this->num_rtpmaps = 0;
+  this->session_conns = { 0, 0 };
+  this->session_attrs = { 0, 0 };
+
+  if (pos >= buflen)
+  {
+    this->parsing_stat = PARSING_FAILED_NO_DATA;
+    return buf;
+  }
+
+  this->rawdata._data = (unsigned char*)buf;
+  this->rawdata._length = (unsigned int)buflen;
+  this->rawdata._pos = (unsigned int)pos;
+
+  while (p < end)
+  {
+    /* skip line terminators: CRLF, LF or CR. Empty lines are ignored */
+    if (*p == CR || *p == LF)
+    {
+      p++;
+      continue;
+    }
+
+    if (!(*p >= 'a' && *p <= 'z') || (end - p < 2) || (p[1] != '='))
+    {
+      this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    /* v= is the first line of any session description */
+    if (this->num_lines == 0 && *p != 'v')
+    {
+      this->parsing_stat = PARSING_FAILED_STATE_DEAD;
+      return p;
+    }
+    if (this->num_lines >= MAX_NUM_SDP_LINES)
+    {
+      this->parsing_stat = PARSING_FAILED_MAX_RANGE;
+      return p;
+    }
+
+    const char* value = p + 2;
+    const char* eol = value;
+    while (eol < end && *eol != CR && *eol != LF)
+    {
+      eol++;
+    }
+
+    sdp_line_t* line = &this->lines[this->num_lines++];
+    line->type = *p;
+    line->value.start = (uint32_t)(value - buf);
+    line->value.length = (uint32_t)(eol - value);
+
+    switch (line->type)
+    {
+      case 'v':
+        this->version = line->value;
+        break;
+
+      case 'o':
+        stat = this->ParseOrigin(buf, line->value);
+        break;
+
+      case 's':
+        this->session_name = line->value;
+        break;
+
+      case 'c':
+        stat = this->ParseConnection(buf, line->value);
+        break;
+
+      case 'm':
+        stat = this->ParseMedia(buf, line->value);
+        break;
+
+      case 'a':
+        stat = this->ParseAttribute(buf, line->value);
+        break;
+
+      default:
+        /* other lines are reachable through 'lines' */
+        break;
+    }
+    if (stat != PARSED_SUCCESSFULLY)
+    {
+      this->parsing_stat = stat;
+      return value;
+    }
+    p = eol;
+  }
+
+  this->parsing_stat = (this->num_lines > 0) ? PARSED_SUCCESSFULLY : PARSING_FAILED_NO_DATA;
+  return p;
+}
+
+const char* SdpBody::ParseBody(SipMessage* msg)
+{
+  RawData body;
+
+  msg->GetBody(body);
+  return this->ParseBody((const char*)body._data, 0, body._length);
+}
+
+const sdp_conn_t* SdpBody::GetConnection(int media) const
+{
+  if (media >= 0 && (uint32_t)media < this->num_media && this->media[media].conns.num > 0)
+  {
+    return &this->conns[this->media[media].conns.first];
+  }
+  if (this->session_conns.num > 0)
+  {
+    return &this->conns[this->session_conns.first];
+  }
+  return NULL;
+}
+
+const sdp_attr_t* SdpBody::FindAttribute(const char* name, int media) const
+{
+  const sdp_range_t* range = &this->session_attrs;
+
+  if (media >= 0)
+  {
+    if ((uint32_t)media >= this->num_media)
+    {
+      return NULL;
+    }
+    range = &this->media[media].attrs;
+  }
+  for (uint32_t i = range->first; i < range->first + range->num; i++)
+  {
+    if (sdp_span_equals((const char*)this->rawdata._data, this->attrs[i].name, name))
+    {
+      return &this->attrs[i];
+    }
+  }
+  return NULL;
+}
+
+const sdp_rtpmap_t* SdpBody::FindRtpMap(const char* payload, int media) const
+{
+  if (media < 0 || (uint32_t)media >= this->num_media)
+  {
+    return NULL;
+  }
+  const sdp_range_t* range = &this->media[media].rtpmaps;
+  for (uint32_t i = range->first; i < range->first + range->num; i++)
+  {
+    if (sdp_span_equals((const char*)this->rawdata._data, this->rtpmaps[i].payload, payload))
+    {
+      return &this->rtpmaps[i];
+    }
+  }
+  return NULL;
+}
+
+const sdp_line_t* SdpBody::FindLine(char type, uint32_t index) const
+{
+  for (uint32_t i = 0; i < this->num_lines; i++)
+  {
+    if (this->lines[i].type == type && index-- == 0)
+    {
+      return &this->lines[i];
+    }
+  }
+  return NULL;
+}
+
+void SdpBody::PrintOut(std::ostringstream& buf)
+{
+  buf << "-------- SDP Body DUMP [parsing-stat=" << this->parsing_stat << "-" << SipHeader::GetParsingStatInText(this->parsing_stat) << "] ----------\n";
+  if (this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    buf << "---------------------------------------\n";
+    return;
+  }
+  buf << "version      : " << GetString(this->version) << std::endl;
+  buf << "origin       : " << GetString(this->origin.username) << " " << GetString(this->origin.sess_id) << " "
+      << GetString(this->origin.sess_version) << " " << GetString(this->origin.nettype) << " "
+      << GetString(this->origin.addrtype) << " " << GetString(this->origin.address) << std::endl;
+  buf << "session name : " << GetString(this->session_name) << std::endl;
+  for (uint32_t i = this->session_conns.first; i < this->session_conns.first + this->session_conns.num; i++)
+  {
+    buf << "connection   : " << GetString(this->conns[i].address) << std::endl;
+  }
+  for (uint32_t i = this->session_attrs.first; i < this->session_attrs.first + this->session_attrs.num; i++)
+  {
+    buf << "attribute    : " << GetString(this->attrs[i].name) << " [" << GetString(this->attrs[i].value) << "]" << std::endl;
+  }
+  for (uint32_t m = 0; m < this->num_media; m++)
+  {
+    const sdp_media_desc_t* md = &this->media[m];
+    buf << "media[" << m << "]     : " << GetString(md->media) << " port=" << GetString(md->port)
+        << " proto=" << GetString(md->proto) << " fmts=" << GetString(md->fmts) << std::endl;
+    for (uint32_t i = md->conns.first; i < md->conns.first + md->conns.num; i++)
+    {
+      buf << "  connection : " << GetString(this->conns[i].address) << std::endl;
+    }
+    for (uint32_t i = md->rtpmaps.first; i < md->rtpmaps.first + md->rtpmaps.num; i++)
+    {
+      buf << "  rtpmap     : " << GetString(this->rtpmaps[i].payload) << " " << GetString(this->rtpmaps[i].encoding)
+          << "/" << GetString(this->rtpmaps[i].clockrate) << std::endl;
+    }
+    for (uint32_t i = md->attrs.first; i < md->attrs.first + md->attrs.num; i++)
+    {
+      buf << "  attribute  : " << GetString(this->attrs[i].name) << " [" << GetString(this->attrs[i].value) << "]" << std::endl;
+    }
+  }
+  buf << "---------------------------------------\n";
+}
@@ -0,0 +1,185 @@
+/*
+ * SdpBody.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _SDP_BODY_H_
+#define _SDP_BODY_H_
+//---------------------------------------------------------------------------
+#include "SipHeader.h"
+#include "SipMessage.h"
+
+/*
+  Session description (RFC 4566) carried in the message-body. Parsing does not
+  copy anything: each element is kept as a span (str_pos_t) over the body bytes
+  and all elements are stored in fixed-size tables of the class instance, so a
+  stack instance parses a body without any heap allocation.
+
+  session-description = proto-version origin-field session-name-field
+                        information-field uri-field email-fields phone-fields
+                        connection-field bandwidth-fields time-fields
+                        key-field attribute-fields media-descriptions
+
+  origin-field     = %x6f "=" username SP sess-id SP sess-version SP
+                     nettype SP addrtype SP unicast-address CRLF
+  connection-field = [%x63 "=" nettype SP addrtype SP connection-address CRLF]
+  media-field      = %x6d "=" media SP port ["/" integer] SP proto
+                     1*(SP fmt) CRLF
+  attribute-fields = *(%x61 "=" attribute CRLF)
+  attribute        = (att-field ":" att-value) / att-field
+
+  a=rtpmap:<payload type> <encoding name>/<clock rate> [/<encoding parameters>]
+
+  Line endings CRLF, LF or CR are all accepted, as osipparser2 does.
+ */
+
+#define MAX_NUM_SDP_LINES     64
+#define MAX_NUM_SDP_MEDIA     8
+#define MAX_NUM_SDP_CONNS     16
+#define MAX_NUM_SDP_ATTRS     48
+#define MAX_NUM_SDP_RTPMAPS   32
+
+/* index of media description for session-level elements */
+#define SDP_SESSION_LEVEL     -1
+
+/* any "<type>=<value>" line of the body in the order they appear */
+typedef struct sdp_line
+{
+  char type;
+  str_pos_t value;
+} sdp_line_t;
+
+typedef struct sdp_origin
+{
+  str_pos_t username;
+  str_pos_t sess_id;
+  str_pos_t sess_version;
+  str_pos_t nettype;
+  str_pos_t addrtype;
+  str_pos_t address;
+} sdp_origin_t;
+
+typedef struct sdp_conn
+{
+  int media;              /**< SDP_SESSION_LEVEL or index of media */
+  str_pos_t nettype;
+  str_pos_t addrtype;
+  str_pos_t address;      /**< connection address without "/ttl/number" part */
+  str_pos_t ttl_num;      /**< optional "/ttl[/number]" part, without leading '/' */
+} sdp_conn_t;
+
+typedef struct sdp_attr
+{
+  int media;              /**< SDP_SESSION_LEVEL or index of media */
+  str_pos_t name;
+  str_pos_t value;        /**< empty for property attributes, i.e. a=sendonly */
+} sdp_attr_t;
+
+typedef struct sdp_rtpmap
+{
+  int media;
+  str_pos_t payload;
+  str_pos_t encoding;
+  str_pos_t clockrate;
+  str_pos_t encparams;
+} sdp_rtpmap_t;
+
+/* elements of a level are stored contiguously in the tables: a range is enough */
+typedef struct sdp_range
+{
+  uint32_t first;
+  uint32_t num;
+} sdp_range_t;
+
+typedef struct sdp_media_desc
+{
+  str_pos_t line;         /**< whole value of m= line */
+  str_pos_t media;
+  str_pos_t port;
+  str_pos_t num_ports;    /**< optional "/integer" part, without leading '/' */
+  str_pos_t proto;
+  str_pos_t fmts;         /**< format list, i.e. "0 3 4 5" */
+  sdp_range_t conns;
+  sdp_range_t attrs;
+  sdp_range_t rtpmaps;
+} sdp_media_desc_t;
+
+class SdpBody
+{
+public:
+  SdpBody()
+    : parsing_stat(NOT_PARSED_YET), version({ 0, 0 }), origin(), session_name({ 0, 0 }),
+      num_lines(0), num_media(0), num_conns(0), num_attrs(0), num_rtpmaps(0),
+      session_conns({ 0, 0 }), session_attrs({ 0, 0 }), rawdata()
+  {}
+
+  /* Parsing utility. Consider the body starts from 'pos' and ends at 'buflen'.
+     On return, 'parsing_stat' attribute of class instance reflects parsing status.
+     Function returns the current position which may indicate the position of
+     problem in case of failure */
+  const char* ParseBody(const char* buf, uint32_t pos, uint32_t buflen);
+
+  /* Parses the body of 'msg' in place */
+  const char* ParseBody(SipMessage* msg);
+
+  /* Effective connection of a media description: its first c= line, or the
+     session-level one when the media has none. NULL if there is no c= line */
+  const sdp_conn_t* GetConnection(int media = SDP_SESSION_LEVEL) const;
+
+  /* First attribute named 'name' at the given level, NULL if not found */
+  const sdp_attr_t* FindAttribute(const char* name, int media = SDP_SESSION_LEVEL) const;
+
+  /* rtpmap of 'payload' in the media description, NULL if not found */
+  const sdp_rtpmap_t* FindRtpMap(const char* payload, int media) const;
+
+  /* index'th line of 'type' in the body, NULL if not found */
+  const sdp_line_t* FindLine(char type, uint32_t index = 0) const;
+
+  /* Span helpers over the parsed body */
+  std::string GetString(const str_pos_t& span) const
+  {
+    return std::string((const char*)this->rawdata._data + span.start, span.length);
+  }
+  const char* GetData(const str_pos_t& span) const
+  {
+    return (const char*)this->rawdata._data + span.start;
+  }
+
+  /* Prints the content of body into 'buf' for debug purposes */
+  void PrintOut(std::ostringstream& buf);
+
+  ParsingStatus_t parsing_stat;
+
+  str_pos_t version;
+  sdp_origin_t origin;
+  str_pos_t session_name;
+
+  uint32_t num_lines;
+  uint32_t num_media;
+  uint32_t num_conns;
+  uint32_t num_attrs;
+  uint32_t num_rtpmaps;
+
+  sdp_range_t session_conns;
+  sdp_range_t session_attrs;
+
+  sdp_line_t lines[MAX_NUM_SDP_LINES];
+  sdp_media_desc_t media[MAX_NUM_SDP_MEDIA];
+  sdp_conn_t conns[MAX_NUM_SDP_CONNS];
+  sdp_attr_t attrs[MAX_NUM_SDP_ATTRS];
+  sdp_rtpmap_t rtpmaps[MAX_NUM_SDP_RTPMAPS];
+
+protected:
+  friend class SdpRewriter;
+
+  ParsingStatus_t ParseOrigin(const char* buf, const str_pos_t& value);
+  ParsingStatus_t ParseConnection(const char* buf, const str_pos_t& value);
+  ParsingStatus_t ParseMedia(const char* buf, const str_pos_t& value);
+  ParsingStatus_t ParseAttribute(const char* buf, const str_pos_t& value);
+
+  /* raw-data points the body in message bytes. Not owned */
+  RawData rawdata;
+};
+
+//---------------------------------------------------------------------------
+#endif // _SDP_BODY_H_
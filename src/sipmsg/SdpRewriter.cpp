@@ -0,0 +1,184 @@
+/*
+ * SdpRewriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SdpRewriter.h"
+
+#include <string.h>
+#include <stdio.h>
+
+sdp_patch_t* SdpRewriter::Insert(const str_pos_t& span, const char* data, uint32_t length)
+{
+  uint32_t i;
+
+  if (this->num_patches >= MAX_NUM_SDP_PATCHES ||
+      span.start < this->sdp.rawdata._pos ||
+      span.start + span.length > this->sdp.rawdata._length)
+  {
+    return NULL;
+  }
+
+  /* find the place of new span, previous one must end before it starts
+     and next one must start after it ends */
+  for (i = this->num_patches; i > 0; i--)
+  {
+    if (this->patches[i - 1].span.start < span.start)
+    {
+      break;
+    }
+  }
+  if ((i > 0 && this->patches[i - 1].span.start + this->patches[i - 1].span.length > span.start) ||
+      (i < this->num_patches && span.start + span.length > this->patches[i].span.start))
+  {
+    return NULL;
+  }
+  /* a zero length span at the same position is an insertion which is fine,
+     two replacements of the same span are not */
+  if (i < this->num_patches && this->patches[i].span.start == span.start &&
+      (span.length > 0 || this->patches[i].span.length == 0))
+  {
+    return NULL;
+  }
+
+  memmove(&this->patches[i + 1], &this->patches[i], (this->num_patches - i) * sizeof(sdp_patch_t));
+  this->num_patches++;
+  /* patches shifted: re-point the ones using their own storage */
+  for (uint32_t j = i + 1; j < this->num_patches; j++)
+  {
+    if (this->patches[j].data == this->patches[j - 1].num)
+    {
+      this->patches[j].data = this->patches[j].num;
+    }
+  }
+
+  sdp_patch_t* patch = &this->patches[i];
+  patch->span = span;
+  patch->data = data;
+  patch->length = length;
+  this->delta += (int32_t)length - (int32_t)span.length;
+
+  return patch;
+}
+
+int SdpRewriter::Replace(const str_pos_t& span, const char* data, uint32_t length)
+{
+  return (this->Insert(span, data, length) != NULL) ? 0 : 1;
+}
+
+int SdpRewriter::SetConnectionAddress(int media, const char* addr, uint32_t length)
+{
+  const sdp_range_t* range = &this->sdp.session_conns;
+
+  if (media >= 0)
+  {
+    if ((uint32_t)media >= this->sdp.num_media)
+    {
+      return 1;
+    }
+    range = &this->sdp.media[media].conns;
+  }
+  if (range->num == 0)
+  {
+    return 1;
+  }
+  for (uint32_t i = range->first; i < range->first + range->num; i++)
+  {
+    if (this->Replace(this->sdp.conns[i].address, addr, length))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int SdpRewriter::SetMediaPort(int media, uint16_t port)
+{
+  if (media < 0 || (uint32_t)media >= this->sdp.num_media)
+  {
+    return 1;
+  }
+  sdp_patch_t* patch = this->Insert(this->sdp.media[media].port, NULL, 0);
+  if (patch == NULL)
+  {
+    return 1;
+  }
+  patch->length = (uint32_t)snprintf(patch->num, sizeof(patch->num), "%u", (unsigned int)port);
+  patch->data = patch->num;
+  this->delta += (int32_t)patch->length;
+
+  return 0;
+}
+
+int SdpRewriter::WriteBody(char* out, uint32_t outlen) const
+{
+  const char* buf = (const char*)this->sdp.rawdata._data;
+  uint32_t pos = this->sdp.rawdata._pos;
+  char* o = out;
+
+  if (this->GetBodyLength() > outlen)
+  {
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < this->num_patches; i++)
+  {
+    const sdp_patch_t* patch = &this->patches[i];
+
+    memcpy(o, buf + pos, patch->span.start - pos);
+    o += patch->span.start - pos;
+    memcpy(o, patch->data, patch->length);
+    o += patch->length;
+    pos = patch->span.start + patch->span.length;
+  }
+  memcpy(o, buf + pos, this->sdp.rawdata._length - pos);
+  o += this->sdp.rawdata._length - pos;
+
+  return (int)(o - out);
+}
+
+int SdpRewriter::WriteMessage(SipMessage* msg, char* out, uint32_t outlen) const
+{
+  const char* data = &msg->v1[0];
+  uint32_t body_len = this->GetBodyLength();
+  uint32_t head_end = msg->msg_body.start;
+  uint32_t written = 0;
+  RawData clen;
+  char num[16];
+  int numlen;
+
+  /* the part before body: copied as is, except Content-Length value */
+  if (msg->GetHeaderValue((unsigned char*)"Content-Length", clen) == 0 && clen._data != NULL)
+  {
+    uint32_t clen_start = (uint32_t)((const char*)clen._data - data);
+    uint32_t clen_end = clen_start + clen._length;
+
+    numlen = snprintf(num, sizeof(num), "%u", body_len);
+    if ((uint64_t)head_end - clen._length + numlen + body_len > outlen)
+    {
+      return -1;
+    }
+    memcpy(out, data, clen_start);
+    memcpy(out + clen_start, num, numlen);
+    memcpy(out + clen_start + numlen, data + clen_end, head_end - clen_end);
+    written = head_end - clen._length + numlen;
+  }
+  else
+  {
+    /* no Content-Length, i.e. datagram: body is delimited by the packet */
+    if ((uint64_t)head_end + body_len > outlen)
+    {
+      return -1;
+    }
+    memcpy(out, data, head_end);
+    written = head_end;
+  }
+
+  int result = this->WriteBody(out + written, outlen - written);
+  if (result < 0)
+  {
+    return -1;
+  }
+  return (int)(written + result);
+}
@@ -0,0 +1,83 @@
+/*
+ * SdpRewriter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _SDP_REWRITER_H_
+#define _SDP_REWRITER_H_
+//---------------------------------------------------------------------------
+#include "SdpBody.h"
+
+/*
+  Targeted patching of a parsed session description, i.e. media anchoring
+  where only c= addresses and m= ports change. Replacements are collected as
+  spans of the original body and the new body is produced in a single pass
+  into a caller buffer, copying untouched bytes as they are. Nothing is
+  re-serialized and no heap allocation is done.
+
+  Replacement data is not copied (except the numeric values formatted by
+  SetMediaPort): it must stay valid until WriteBody/WriteMessage returns.
+ */
+
+#define MAX_NUM_SDP_PATCHES 32
+
+typedef struct sdp_patch
+{
+  str_pos_t span;         /**< replaced part of the original body */
+  const char* data;       /**< new content */
+  uint32_t length;
+  char num[8];            /**< storage for formatted numeric content */
+} sdp_patch_t;
+
+class SdpRewriter
+{
+public:
+  SdpRewriter(const SdpBody& body)
+    : sdp(body), num_patches(0), delta(0)
+  {}
+
+  /* Replaces the 'span' of the original body with 'data'.
+     Returns 0 on success, 1 if span overlaps with a previous replacement,
+     is out of the body or there is no room for more replacements */
+  int Replace(const str_pos_t& span, const char* data, uint32_t length);
+
+  /* Replaces the address of every c= line of the level, keeping the
+     nettype/addrtype and "/ttl" parts (SDP_SESSION_LEVEL for session c=) */
+  int SetConnectionAddress(int media, const char* addr, uint32_t length);
+
+  /* Replaces the port of the m= line of 'media' */
+  int SetMediaPort(int media, uint16_t port);
+
+  /* Drops all replacements */
+  void Reset() { num_patches = 0; delta = 0; }
+
+  /* Length of the body after replacements */
+  uint32_t GetBodyLength() const
+  {
+    return (uint32_t)((int64_t)(this->sdp.rawdata._length - this->sdp.rawdata._pos) + this->delta);
+  }
+
+  /* Writes the patched body into 'out'. Returns the number of bytes written,
+     -1 if 'outlen' is not enough */
+  int WriteBody(char* out, uint32_t outlen) const;
+
+  /* Writes the whole message with the patched body into 'out', Content-Length
+     value being updated. The body must have been parsed from 'msg' (see
+     SdpBody::ParseBody(SipMessage*)). Returns the number of bytes written,
+     -1 if 'outlen' is not enough */
+  int WriteMessage(SipMessage* msg, char* out, uint32_t outlen) const;
+
+  uint32_t GetPatchCount() const { return num_patches; }
+
+private:
+  /* inserts a replacement keeping the order, NULL on overlap or overflow */
+  sdp_patch_t* Insert(const str_pos_t& span, const char* data, uint32_t length);
+
+  const SdpBody& sdp;
+  sdp_patch_t patches[MAX_NUM_SDP_PATCHES];  /**< sorted by span.start */
+  uint32_t num_patches;
+  int32_t delta;
+};
+
+//---------------------------------------------------------------------------
+#endif // _SDP_REWRITER_H_
@@ -11,6 +11,7 @@
 #include "RawData.h"
 
 #include <sstream>      // std::ostringstream
+#include <stdint.h>
 
 #define CR                  '\r'
 #define LF                  '\n'
@@ -71,8 +72,9 @@ class SipHeader
 {
 public:
   SipHeader()
-    : parsing_stat(NOT_PARSED_YET), rawdata()
+    : parsing_stat(NOT_PARSED_YET), modified(false), rawdata()
   {}
+  virtual ~SipHeader() {}
 
   /* Parsing utility. Consider the value part of header starts from 'pos' with length 'buflen'.
      On return, 'parsing_stat' attribute of class instance reflects parsing status.
@@ -90,9 +92,39 @@ public:
   virtual int GetHeaderValue(std::string& value) = 0;
 
   /* provides the pointer to value part of the header in question.
-     No any additional copy applied. */
+     No any additional copy applied. Fails for a modified header, see
+     WriteHeaderValue() */
   virtual int GetHeaderValue(RawData& value) = 0;
 
+  /* Header parts are spans of the received value. The code changing them,
+     i.e. removing a parameter, marks the header as modified: value of an
+     unmodified header is served from the received bytes as is, only a
+     modified one is re-formatted from its parts */
+  void SetModified() { modified = true; }
+  bool IsModified() const { return modified; }
+
+  /* Writes the value into 'buf': the received bytes for an unmodified header,
+     re-formatted parts otherwise. Returns the length, -1 if 'buflen' is not
+     enough or the header is not parsed */
+  int WriteHeaderValue(char* buf, uint32_t buflen)
+  {
+    if (this->parsing_stat != PARSED_SUCCESSFULLY)
+    {
+      return -1;
+    }
+    if (!this->modified)
+    {
+      uint32_t length = this->rawdata._length - this->rawdata._pos;
+      if (length > buflen)
+      {
+        return -1;
+      }
+      memcpy(buf, this->rawdata._data + this->rawdata._pos, length);
+      return (int)length;
+    }
+    return this->FormatValue(buf, buflen);
+  }
+
   /* Prints the content of header into 'buf' for debug purposes */
   virtual void PrintOut(std::ostringstream& buf) = 0;
 
@@ -120,6 +152,53 @@ public:
   ParsingStatus_t parsing_stat;
 
 protected:
+  /* true if the received value can be served instead of re-formatting */
+  bool IsReceivedValueValid() const
+  {
+    return !this->modified && this->parsing_stat == PARSED_SUCCESSFULLY;
+  }
+
+  std::string GetReceivedValue() const
+  {
+    return std::string((const char*)this->rawdata._data + this->rawdata._pos, this->rawdata._length - this->rawdata._pos);
+  }
+
+  /* Re-formats the value from its parts into 'buf', see WriteHeaderValue().
+     Headers with subparts write directly, others go through GetHeaderValue() */
+  virtual int FormatValue(char* buf, uint32_t buflen)
+  {
+    std::string value;
+    if (this->GetHeaderValue(value) != 0 || value.length() > buflen)
+    {
+      return -1;
+    }
+    memcpy(buf, value.data(), value.length());
+    return (int)value.length();
+  }
+
+  /* helpers of FormatValue(). Return false if 'buf' is full */
+  bool AppendValue(char* buf, uint32_t buflen, uint32_t& pos, uint32_t start, uint32_t length) const
+  {
+    if (pos + length > buflen)
+    {
+      return false;
+    }
+    memcpy(buf + pos, this->rawdata._data + start, length);
+    pos += length;
+    return true;
+  }
+  bool AppendChar(char* buf, uint32_t buflen, uint32_t& pos, char ch) const
+  {
+    if (pos >= buflen)
+    {
+      return false;
+    }
+    buf[pos++] = ch;
+    return true;
+  }
+
+  bool modified;
+
   /* raw-data points the header position in message bytes. Actually, header class
      is not owner the raw-data, so should not clear it on destruction */
   RawData rawdata;
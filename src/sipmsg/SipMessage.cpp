@@ -7,6 +7,7 @@
 
 #include "SipMessage.h"
 #include "Utility.h"
+#include "SipHeader.h"
 
 #include <iostream>
 #include <sstream>
@@ -48,6 +49,78 @@ int SipMessage::GetRequestUrl(RawData& value)
   return 0;
 }
 
+int SipMessage::GetNormalizedValue(uint32_t index, RawData& value)
+{
+  if (index >= this->num_headers)
+  {
+    value._data = NULL;
+    value._length = 0;
+    return -1;
+  }
+  const str_pos_t& raw = this->headers[index].valuepos;
+  if (!this->folded[index])
+  {
+    value._data = (unsigned char*)(&this->v1[raw.start]);
+    value._length = raw.length;
+    return 0;
+  }
+
+  for (size_t i = 0; i < this->unfolded_values.size(); i++)
+  {
+    if (this->unfolded_values[i].index == index)
+    {
+      value._data = (unsigned char*)(&this->unfolded[this->unfolded_values[i].pos.start]);
+      value._length = this->unfolded_values[i].pos.length;
+      return 0;
+    }
+  }
+
+  if (this->unfolded.capacity() == 0)
+  {
+    /* a normalized value is not longer than the value */
+    size_t size = 0;
+    for (uint32_t i = 0; i < this->num_headers; i++)
+    {
+      if (this->folded[i])
+      {
+        size += this->headers[i].valuepos.length;
+      }
+    }
+    this->unfolded.reserve(size);
+  }
+
+  unfolded_value_t normalized;
+  normalized.index = index;
+  normalized.pos.start = (uint32_t)this->unfolded.size();
+  const char* p = &this->v1[raw.start];
+  const char* end = p + raw.length;
+  while (p < end)
+  {
+    char ch = *p++;
+    if (ch != CR && ch != LF)
+    {
+      this->unfolded.push_back(ch);
+      continue;
+    }
+    /* LWS = [*WSP CRLF] 1*WSP */
+    while (this->unfolded.size() > normalized.pos.start && IS_WSP(this->unfolded.back()))
+    {
+      this->unfolded.pop_back();
+    }
+    while (p < end && IS_LWS(*p))
+    {
+      p++;
+    }
+    this->unfolded.push_back(' ');
+  }
+  normalized.pos.length = (uint32_t)this->unfolded.size() - normalized.pos.start;
+  this->unfolded_values.push_back(normalized);
+
+  value._data = (unsigned char*)(this->unfolded.data() + normalized.pos.start);
+  value._length = normalized.pos.length;
+  return 0;
+}
+
 int SipMessage::GetHeaderCount(unsigned char* headerName)
 {
   return GetHeaderCount(headerName, strlen((const char*)headerName));
@@ -280,6 +353,41 @@ recheck:
   return result;
 }
 
+int SipMessage::GetHeaderIndex(const char* headerName, uint32_t idx)
+{
+  uint32_t hnmlen = (uint32_t)strlen(headerName);
+  const char* altName = NULL;
+  uint32_t altlen = 0;
+  char sname = 0;
+  uint32_t count = 0;
+
+  /* the other form of the name, if any */
+  if (hnmlen == 1)
+  {
+    altName = GetLongHeaderName(headerName[0]);
+    altlen = altName ? (uint32_t)strlen(altName) : 0;
+  }
+  else if ((sname = GetShortHeaderName(headerName)) != 0)
+  {
+    altName = &sname;
+    altlen = 1;
+  }
+
+  for (uint32_t i = 0; i < this->num_headers; i++)
+  {
+    const str_pos_t& field = this->headers[i].fieldpos;
+    if ((field.length == hnmlen && 0 == _strnicmp_(&this->v1[field.start], headerName, hnmlen)) ||
+        (altlen && field.length == altlen && 0 == _strnicmp_(&this->v1[field.start], altName, altlen)))
+    {
+      if (count++ == idx)
+      {
+        return (int)i;
+      }
+    }
+  }
+  return -1;
+}
+
 int SipMessage::GetHeaderValuesInList(unsigned char* headerName, std::list<std::string>& strlist)
 {
   return GetHeaderValuesInList(headerName, strlen((const char*)headerName), strlist);
@@ -496,7 +604,16 @@ void SipMessage::PrintOut(std::ostringstream &buf)
   if (this->type == SIP_REQUEST)
   {
     std::string rurl((const char*)rawdata + this->request_url.start, this->request_url.length);
-    buf << sip_method_str(this->method) << " "
+    /* the token as received, an extension method has no name of its own */
+    if (this->request_method.length > 0)
+    {
+      buf << std::string((const char*)rawdata + this->request_method.start, this->request_method.length);
+    }
+    else
+    {
+      buf << sip_method_str(this->method);
+    }
+    buf << " "
         << std::string((const char*)rawdata + this->request_url.start, this->request_url.length) << " "
         << "SIP/" << this->sip_major << "." << this->sip_minor << "\r\n";
   }
@@ -23,6 +23,7 @@
 #include <list>
 #include <vector>
 #include <array>
+#include <bitset>
 
 enum sip_element_status_t{ NONE = 0, FIELD, VALUE };
 
@@ -51,6 +52,13 @@ typedef struct param_pos
 } param_pos_t;
 
 
+/* a normalized value of SipMessage::GetNormalizedValue() */
+typedef struct unfolded_value
+{
+  uint32_t index;  /* of the header */
+  str_pos_t pos;   /* in SipMessage::unfolded */
+} unfolded_value_t;
+
 typedef std::list<param_pos_t*> SipParamPosList_t;
 #define MAX_NUM_PARAMS 32
 typedef std::array<param_pos_t, MAX_NUM_PARAMS> SipParamArray_t;
@@ -60,8 +68,8 @@ class SipMessage
 public:
   SipMessage()
     : builder(0), parser(0), type(SIP_BOTH), method(SIP_ACK), status_code(0),
-      response_status({0, 0}), request_path({0, 0}), request_url({0, 0}), msg_body({0, 0}),
-      num_headers(0), last_header_element(NONE), headers(), should_keep_alive(0),
+      response_status({0, 0}), request_path({0, 0}), request_method({0, 0}), request_url({0, 0}), msg_body({0, 0}),
+      num_headers(0), last_header_element(NONE), headers(), folded(), should_keep_alive(0),
       sip_major(0), sip_minor(0), bias(0), message_begin_cb_called(0), message_begin_pos(0),
       headers_complete_cb_called(0), headers_complete_pos(0), message_complete_cb_called(0),
       message_complete_pos(0), status_cb_called(0), message_complete_on_eof(0), body_is_final(0)
@@ -93,6 +101,17 @@ public:
   int GetHeaderValue(unsigned char* headerName, RawData& value, uint32_t idx=0);
   int GetHeaderValue(unsigned char* headerName, uint32_t hnmlen, RawData& value, uint32_t idx=0);
 
+  /* returns the index in 'headers' of the 'idx'th occurrence of "headerName", both
+     long-form and short-form names counted in message order. -1 if not found */
+  int GetHeaderIndex(const char* headerName, uint32_t idx=0);
+
+  /* provides the value of headers[index] with each obsolete line folding, i.e.
+     the LWS with a CRLF in it, replaced by a single SP (RFC 3261 7.3.1), so it
+     has no CR or LF. It points into v1 unless the header is folded, a folded
+     one is normalized at the first call into 'unfolded', it is expected after
+     the headers are complete. -1 if there is no such header */
+  int GetNormalizedValue(uint32_t index, RawData& value);
+
   /* Followings provide data from multiple headers in the message in a list.
      Does not distiguish multiple headers received in a header as seperated with comma (,) */
   int GetHeaderValuesInList(unsigned char* headerName, std::list<std::string>& strlist);
@@ -119,17 +138,27 @@ public:
   int status_code;
   str_pos_t response_status; 
   str_pos_t request_path;
+  str_pos_t request_method; /* the token, also of SIP_EXTENSION */
   str_pos_t request_url;
 
   str_pos_t msg_body;
   uint32_t num_headers;
   sip_element_status_t last_header_element;
   SipHeadersArray_t  headers;
+  /* headers of a value with an obsolete line folding, by F_FOLDED of the parser;
+     the values of the others have no CR or LF */
+  std::bitset<MAX_NUM_HEADERS> folded;
+  /* normalized values of the folded headers, reserved for all of them at the
+     first one so the values provided stay in place */
+  std::vector<char> unfolded;
+  std::vector<unfolded_value_t> unfolded_values;
   int should_keep_alive;
 
   unsigned short sip_major;
   unsigned short sip_minor;
 
+  /* offset in v1 of the data given to sip_parser_execute(), the positions of
+     the callbacks are relative to it while parsing and to v1 after that */
   int bias;
 
   int message_begin_cb_called;
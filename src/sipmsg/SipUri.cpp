@@ -7,6 +7,9 @@
 
 #include "SipUri.h"
 #include "SipHeader.h"  /* to access macros */
+#include "Utility.h"
+
+#include <new>
 
 /* General form of SIP URI:
    sip:user:password@host:port;uri-parameters?headers 
@@ -903,9 +906,6 @@ enum url_parsing_state
   , s_url_spaces_before_url
   , s_url_scheme
   , s_url_user_or_host_start
-  , s_url_user_or_host
-  , s_url_passwd_or_port_start
-  , s_url_passwd_or_port
   , s_url_host_start
   , s_url_host
   , s_url_host_v6_start
@@ -954,52 +954,11 @@ static enum url_parsing_state parse_url_char(enum url_parsing_state s, const cha
       }
       if (ch == ':') 
       {
+        /* userinfo and host are told apart by ParseUri() with the '@' */
         return s_url_user_or_host_start;
       }
       break;
 
-    case s_url_user_or_host_start:
-      if (IS_USERINFO_CHAR(ch))
-      {
-        return s_url_user_or_host;
-      }
-      break;
-
-    // NOTE: user may contain ';', host may not...
-    case s_url_user_or_host:
-      if (IS_USERINFO_CHAR(ch))
-      {
-        return s;
-      }
-      if (ch == ':')
-      {
-        return s_url_passwd_or_port_start;
-      }
-      if (ch == '@') 
-      {
-        return s_url_host_start;
-      }
-      break;
-
-    case s_url_passwd_or_port_start:
-      if (IS_PASSWORD_CHAR(ch))
-      {
-        return s_url_passwd_or_port;
-      }
-      break;
-
-    /* we collect according to password */
-    case s_url_passwd_or_port:
-      if (IS_PASSWORD_CHAR(ch))
-      {
-        return s;
-      }
-      if (ch == '@')
-      {
-        return s_url_host_start;
-      }
-      break;
-
     case s_url_host_start:
       if (ch == '[')
       {
@@ -1191,13 +1150,145 @@ static enum url_parsing_state parse_url_char(enum url_parsing_state s, const cha
   return s_url_dead;
 }
 
+UriArena::~UriArena()
+{
+  while (this->blocks)
+  {
+    arena_block* next = this->blocks->next;
+    delete[] (char*)this->blocks;
+    this->blocks = next;
+  }
+}
+
+void* UriArena::Allocate(uint32_t size)
+{
+  size = (size + 7) & ~7u;
+  if (this->used + size <= sizeof(this->storage))
+  {
+    void* area = (char*)this->storage + this->used;
+    this->used += size;
+    return area;
+  }
+  if (this->blocks == NULL || this->blocks->used + size > this->blocks->size)
+  {
+    uint32_t bsize = (size > URI_ARENA_BLOCK_SIZE) ? size : URI_ARENA_BLOCK_SIZE;
+    arena_block* block = (arena_block*)new (std::nothrow) char[sizeof(arena_block) + bsize];
+    if (block == NULL)
+    {
+      return NULL;
+    }
+    block->next = this->blocks;
+    block->used = 0;
+    block->size = bsize;
+    this->blocks = block;
+  }
+  void* area = (char*)(this->blocks + 1) + this->blocks->used;
+  this->blocks->used += size;
+  return area;
+}
+
+param_pos_t* SipUri::AddParam()
+{
+  if (this->uri.num_params < URI_INLINE_PARAMS)
+  {
+    return &this->uri.inlineParams[this->uri.num_params++];
+  }
+  if (this->uri.num_params >= MAX_NUM_PARAMS)
+  {
+    return NULL;
+  }
+  if (this->uri.spillParams == NULL)
+  {
+    uint32_t size = (MAX_NUM_PARAMS - URI_INLINE_PARAMS) * sizeof(param_pos_t);
+    this->uri.spillParams = (this->arena) ? (param_pos_t*)this->arena->Allocate(size)
+                                          : new (std::nothrow) param_pos_t[MAX_NUM_PARAMS - URI_INLINE_PARAMS];
+    if (this->uri.spillParams == NULL)
+    {
+      return NULL;
+    }
+    memset(this->uri.spillParams, 0, size);
+  }
+  return &this->uri.spillParams[this->uri.num_params++ - URI_INLINE_PARAMS];
+}
+
+header_pos_t* SipUri::AddHeader()
+{
+  if (this->uri.num_headers < URI_INLINE_HEADERS)
+  {
+    return &this->uri.inlineHeaders[this->uri.num_headers++];
+  }
+  if (this->uri.num_headers >= MAX_NUM_URI_HEADERS)
+  {
+    return NULL;
+  }
+  if (this->uri.spillHeaders == NULL)
+  {
+    uint32_t size = (MAX_NUM_URI_HEADERS - URI_INLINE_HEADERS) * sizeof(header_pos_t);
+    this->uri.spillHeaders = (this->arena) ? (header_pos_t*)this->arena->Allocate(size)
+                                           : new (std::nothrow) header_pos_t[MAX_NUM_URI_HEADERS - URI_INLINE_HEADERS];
+    if (this->uri.spillHeaders == NULL)
+    {
+      return NULL;
+    }
+    memset(this->uri.spillHeaders, 0, size);
+  }
+  return &this->uri.spillHeaders[this->uri.num_headers++ - URI_INLINE_HEADERS];
+}
+
+/* keeps the position of a completed parameter in the slots if it is one of
+   the well-known ones */
+void SipUri::SetWellKnownParam(const param_pos_t& param)
+{
+  ParamId_t id = classify_param((const char*)this->rawdata._data + param.type.start, param.type.length);
+
+  /* 'param' is always the last one added */
+  set_param_slot(&this->uri.slots, id, this->uri.num_params - 1);
+}
+
+/* collects user and password between 'p' and the '@' at 'at'. Returns the
+   position of '@', NULL if userinfo is malformed */
+const char* SipUri::ParseUserInfo(const char* buf, const char* p, const char* at)
+{
+  const char* user = p;
+
+  while (p < at && IS_USERINFO_CHAR(*p))
+  {
+    p++;
+  }
+  if (p == user)
+  {
+    return NULL;
+  }
+  this->uri.username.start = (uint32_t)(user - buf);
+  this->uri.username.length = (uint32_t)(p - user);
+  if (p == at)
+  {
+    return at;
+  }
+  if (*p != ':' || ++p == at)
+  {
+    return NULL;
+  }
+
+  const char* password = p;
+  while (p < at && IS_PASSWORD_CHAR(*p))
+  {
+    p++;
+  }
+  if (p != at)
+  {
+    return NULL;
+  }
+  this->uri.password.start = (uint32_t)(password - buf);
+  this->uri.password.length = (uint32_t)(at - password);
+  return at;
+}
+
 int SipUri::ParseUri(const char* buf, size_t pos, size_t buflen)
 {
   enum url_parsing_state s = s_url_spaces_before_url;
   enum url_parsing_state prev_s = s_url_spaces_before_url;
   const char* scheme_mark = NULL;
-  const char* user_or_host_mark = NULL;
-  const char* passwd_or_port_mark = NULL;
   const char* host_mark = NULL;
   const char* port_mark = NULL;
   const char* param_name_mark = NULL;
@@ -1208,8 +1299,6 @@ int SipUri::ParseUri(const char* buf, size_t pos, size_t buflen)
   param_pos_t* current_param = NULL;
   header_pos_t* current_header = NULL;
 
-  bool reparsing = false;
-
   const char* p;
 
   if (buflen == 0) 
@@ -1221,8 +1310,6 @@ int SipUri::ParseUri(const char* buf, size_t pos, size_t buflen)
   this->rawdata._length = buflen;
   this->rawdata._pos = pos;
 
-reparse:
-  //for (p = buf + pos; p < buf + pos + buflen; p++)
   for (p = buf + pos; p < buf + buflen; p++)
   {
     s = parse_url_char(s, *p);
@@ -1244,49 +1331,21 @@ reparse:
         {
           this->uri.scheme.start = (uint32_t)(scheme_mark - buf);
           this->uri.scheme.length = (uint32_t)(p - scheme_mark);
-          if (reparsing)
+          /* userinfo can only be told from host by its terminating '@', which
+             cannot appear unescaped elsewhere in a SIP URI. Looking it up once
+             lets both parts be collected in a single pass: without '@' there
+             is no userinfo and the host starts right after the scheme */
+          const char* at = (const char*)memchr(p + 1, '@', buf + buflen - p - 1);
+          if (at != NULL && (p = this->ParseUserInfo(buf, p + 1, at)) == NULL)
           {
-            s = s_url_host_start;
+            return 1;
           }
-        }
-        break;
-
-      case s_url_user_or_host:
-        if (prev_s == s_url_user_or_host_start)
-        {
-          user_or_host_mark = p;
-        }
-        break;
-
-      case s_url_passwd_or_port_start:
-        if (prev_s == s_url_user_or_host)
-        {
-          /* although it is not certain that we are collecting username and password,
-             for now we consider this */
-          this->uri.username.start = (uint32_t)(user_or_host_mark - buf);
-          this->uri.username.length = (uint32_t)(p - user_or_host_mark);
-        }
-        break;
-
-      case s_url_passwd_or_port:
-        if (prev_s == s_url_passwd_or_port_start)
-        {
-          passwd_or_port_mark = p;
+          s = s_url_host_start;
         }
         break;
 
       case s_url_host_start:
-        if (prev_s == s_url_user_or_host)
-        {
-          /* now it is certain that we have collected username */
-          this->uri.username.start = (uint32_t)(user_or_host_mark - buf);
-          this->uri.username.length = (uint32_t)(p - user_or_host_mark);
-        }
-        else if (prev_s == s_url_passwd_or_port)
-        {
-          this->uri.password.start = (uint32_t)(passwd_or_port_mark - buf);
-          this->uri.password.length = (uint32_t)(p - passwd_or_port_mark);
-        }
+        /* userinfo, if any, has been collected by ParseUserInfo() */
         break;
 
       case s_url_host:
@@ -1340,12 +1399,14 @@ reparse:
           /* a parameter with no value part is completed */
           current_param->type.start = param_name_mark - buf;
           current_param->type.length = p - param_name_mark;
+          this->SetWellKnownParam(*current_param);
         }
         else if (prev_s == s_url_param_value)
         {
           /* value part of a parameter is completed */
           current_param->value.start = param_value_mark - buf;
           current_param->value.length = p - param_value_mark;
+          this->SetWellKnownParam(*current_param);
         }
         break;
 
@@ -1353,7 +1414,10 @@ reparse:
         if (prev_s == s_url_param_start)
         {
           param_name_mark = p;
-          current_param = &this->uri.urlParams[this->uri.num_params++];
+          if ((current_param = this->AddParam()) == NULL)
+          {
+            return 1;
+          }
         }
         break;
 
@@ -1390,12 +1454,14 @@ reparse:
           /* a parameter with no value part is completed */
           current_param->type.start = param_name_mark - buf;
           current_param->type.length = p - param_name_mark;
+          this->SetWellKnownParam(*current_param);
         }
         else if (prev_s == s_url_param_value)
         {
           /* value part of a parameter is completed */
           current_param->value.start = param_value_mark - buf;
           current_param->value.length = p - param_value_mark;
+          this->SetWellKnownParam(*current_param);
         }
         else if (prev_s == s_url_header_value)
         {
@@ -1410,7 +1476,10 @@ reparse:
         {
           header_name_mark = p;
           /* starts a new header */
-          current_header = &this->uri.urlHeaders[this->uri.num_headers++];
+          if ((current_header = this->AddHeader()) == NULL)
+          {
+            return 1;
+          }
         }
         break;
 
@@ -1448,6 +1517,7 @@ reparse:
     /* consider value part of a parameter is completed */
     current_param->value.start = param_value_mark - buf;
     current_param->value.length = p - param_value_mark;
+    this->SetWellKnownParam(*current_param);
     return 0;
   }
   if (s == s_url_param_name)
@@ -1455,6 +1525,7 @@ reparse:
     /* consider a parameter with no value part is completed */
     current_param->type.start = param_name_mark - buf;
     current_param->type.length = p - param_name_mark;
+    this->SetWellKnownParam(*current_param);
     return 0;
   }
   if ((s == s_url_host) || (s == s_url_host_v6_end))
@@ -1469,20 +1540,233 @@ reparse:
     this->uri.port.length = p - port_mark;
     return 0;
   }
-  if (s == s_url_user_or_host)
+  /* completed in an inappropriate state */
+  return 1;
+}
+
+/* reserved = ";" / "/" / "?" / ":" / "@" / "&" / "=" / "+" / "$" / "," */
+#define IS_URI_RESERVED(c)  ((c) == ';' || (c) == '/' || (c) == '?' || (c) == ':' || \
+  (c) == '@' || (c) == '&' || (c) == '=' || (c) == '+' || (c) == '$' || (c) == ',')
+
+#define HEX_VALUE(c)        (IS_DIGIT(c) ? (c) - '0' : LOWER(c) - 'a' + 10)
+
+#define URI_HASH_INIT       14695981039346656037ULL
+#define URI_HASH_PRIME      1099511628211ULL
+
+/* Returns the comparison unit of a URI component at 'i' and moves 'i' after it.
+   "Characters other than those in the reserved set are equivalent to their
+   encoding": an escaped unreserved character is the character itself while an
+   escaped reserved one is kept distinct from the plain character */
+static inline int next_uri_unit(const char* s, uint32_t length, uint32_t& i, bool nocase)
+{
+  int c = (unsigned char)s[i++];
+
+  if (c == '%' && i + 2 <= length && IS_HEX(s[i]) && IS_HEX(s[i + 1]))
+  {
+    c = (HEX_VALUE(s[i]) << 4) | HEX_VALUE(s[i + 1]);
+    i += 2;
+    if (IS_URI_RESERVED(c))
+    {
+      return 0x100 | c;
+    }
+  }
+  if (nocase && c >= 'A' && c <= 'Z')
   {
-    /* This is the special case where there is no userinfo part of
-       the URI and start with host and others. We select the way 
-       re-invocation  with s_url_host */
-    s = s_url_host;
-    prev_s = s_url_host_start; /* to be able to set host_mark */
-    /* we have to skip scheme part */
-    pos += this->uri.scheme.length + 1; /* +1 is to skip ':' */
-    goto reparse;
+    c |= 0x20;
   }
+  return c;
+}
 
-  /* completed in an inappropriate state */
-  return 1;
+static bool uri_span_equals(const char* a, const str_pos_t& sa, const char* b, const str_pos_t& sb, bool nocase)
+{
+  uint32_t i = 0, j = 0;
+
+  a += sa.start;
+  b += sb.start;
+  if (sa.length == sb.length && 0 == memcmp(a, b, sa.length))
+  {
+    return true;
+  }
+  while (i < sa.length && j < sb.length)
+  {
+    if (next_uri_unit(a, sa.length, i, nocase) != next_uri_unit(b, sb.length, j, nocase))
+    {
+      return false;
+    }
+  }
+  return i == sa.length && j == sb.length;
+}
+
+static inline uint64_t uri_span_hash(uint64_t h, const char* s, const str_pos_t& span, bool nocase)
+{
+  uint32_t i = 0;
+
+  s += span.start;
+  while (i < span.length)
+  {
+    h = (h ^ (uint64_t)next_uri_unit(s, span.length, i, nocase)) * URI_HASH_PRIME;
+  }
+  /* separator between components, out of the unit range */
+  return (h ^ 0x200) * URI_HASH_PRIME;
+}
+
+static inline uint32_t uri_port_value(const char* s, const str_pos_t& port)
+{
+  uint32_t value = 0;
+
+  for (uint32_t i = 0; i < port.length; i++)
+  {
+    value = value * 10 + (s[port.start + i] - '0');
+  }
+  return value;
+}
+
+/* user, ttl, method, maddr and transport parameters never match when only in one URI */
+static bool is_strict_uri_param(const char* s, const str_pos_t& name)
+{
+  const char* n = s + name.start;
+
+  switch (name.length)
+  {
+    case 3: return 0 == _strnicmp_(n, "ttl", 3);
+    case 4: return 0 == _strnicmp_(n, "user", 4);
+    case 5: return 0 == _strnicmp_(n, "maddr", 5);
+    case 6: return 0 == _strnicmp_(n, "method", 6);
+    case 9: return 0 == _strnicmp_(n, "transport", 9);
+    default: return false;
+  }
+}
+
+static int find_uri_param(const char* s, const SipUri& uri, const char* name, const str_pos_t& nspan)
+{
+  for (uint32_t i = 0; i < uri.GetParamCount(); i++)
+  {
+    if (uri_span_equals(s, uri.GetParam(i).type, name, nspan, true))
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int find_uri_header(const char* s, const SipUri& uri, const char* name, const str_pos_t& nspan)
+{
+  for (uint32_t i = 0; i < uri.GetHeaderCount(); i++)
+  {
+    if (uri_span_equals(s, uri.GetHeader(i).fieldpos, name, nspan, true))
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool SipUri::Equals(const SipUri& other) const
+{
+  const char* a = (const char*)this->rawdata._data;
+  const char* b = (const char*)other.rawdata._data;
+  const sip_uri_t& ua = this->uri;
+  const sip_uri_t& ub = other.uri;
+  int i, j;
+
+  if (a == NULL || b == NULL)
+  {
+    return false;
+  }
+  if (!uri_span_equals(a, ua.scheme, b, ub.scheme, true) ||
+      !uri_span_equals(a, ua.host, b, ub.host, true) ||
+      !uri_span_equals(a, ua.username, b, ub.username, false) ||
+      !uri_span_equals(a, ua.password, b, ub.password, false))
+  {
+    return false;
+  }
+  /* a URI omitting the port does not match one with the default port */
+  if ((ua.port.length == 0) != (ub.port.length == 0) || uri_port_value(a, ua.port) != uri_port_value(b, ub.port))
+  {
+    return false;
+  }
+
+  for (i = 0; i < (int)ua.num_params; i++)
+  {
+    const param_pos_t& param = this->GetParam(i);
+    if ((j = find_uri_param(b, other, a, param.type)) < 0)
+    {
+      if (is_strict_uri_param(a, param.type))
+      {
+        return false;
+      }
+      continue;
+    }
+    if (!uri_span_equals(a, param.value, b, other.GetParam(j).value, true))
+    {
+      return false;
+    }
+  }
+  for (j = 0; j < (int)ub.num_params; j++)
+  {
+    if (is_strict_uri_param(b, other.GetParam(j).type) && find_uri_param(a, *this, b, other.GetParam(j).type) < 0)
+    {
+      return false;
+    }
+  }
+
+  /* header components are never ignored */
+  if (ua.num_headers != ub.num_headers)
+  {
+    return false;
+  }
+  for (i = 0; i < (int)ua.num_headers; i++)
+  {
+    const header_pos_t& header = this->GetHeader(i);
+    if ((j = find_uri_header(b, other, a, header.fieldpos)) < 0 ||
+        !uri_span_equals(a, header.valuepos, b, other.GetHeader(j).valuepos, false))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t SipUri::Hash() const
+{
+  const char* s = (const char*)this->rawdata._data;
+  uint64_t h = URI_HASH_INIT;
+  uint64_t params = 0;
+  uint64_t headers = 0;
+
+  if (s == NULL)
+  {
+    return 0;
+  }
+  h = uri_span_hash(h, s, this->uri.scheme, true);
+  h = uri_span_hash(h, s, this->uri.username, false);
+  h = uri_span_hash(h, s, this->uri.password, false);
+  h = uri_span_hash(h, s, this->uri.host, true);
+  h = (h ^ (this->uri.port.length ? uri_port_value(s, this->uri.port) : 0x10000)) * URI_HASH_PRIME;
+
+  /* only the parameters that take part in every comparison are hashed. Order
+     of parameters and headers is not significant: their hashes are summed */
+  for (uint32_t i = 0; i < this->uri.num_params; i++)
+  {
+    const param_pos_t& param = this->GetParam(i);
+    if (is_strict_uri_param(s, param.type))
+    {
+      params += uri_span_hash(uri_span_hash(URI_HASH_INIT, s, param.type, true), s, param.value, true);
+    }
+  }
+  for (uint32_t i = 0; i < this->uri.num_headers; i++)
+  {
+    const header_pos_t& header = this->GetHeader(i);
+    headers += uri_span_hash(uri_span_hash(URI_HASH_INIT, s, header.fieldpos, true), s, header.valuepos, false);
+  }
+  h = (h ^ params) * URI_HASH_PRIME;
+  h = (h ^ headers) * URI_HASH_PRIME;
+
+  /* final avalanche so that low bits can be used for bucket selection */
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
 }
 
 void SipUri::PrintOut(std::ostringstream& buf)
@@ -1508,13 +1792,13 @@ void SipUri::PrintOut(std::ostringstream& buf)
   if (this->uri.num_params)
   {
     buf << "---------- Parameters ----------\n";
-    for (int i = 0; i < this->uri.num_params; i++)
+    for (uint32_t i = 0; i < this->uri.num_params; i++)
     {
-      buf << std::string((const char*)this->rawdata._data + this->uri.urlParams[i].type.start, this->uri.urlParams[i].type.length);
-      if (this->uri.urlParams[i].value.length)
+      buf << std::string((const char*)this->rawdata._data + this->GetParam(i).type.start, this->GetParam(i).type.length);
+      if (this->GetParam(i).value.length)
       {
         buf << '=';
-        buf << std::string((const char*)this->rawdata._data + this->uri.urlParams[i].value.start, this->uri.urlParams[i].value.length);
+        buf << std::string((const char*)this->rawdata._data + this->GetParam(i).value.start, this->GetParam(i).value.length);
         buf << std::endl;
       }
     }
@@ -1522,13 +1806,13 @@ void SipUri::PrintOut(std::ostringstream& buf)
   if (this->uri.num_headers)
   {
     buf << "---------- Headers ----------\n";
-    for (int i = 0; i < this->uri.num_headers; i++)
+    for (uint32_t i = 0; i < this->uri.num_headers; i++)
     {
-      buf << std::string((const char*)this->rawdata._data + this->uri.urlHeaders[i].fieldpos.start, this->uri.urlHeaders[i].fieldpos.length);
-      if (this->uri.urlParams[i].value.length)
+      buf << std::string((const char*)this->rawdata._data + this->GetHeader(i).fieldpos.start, this->GetHeader(i).fieldpos.length);
+      if (this->GetParam(i).value.length)
       {
         buf << '=';
-        buf << std::string((const char*)this->rawdata._data + this->uri.urlHeaders[i].valuepos.start, this->uri.urlHeaders[i].valuepos.length);
+        buf << std::string((const char*)this->rawdata._data + this->GetHeader(i).valuepos.start, this->GetHeader(i).valuepos.length);
         buf << std::endl;
       }
     }
@@ -11,6 +11,7 @@
 #include "SipMessage.h" // TODO: SipMessage.h shall be removed by moving 
                         // definitions, like str_pos_t, to a common place 
 #include "RawData.h"
+#include "ParamParser.h"
 
 #include <sstream>      // std::ostringstream
 
@@ -30,6 +31,13 @@
    sip:juser@ExAmPlE.CoM;Transport=UDP
 */
 
+/* Parameters and headers beyond the inline ones are kept in a spill area taken
+   from a UriArena, or from the heap when the URI is not given one. Limits of the
+   total number are MAX_NUM_PARAMS and MIN_NUM_HEADERS as before */
+#define URI_INLINE_PARAMS       4
+#define URI_INLINE_HEADERS      2
+#define MAX_NUM_URI_HEADERS     MIN_NUM_HEADERS
+
 typedef struct sip_uri_t
 {
   str_pos_t scheme;                          /**< Uri Scheme (sip or sips) */
@@ -37,35 +45,133 @@ typedef struct sip_uri_t
   str_pos_t password;                        /**< Password */
   str_pos_t host;                            /**< Domain */
   str_pos_t port;                            /**< Port number */
-  int num_params;
-  SipParamArray_t urlParams;                 /**< Uri parameters */
 
-  int num_headers;
-  SipHeadersMinArray_t urlHeaders;           /**< Uri headers */
+  param_slots_t slots;                       /**< positions of well-known parameters, see GetParam(ParamId_t) */
+
+  uint16_t num_params;
+  uint16_t num_headers;
+  param_pos_t inlineParams[URI_INLINE_PARAMS];    /**< first Uri parameters */
+  header_pos_t inlineHeaders[URI_INLINE_HEADERS]; /**< first Uri headers */
+  param_pos_t* spillParams;                  /**< others, MAX_NUM_PARAMS - URI_INLINE_PARAMS */
+  header_pos_t* spillHeaders;                /**< others, MAX_NUM_URI_HEADERS - URI_INLINE_HEADERS */
 
   str_pos_t others;                          /**< Space for other url schemes. (http, mailto...) */
 } sip_uri_t;
 
+/* Bump allocator for the spill areas of the URIs parsed from a message. The
+   first block is a part of the instance (i.e. on stack), further ones are taken
+   from the heap. Everything is released at once on destruction */
+#define URI_ARENA_BLOCK_SIZE    1024
+
+class UriArena
+{
+public:
+  UriArena()
+    : used(0), blocks(NULL)
+  {}
+
+  ~UriArena();
+
+  /* NULL if the heap is exhausted */
+  void* Allocate(uint32_t size);
+
+private:
+  UriArena(const UriArena&);
+  UriArena& operator=(const UriArena&);
+
+  struct arena_block
+  {
+    arena_block* next;
+    uint32_t used;
+    uint32_t size;
+  };
+
+  uint64_t storage[URI_ARENA_BLOCK_SIZE / sizeof(uint64_t)];
+  uint32_t used;
+  arena_block* blocks;
+};
+
 class SipUri
 {
 public:
-  SipUri()
-    : uri(), rawdata()
+  SipUri(UriArena* uriArena = NULL)
+    : uri(), rawdata(), arena(uriArena)
   {}
 
-  ~SipUri() { /* To be implemented when data relationship is clear */ }
+  ~SipUri()
+  {
+    /* spill areas are owned when they are not from an arena */
+    if (this->arena == NULL)
+    {
+      delete[] this->uri.spillParams;
+      delete[] this->uri.spillHeaders;
+    }
+  }
 
   sip_uri_t uri;
 
   RawData rawdata;
 
+  uint32_t GetParamCount() const { return this->uri.num_params; }
+  const param_pos_t& GetParam(uint32_t i) const
+  {
+    return (i < URI_INLINE_PARAMS) ? this->uri.inlineParams[i] : this->uri.spillParams[i - URI_INLINE_PARAMS];
+  }
+
+  uint32_t GetHeaderCount() const { return this->uri.num_headers; }
+  const header_pos_t& GetHeader(uint32_t i) const
+  {
+    return (i < URI_INLINE_HEADERS) ? this->uri.inlineHeaders[i] : this->uri.spillHeaders[i - URI_INLINE_HEADERS];
+  }
+
+  /* well-known parameter without any comparison, NULL if it does not exist.
+     See ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t id) const
+  {
+    return (id < MAX_NUM_PARAM_IDS && this->uri.slots.index[id]) ? &this->GetParam((uint32_t)this->uri.slots.index[id] - 1) : NULL;
+  }
+
+  /* numeric value of a well-known parameter, i.e. ttl. Returns 0 on success,
+     1 if it does not exist or is not a number */
+  int GetParamU32(ParamId_t id, uint32_t* value) const
+  {
+    return get_param_u32((const char*)this->rawdata._data, this->GetParam(id), id, value);
+  }
+
   int ParseUri(const char* buf, size_t pos, size_t buflen);
 
+  /* arena of spill areas for an inline SipUri, must be set before ParseUri() */
+  void SetArena(UriArena* uriArena) { arena = uriArena; }
+
   int ParseHostPortPair(size_t pos, const char* hostport, size_t length);
   int ParseUriHeaders(const char* buf, size_t length);
   int ParseUriParams(const char* buf, size_t length);
 
+  /* URI comparison of RFC 3261 19.1.4 over the parsed spans, without any copy:
+     scheme, host and parameters are case-insensitive, userinfo and header values
+     are case-sensitive, an escaped character equals to itself unless it is a
+     reserved one. user, ttl, method, maddr and transport parameters never match
+     when only in one URI, other parameters are compared only when in both.
+     Headers must be present in both URIs */
+  bool Equals(const SipUri& other) const;
+
+  /* 64-bit hash of the URI consistent with Equals(): equal URIs have equal hashes */
+  uint64_t Hash() const;
+
   void PrintOut(std::ostringstream& buf);
+
+private:
+  SipUri(const SipUri&);
+  SipUri& operator=(const SipUri&);
+
+  const char* ParseUserInfo(const char* buf, const char* p, const char* at);
+
+  /* room for a new parameter/header, NULL if the limit is reached */
+  param_pos_t* AddParam();
+  header_pos_t* AddHeader();
+  void SetWellKnownParam(const param_pos_t& param);
+
+  UriArena* arena;
 };
 
 //---------------------------------------------------------------------------
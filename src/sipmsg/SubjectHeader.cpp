@@ -203,6 +203,10 @@ const char* SubjectHeader::ParseHeader(const char* buf, uint32_t pos, uint32_t b
    subparts or represents a multiple-header */
 std::string SubjectHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   if (!(this->rawdata._length) || !(this->subject.length))
   {
     return "";
@@ -224,6 +228,11 @@ std::string SubjectHeader::GetHeaderValue()
 
 int SubjectHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   if (!(this->rawdata._length) || !(this->subject.length))
   {
     return 1;
@@ -246,7 +255,7 @@ int SubjectHeader::GetHeaderValue(std::string& value)
    No any additional copy applied. */
 int SubjectHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
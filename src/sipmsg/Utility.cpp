@@ -1,6 +1,7 @@
 
 #include "Utility.h"
 #include "SipHeader.h"
+#include "ParamParser.h"
 
 enum param_parsing_state 
 { s_pp_dead
@@ -218,7 +219,7 @@ enum param_parsing_state parse_param_char(enum param_parsing_state s, const char
   return s_pp_dead;
 }
 
-const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, param_pos_t* cparam, uint32_t maxnum_of_params, uint32_t* num_of_params, int* parse_error, int multihdr_allowed)
+static const char* parse_params(const char* buf, uint32_t pos, uint32_t buflen, param_pos_t* cparam, uint32_t maxnum_of_params, uint32_t* num_of_params, int* parse_error, int multihdr_allowed)
 {
   int result = 0;
   /* TODO: Try to use s_pp_param_value_lws as a start-state */
@@ -269,10 +270,16 @@ const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, par
       case s_pp_param_name:
         if ((prev_s == s_pp_param_start) || (prev_s == s_pp_param_start_lws))
         {
+          if (*num_of_params >= maxnum_of_params)
+          {
+            *parse_error = 5; /* TODO: assign meaningful error code */
+            return p;
+          }
           param_name_mark = p;
           /* using '()' invokes default construtor which initializes
              the struct to 0*/
           current_param = &cparam[(*num_of_params)++];
+          *current_param = param_pos_t();
         }
         break;
 
@@ -378,6 +385,19 @@ const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, par
 
 }
 
+const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, param_pos_t* cparam, uint32_t maxnum_of_params, uint32_t* num_of_params, int* parse_error, int multihdr_allowed, struct param_slots* slots)
+{
+  uint32_t first = *num_of_params;
+  const char* p = parse_params(buf, pos, buflen, cparam, maxnum_of_params, num_of_params, parse_error, multihdr_allowed);
+
+  /* names of the new parameters are still in cache, classify them now */
+  if (slots != NULL && *parse_error == 0)
+  {
+    fill_param_slots(slots, buf, cparam, first, *num_of_params);
+  }
+  return p;
+}
+
 int _strnicmp_(const char* s1, const char* s2, size_t n)
 {
   if (n == 0)
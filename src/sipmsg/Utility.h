@@ -9,9 +9,13 @@
  //---------------------------------------------------------------------------
 #include "SipMessage.h"
 
+struct param_slots;
+
 //static int ParseParamPart(int currState, char ch, param_pos_t* current_param);
 
-const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, param_pos_t* cparam, uint32_t maxnum_of_params, uint32_t* num_of_params, int* parse_error, int multihdr_allowed);
+/* well-known ones of the parsed parameters are classified into 'slots' when
+   given, see ParamParser.h */
+const char* parse_param_part(const char* buf, uint32_t pos, uint32_t buflen, param_pos_t* cparam, uint32_t maxnum_of_params, uint32_t* num_of_params, int* parse_error, int multihdr_allowed, struct param_slots* slots = NULL);
 
 int _strnicmp_(const char* s1, const char* s2, size_t n);
 
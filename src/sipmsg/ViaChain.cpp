@@ -0,0 +1,98 @@
+/*
+ * ViaChain.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ViaChain.h"
+#include "Utility.h"
+
+#include <string.h>
+
+ViaChain::ViaChain(SipMessage* message)
+  : parsing_stat(PARSED_SUCCESSFULLY), msg(message), header_idx(-1), pos(0), end(0),
+    more(false), num_hops(0), hop_value({ 0, 0 })
+{}
+
+void ViaChain::Reset()
+{
+  this->parsing_stat = PARSED_SUCCESSFULLY;
+  this->header_idx = -1;
+  this->pos = 0;
+  this->end = 0;
+  this->more = false;
+  this->num_hops = 0;
+}
+
+bool ViaChain::NextHeader()
+{
+  const char* data = &this->msg->v1[0];
+
+  for (uint32_t i = (uint32_t)(this->header_idx + 1); i < this->msg->num_headers; i++)
+  {
+    const str_pos_t& field = this->msg->headers[i].fieldpos;
+    const char* name = data + field.start;
+
+    if ((field.length == 3 && 0 == _strnicmp_(name, "Via", 3)) ||
+        (field.length == 1 && LOWER(name[0]) == 'v'))
+    {
+      const str_pos_t& value = this->msg->headers[i].valuepos;
+      this->header_idx = (int)i;
+      this->pos = value.start;
+      this->end = value.start + value.length;
+      return true;
+    }
+  }
+  this->header_idx = (int)this->msg->num_headers;
+  return false;
+}
+
+bool ViaChain::Next()
+{
+  const char* data = &this->msg->v1[0];
+  static const str_pos_t empty = { 0, 0 };
+
+  if (this->parsing_stat != PARSED_SUCCESSFULLY || this->header_idx >= (int)this->msg->num_headers)
+  {
+    return false;
+  }
+  if (!this->more)
+  {
+    if (!this->NextHeader())
+    {
+      return false;
+    }
+    if (this->pos >= this->end)
+    {
+      this->parsing_stat = PARSING_FAILED_NO_DATA;
+      return false;
+    }
+  }
+  while (this->pos < this->end && IS_LWS(data[this->pos]))
+  {
+    this->pos++;
+  }
+
+  /* only the parts set by parsing are reset, parameters are overwritten */
+  this->hop.protocol = empty;
+  this->hop.version = empty;
+  this->hop.transport = empty;
+  this->hop.host = empty;
+  this->hop.port = empty;
+  this->hop.branch = empty;
+  this->hop.num_params = 0;
+  memset(&this->hop.slots, 0, sizeof(this->hop.slots));
+
+  const char* p = parse_via_parm(data, data + this->pos, this->end, &this->hop, &this->parsing_stat);
+  if (this->parsing_stat != PARSED_SUCCESSFULLY)
+  {
+    return false;
+  }
+  this->hop_value.start = this->pos;
+  this->hop_value.length = (uint32_t)(p - data) - this->pos;
+  this->more = (p < data + this->end);
+  this->pos = (uint32_t)(p - data) + 1; /* skip ',' */
+  this->num_hops++;
+
+  return true;
+}
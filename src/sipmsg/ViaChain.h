@@ -0,0 +1,83 @@
+/*
+ * ViaChain.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _VIA_CHAIN_H_
+#define _VIA_CHAIN_H_
+//---------------------------------------------------------------------------
+#include "ViaHeader.h"
+
+/*
+  Iterates over the hops of a parsed message: all Via header lines in the order
+  they appear and the comma separated via-parms in each of them, i.e.
+
+      Via: SIP/2.0/UDP a.example.com;branch=z9hG4bK1, SIP/2.0/UDP b.example.com
+      v: SIP/2.0/TCP c.example.com;branch=z9hG4bK3
+
+  has three hops. Each Next() parses only the following hop into a single
+  via_param_t of the iterator, nothing is parsed ahead. Routing a response
+  needs only the first one; loop detection may walk through all of them as
+  there is no limit on the number of hops, unlike ViaHeader.
+
+      ViaChain chain(msg);
+      while (chain.Next())
+      {
+        const via_param_t& hop = chain.GetHop();
+        ...
+      }
+      if (chain.parsing_stat != PARSED_SUCCESSFULLY) ... malformed Via
+ */
+
+class ViaChain
+{
+public:
+  ViaChain(SipMessage* message);
+
+  /* Parses the next hop. Returns false at the end of the chain or when a hop
+     cannot be parsed, 'parsing_stat' tells which one */
+  bool Next();
+
+  /* Starts over from the top Via */
+  void Reset();
+
+  /* Current hop, valid after Next() returns true */
+  const via_param_t& GetHop() const { return hop; }
+
+  /* Well-known parameter of the current hop, see ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t id) const
+  {
+    return get_param(this->hop.slots, &this->hop.params[0], id);
+  }
+  int GetParamU32(ParamId_t id, uint32_t* value) const
+  {
+    return get_param_u32(&this->msg->v1[0], this->GetParam(id), id, value);
+  }
+
+  /* Number of the current hop from the top one, which is 0 */
+  uint32_t GetHopIndex() const { return num_hops - 1; }
+
+  /* Position of the Via line of the current hop in SipMessage::headers */
+  uint32_t GetHeaderIndex() const { return (uint32_t)header_idx; }
+
+  /* Position of the value of the current hop in message bytes 'v1' */
+  str_pos_t GetHopValue() const { return hop_value; }
+
+  ParsingStatus_t parsing_stat;
+
+private:
+  /* finds the next Via line after 'header_idx', false if there is none */
+  bool NextHeader();
+
+  SipMessage* msg;
+  int header_idx;
+  uint32_t pos;           /**< start of the next hop in 'v1' */
+  uint32_t end;           /**< end of the value of the current Via line */
+  bool more;              /**< a ',' ends the current hop, another one follows in the line */
+  uint32_t num_hops;
+  str_pos_t hop_value;
+  via_param_t hop;
+};
+
+//---------------------------------------------------------------------------
+#endif // _VIA_CHAIN_H_
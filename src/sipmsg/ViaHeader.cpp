@@ -240,8 +240,9 @@ enum via_sby_parsing_state parse_sentby_char(enum via_sby_parsing_state s, const
       {
         return s_sby_sentby_host_lws;
       }
-      if (ch == ';')
+      if (ch == ';' || ch == ',')
       {
+        /* ',' ends a via-parm without parameters */
         return s_sby_param_start;
       }
       break;
@@ -255,6 +256,10 @@ enum via_sby_parsing_state parse_sentby_char(enum via_sby_parsing_state s, const
       {
         return s_sby_sentby_port_start;
       }
+      if (ch == ';' || ch == ',')
+      {
+        return s_sby_param_start;
+      }
       break;
 
     case s_sby_sentby_port_start:
@@ -295,7 +300,22 @@ enum via_sby_parsing_state parse_sentby_char(enum via_sby_parsing_state s, const
       {
         return s_sby_sentby_port_start;
       }
-      if (ch == ';')
+      if (ch == ';' || ch == ',')
+      {
+        return s_sby_param_start;
+      }
+      break;
+
+    case s_sby_sentby_host_v6_end_lws:
+      if (IS_LWS(ch))
+      {
+        return s_sby_sentby_host_v6_end_lws;
+      }
+      if (ch == ':')
+      {
+        return s_sby_sentby_port_start;
+      }
+      if (ch == ';' || ch == ',')
       {
         return s_sby_param_start;
       }
@@ -310,7 +330,7 @@ enum via_sby_parsing_state parse_sentby_char(enum via_sby_parsing_state s, const
       {
         return s_sby_sentby_port_lws;
       }
-      if (ch == ';')
+      if (ch == ';' || ch == ',')
       {
         return s_sby_param_start;
       }
@@ -321,7 +341,7 @@ enum via_sby_parsing_state parse_sentby_char(enum via_sby_parsing_state s, const
       {
         return s_sby_sentby_port_lws;
       }
-      if (ch == ';')
+      if (ch == ';' || ch == ',')
       {
         return s_sby_param_start;
       }
@@ -513,17 +533,62 @@ const char* parse_via_sentby_part(const char* buf, size_t pos, size_t buflen, vi
       break;
 
     default:
-      *parse_error = 1;
+      /* value ends before sent-by is completed */
+      *parse_error = PARSING_FAILED_STATE_UNHANDLED;
       break;
   }
   return p;
 }
 
-const char* ViaHeader:: ParseHeader(const char* buf, uint32_t pos, uint32_t buflen)
+const char* parse_via_parm(const char* buf, const char* p, uint32_t buflen, via_param_t* viaparam, ParsingStatus_t* stat)
 {
-  int result = 0;
   int parse_error = 0;
 
+  p = parse_via_sentby_part(buf, p - buf, buflen, viaparam, &parse_error);
+  if (parse_error)
+  {
+    *stat = (ParsingStatus_t)parse_error;
+    return p;
+  }
+  if (p < buf + buflen)
+  {
+    /* there should be parameters part or a new via-parm encountered */
+    if ((*p != ';') && (*p != ','))
+    {
+      /* we expected ';' for parameters part or "," for multiple-header */
+      *stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+    /* parameters part shall be first if there is */
+    if (*p == ';')
+    {
+      p++; /* skip ';' char */
+      p = parse_param_part(buf, p - buf, buflen, &viaparam->params[0], MAX_NUM_PARAMS, &viaparam->num_params, &parse_error, 1, &viaparam->slots);
+      if (parse_error)
+      {
+        /* TODO: Map parse_error to parsing_stat */
+        *stat = PARSING_FAILED_UNCLEAR_REASON;
+        return p;
+      }
+      const param_pos_t* branch = get_param(viaparam->slots, &viaparam->params[0], PARAM_BRANCH);
+      if (branch != NULL)
+      {
+        viaparam->branch = branch->value;
+      }
+    }
+    if ((p < buf + buflen) && (*p != ','))
+    {
+      /* we expected ',' for a new via-parm start phase */
+      *stat = PARSING_FAILED_UNEXPECTED_CHAR;
+      return p;
+    }
+  }
+  *stat = PARSED_SUCCESSFULLY;
+  return p;
+}
+
+const char* ViaHeader:: ParseHeader(const char* buf, uint32_t pos, uint32_t buflen)
+{
   const char* p;
 
   if (buflen == 0)
@@ -536,64 +601,31 @@ const char* ViaHeader:: ParseHeader(const char* buf, uint32_t pos, uint32_t bufl
   this->rawdata._length = buflen;
   this->rawdata._pos = pos;
 
-  for (p = buf + pos; p < buf + buflen; p++)
+  for (p = buf + pos; ; p++) /* skip ',' */
   {
-    via_param_t* viaparam = &this->via_parms[this->num_via_parms++];
-    p = parse_via_sentby_part(buf, p - buf, buflen, viaparam, &parse_error);
-    if (parse_error)
+    if (this->num_via_parms >= MAX_NUM_VIAPARMS)
     {
-      this->parsing_stat = (ParsingStatus_t)parse_error;
+      /* see ViaChain for any number of hops */
+      this->parsing_stat = PARSING_FAILED_MAX_RANGE;
       return p;
     }
-//    /* TODO: not sure the following is necessary */
-//    if (p == NULL)
-//    {
-//      this->parsing_stat = PARSING_FAILED;
-//      return 1;
-//    }
-    if (p < buf + buflen)
+    via_param_t* viaparam = &this->via_parms[this->num_via_parms++];
+    p = parse_via_parm(buf, p, buflen, viaparam, &this->parsing_stat);
+    if ((this->parsing_stat != PARSED_SUCCESSFULLY) || (p >= buf + buflen))
     {
-      /* there should be parameters part or a new via-parm encountered */
-      if ((*p != ';') && (*p != ','))
-      {
-        /* we expected ';' for parameters part or "," for multiple-header */
-        this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
-        return p; 
-      }
-      /* parameters part shall be first if there is */
-      if (*p == ';')
-      {
-        p++; /* skip ';' char */
-        p = parse_param_part(buf, p - buf, buflen, &viaparam->params[0], MAX_NUM_PARAMS, &viaparam->num_params, &parse_error, 1);
-        if (parse_error)
-        {
-          /* TODO: Map parse_error to parsing_stat */
-          this->parsing_stat = PARSING_FAILED_UNCLEAR_REASON;
-          return p;
-        }
-      }
-      if (p >= buf + buflen)
-      {
-        this->parsing_stat = PARSED_SUCCESSFULLY;
-        return 0;
-      }
-      if (*p != ',')
-      {
-        /* we expected ',' for a new contact_param start phase */
-        this->parsing_stat = PARSING_FAILED_UNEXPECTED_CHAR;
-        return p; 
-      }
+      return p;
     }
   }
-
-  this->parsing_stat = (parse_error) ? PARSING_FAILED_UNCLEAR_REASON : PARSED_SUCCESSFULLY;
-  return p;
 }
 
 /* both provide the value part, which can be re-formatted if the header has
    subparts or represents a multiple-header */
 std::string ViaHeader::GetHeaderValue()
 {
+  if (this->IsReceivedValueValid())
+  {
+    return this->GetReceivedValue();
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -626,8 +658,6 @@ std::string ViaHeader::GetHeaderValue()
     {
       return "";
     }
-    size_t length = (size_t)this->rawdata._length;
-    sbuf.reserve(length);
     sbuf.append((const char*)this->rawdata._data + viaparam->protocol.start, viaparam->protocol.length);
     sbuf.append(1, '/');
     sbuf.append((const char*)this->rawdata._data + viaparam->version.start, viaparam->version.length);
@@ -656,6 +686,11 @@ std::string ViaHeader::GetHeaderValue()
 
 int ViaHeader::GetHeaderValue(std::string& value)
 {
+  if (this->IsReceivedValueValid())
+  {
+    value = this->GetReceivedValue();
+    return 0;
+  }
   /* check for mandatory parts if exist */
   if (!this->rawdata._length)
   {
@@ -672,15 +707,13 @@ int ViaHeader::GetHeaderValue(std::string& value)
       return 1;
     }
   }
-  size_t length = (size_t)this->rawdata._length;
-  std::string sbuf;
-  sbuf.reserve(length);
+  value.reserve((size_t)this->rawdata._length);
   for (int i = 0; i < this->num_via_parms; i++)
   {
     if (i > 0)
     {
       /* multiple-header in a filed, add ',' */
-      sbuf.append(1, ',');
+      value.append(1, ',');
     }
     via_param_t* viaparam = &this->via_parms[i];
 
@@ -690,8 +723,6 @@ int ViaHeader::GetHeaderValue(std::string& value)
     {
       return 1;
     }
-    size_t length = (size_t)this->rawdata._length;
-    value.reserve(length);
     value.append((const char*)this->rawdata._data + viaparam->protocol.start, viaparam->protocol.length);
     value.append(1, '/');
     value.append((const char*)this->rawdata._data + viaparam->version.start, viaparam->version.length);
@@ -719,11 +750,52 @@ int ViaHeader::GetHeaderValue(std::string& value)
   return 0;
 }
 
+int ViaHeader::FormatValue(char* buf, uint32_t buflen)
+{
+  uint32_t pos = 0;
+
+  for (uint32_t i = 0; i < this->num_via_parms; i++)
+  {
+    const via_param_t* viaparam = &this->via_parms[i];
+
+    if ((i > 0 && !this->AppendChar(buf, buflen, pos, ',')) ||
+        !this->AppendValue(buf, buflen, pos, viaparam->protocol.start, viaparam->protocol.length) ||
+        !this->AppendChar(buf, buflen, pos, '/') ||
+        !this->AppendValue(buf, buflen, pos, viaparam->version.start, viaparam->version.length) ||
+        !this->AppendChar(buf, buflen, pos, '/') ||
+        !this->AppendValue(buf, buflen, pos, viaparam->transport.start, viaparam->transport.length) ||
+        !this->AppendChar(buf, buflen, pos, ' ') ||
+        !this->AppendValue(buf, buflen, pos, viaparam->host.start, viaparam->host.length))
+    {
+      return -1;
+    }
+    if (viaparam->port.length &&
+        (!this->AppendChar(buf, buflen, pos, ':') ||
+         !this->AppendValue(buf, buflen, pos, viaparam->port.start, viaparam->port.length)))
+    {
+      return -1;
+    }
+    for (uint32_t j = 0; j < viaparam->num_params; j++)
+    {
+      const param_pos_t& param = viaparam->params[j];
+      if (!this->AppendChar(buf, buflen, pos, ';') ||
+          !this->AppendValue(buf, buflen, pos, param.type.start, param.type.length) ||
+          (param.value.length &&
+           (!this->AppendChar(buf, buflen, pos, '=') ||
+            !this->AppendValue(buf, buflen, pos, param.value.start, param.value.length))))
+      {
+        return -1;
+      }
+    }
+  }
+  return (int)pos;
+}
+
 /* provides the pointer to value part of the header in question.
    No any additional copy applied. */
 int ViaHeader::GetHeaderValue(RawData& value)
 {
-  if (!this->rawdata._length)
+  if (!this->rawdata._length || this->modified)
   {
     return 1;
   }
@@ -758,22 +830,6 @@ void ViaHeader::PrintOut(std::ostringstream& buf)
     buf << "sent-by-host: " << std::string((const char*)this->rawdata._data + viaparam->host.start, viaparam->host.length) << std::endl;
     buf << "sent-by-port: " << std::string((const char*)this->rawdata._data + viaparam->port.start, viaparam->port.length) << std::endl;
 
-    if ((viaparam->branch.start <= 0) && (viaparam->branch.length <= 0))
-    {
-      for (int i = 0; i < viaparam->num_params; i++)
-      {
-        if (viaparam->params[i].type.length == 6)
-        {
-          int result = _strnicmp_((const char*)this->rawdata._data + viaparam->params[i].type.start, "branch", 6);
-          if (result == 0)
-          {
-            viaparam->branch.start = viaparam->params[i].value.start;
-            viaparam->branch.length = viaparam->params[i].value.length;
-            break;
-          }
-        }
-      }
-    }
     buf << "branch      : " << std::string((const char*)this->rawdata._data + viaparam->branch.start, viaparam->branch.length) << std::endl;
 
     if (viaparam->num_params)
@@ -11,6 +11,7 @@
 
 #include "SipMessage.h"
 #include "SipHeader.h"
+#include "ParamParser.h"
 
 typedef struct via_param_t
 {
@@ -22,11 +23,18 @@ typedef struct via_param_t
   str_pos_t branch;          /**< Branch parameter for quick access */
   uint32_t  num_params;
   SipParamArray_t params;    /**< Via parameters */
+  param_slots_t slots;       /**< well-known ones of 'params' */
 } via_param_t;
 
 #define MAX_NUM_VIAPARMS 8
 typedef std::array<via_param_t, MAX_NUM_VIAPARMS> via_param_array_t;
 
+/* Parses a single via-parm starting at 'p' into 'viaparam'. On success, returns
+   the position of the ',' before the next via-parm or the end of the value.
+   Otherwise 'stat' tells the reason and the returned position is where the
+   problem is */
+const char* parse_via_parm(const char* buf, const char* p, uint32_t buflen, via_param_t* viaparam, ParsingStatus_t* stat);
+
 class ViaHeader : public SipHeader
 {
 public:
@@ -46,11 +54,28 @@ public:
      No any additional copy applied. */
   int GetHeaderValue(RawData& value);
 
+  /* well-known parameter of the 'index'th via-parm without any comparison,
+     NULL if it does not exist. See ParamParser.h */
+  const param_pos_t* GetParam(ParamId_t id, uint32_t index = 0) const
+  {
+    return (index < this->num_via_parms) ? get_param(this->via_parms[index].slots, &this->via_parms[index].params[0], id) : NULL;
+  }
+
+  /* numeric value of a well-known parameter, i.e. ttl or rport. Returns 0 on
+     success, 1 if it does not exist or is not a number */
+  int GetParamU32(ParamId_t id, uint32_t* value, uint32_t index = 0) const
+  {
+    return get_param_u32((const char*)this->rawdata._data, this->GetParam(id, index), id, value);
+  }
+
   void PrintOut(std::ostringstream& buf);
 
   uint32_t num_via_parms;
   via_param_array_t via_parms;
 
+protected:
+  /* writes parts directly into 'buf' for a modified header */
+  int FormatValue(char* buf, uint32_t buflen);
 };
 
 //---------------------------------------------------------------------------
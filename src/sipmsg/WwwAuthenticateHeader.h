@@ -0,0 +1,55 @@
+/*
+ * WwwAuthenticateHeader.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+#ifndef _WWW_AUTHENTICATE_HEADER_H_
+#define _WWW_AUTHENTICATE_HEADER_H_
+//---------------------------------------------------------------------------
+#include "AuthHeader.h"
+
+/*
+   The WWW-Authenticate header field value consists of at least one
+   challenge that indicates the authentication scheme(s) and parameters
+   applicable to the Request-URI, Proxy-Authenticate the ones of a proxy.
+
+   digest-cln        =  realm / domain / nonce
+                        / opaque / stale / algorithm
+                        / qop-options / auth-param
+   realm             =  "realm" EQUAL realm-value
+   domain            =  "domain" EQUAL LDQUOT URI
+                        *( 1*SP URI ) RDQUOT
+   nonce             =  "nonce" EQUAL nonce-value
+   stale             =  "stale" EQUAL ( "true" / "false" )
+   qop-options       =  "qop" EQUAL LDQUOT qop-value
+                        *("," qop-value) RDQUOT
+
+   Example:
+      WWW-Authenticate: Digest realm="atlanta.com",
+       domain="sip:boxesbybob.com", qop="auth",
+       nonce="f84f1cec41e6cbe5aea9c8e88d359", opaque="", stale=FALSE
+
+   A Digest challenge without realm or nonce is not accepted.
+ */
+
+class WwwAuthenticateHeader : public AuthHeader
+{
+public:
+  WwwAuthenticateHeader(bool proxy = false)
+    : proxy(proxy)
+  {}
+
+  const char* GetName() const { return proxy ? "Proxy-Authenticate" : "WWW-Authenticate"; }
+
+protected:
+  bool HasDigestParams() const
+  {
+    return this->GetParam(AUTH_PARAM_REALM) != NULL && this->GetParam(AUTH_PARAM_NONCE) != NULL;
+  }
+
+private:
+  bool proxy;
+};
+
+//---------------------------------------------------------------------------
+#endif // _WWW_AUTHENTICATE_HEADER_H_
@@ -6,14 +6,17 @@
 #include <string.h>
 #include <limits.h>
 
-static uint32_t max_header_size = SIP_MAX_HEADER_SIZE;
-
 //#define SIP_PARSER_STRICT
 
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
 
+/* the limits of a parser until sip_parser_set_limits() */
+static sip_parser_limits default_limits = {
+  SIP_MAX_HEADER_SIZE, (uint32_t) -1, (uint32_t) -1, ULLONG_MAX
+};
+
 #ifndef MIN
 # define MIN(a,b) ((a) < (b) ? (a) : (b))
 #endif
@@ -49,6 +52,41 @@ do {                                                                 \
 #define REEXECUTE()                                                  \
   goto reexecute;                                                    \
 
+/* With SIP_PARSER_COMPUTED_GOTO each state is also a label and a state
+ * reads the next char and jumps to the label of the next state itself,
+ * otherwise it leaves the switch for the loop to do it */
+#if SIP_PARSER_COMPUTED_GOTO
+# define CASE_STATE(S)   case S: l_##S
+# define CASE_OTHER_STATE default: l_other_state
+# define DISPATCH()      goto *dispatch[CURRENT_STATE()]
+# define NEXT_CHAR()                                                 \
+do {                                                                 \
+  if (UNLIKELY(++p == data + len)) {                                 \
+    goto parsed;                                                     \
+  }                                                                  \
+  ch = *p;                                                           \
+  if (PARSING_HEADER(CURRENT_STATE()))                               \
+    COUNT_HEADER_SIZE(1);                                            \
+  DISPATCH();                                                        \
+} while (0)
+#else
+# define CASE_STATE(S)   case S
+# define CASE_OTHER_STATE default
+# define DISPATCH()
+# define NEXT_CHAR()     break
+#endif
+
+
+/* A state going on with the next one, a comment is not seen by the compiler
+ * before CASE_STATE() */
+#if defined(__has_attribute)
+# if __has_attribute(fallthrough)
+#  define FALLTHROUGH __attribute__((fallthrough))
+# endif
+#endif
+#ifndef FALLTHROUGH
+# define FALLTHROUGH do { } while (0)
+#endif
 
 #ifdef __GNUC__
 # define LIKELY(X) __builtin_expect(!!(X), 1)
@@ -58,51 +96,98 @@ do {                                                                 \
 # define UNLIKELY(X) (X)
 #endif
 
+/* The parser is instantiated once with the callbacks and once filling a
+ * sip_parse_result, see sip_parser_execute_() */
+#if defined(_MSC_VER)
+# define ALWAYS_INLINE __forceinline
+#elif defined(__GNUC__)
+# define ALWAYS_INLINE __inline__ __attribute__((always_inline))
+#else
+# define ALWAYS_INLINE
+#endif
+
+/* A function with a computed goto is never inlined, the entry points and
+ * the parser variants share one sip_parser_execute_() then */
+#if SIP_PARSER_COMPUTED_GOTO
+# define EXECUTE_INLINE
+#else
+# define EXECUTE_INLINE ALWAYS_INLINE
+#endif
+
 
-/* Run the notify callback FOR, returning ER if it fails */
+/* Run the notify callback FOR, returning ER if it fails. When pulling
+ * the position is kept in 'result' instead, returning ER at the end of
+ * the message. A datagram also ends there */
 #define CALLBACK_NOTIFY_(FOR, ER)                                    \
 do {                                                                 \
   assert(SIP_PARSER_ERRNO(parser) == SPE_OK);                        \
                                                                      \
-  if (LIKELY(settings->on_##FOR)) {                                  \
-    parser->state = CURRENT_STATE();                                 \
-    if (UNLIKELY(0 != settings->on_##FOR(parser))) {                 \
-      SET_ERRNO(SPE_CB_##FOR);                                       \
+  if (pull) {                                                        \
+    if (pull_##FOR(result, (uint32_t) (p - data) + result->offset)) {\
+      RETURN(ER);                                                    \
     }                                                                \
-    UPDATE_STATE(parser->state);                                     \
+  } else {                                                           \
+    if (LIKELY(settings->on_##FOR)) {                                \
+      parser->state = CURRENT_STATE();                               \
+      if (UNLIKELY(0 != settings->on_##FOR(parser))) {               \
+        SET_ERRNO(SPE_CB_##FOR);                                     \
+      }                                                              \
+      UPDATE_STATE(parser->state);                                   \
                                                                      \
-    /* We either errored above or got paused; get out */             \
-    if (UNLIKELY(SIP_PARSER_ERRNO(parser) != SPE_OK)) {              \
-      return (ER);                                                   \
+      /* We either errored above or got paused; get out */           \
+      if (UNLIKELY(SIP_PARSER_ERRNO(parser) != SPE_OK)) {            \
+        return (ER);                                                 \
+      }                                                              \
+    }                                                                \
+    if (datagram && ENDS_MESSAGE_##FOR) {                            \
+      RETURN(ER);                                                    \
     }                                                                \
   }                                                                  \
 } while (0)
 
+#define ENDS_MESSAGE_message_begin      0
+#define ENDS_MESSAGE_message_complete   1
+
 /* Run the notify callback FOR and consume the current byte */
 #define CALLBACK_NOTIFY(FOR)            CALLBACK_NOTIFY_(FOR, p - data + 1)
 
 /* Run the notify callback FOR and don't consume the current byte */
 #define CALLBACK_NOTIFY_NOADVANCE(FOR)  CALLBACK_NOTIFY_(FOR, p - data)
 
-/* Run data callback FOR with LEN bytes, returning ER if it fails */
-#define CALLBACK_DATA_(FOR, LEN, ER)                                 \
+/* Run data callback FOR with the LEN bytes at AT, returning ER if it
+ * fails. When pulling the span at POS is kept in 'result' instead */
+#define CALLBACK_DATA_AT_(FOR, AT, POS, LEN, ER)                     \
 do {                                                                 \
   assert(SIP_PARSER_ERRNO(parser) == SPE_OK);                        \
                                                                      \
-  if (FOR##_mark) {                                                  \
-    if (LIKELY(settings->on_##FOR)) {                                \
-      parser->state = CURRENT_STATE();                               \
-      if (UNLIKELY(0 !=                                              \
-                   settings->on_##FOR(parser, FOR##_mark, (LEN)))) { \
-        SET_ERRNO(SPE_CB_##FOR);                                     \
-      }                                                              \
-      UPDATE_STATE(parser->state);                                   \
+  if (pull) {                                                        \
+    enum sip_errno e_ = pull_##FOR(result, (AT), (uint32_t) (POS),   \
+      (uint32_t) (LEN), CURRENT_STATE());                            \
+    if (UNLIKELY(e_ != SPE_OK)) {                                    \
+      SET_ERRNO(e_);                                                 \
+      return (ER);                                                   \
+    }                                                                \
+  } else if (LIKELY(settings->on_##FOR)) {                           \
+    parser->state = CURRENT_STATE();                                 \
+    if (UNLIKELY(0 != settings->on_##FOR(parser, (AT), (LEN)))) {    \
+      SET_ERRNO(SPE_CB_##FOR);                                       \
+    }                                                                \
+    UPDATE_STATE(parser->state);                                     \
                                                                      \
-      /* We either errored above or got paused; get out */           \
-      if (UNLIKELY(SIP_PARSER_ERRNO(parser) != SPE_OK)) {            \
-        return (ER);                                                 \
-      }                                                              \
+    /* We either errored above or got paused; get out */             \
+    if (UNLIKELY(SIP_PARSER_ERRNO(parser) != SPE_OK)) {              \
+      return (ER);                                                   \
     }                                                                \
+  }                                                                  \
+} while (0)
+
+/* Run data callback FOR with LEN bytes from its mark, returning ER if it
+ * fails. When pulling the span is kept in 'result' instead */
+#define CALLBACK_DATA_(FOR, LEN, ER)                                 \
+do {                                                                 \
+  if (FOR##_mark) {                                                  \
+    CALLBACK_DATA_AT_(FOR, FOR##_mark,                               \
+      (FOR##_mark - data) + result->offset, LEN, ER);                \
     FOR##_mark = NULL;                                               \
   }                                                                  \
 } while (0)
@@ -132,14 +217,16 @@ do {                                                                 \
  * it on the embedder's behalf because most won't bother and this way we
  * make the web a little safer.  max_header_size is still far bigger
  * than any reasonable request or response so this should never affect
- * day-to-day operation.
+ * day-to-day operation. A datagram not longer than it is not counted.
  */
 #define COUNT_HEADER_SIZE(V)                                         \
 do {                                                                 \
-  nread += (uint32_t)(V);                                            \
-  if (UNLIKELY(nread > max_header_size)) {                           \
-    SET_ERRNO(SPE_HEADER_OVERFLOW);                                  \
-    goto error;                                                      \
+  if (count_header) {                                                \
+    nread += (uint32_t)(V);                                          \
+    if (UNLIKELY(nread > max_header_size)) {                         \
+      SET_ERRNO(SPE_HEADER_OVERFLOW);                                \
+      goto error;                                                    \
+    }                                                                \
   }                                                                  \
 } while (0)
 
@@ -169,6 +256,45 @@ static const char *method_strings[] =
  *                    | "/" | "[" | "]" | "?" | "="
  *                    | "{" | "}" | SP | HT
  */
+/* The known methods followed by SP as the first 8 bytes of a Request-Line
+ * read at once, in the order of enum sip_method. 'length' is the one of the
+ * method, the rest of the longer ones is compared after the word. */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define BYTE_AT(c, i)  ((uint64_t) (unsigned char) (c) << (56 - 8 * (i)))
+# define WORD_MASK(n)   (~(uint64_t) 0 << (64 - 8 * (n)))
+#else
+# define BYTE_AT(c, i)  ((uint64_t) (unsigned char) (c) << (8 * (i)))
+# define WORD_MASK(n)   (~(uint64_t) 0 >> (64 - 8 * (n)))
+#endif
+#define METHOD_WORD(a, b, c, d, e, f, g, h)                          \
+  (BYTE_AT(a, 0) | BYTE_AT(b, 1) | BYTE_AT(c, 2) | BYTE_AT(d, 3) |   \
+   BYTE_AT(e, 4) | BYTE_AT(f, 5) | BYTE_AT(g, 6) | BYTE_AT(h, 7))
+
+static const struct {
+  uint64_t word;
+  uint64_t mask;
+  unsigned int length;
+} method_words[] = {
+  { METHOD_WORD('A','C','K',' ', 0 , 0 , 0 , 0 ), WORD_MASK(4), 3 },
+  { METHOD_WORD('B','Y','E',' ', 0 , 0 , 0 , 0 ), WORD_MASK(4), 3 },
+  { METHOD_WORD('C','A','N','C','E','L',' ', 0 ), WORD_MASK(7), 6 },
+  { METHOD_WORD('I','N','F','O',' ', 0 , 0 , 0 ), WORD_MASK(5), 4 },
+  { METHOD_WORD('I','N','V','I','T','E',' ', 0 ), WORD_MASK(7), 6 },
+  { METHOD_WORD('M','E','S','S','A','G','E',' '), WORD_MASK(8), 7 },
+  { METHOD_WORD('N','O','T','I','F','Y',' ', 0 ), WORD_MASK(7), 6 },
+  { METHOD_WORD('O','P','T','I','O','N','S',' '), WORD_MASK(8), 7 },
+  { METHOD_WORD('P','R','A','C','K',' ', 0 , 0 ), WORD_MASK(6), 5 },
+  { METHOD_WORD('P','U','B','L','I','S','H',' '), WORD_MASK(8), 7 },
+  { METHOD_WORD('R','E','F','E','R',' ', 0 , 0 ), WORD_MASK(6), 5 },
+  { METHOD_WORD('R','E','G','I','S','T','E','R'), WORD_MASK(8), 8 },
+  { METHOD_WORD('S','U','B','S','C','R','I','B'), WORD_MASK(8), 9 },
+  { METHOD_WORD('U','P','D','A','T','E',' ', 0 ), WORD_MASK(7), 6 }
+};
+
+#undef METHOD_WORD
+#undef WORD_MASK
+#undef BYTE_AT
+
 static const char tokens[256] = {
 /*   0 nul    1 soh    2 stx    3 etx    4 eot    5 enq    6 ack    7 bel  */
         0,       0,       0,       0,       0,       0,       0,       0,
@@ -445,8 +571,10 @@ enum http_host_state
 #define IS_HEADER_CHAR(ch)                                                     \
   (ch == CR || ch == LF || ch == 9 || ((unsigned char)ch > 31 && ch != 127))
 
-/*#define start_state (parser->type == HTTP_REQUEST ? s_start_req : s_start_res)*/
-#define start_state (s_start_req_or_res)
+#define START_STATE(T)                                               \
+  ((T) == SIP_REQUEST ? s_start_req :                                \
+   ((T) == SIP_RESPONSE ? s_start_res : s_start_req_or_res))
+#define start_state START_STATE(type)
 
 
 #if SIP_PARSER_STRICT
@@ -476,6 +604,183 @@ static struct {
 
 int sip_message_needs_eof(const sip_parser *parser);
 
+/* The followings keep the parts of a message in sip_parse_result for
+ * sip_parser_pull(). Notifications return nonzero to stop parsing, data
+ * ones an errno value. 'pos' is the position of 'at' for the caller. */
+
+static ALWAYS_INLINE int
+pull_message_begin (sip_parse_result *result, uint32_t pos)
+{
+  result->flags |= SR_MESSAGE_BEGIN;
+  result->message_begin_pos = pos;
+  return 0;
+}
+
+static ALWAYS_INLINE int
+pull_headers_complete (sip_parse_result *result, uint32_t pos)
+{
+  result->flags |= SR_HEADERS_COMPLETE;
+  result->headers_complete_pos = pos;
+  return 0;
+}
+
+static ALWAYS_INLINE int
+pull_message_complete (sip_parse_result *result, uint32_t pos)
+{
+  result->flags |= SR_MESSAGE_COMPLETE;
+  result->message_complete_pos = pos;
+  return 1;
+}
+
+static ALWAYS_INLINE void
+pull_span (sip_span *span, uint32_t pos, uint32_t length)
+{
+  if (span->start == 0) {
+    span->start = pos;
+  }
+  span->length += length;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_method (sip_parse_result *result, const char *at, uint32_t pos,
+             uint32_t length, enum state s)
+{
+  (void) at;
+  (void) pos;
+  (void) s;
+  /* the 'S' may be of the previous data, see s_req_or_res_S */
+  result->method.start = result->message_begin_pos;
+  result->method.length += length;
+  return SPE_OK;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_url (sip_parse_result *result, const char *at, uint32_t pos,
+          uint32_t length, enum state s)
+{
+  (void) at;
+  (void) s;
+  pull_span(&result->url, pos, length);
+  return SPE_OK;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_status (sip_parse_result *result, const char *at, uint32_t pos,
+             uint32_t length, enum state s)
+{
+  (void) at;
+  (void) s;
+  result->flags |= SR_STATUS;
+  pull_span(&result->status, pos, length);
+  return SPE_OK;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_body (sip_parse_result *result, const char *at, uint32_t pos,
+           uint32_t length, enum state s)
+{
+  (void) at;
+  pull_span(&result->body, pos, length);
+  if (s == s_message_done) {
+    result->flags |= SR_BODY_FINAL;
+  }
+  return SPE_OK;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_header_field (sip_parse_result *result, const char *at, uint32_t pos,
+                   uint32_t length, enum state s)
+{
+  sip_header_span *header;
+
+  (void) s;
+
+  /* a header-name may come in parts when the data is received in parts */
+  if (!(result->flags & SR_IN_FIELD)) {
+    if (UNLIKELY(result->num_headers == result->max_headers)) {
+      return SPE_HEADER_OVERFLOW;
+    }
+    header = &result->headers[result->num_headers++];
+    header->field.start = pos;
+    header->field.length = 0;
+    header->value.start = 0;
+    header->value.length = 0;
+    header->folded = 0;
+    result->flags |= SR_IN_FIELD;
+  } else {
+    header = &result->headers[result->num_headers - 1];
+  }
+
+  /* spaces between header-name and ':' are not a part of the name */
+  while (length > 0 && at[length - 1] == ' ') {
+    length--;
+  }
+  header->field.length += length;
+  return SPE_OK;
+}
+
+static ALWAYS_INLINE enum sip_errno
+pull_header_value (sip_parse_result *result, const char *at, uint32_t pos,
+                   uint32_t length, enum state s)
+{
+  sip_header_span *header = &result->headers[result->num_headers - 1];
+
+  (void) at;
+  (void) s;
+
+  if (header->value.start == 0) {
+    header->value.start = pos;
+  } else {
+    /* a continuation line, the value covers the CRLF and the LWS before */
+    if (pos != header->value.start + header->value.length) {
+      header->folded = 1;
+    }
+    header->value.length = pos - header->value.start;
+  }
+  header->value.length += length;
+  result->flags &= ~SR_IN_FIELD;
+  return SPE_OK;
+}
+
+/* Is the Request-Line at 'p' of method 'm'? Only when the method and the SP
+ * after it are all before 'end' */
+static ALWAYS_INLINE int
+method_word_is (const char *p, const char *end, uint64_t word,
+                enum sip_method m)
+{
+  unsigned int length = method_words[m].length;
+
+  if ((word & method_words[m].mask) != method_words[m].word) {
+    return 0;
+  }
+  return length < 8 ||
+    ((size_t) (end - p) > length &&
+     memcmp(p + 8, method_strings[m] + 8, length - 8) == 0 &&
+     p[length] == ' ');
+}
+
+/* The known method of the Request-Line at 'p' from the first 8 bytes, 'm'
+ * is the one of the first character, or the next one sharing it with 'm'.
+ * -1 if it is neither or not all of it is before 'end' */
+static ALWAYS_INLINE int
+method_word_match (const char *p, const char *end, enum sip_method m)
+{
+  uint64_t word;
+
+  if (end - p < 8) {
+    return -1;
+  }
+  memcpy(&word, p, sizeof(word));
+  if (method_word_is(p, end, word, m)) {
+    return m;
+  }
+  if ((m == SIP_INFO || m == SIP_PRACK || m == SIP_REFER) &&
+      method_word_is(p, end, word, (enum sip_method) (m + 1))) {
+    return m + 1;
+  }
+  return -1;
+}
+
 #if 0
 /* Our URL parser.
  *
@@ -637,33 +942,83 @@ parse_url_char(enum state s, const char ch)
 }
 #endif
 
-size_t sip_parser_execute (sip_parser *parser,
-                           const sip_parser_settings *settings,
-                           const char *data,
-                           size_t len)
+/* Either 'settings' or, when 'pull', 'result' is used. 'pull', 'type',
+ * 'datagram' and 'lenient' are constants in the parser variants below so
+ * each gets its own copy without the checks of the others */
+static EXECUTE_INLINE size_t
+sip_parser_execute_ (sip_parser *parser,
+                     const sip_parser_settings *settings,
+                     sip_parse_result *result,
+                     const int pull,
+                     const enum sip_parser_type type,
+                     const int datagram,
+                     const unsigned int lenient,
+                     const char *data,
+                     size_t len)
 {
   char c, ch;
   /*int8_t unhex_val;*/
   const char *p = data;
   const char *header_field_mark = 0;
   const char *header_value_mark = 0;
+  const char *method_mark = 0;
   const char *url_mark = 0;
   const char *body_mark = 0;
   const char *status_mark = 0;
   enum state p_state = (enum state) parser->state;
-  const unsigned int lenient = parser->lenient_http_headers;
+  const sip_parser_limits *limits = parser->limits;
+  const uint32_t max_header_size = limits->max_header_size;
+  const int count_header = !datagram || len > max_header_size;
   uint32_t nread = parser->nread;
+#if SIP_PARSER_COMPUTED_GOTO
+  /* the states without a label go to l_other_state, the others override it */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+  static const void *const dispatch[s_message_done + 1] = {
+    [0 ... s_message_done] = &&l_other_state,
+#define XX(S) [S] = &&l_##S,
+    XX(s_dead)
+    XX(s_start_req_or_res) XX(s_req_or_res_S) XX(s_start_res)
+    XX(s_res_S) XX(s_res_SI) XX(s_res_SIP) XX(s_res_sip_major) XX(s_res_sip_dot)
+    XX(s_res_sip_minor) XX(s_res_sip_end) XX(s_res_first_status_code)
+    XX(s_res_status_code) XX(s_res_status_start) XX(s_res_status)
+    XX(s_res_line_almost_done)
+    XX(s_start_req) XX(s_req_method) XX(s_req_spaces_before_url) XX(s_req_url)
+    XX(s_req_sip_start) XX(s_req_sip_S) XX(s_req_sip_SI) XX(s_req_sip_SIP)
+    XX(s_req_sip_major) XX(s_req_sip_dot) XX(s_req_sip_minor) XX(s_req_sip_end)
+    XX(s_req_line_almost_done)
+    XX(s_header_field_start) XX(s_header_field) XX(s_header_field_discard_ws)
+    XX(s_header_value_discard_ws) XX(s_header_value_discard_ws_almost_done)
+    XX(s_header_value_discard_lws) XX(s_header_value_start) XX(s_header_value)
+    XX(s_header_value_lws) XX(s_header_almost_done)
+    XX(s_headers_almost_done) XX(s_headers_done)
+    XX(s_body_identity) XX(s_body_identity_eof) XX(s_message_done)
+#undef XX
+  };
+#pragma GCC diagnostic pop
+#endif
 
-  /* Modifications to access the current position from outside */
-  parser->parsing_data = data;
-  parser->parsing_len = len;
-  parser->position = &p;
+  /* Modifications to access the current position from outside, only the
+   * callbacks need it */
+  if (!pull) {
+    parser->parsing_data = data;
+    parser->parsing_len = len;
+    parser->position = &p;
+  }
 
   /* We're in an error state. Don't bother doing anything. */
   if (SIP_PARSER_ERRNO(parser) != SPE_OK) {
     return 0;
   }
 
+  /* A datagram is a new message whatever is left from the previous one */
+  if (datagram) {
+    UPDATE_STATE(start_state);
+    parser->state = CURRENT_STATE();
+    parser->nread = nread = 0;
+    parser->nlimit = 0;
+  }
+
   if (len == 0) {
     switch (CURRENT_STATE()) {
       case s_body_identity_eof:
@@ -704,6 +1059,12 @@ size_t sip_parser_execute (sip_parser *parser,
   case s_req_fragment:
     url_mark = data;
     break;*/
+  case s_req_method:
+    method_mark = data;
+    break;
+  case s_req_url:
+    url_mark = data;
+    break;
   case s_res_status:
     status_mark = data;
     break;
@@ -718,9 +1079,10 @@ size_t sip_parser_execute (sip_parser *parser,
       COUNT_HEADER_SIZE(1);
 
 reexecute:
+    DISPATCH();
     switch (CURRENT_STATE()) {
 
-      case s_dead:
+      CASE_STATE(s_dead):
         /* TODO: Seems that the following code is not valid for SIP 
                  (no 'Connection' header defined). Modify the code-block
                  below for this purpose. */
@@ -728,20 +1090,23 @@ reexecute:
          * the parser will error out if it reads another message
          */
         if (LIKELY(ch == CR || ch == LF))
-          break;
+          NEXT_CHAR();
 
         SET_ERRNO(SPE_CLOSED_CONNECTION);
         goto error;
 
-      case s_start_req_or_res:
+      CASE_STATE(s_start_req_or_res):
       {
         if (ch == CR || ch == LF)
-          break;
+          NEXT_CHAR();
         parser->flags = 0;
         parser->extra_flags = 0;
         parser->content_length = ULLONG_MAX;
+        parser->nlimit = 0;
 
-        if (ch == 'S') {
+        /* "SI" of "SIP/" is a response, "S" at the end of the data is
+         * left to s_req_or_res_S */
+        if (ch == 'S' && (p + 1 == data + len || p[1] == 'I')) {
           UPDATE_STATE(s_req_or_res_S);
 
           CALLBACK_NOTIFY(message_begin);
@@ -751,33 +1116,35 @@ reexecute:
           REEXECUTE();
         }
 
-        break;
+        NEXT_CHAR();
       }
 
-      case s_req_or_res_S:
+      CASE_STATE(s_req_or_res_S):
         if (ch == 'I') {
           parser->type = SIP_RESPONSE;
           UPDATE_STATE(s_res_SI);
-        } else {
-          if (UNLIKELY(ch != 'U')) {
-            SET_ERRNO(SPE_INVALID_CONSTANT);
-            goto error;
-          }
-
-          parser->type = SIP_REQUEST;
-          parser->method = SIP_SUBSCRIBE;
-          parser->index = 2;
-          UPDATE_STATE(s_req_method);
+          NEXT_CHAR();
         }
-        break;
 
-      case s_start_res:
+        /* a method starting with the 'S' at the end of the previous data,
+         * it is not there any more: the 'S' is given by itself, its
+         * position is the begin of the message */
+        parser->type = SIP_REQUEST;
+        parser->method = SIP_SUBSCRIBE;
+        parser->index = 1;
+        UPDATE_STATE(s_req_method);
+        CALLBACK_DATA_AT_(method, "S", result->message_begin_pos, 1, p - data);
+        MARK(method);
+        REEXECUTE();
+
+      CASE_STATE(s_start_res):
       {
         if (ch == CR || ch == LF)
-          break;
+          NEXT_CHAR();
         parser->flags = 0;
         parser->extra_flags = 0;
         parser->content_length = ULLONG_MAX;
+        parser->nlimit = 0;
 
         if (ch == 'S') {
           UPDATE_STATE(s_res_S);
@@ -787,25 +1154,25 @@ reexecute:
         }
 
         CALLBACK_NOTIFY(message_begin);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_S:
+      CASE_STATE(s_res_S):
         STRICT_CHECK(ch != 'I');
         UPDATE_STATE(s_res_SI);
-        break;
+        NEXT_CHAR();
 
-      case s_res_SI:
+      CASE_STATE(s_res_SI):
         STRICT_CHECK(ch != 'P');
         UPDATE_STATE(s_res_SIP);
-        break;
+        NEXT_CHAR();
 
-      case s_res_SIP:
+      CASE_STATE(s_res_SIP):
         STRICT_CHECK(ch != '/');
         UPDATE_STATE(s_res_sip_major);
-        break;
+        NEXT_CHAR();
 
-      case s_res_sip_major:
+      CASE_STATE(s_res_sip_major):
         if (UNLIKELY(!IS_DIGIT(ch))) {
           SET_ERRNO(SPE_INVALID_VERSION);
           goto error;
@@ -813,9 +1180,9 @@ reexecute:
 
         parser->sip_major = ch - '0';
         UPDATE_STATE(s_res_sip_dot);
-        break;
+        NEXT_CHAR();
 
-      case s_res_sip_dot:
+      CASE_STATE(s_res_sip_dot):
       {
         if (UNLIKELY(ch != '.')) {
           SET_ERRNO(SPE_INVALID_VERSION);
@@ -823,10 +1190,10 @@ reexecute:
         }
 
         UPDATE_STATE(s_res_sip_minor);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_sip_minor:
+      CASE_STATE(s_res_sip_minor):
         if (UNLIKELY(!IS_DIGIT(ch))) {
           SET_ERRNO(SPE_INVALID_VERSION);
           goto error;
@@ -834,9 +1201,9 @@ reexecute:
 
         parser->sip_minor = ch - '0';
         UPDATE_STATE(s_res_sip_end);
-        break;
+        NEXT_CHAR();
 
-      case s_res_sip_end:
+      CASE_STATE(s_res_sip_end):
       {
         if (UNLIKELY(ch != ' ')) {
           SET_ERRNO(SPE_INVALID_VERSION);
@@ -844,14 +1211,14 @@ reexecute:
         }
 
         UPDATE_STATE(s_res_first_status_code);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_first_status_code:
+      CASE_STATE(s_res_first_status_code):
       {
         if (!IS_DIGIT(ch)) {
           if (ch == ' ') {
-            break;
+            NEXT_CHAR();
           }
 
           SET_ERRNO(SPE_INVALID_STATUS);
@@ -859,10 +1226,10 @@ reexecute:
         }
         parser->status_code = ch - '0';
         UPDATE_STATE(s_res_status_code);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_status_code:
+      CASE_STATE(s_res_status_code):
       {
         if (!IS_DIGIT(ch)) {
           switch (ch) {
@@ -878,7 +1245,7 @@ reexecute:
               SET_ERRNO(SPE_INVALID_STATUS);
               goto error;
           }
-          break;
+          NEXT_CHAR();
         }
 
         parser->status_code *= 10;
@@ -889,10 +1256,10 @@ reexecute:
           goto error;
         }
 
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_status_start:
+      CASE_STATE(s_res_status_start):
       {
         MARK(status);
         UPDATE_STATE(s_res_status);
@@ -901,43 +1268,43 @@ reexecute:
         if (ch == CR || ch == LF)
           REEXECUTE();
 
-        break;
+        NEXT_CHAR();
       }
 
-      case s_res_status:
+      CASE_STATE(s_res_status):
         if (ch == CR) {
           UPDATE_STATE(s_res_line_almost_done);
           CALLBACK_DATA(status);
-          break;
+          NEXT_CHAR();
         }
 
         if (ch == LF) {
           UPDATE_STATE(s_header_field_start);
           CALLBACK_DATA(status);
-          break;
+          NEXT_CHAR();
         }
 
-        break;
+        NEXT_CHAR();
 
-      case s_res_line_almost_done:
+      CASE_STATE(s_res_line_almost_done):
         STRICT_CHECK(ch != LF);
         UPDATE_STATE(s_header_field_start);
-        break;
+        NEXT_CHAR();
 
-      case s_start_req:
+      CASE_STATE(s_start_req):
       {
         if (ch == CR || ch == LF)
-          break;
+          NEXT_CHAR();
         parser->flags = 0;
         parser->extra_flags = 0;
         parser->content_length = ULLONG_MAX;
+        parser->nlimit = 0;
 
-        if (UNLIKELY(!IS_ALPHA(ch))) {
+        if (UNLIKELY(!STRICT_TOKEN(ch))) {
           SET_ERRNO(SPE_INVALID_METHOD);
           goto error;
         }
 
-        parser->method = (enum sip_method) 0;
         parser->index = 1;
         switch (ch) {
           case 'A': parser->method = SIP_ACK; break;
@@ -951,71 +1318,99 @@ reexecute:
           case 'R': parser->method = SIP_REFER; /* or REGISTER */ break;
           case 'S': parser->method = SIP_SUBSCRIBE; break;
           case 'U': parser->method = SIP_UPDATE; break;
-          default:
-            SET_ERRNO(SPE_INVALID_METHOD);
-            goto error;
+          default: parser->method = SIP_EXTENSION; break;
         }
         UPDATE_STATE(s_req_method);
+        MARK(method);
 
         CALLBACK_NOTIFY(message_begin);
 
-        break;
+        /* A known method is matched at once when it is all here */
+        if (parser->method != SIP_EXTENSION) {
+          int m = method_word_match(p, data + len,
+                                    (enum sip_method) parser->method);
+          if (m >= 0) {
+            parser->method = m;
+            COUNT_HEADER_SIZE(method_words[m].length);
+            p += method_words[m].length;
+            UPDATE_STATE(s_req_spaces_before_url);
+            CALLBACK_DATA(method);
+          }
+        }
+
+        NEXT_CHAR();
       }
 
-      case s_req_method:
+      CASE_STATE(s_req_method):
       {
         const char *matcher;
-        if (UNLIKELY(ch == '\0')) {
+
+        if (ch == ' ') {
+          /* a known method cut short is an extension */
+          if (parser->method != SIP_EXTENSION &&
+              method_strings[parser->method][parser->index] != '\0') {
+            parser->method = SIP_EXTENSION;
+          }
+          UPDATE_STATE(s_req_spaces_before_url);
+          CALLBACK_DATA(method);
+          NEXT_CHAR();
+        }
+
+        if (UNLIKELY(!STRICT_TOKEN(ch))) {
           SET_ERRNO(SPE_INVALID_METHOD);
           goto error;
         }
 
+        if (parser->method == SIP_EXTENSION) {
+          NEXT_CHAR();
+        }
+
         matcher = method_strings[parser->method];
-        if (ch == ' ' && matcher[parser->index] == '\0') {
-          UPDATE_STATE(s_req_spaces_before_url);
-        } else if (ch == matcher[parser->index]) {
-          ; /* nada */
-        } else if ((ch >= 'A' && ch <= 'Z') || ch == '-') {
+        if (ch == matcher[parser->index]) {
+          ++parser->index;
+          NEXT_CHAR();
+        }
 
-          switch (parser->method << 16 | parser->index << 8 | ch) {
+        switch (parser->method << 16 | parser->index << 8 | ch) {
 #define XX(meth, pos, ch, new_meth) \
-            case (SIP_##meth << 16 | pos << 8 | ch): \
-              parser->method = SIP_##new_meth; break;
+          case (SIP_##meth << 16 | pos << 8 | ch): \
+            parser->method = SIP_##new_meth; ++parser->index; break;
 
-            XX(INFO,      2, 'V', INVITE)
-            XX(PRACK,     1, 'U', PUBLISH)
-            XX(REFER,     2, 'G', REGISTER)
+          XX(INFO,      2, 'V', INVITE)
+          XX(PRACK,     1, 'U', PUBLISH)
+          XX(REFER,     2, 'G', REGISTER)
 #undef XX
-            default:
-              SET_ERRNO(SPE_INVALID_METHOD);
-              goto error;
-          }
-        } else {
-          SET_ERRNO(SPE_INVALID_METHOD);
-          goto error;
+          default:
+            parser->method = SIP_EXTENSION;
+            break;
         }
-
-        ++parser->index;
-        break;
+        NEXT_CHAR();
       }
 
-      case s_req_spaces_before_url:
+      CASE_STATE(s_req_spaces_before_url):
       {
-        if (ch == ' ') break;
+        if (ch == ' ') NEXT_CHAR();
 
         MARK(url);
         UPDATE_STATE(s_req_url);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_req_url:
+      CASE_STATE(s_req_url):
       {
         if (ch == ' ')
         {
+          /* the bytes of the previous data are in 'nlimit' */
+          if (UNLIKELY(parser->nlimit + (uint64_t) (p - url_mark) >
+                       limits->max_url_length)) {
+            SET_ERRNO(SPE_URL_OVERFLOW);
+            goto error;
+          }
+          parser->nlimit = 0;
           UPDATE_STATE(s_req_sip_start);
           CALLBACK_DATA(url);
         }
-        break;
+        NEXT_CHAR();
       }
 
 #if 0
@@ -1074,7 +1469,7 @@ reexecute:
         break;
       }
 #endif
-      case s_req_sip_start:
+      CASE_STATE(s_req_sip_start):
         switch (ch) {
           case ' ':
             break;
@@ -1085,24 +1480,24 @@ reexecute:
             SET_ERRNO(SPE_INVALID_CONSTANT);
             goto error;
         }
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_S:
+      CASE_STATE(s_req_sip_S):
         STRICT_CHECK(ch != 'I');
         UPDATE_STATE(s_req_sip_SI);
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_SI:
+      CASE_STATE(s_req_sip_SI):
         STRICT_CHECK(ch != 'P');
         UPDATE_STATE(s_req_sip_SIP);
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_SIP:
+      CASE_STATE(s_req_sip_SIP):
         STRICT_CHECK(ch != '/');
         UPDATE_STATE(s_req_sip_major);
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_major:
+      CASE_STATE(s_req_sip_major):
         if (UNLIKELY(!IS_DIGIT(ch))) {
           SET_ERRNO(SPE_INVALID_VERSION);
           goto error;
@@ -1110,9 +1505,9 @@ reexecute:
 
         parser->sip_major = ch - '0';
         UPDATE_STATE(s_req_sip_dot);
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_dot:
+      CASE_STATE(s_req_sip_dot):
       {
         if (UNLIKELY(ch != '.')) {
           SET_ERRNO(SPE_INVALID_VERSION);
@@ -1120,10 +1515,10 @@ reexecute:
         }
 
         UPDATE_STATE(s_req_sip_minor);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_req_sip_minor:
+      CASE_STATE(s_req_sip_minor):
         if (UNLIKELY(!IS_DIGIT(ch))) {
           SET_ERRNO(SPE_INVALID_VERSION);
           goto error;
@@ -1131,18 +1526,18 @@ reexecute:
 
         parser->sip_minor = ch - '0';
         UPDATE_STATE(s_req_sip_end);
-        break;
+        NEXT_CHAR();
 
-      case s_req_sip_end:
+      CASE_STATE(s_req_sip_end):
       {
         if (ch == CR) {
           UPDATE_STATE(s_req_line_almost_done);
-          break;
+          NEXT_CHAR();
         }
 
         if (ch == LF) {
           UPDATE_STATE(s_header_field_start);
-          break;
+          NEXT_CHAR();
         }
 
         SET_ERRNO(SPE_INVALID_VERSION);
@@ -1151,7 +1546,7 @@ reexecute:
       }
 
       /* end of request line */
-      case s_req_line_almost_done:
+      CASE_STATE(s_req_line_almost_done):
       {
         if (UNLIKELY(ch != LF)) {
           SET_ERRNO(SPE_LF_EXPECTED);
@@ -1159,14 +1554,14 @@ reexecute:
         }
 
         UPDATE_STATE(s_header_field_start);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_field_start:
+      CASE_STATE(s_header_field_start):
       {
         if (ch == CR) {
           UPDATE_STATE(s_headers_almost_done);
-          break;
+          NEXT_CHAR();
         }
 
         if (ch == LF) {
@@ -1183,9 +1578,15 @@ reexecute:
           goto error;
         }
 
+        if (UNLIKELY(++parser->nlimit > limits->max_headers)) {
+          SET_ERRNO(SPE_HEADER_OVERFLOW);
+          goto error;
+        }
+
         MARK(header_field);
 
         parser->index = 0;
+        parser->flags &= ~F_FOLDED;
         UPDATE_STATE(s_header_field);
 
         switch (c) {
@@ -1201,10 +1602,10 @@ reexecute:
             parser->header_state = h_general;
             break;
         }
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_field:
+      CASE_STATE(s_header_field):
       {
         const char* start = p;
         for (; p != data + len; p++) {
@@ -1278,7 +1679,7 @@ reexecute:
         if (p == data + len) {
           --p;
           COUNT_HEADER_SIZE(p - start);
-          break;
+          NEXT_CHAR();
         }
 
         COUNT_HEADER_SIZE(p - start);
@@ -1290,7 +1691,7 @@ reexecute:
           }
           UPDATE_STATE(s_header_value_discard_ws);
           CALLBACK_DATA(header_field);
-          break;
+          NEXT_CHAR();
         }
 
         /* (DY) */
@@ -1301,39 +1702,39 @@ reexecute:
           }
           UPDATE_STATE(s_header_field_discard_ws);
           CALLBACK_DATA(header_field);
-          break;
+          NEXT_CHAR();
         }
 
         SET_ERRNO(SPE_INVALID_HEADER_TOKEN);
         goto error;
       } /* case */
 
-      case s_header_field_discard_ws:
-        if (ch == ' ' || ch == '\t') break;
+      CASE_STATE(s_header_field_discard_ws):
+        if (ch == ' ' || ch == '\t') NEXT_CHAR();
 
         if (ch == ':') {
           UPDATE_STATE(s_header_value_discard_ws);
           //CALLBACK_DATA(header_field);
-          break;
+          NEXT_CHAR();
         }
-        break;
+        NEXT_CHAR();
 
-      case s_header_value_discard_ws:
-        if (ch == ' ' || ch == '\t') break;
+      CASE_STATE(s_header_value_discard_ws):
+        if (ch == ' ' || ch == '\t') NEXT_CHAR();
 
         if (ch == CR) {
           UPDATE_STATE(s_header_value_discard_ws_almost_done);
-          break;
+          NEXT_CHAR();
         }
 
         if (ch == LF) {
           UPDATE_STATE(s_header_value_discard_lws);
-          break;
+          NEXT_CHAR();
         }
 
-        /* fall through */
+        FALLTHROUGH;
 
-      case s_header_value_start:
+      CASE_STATE(s_header_value_start):
       {
         MARK(header_value);
 
@@ -1367,10 +1768,10 @@ reexecute:
             parser->header_state = h_general;
             break;
         }
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_value:
+      CASE_STATE(s_header_value):
       {
         const char* start = p;
         enum header_states h_state = (enum header_states) parser->header_state;
@@ -1472,10 +1873,10 @@ reexecute:
           --p;
 
         COUNT_HEADER_SIZE(p - start);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_almost_done:
+      CASE_STATE(s_header_almost_done):
       {
         if (UNLIKELY(ch != LF)) {
           SET_ERRNO(SPE_LF_EXPECTED);
@@ -1483,12 +1884,13 @@ reexecute:
         }
 
         UPDATE_STATE(s_header_value_lws);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_value_lws:
+      CASE_STATE(s_header_value_lws):
       {
         if (ch == ' ' || ch == '\t') {
+          parser->flags |= F_FOLDED;
           if (parser->header_state == h_content_length_num) {
               /* treat obsolete line folding as space */
               parser->header_state = h_content_length_ws;
@@ -1500,18 +1902,18 @@ reexecute:
         REEXECUTE();
       }
 
-      case s_header_value_discard_ws_almost_done:
+      CASE_STATE(s_header_value_discard_ws_almost_done):
       {
         STRICT_CHECK(ch != LF);
         UPDATE_STATE(s_header_value_discard_lws);
-        break;
+        NEXT_CHAR();
       }
 
-      case s_header_value_discard_lws:
+      CASE_STATE(s_header_value_discard_lws):
       {
         if (ch == ' ' || ch == '\t') {
           UPDATE_STATE(s_header_value_discard_ws);
-          break;
+          NEXT_CHAR();
         } else {
           switch (parser->header_state) {
             case h_content_length:
@@ -1531,9 +1933,14 @@ reexecute:
         }
       }
 
-      case s_headers_almost_done:
+      CASE_STATE(s_headers_almost_done):
       {
         STRICT_CHECK(ch != LF);
+        if (UNLIKELY(parser->content_length != ULLONG_MAX &&
+                     parser->content_length > limits->max_body_size)) {
+          SET_ERRNO(SPE_BODY_OVERFLOW);
+          goto error;
+        }
         UPDATE_STATE(s_headers_done);
         /* Here we call the headers_complete callback. This is somewhat
          * different than other callbacks because if the user returns 1, we
@@ -1544,7 +1951,9 @@ reexecute:
          * We'd like to use CALLBACK_NOTIFY_NOADVANCE() here but we cannot, so
          * we have to simulate it by handling a change in errno below.
          */
-        if (settings->on_headers_complete) {
+        if (pull) {
+          pull_headers_complete(result, (uint32_t) (p - data) + result->offset);
+        } else if (settings->on_headers_complete) {
           switch (settings->on_headers_complete(parser)) {
             case 0:
               break;
@@ -1570,7 +1979,7 @@ reexecute:
         REEXECUTE();
       }
 
-      case s_headers_done:
+      CASE_STATE(s_headers_done):
       {
         STRICT_CHECK(ch != LF);
 
@@ -1610,10 +2019,10 @@ reexecute:
           }
         }
 
-        break;
+        NEXT_CHAR();
       }
 
-      case s_body_identity:
+      CASE_STATE(s_body_identity):
       {
         uint64_t to_read = MIN(parser->content_length,
                                (uint64_t) ((data + len) - p));
@@ -1646,31 +2055,34 @@ reexecute:
           REEXECUTE();
         }
 
-        break;
+        NEXT_CHAR();
       }
 
       /* read until EOF */
-      case s_body_identity_eof:
+      CASE_STATE(s_body_identity_eof):
         MARK(body);
         p = data + len - 1;
 
-        break;
+        NEXT_CHAR();
 
-      case s_message_done:
+      CASE_STATE(s_message_done):
         UPDATE_STATE(NEW_MESSAGE());
         CALLBACK_NOTIFY(message_complete);
         if (parser->upgrade) {
           /* Exit, the rest of the message is in a different protocol. */
           RETURN((p - data) + 1);
         }
-        break;
+        NEXT_CHAR();
 
-      default:
+      CASE_OTHER_STATE:
         assert(0 && "unhandled state");
         SET_ERRNO(SPE_INVALID_INTERNAL_STATE);
         goto error;
     }
   }
+#if SIP_PARSER_COMPUTED_GOTO
+parsed:
+#endif
 
   /* Run callbacks for any marks that we have leftover after we ran out of
    * bytes. There should be at most one of these set, so it's OK to invoke
@@ -1684,12 +2096,17 @@ reexecute:
 
   assert(((header_field_mark ? 1 : 0) +
           (header_value_mark ? 1 : 0) +
+          (method_mark ? 1 : 0) +
           (url_mark ? 1 : 0)  +
           (body_mark ? 1 : 0) +
           (status_mark ? 1 : 0)) <= 1);
 
   CALLBACK_DATA_NOADVANCE(header_field);
   CALLBACK_DATA_NOADVANCE(header_value);
+  CALLBACK_DATA_NOADVANCE(method);
+  if (url_mark) {
+    parser->nlimit += (uint32_t) (p - url_mark);
+  }
   CALLBACK_DATA_NOADVANCE(url);
   CALLBACK_DATA_NOADVANCE(body);
   CALLBACK_DATA_NOADVANCE(status);
@@ -1704,6 +2121,105 @@ error:
   RETURN(p - data);
 }
 
+#if SIP_PARSER_VARIANTS
+/* The parser variants, one for each 'pull', 'type' (SIP_REQUEST,
+ * SIP_RESPONSE, SIP_BOTH in that order), 'datagram' and 'lenient'. The
+ * entry points call the one of 'parser->variant' */
+#define DEFINE_VARIANT(PULL, TYPE, DATAGRAM, LENIENT)                  \
+static size_t                                                          \
+sip_parser_variant_##PULL##TYPE##DATAGRAM##LENIENT (                   \
+  sip_parser *parser, const sip_parser_settings *settings,             \
+  sip_parse_result *result, const char *data, size_t len)              \
+{                                                                      \
+  return sip_parser_execute_(parser, settings, result, PULL,           \
+                             (enum sip_parser_type) TYPE, DATAGRAM,    \
+                             LENIENT, data, len);                      \
+}
+
+#define DEFINE_VARIANTS(PULL, TYPE)                                    \
+  DEFINE_VARIANT(PULL, TYPE, 0, 0)                                     \
+  DEFINE_VARIANT(PULL, TYPE, 0, 1)                                     \
+  DEFINE_VARIANT(PULL, TYPE, 1, 0)                                     \
+  DEFINE_VARIANT(PULL, TYPE, 1, 1)
+
+DEFINE_VARIANTS(0, 0)
+DEFINE_VARIANTS(0, 1)
+DEFINE_VARIANTS(0, 2)
+DEFINE_VARIANTS(1, 0)
+DEFINE_VARIANTS(1, 1)
+DEFINE_VARIANTS(1, 2)
+
+#define VARIANTS_OF(PULL, TYPE)                                        \
+  { sip_parser_variant_##PULL##TYPE##00,                               \
+    sip_parser_variant_##PULL##TYPE##01 },                             \
+  { sip_parser_variant_##PULL##TYPE##10,                               \
+    sip_parser_variant_##PULL##TYPE##11 }
+
+typedef size_t (*sip_parser_variant_cb) (sip_parser*,
+                                         const sip_parser_settings*,
+                                         sip_parse_result*,
+                                         const char*,
+                                         size_t);
+
+/* [pull][type * 2 + datagram][lenient] */
+static const sip_parser_variant_cb sip_parser_variants[2][6][2] = {
+  { VARIANTS_OF(0, 0),
+    VARIANTS_OF(0, 1),
+    VARIANTS_OF(0, 2) },
+  { VARIANTS_OF(1, 0),
+    VARIANTS_OF(1, 1),
+    VARIANTS_OF(1, 2) }
+};
+
+#undef VARIANTS_OF
+#undef DEFINE_VARIANTS
+#undef DEFINE_VARIANT
+
+# define EXECUTE_VARIANT(PULL, SETTINGS, RESULT)                       \
+  sip_parser_variants[PULL][parser->variant][parser->lenient_http_headers] \
+    (parser, SETTINGS, RESULT, data, len)
+#else
+# define EXECUTE_VARIANT(PULL, SETTINGS, RESULT)                       \
+  sip_parser_execute_(parser, SETTINGS, RESULT, PULL,                  \
+                      (enum sip_parser_type) (parser->variant >> 1),   \
+                      parser->variant & 1,                             \
+                      parser->lenient_http_headers, data, len)
+#endif
+
+size_t sip_parser_execute (sip_parser *parser,
+                           const sip_parser_settings *settings,
+                           const char *data,
+                           size_t len)
+{
+  size_t nparsed = EXECUTE_VARIANT(0, settings, NULL);
+
+  /* 'position' is of a local of the parsing, nothing is kept of 'data' */
+  parser->parsing_data = NULL;
+  parser->parsing_len = 0;
+  parser->position = NULL;
+  return nparsed;
+}
+
+size_t sip_parser_pull (sip_parser *parser,
+                        sip_parse_result *result,
+                        const char *data,
+                        size_t len)
+{
+  return EXECUTE_VARIANT(1, NULL, result);
+}
+
+void
+sip_parse_result_init (sip_parse_result *result,
+                       sip_header_span *headers,
+                       uint32_t max_headers)
+{
+  uint32_t offset = result->offset; /* preserve the position of the caller */
+  memset(result, 0, sizeof(*result));
+  result->offset = offset;
+  result->headers = headers;
+  result->max_headers = max_headers;
+}
+
 
 /* Does the parser need to see an EOF to find the end of the message? */
 int
@@ -1787,8 +2303,17 @@ sip_parser_init (sip_parser *parser, enum sip_parser_type t)
   parser->data = data; 
   //parser->currmsg = currmsg; /* (DY) */
   parser->type = t;
-  parser->state = (t == SIP_REQUEST ? s_start_req : (t == SIP_RESPONSE ? s_start_res : s_start_req_or_res));
+  parser->variant = t * 2;
+  parser->state = START_STATE(t);
   parser->sip_errno = SPE_OK;
+  parser->limits = &default_limits;
+}
+
+void
+sip_parser_init_datagram (sip_parser *parser, enum sip_parser_type t)
+{
+  sip_parser_init(parser, t);
+  parser->variant = t * 2 + 1;
 }
 
 void
@@ -1797,6 +2322,69 @@ sip_parser_settings_init(sip_parser_settings *settings)
   memset(settings, 0, sizeof(*settings));
 }
 
+void
+sip_parser_limits_init(sip_parser_limits *limits)
+{
+  limits->max_header_size = SIP_MAX_HEADER_SIZE;
+  limits->max_headers = (uint32_t) -1;
+  limits->max_url_length = (uint32_t) -1;
+  limits->max_body_size = ULLONG_MAX;
+}
+
+void
+sip_parser_set_limits(sip_parser *parser, const sip_parser_limits *limits)
+{
+  parser->limits = limits;
+}
+
+void
+sip_parser_snapshot(const sip_parser *parser, sip_parser_state *state)
+{
+  memset(state, 0, sizeof(*state));
+  state->type = parser->type;
+  state->variant = parser->variant;
+  state->lenient_http_headers = parser->lenient_http_headers;
+  state->state = parser->state;
+  state->header_state = parser->header_state;
+  state->index = parser->index;
+  state->flags = parser->flags;
+  state->extra_flags = parser->extra_flags;
+  state->method = parser->method;
+  state->sip_errno = parser->sip_errno;
+  state->upgrade = parser->upgrade;
+  state->sip_major = parser->sip_major;
+  state->sip_minor = parser->sip_minor;
+  state->status_code = parser->status_code;
+  state->nread = parser->nread;
+  state->nlimit = parser->nlimit;
+  state->content_length = parser->content_length;
+}
+
+void
+sip_parser_restore(sip_parser *parser, const sip_parser_state *state)
+{
+  parser->type = state->type;
+  parser->variant = state->variant;
+  parser->lenient_http_headers = state->lenient_http_headers;
+  parser->state = state->state;
+  parser->header_state = state->header_state;
+  parser->index = state->index;
+  parser->flags = state->flags;
+  parser->extra_flags = state->extra_flags;
+  parser->method = state->method;
+  parser->sip_errno = state->sip_errno;
+  parser->upgrade = state->upgrade;
+  parser->sip_major = state->sip_major;
+  parser->sip_minor = state->sip_minor;
+  parser->status_code = state->status_code;
+  parser->nread = state->nread;
+  parser->nlimit = state->nlimit;
+  parser->content_length = state->content_length;
+  parser->parsing_data = NULL;
+  parser->parsing_len = 0;
+  parser->position = NULL;
+}
+
 const char *
 sip_errno_name(enum sip_errno err) {
   assert(((size_t) err) < ARRAY_SIZE(sip_strerror_tab));
@@ -1838,6 +2426,6 @@ sip_parser_version(void) {
 
 void
 sip_parser_set_max_header_size(uint32_t size) {
-  max_header_size = size;
+  default_limits.max_header_size = size;
 }
 
@@ -39,6 +39,30 @@ typedef unsigned __int64 uint64_t;
 # define SIP_PARSER_STRICT 0
 #endif
 
+/* Compile with -DSIP_PARSER_VARIANTS=1 to have a copy of the parser for
+ * each parser type, transport and 'lenient_http_headers', see
+ * sip_parser_init_datagram(), instead of one checking them while parsing.
+ * It is 24 copies of the state machine, worth it only where the benchmark
+ * of the variants shows them faster for the parsers in use
+ */
+#ifndef SIP_PARSER_VARIANTS
+# define SIP_PARSER_VARIANTS 0
+#endif
+
+/* Compile with -DSIP_PARSER_COMPUTED_GOTO=1 to run the states of the parser
+ * as direct-threaded code with labels as values, each state jumping to the
+ * next one instead of going through the switch. Only with GCC and Clang,
+ * ignored otherwise. GCC keeps more of the jumps apart with -fno-gcse
+ * -fno-crossjumping.
+ */
+#ifndef SIP_PARSER_COMPUTED_GOTO
+# define SIP_PARSER_COMPUTED_GOTO 0
+#endif
+#if SIP_PARSER_COMPUTED_GOTO && !defined(__GNUC__)
+# undef SIP_PARSER_COMPUTED_GOTO
+# define SIP_PARSER_COMPUTED_GOTO 0
+#endif
+
 /* Maximium header size allowed. If the macro is not defined
  * before including this header then the default is used. To
  * change the maximum header size, define the macro in the build
@@ -52,6 +76,8 @@ typedef unsigned __int64 uint64_t;
 
 typedef struct sip_parser sip_parser;
 typedef struct sip_parser_settings sip_parser_settings;
+typedef struct sip_parser_limits sip_parser_limits;
+typedef struct sip_parser_state sip_parser_state;
 
 
 /* Callbacks should return non-zero to indicate an error. The parser will
@@ -183,6 +209,9 @@ enum sip_method
 #define XX(num, name, string) SIP_##name = num,
   SIP_METHOD_MAP(XX)
 #undef XX
+  /* any other method (RFC 3261 extension-method), its name is given to
+   * on_method() and in sip_parse_result.method */
+  SIP_EXTENSION
   };
 
 
@@ -207,6 +236,8 @@ enum flags
 enum flags
   { F_CONTENTLENGTH               = 1 << 0
   , F_SKIPBODY                    = 1 << 1 /* Not sure be needed for SIP */
+  , F_FOLDED                      = 1 << 2 /* (ADDITION) the header-value being
+                                            * read has an obsolete line folding */
   };
 
 /* TODO: Athough almost all error messages are applicable for SIP
@@ -260,6 +291,11 @@ enum flags
   XX(STRICT, "strict mode assertion failed")                         \
   XX(PAUSED, "parser is paused")                                     \
   XX(UNKNOWN, "an unknown error occurred")                           \
+                                                                     \
+  /* (ADDITION) Appended to keep the values of the ones above */     \
+  XX(CB_method, "the on_method callback failed")                     \
+  XX(URL_OVERFLOW, "Request-URI longer than the limit")              \
+  XX(BODY_OVERFLOW, "Content-Length larger than the limit")          \
   /*XX(INVALID_TRANSFER_ENCODING,*/                                  \
      /*"request has invalid transfer-encoding")                        \*/
 
@@ -285,9 +321,12 @@ struct sip_parser {
   unsigned int index : 5;        /* index into current matcher */
   unsigned int extra_flags : 2;
   unsigned int lenient_http_headers : 1;
+  unsigned int variant : 3;      /* parser type and transport given at init */
 
   uint32_t nread;          /* # bytes read in various scenarios */
+  uint32_t nlimit;         /* # bytes of Request-URI, then # header lines */
   uint64_t content_length; /* # bytes in body (0 if no Content-Length header) */
+  const sip_parser_limits *limits;
 
   /** READ-ONLY **/
   unsigned short sip_major;
@@ -306,6 +345,8 @@ struct sip_parser {
   /** PUBLIC **/
   void *currmsg;  /* (ADDITION) Current message */
   /*void *currmsg_x; */ /* (ADDITION) Current message */
+  /* (ADDITION) The data given to sip_parser_execute() and the position of the
+   * parsing in it, for the callbacks only: they are NULL when it returns */
   const char* parsing_data; /* (ADDITION) current received bystes that used in parsing process */
   size_t parsing_len; /* (ADDITION) current length of data that used in parsing process */
   const char** position;
@@ -313,6 +354,44 @@ struct sip_parser {
 };
 
 
+/* (ADDITION) What a parser accepts of a message, see sip_parser_set_limits().
+ * Exceeding one is an error: SPE_HEADER_OVERFLOW for the bytes up to the body
+ * and for the header lines, SPE_URL_OVERFLOW and SPE_BODY_OVERFLOW. They are
+ * checked once a line, a never-ending line is stopped by 'max_header_size'.
+ */
+struct sip_parser_limits {
+  uint32_t max_header_size; /* start line and headers, a datagram up to it is not counted */
+  uint32_t max_headers;     /* header lines */
+  uint32_t max_url_length;  /* Request-URI */
+  uint64_t max_body_size;   /* Content-Length */
+};
+
+/* (ADDITION) The state of a parser between two calls, see
+ * sip_parser_snapshot(). It has no pointers and no positions: the ones of a
+ * message are offsets from its start kept by the caller, as in
+ * sip_parse_result, so a message received in parts may be continued by
+ * another parser, e.g. of another thread, after its bytes are moved.
+ */
+struct sip_parser_state {
+  uint8_t type;
+  uint8_t variant;
+  uint8_t lenient_http_headers;
+  uint8_t state;
+  uint8_t header_state;
+  uint8_t index;
+  uint8_t flags;
+  uint8_t extra_flags;
+  uint8_t method;
+  uint8_t sip_errno;
+  uint8_t upgrade;
+  uint16_t sip_major;
+  uint16_t sip_minor;
+  uint16_t status_code;
+  uint32_t nread;
+  uint32_t nlimit;
+  uint64_t content_length;
+};
+
 struct sip_parser_settings {
   sip_cb      on_message_begin;
   sip_data_cb on_url;
@@ -327,8 +406,60 @@ struct sip_parser_settings {
    */
   sip_cb      on_chunk_header;
   sip_cb      on_chunk_complete;
+  /* The method of a request, the same for the known methods as the one
+   * in parser->method. 'at' may not be in the data given when the data
+   * received ends in the first character of the method.
+   */
+  sip_data_cb on_method;
 };
 
+
+/* (ADDITION) Result of sip_parser_pull(), the callback-free way of parsing.
+ *
+ * The parser writes the positions of the parts of a message here instead of
+ * passing them to the callbacks of sip_parser_settings. All positions are
+ * relative to the buffer of the caller: 'offset' is set by the caller to the
+ * position of 'data' in it (i.e. incremented by the length of each call when
+ * a message is received in parts). Header-names do not include the spaces
+ * before ':', a folded header-value includes its CRLFs. The method, the status
+ * code and the version are kept in sip_parser as with the callbacks.
+ */
+typedef struct sip_span {
+  uint32_t start;
+  uint32_t length;
+} sip_span;
+
+typedef struct sip_header_span {
+  sip_span field;
+  sip_span value;
+  uint32_t folded; /* 1 when the value has an obsolete line folding */
+} sip_header_span;
+
+/* Flag values for sip_parse_result.flags */
+enum sip_result_flags
+  { SR_MESSAGE_BEGIN        = 1 << 0
+  , SR_STATUS               = 1 << 1 /* Reason-Phrase seen, may be empty */
+  , SR_HEADERS_COMPLETE     = 1 << 2
+  , SR_MESSAGE_COMPLETE     = 1 << 3
+  , SR_BODY_FINAL           = 1 << 4
+  , SR_IN_FIELD             = 1 << 5 /* private; a header-name is being read */
+  };
+
+typedef struct sip_parse_result {
+  uint32_t offset;
+  uint32_t flags;                /* SR_* values */
+  uint32_t message_begin_pos;
+  uint32_t headers_complete_pos; /* LF of the empty line */
+  uint32_t message_complete_pos; /* last byte of the message */
+  sip_span method;               /* starts at message_begin_pos */
+  sip_span url;
+  sip_span status;
+  sip_span body;
+  sip_header_span *headers;      /* provided by the caller */
+  uint32_t max_headers;
+  uint32_t num_headers;
+} sip_parse_result;
+
 /* NOTE: We support SIP URI parsing separately. */
 #if 0
 enum http_parser_url_fields
@@ -373,13 +504,50 @@ struct http_parser_url {
  */
 unsigned long sip_parser_version(void);
 
+/* Initialize the parser, its limits are the default ones of
+ * sip_parser_limits_init() until sip_parser_set_limits().
+ */
 void sip_parser_init(sip_parser *parser, enum sip_parser_type type);
 
+/* Initialize the parser for datagram transports, e.g. UDP. Each call to
+ * sip_parser_execute() or sip_parser_pull() is given one datagram: it starts
+ * a new message, dropping what is left of the previous one, and stops after
+ * the end of it as the rest of a datagram is not a message (RFC 3261 18.3).
+ * A paused parser is not resumed with the rest of the datagram.
+ *
+ * The parser has its own copy of the parsing code for the type, transport and
+ * 'lenient_http_headers' it is used with, with the checks for the others left
+ * out. A SIP_REQUEST or SIP_RESPONSE parser only parses that type, also after
+ * the first message.
+ */
+void sip_parser_init_datagram(sip_parser *parser, enum sip_parser_type type);
+
 
 /* Initialize sip_parser_settings members to 0
  */
 void sip_parser_settings_init(sip_parser_settings *settings);
 
+/* Initialize 'limits' to the defaults: SIP_MAX_HEADER_SIZE header bytes and
+ * no limit for the others.
+ */
+void sip_parser_limits_init(sip_parser_limits *limits);
+
+/* Use 'limits' for the parser until it is initialized again. They are only
+ * read while parsing, so parsers of different threads may share them.
+ */
+void sip_parser_set_limits(sip_parser *parser, const sip_parser_limits *limits);
+
+/* Save the state of 'parser' between two calls to sip_parser_execute() or
+ * sip_parser_pull() in 'state'.
+ */
+void sip_parser_snapshot(const sip_parser *parser, sip_parser_state *state);
+
+/* Continue the parsing of 'state' with 'parser': its next call is given the
+ * bytes after the ones given to the parser of the snapshot. 'data', 'currmsg'
+ * and the limits of 'parser' are kept.
+ */
+void sip_parser_restore(sip_parser *parser, const sip_parser_state *state);
+
 
 /* Executes the parser. Returns number of parsed bytes. Sets
  * `parser->sip_errno` on error. */
@@ -388,6 +556,23 @@ size_t sip_parser_execute(sip_parser *parser,
                            const char *data,
                            size_t len);
 
+/* Initialize 'result' for a new message with the header table of the caller.
+ */
+void sip_parse_result_init(sip_parse_result *result,
+                           sip_header_span *headers,
+                           uint32_t max_headers);
+
+/* Executes the parser as sip_parser_execute() does but fills 'result'
+ * instead of invoking callbacks. Returns number of parsed bytes; it stops
+ * after the end of a message, SR_MESSAGE_COMPLETE in 'result->flags' tells
+ * it, so the rest of 'data' is for the next message (with a re-initialized
+ * 'result'). More than 'max_headers' headers is SPE_HEADER_OVERFLOW.
+ */
+size_t sip_parser_pull(sip_parser *parser,
+                       sip_parse_result *result,
+                       const char *data,
+                       size_t len);
+
 /* TODO: Think about necessity */
 
 /* If http_should_keep_alive() in the on_headers_complete or
@@ -427,7 +612,10 @@ void sip_parser_pause(sip_parser *parser, int paused);
 /* Checks if this is the final chunk of the body. */
 int sip_body_is_final(const sip_parser *parser);
 
-/* Change the maximum header size provided at compile time. */
+/* Change the maximum header size provided at compile time for the parsers
+ * with the default limits. It is not safe while other threads are parsing,
+ * sip_parser_set_limits() is the one for a parser.
+ */
 void sip_parser_set_max_header_size(uint32_t size);
 
 #ifdef __cplusplus
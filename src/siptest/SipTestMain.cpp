@@ -16,7 +16,18 @@
 #include "AcceptEncodingHeader.h"
 #include "AcceptLanguageHeader.h"
 #include "AllowHeader.h"
+#include "SdpBody.h"
+#include "SdpRewriter.h"
 #include "MessageProcessor.h"
+#include "MessageSerializer.h"
+#include "ProxyForwarder.h"
+#include "ViaChain.h"
+#include "GenericHeader.h"
+#include "RouteHeader.h"
+#include "AuthorizationHeader.h"
+#include "WwwAuthenticateHeader.h"
+#include "DatagramParser.h"
+#include "Prefilter.h"
 
 #include <stdio.h>
 
@@ -78,6 +89,1576 @@ void TestForURI()
 	std::cout << buff.str();
 }
 
+/* Equivalent and non-equivalent URI examples of RFC 3261 19.1.4 */
+void TestForUriCompare()
+{
+	static const struct { const char* a; const char* b; bool equal; } cases[] =
+	{
+		{ "sip:%61lice@atlanta.com;transport=TCP", "sip:alice@AtLanTa.CoM;Transport=tcp", true },
+		{ "sip:carol@chicago.com", "sip:carol@chicago.com;newparam=5", true },
+		{ "sip:carol@chicago.com", "sip:carol@chicago.com;security=on", true },
+		{ "sip:carol@chicago.com;newparam=5", "sip:carol@chicago.com;security=on", true },
+		{ "sip:biloxi.com;transport=tcp;method=REGISTER?to=sip:bob%40biloxi.com",
+		  "sip:biloxi.com;method=REGISTER;transport=tcp?to=sip:bob%40biloxi.com", true },
+		{ "sip:alice@atlanta.com?subject=project%20x&priority=urgent",
+		  "sip:alice@atlanta.com?priority=urgent&subject=project%20x", true },
+		{ "SIP:ALICE@AtLanTa.CoM;Transport=udp", "sip:alice@AtLanTa.CoM;Transport=UDP", false },
+		{ "sip:bob@biloxi.com", "sip:bob@biloxi.com:5060", false },
+		{ "sip:bob@biloxi.com", "sip:bob@biloxi.com;transport=udp", false },
+		{ "sip:bob@biloxi.com", "sip:bob@biloxi.com:6000;transport=tcp", false },
+		{ "sip:carol@chicago.com", "sip:carol@chicago.com?Subject=next%20meeting", false },
+		{ "sip:bob@phone21.boxesbybob.com", "sip:bob@192.0.2.4", false },
+		{ "sip:alice@atlanta.com;maddr=239.255.255.1", "sip:alice@atlanta.com", false },
+		{ "sips:alice@atlanta.com", "sip:alice@atlanta.com", false },
+		{ "sip:alice@atlanta.com;user=ip", "sip:alice@atlanta.com;user=IP", true },
+		{ "sip:a%3blice@atlanta.com", "sip:a;lice@atlanta.com", false },
+	};
+	int failed = 0;
+
+	std::cout << "----- URI Compare Test -------\n";
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		SipUri a, b;
+		if (a.ParseUri(cases[i].a, 0, strlen(cases[i].a)) != 0 || b.ParseUri(cases[i].b, 0, strlen(cases[i].b)) != 0)
+		{
+			std::cout << "[PARSE FAILED] " << cases[i].a << " | " << cases[i].b << std::endl;
+			failed++;
+			continue;
+		}
+		bool equal = a.Equals(b);
+		bool ok = (equal == cases[i].equal) && (equal == b.Equals(a)) && (!equal || a.Hash() == b.Hash());
+		std::cout << (ok ? "[PASS] " : "[FAIL] ") << cases[i].a << (equal ? " == " : " != ") << cases[i].b << std::endl;
+		failed += ok ? 0 : 1;
+	}
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static int ReportParamCheck(bool ok, const char* text)
+{
+	std::cout << (ok ? "[PASS] " : "[FAIL] ") << text << std::endl;
+	return ok ? 0 : 1;
+}
+
+void TestForParamLookup()
+{
+	static const char via[] = "SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds;rport;TTL=16, SIP/2.0/TCP b.example.com;received=192.0.2.1;rport=5061";
+	static const char contact[] = "<sip:alice@pc33.atlanta.com>;q=0.7;expires=3600, <sip:bob@192.0.2.4>;q=1;expires=abc";
+	static const char from[] = "Alice <sip:alice@atlanta.com>;Tag=1928301774;x=1";
+	static const char uri[] = "sip:alice@atlanta.com;maddr=239.255.255.1;ttl=15;lr";
+	uint32_t value = 0;
+	int failed = 0;
+
+	std::cout << "----- Param Lookup Test -------\n";
+	ViaHeader vhdr;
+	vhdr.ParseHeader(via, 0, sizeof(via) - 1);
+	const param_pos_t* param = vhdr.GetParam(PARAM_BRANCH);
+	failed += ReportParamCheck(param && std::string(via + param->value.start, param->value.length) == "z9hG4bK776asdhds", "Via branch");
+	failed += ReportParamCheck(vhdr.via_parms[0].branch.length == 16, "Via branch quick access");
+	failed += ReportParamCheck(vhdr.GetParam(PARAM_RPORT) && vhdr.GetParamU32(PARAM_RPORT, &value) != 0, "Via rport without value");
+	failed += ReportParamCheck(vhdr.GetParamU32(PARAM_TTL, &value) == 0 && value == 16, "Via ttl");
+	failed += ReportParamCheck(vhdr.GetParam(PARAM_RECEIVED) == NULL && vhdr.GetParam(PARAM_RECEIVED, 1) != NULL, "Via received of second via-parm");
+	failed += ReportParamCheck(vhdr.GetParamU32(PARAM_RPORT, &value, 1) == 0 && value == 5061, "Via rport of second via-parm");
+
+	ContactHeader cont;
+	cont.ParseHeader(contact, 0, sizeof(contact) - 1);
+	failed += ReportParamCheck(cont.GetParamU32(PARAM_Q, &value) == 0 && value == 700, "Contact q=0.7");
+	failed += ReportParamCheck(cont.GetParamU32(PARAM_EXPIRES, &value) == 0 && value == 3600, "Contact expires");
+	failed += ReportParamCheck(cont.GetParamU32(PARAM_Q, &value, 1) == 0 && value == 1000, "Contact q=1");
+	failed += ReportParamCheck(cont.GetParamU32(PARAM_EXPIRES, &value, 1) != 0, "Contact expires=abc");
+
+	FromHeader fhdr;
+	fhdr.ParseHeader(from, 0, sizeof(from) - 1);
+	param = fhdr.GetParam(PARAM_TAG);
+	failed += ReportParamCheck(param && fhdr.tag.length == 10 && std::string(from + param->value.start, param->value.length) == "1928301774", "From tag");
+
+	SipUri suri;
+	suri.ParseUri(uri, 0, sizeof(uri) - 1);
+	failed += ReportParamCheck(suri.GetParamU32(PARAM_TTL, &value) == 0 && value == 15, "URI ttl");
+	failed += ReportParamCheck(suri.GetParam(PARAM_LR) != NULL && suri.GetParam(PARAM_TRANSPORT) == NULL, "URI lr");
+	param = suri.GetParam(PARAM_MADDR);
+	failed += ReportParamCheck(param && std::string(uri + param->value.start, param->value.length) == "239.255.255.1", "URI maddr");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* sample value of each header described in SIP_GENERIC_HEADER_MAP */
+static const struct
+{
+	GenericHeaderId_t id;
+	const char* value;
+} generic_samples[] =
+{
+	{ GHDR_ACCEPT_CONTACT, "*;audio;require, *;video;explicit" },
+	{ GHDR_ACCEPT_RESOURCE_PRIORITY, "dsn.flash-override, dsn.flash, q735.0" },
+	{ GHDR_ADDITIONAL_IDENTITY, "<sip:alice@example.com>;type=uri" },
+	{ GHDR_ALERT_INFO, "<http://www.example.com/sounds/moo.wav>;appearance=2" },
+	{ GHDR_ALLOW_EVENTS, "presence, dialog;sla, message-summary" },
+	{ GHDR_ANSWER_MODE, "Auto;require" },
+	{ GHDR_ATTESTATION_INFO, "A" },
+	{ GHDR_CALL_INFO, "<http://wwww.example.com/alice/photo.jpg> ;purpose=icon, <http://www.example.com/alice/> ;purpose=info" },
+	{ GHDR_CELLULAR_NETWORK_INFO, "3GPP-E-UTRAN-TDD;utran-cell-id-3gpp=23456789ABCDE;cell-info-age=1234" },
+	{ GHDR_CONTENT_DISPOSITION, "session;handling=optional" },
+	{ GHDR_CONTENT_ENCODING, "gzip, deflate" },
+	{ GHDR_CONTENT_ID, "<19920611@example.com>" },
+	{ GHDR_CONTENT_LANGUAGE, "fr, en-US" },
+	{ GHDR_DATE, "Sat, 13 Nov 2010 23:29:00 GMT" },
+	{ GHDR_ERROR_INFO, "<sip:not-in-service-recording@atlanta.com>" },
+	{ GHDR_EVENT, "dialog;id=453;call-id=\"12345@example.com\"" },
+	{ GHDR_EXPIRES, "3600" },
+	{ GHDR_FEATURE_CAPS, "*;+sip.pref=\"video\";+sip.extensions=\"sec-agree\"" },
+	{ GHDR_FLOW_TIMER, "126" },
+	{ GHDR_GEOLOCATION, "<cid:target123@atlanta.example.com>, <sips:3sdefrhy2jj7@lis.atlanta.example.com;transport=tls>" },
+	{ GHDR_GEOLOCATION_ERROR, "100;code=\"Cannot Process Location\"" },
+	{ GHDR_GEOLOCATION_ROUTING, "no" },
+	{ GHDR_HISTORY_INFO, "<sip:bob@biloxi.example.com>;index=1, <sip:bob@192.0.2.4?Reason=SIP%3Bcause%3D408>;index=1.1;rc=1" },
+	{ GHDR_IDENTITY, "sv5CTo05KqpSmtHt3dcEi0/1CWTSZtnG3iV+1nmurLXV/HmtyNS7Ltrg9dlxkWzo;info=<https://biloxi.example.org/biloxi.cer>;alg=ES256" },
+	{ GHDR_INFO_PACKAGE, "foo" },
+	{ GHDR_IN_REPLY_TO, "70710@saturn.bell-tel.com, 17320@saturn.bell-tel.com" },
+	{ GHDR_JOIN, "12345600@atlanta.example.com;from-tag=1234567;to-tag=23431" },
+	{ GHDR_MAX_BREADTH, "60" },
+	{ GHDR_MIME_VERSION, "1.0" },
+	{ GHDR_MIN_EXPIRES, "60" },
+	{ GHDR_MIN_SE, "90;lwsparam" },
+	{ GHDR_ORGANIZATION, "Boxes by Bob" },
+	{ GHDR_ORIGINATION_ID, "2a2e3e5e-1d12-4a46-9c51-d12b1f5a3c55" },
+	{ GHDR_P_ACCESS_NETWORK_INFO, "3GPP-UTRAN-TDD; utran-cell-id-3gpp=23456789ABCDE, IEEE-802.11" },
+	{ GHDR_P_ANSWER_STATE, "Unconfirmed" },
+	{ GHDR_P_ASSERTED_IDENTITY, "\"Cullen Jennings\" <sip:fluffy@cisco.com>, tel:+14085264000" },
+	{ GHDR_P_ASSERTED_SERVICE, "urn:urn-7:3gpp-service.ims.icsi.mmtel" },
+	{ GHDR_P_ASSOCIATED_URI, "<sip:user1_public2@home1.net>, <sip:+1-212-555-1234@home1.net;user=phone>" },
+	{ GHDR_P_CALLED_PARTY_ID, "<sip:user1-business@example.com>" },
+	{ GHDR_P_CHARGE_INFO, "<sip:+15555550101@example.com;user=phone>;npi=ISDN;noa=3" },
+	{ GHDR_P_CHARGING_FUNCTION_ADDRESSES, "ccf=192.1.1.1; ccf=192.1.1.2; ecf=192.1.1.3" },
+	{ GHDR_P_CHARGING_VECTOR, "icid-value=1234bc9876e;icid-generated-at=192.0.6.8;orig-ioi=home1.net" },
+	{ GHDR_P_DCS_BILLING_INFO, "0123456789ABCDEF/192.0.2.1;rksgroup=1" },
+	{ GHDR_P_DCS_LAES, "laes.example.com:5060;content=192.0.2.2" },
+	{ GHDR_P_DCS_OSPS, "BLV" },
+	{ GHDR_P_DCS_REDIRECT, "\"sip:alice@example.com\";count=2" },
+	{ GHDR_P_DCS_TRACE_PARTY_ID, "<tel:+15555551212>;timestamp=1234567890" },
+	{ GHDR_P_EARLY_MEDIA, "sendrecv, gated" },
+	{ GHDR_P_MEDIA_AUTHORIZATION, "0020000100100101706466312e6e6f64652e636f6d" },
+	{ GHDR_P_PREFERRED_IDENTITY, "\"Cullen Jennings\" <sip:fluffy@cisco.com>" },
+	{ GHDR_P_PREFERRED_SERVICE, "urn:urn-7:3gpp-service.ims.icsi.mmtel" },
+	{ GHDR_P_PRIVATE_NETWORK_INDICATION, "example.com" },
+	{ GHDR_P_PROFILE_KEY, "<sip:user1_public1@home1.net>" },
+	{ GHDR_P_REFUSED_URI_LIST, "<sip:bob@example.com>, <sip:carol@example.com>" },
+	{ GHDR_P_SERVED_USER, "<sip:user@example.com>;sescase=orig;regstate=reg" },
+	{ GHDR_P_USER_DATABASE, "<aaa://host.example.com;transport=tcp>" },
+	{ GHDR_P_VISITED_NETWORK_ID, "other.net, \"Visited network number 1\"" },
+	{ GHDR_PATH, "<sip:P3.EXAMPLEHOME.COM;lr>,<sip:P1.EXAMPLEVISITED.COM;lr>" },
+	{ GHDR_PERMISSION_MISSING, "sip:C@example.com" },
+	{ GHDR_POLICY_CONTACT, "<https://policy.example.com/policy.cgi>;non-cacheable" },
+	{ GHDR_POLICY_ID, "<https://policy.example.com/policy.cgi>" },
+	{ GHDR_PRIORITY, "emergency" },
+	{ GHDR_PRIORITY_SHARE, "allowed" },
+	{ GHDR_PRIORITY_VERSTAT, "passed" },
+	{ GHDR_PRIV_ANSWER_MODE, "Manual" },
+	{ GHDR_PRIVACY, "id;user" },
+	{ GHDR_PROXY_REQUIRE, "foo, sec-agree" },
+	{ GHDR_RACK, "776656 1 INVITE" },
+	{ GHDR_REASON, "SIP ;cause=580 ;text=\"Precondition Failure\", Q.850;cause=16" },
+	{ GHDR_RECORD_ROUTE, "<sip:server10.biloxi.com;lr>, <sip:bigbox3.site3.atlanta.com;lr>" },
+	{ GHDR_RECV_INFO, "foo, bar" },
+	{ GHDR_REFER_EVENTS_AT, "<sip:events@server.example.com>" },
+	{ GHDR_REFER_SUB, "false" },
+	{ GHDR_REFER_TO, "<sip:dave@denver.example.org?Replaces=12345%40192.168.118.3%3Bto-tag%3D12345%3Bfrom-tag%3D5FFE-3994>" },
+	{ GHDR_REFERRED_BY, "<sip:referrer@referrer.example>;cid=\"20398823.2UWQFN309shb3@referrer.example\"" },
+	{ GHDR_REJECT_CONTACT, "*;actor=\"msg-taker\";video" },
+	{ GHDR_RELAYED_CHARGE, "icid-value=1234bc9876e;orig-ioi=home1.net" },
+	{ GHDR_REPLACES, "98732@sip.example.com;from-tag=r33th4x0r;to-tag=ff87ff" },
+	{ GHDR_REPLY_TO, "Bob <sip:bob@biloxi.com>" },
+	{ GHDR_REQUEST_DISPOSITION, "proxy, recurse, parallel" },
+	{ GHDR_REQUIRE, "100rel" },
+	{ GHDR_RESOURCE_PRIORITY, "wps.3, dsn.flash" },
+	{ GHDR_RESOURCE_SHARE, "media-sharing;origin=session-initiator;timestamp=1234" },
+	{ GHDR_RESPONSE_SOURCE, "<urn:3gpp:role:p-cscf>" },
+	{ GHDR_RESTORATION_INFO, "cause=1" },
+	{ GHDR_RETRY_AFTER, "18000;duration=3600" },
+	{ GHDR_ROUTE, "<sip:bigbox3.site3.atlanta.com;lr>, <sip:server10.biloxi.com;lr>" },
+	{ GHDR_RSEQ, "988789" },
+	{ GHDR_SECURITY_CLIENT, "ipsec-ike;q=0.1, tls;q=0.2" },
+	{ GHDR_SECURITY_SERVER, "ipsec-ike;q=0.1" },
+	{ GHDR_SECURITY_VERIFY, "tls;q=0.2" },
+	{ GHDR_SERVER, "HomeServer v2" },
+	{ GHDR_SERVICE_INTERACT_INFO, "cdiv;count=1" },
+	{ GHDR_SERVICE_ROUTE, "<sip:P2.HOME.EXAMPLE.COM;lr>, <sip:HSP.HOME.EXAMPLE.COM;lr>" },
+	{ GHDR_SESSION_EXPIRES, "4000;refresher=uac" },
+	{ GHDR_SESSION_ID, "ab30317f1a784dc48ff824d0d3715d86;remote=47755a9de7794ba387653f2099600ef2" },
+	{ GHDR_SIP_ETAG, "dx200xyz" },
+	{ GHDR_SIP_IF_MATCH, "dx200xyz" },
+	{ GHDR_SUBSCRIPTION_STATE, "active;expires=600" },
+	{ GHDR_SUPPORTED, "replaces, 100rel, timer, gruu" },
+	{ GHDR_SUPPRESS_IF_MATCH, "*" },
+	{ GHDR_TARGET_DIALOG, "fa77as7dad8-sd98ajzz@host.example.com;local-tag=1928301774;remote-tag=a84b4c76e66710" },
+	{ GHDR_TIMESTAMP, "54" },
+	{ GHDR_TRIGGER_CONSENT, "sip:123@relay.example.com;target-uri=\"sip:friends@relay.example.com\"" },
+	{ GHDR_UNSUPPORTED, "foo" },
+	{ GHDR_USER_AGENT, "Softphone Beta1.5" },
+	{ GHDR_USER_TO_USER, "56a390f3d2b7310023a2;encoding=hex;purpose=isdn-uui;content=isdn-uui" },
+	{ GHDR_WARNING, "307 isi.edu \"Session parameter 'foo' not understood\"" },
+};
+
+/* spans of a parsed header stay in its value */
+static bool IsInBounds(const GenericHeader& hdr, uint32_t length)
+{
+	for (uint32_t i = 0; i < hdr.num_elements; i++)
+	{
+		const header_element_t& element = hdr.elements[i];
+		if (element.displayName.start + element.displayName.length > length ||
+			element.value.start + element.value.length > length ||
+			element.comment.start + element.comment.length > length ||
+			element.first_param + element.num_params > hdr.num_params)
+		{
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < hdr.num_params; i++)
+	{
+		if (hdr.params[i].type.start + hdr.params[i].type.length > length ||
+			hdr.params[i].value.start + hdr.params[i].value.length > length)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Parses a copy of 'length' bytes of 'value' in a buffer of exactly that size,
+   so reading past the value is caught by memory checkers */
+static bool ParseCopy(GenericHeader* hdr, const char* value, uint32_t length)
+{
+	char* copy = new char[length + 1];
+	memcpy(copy, value, length);
+	hdr->ParseHeader(copy, 0, length);
+	bool ok = (hdr->parsing_stat != NOT_PARSED_YET) &&
+		(hdr->parsing_stat != PARSED_SUCCESSFULLY || IsInBounds(*hdr, length));
+	delete[] copy;
+	return ok;
+}
+
+void TestForGenericHeaders()
+{
+	static const char mutations[] = ",;<>\"()@=: \\\t\r\n";
+	static const char route[] = "<sip:p1.example.com;lr>;x=1, <sip:p2.example.com>";
+	static const char retry[] = "120 (I'm in a (long) meeting);duration=60";
+	uint32_t seed = 1, value = 0;
+	int failed = 0, found = 0, parsed = 0, runs = 0;
+	char buf[256];
+
+	std::cout << "----- Generic Header Test -------\n";
+	for (int id = 0; id < MAX_NUM_GENERIC_HEADERS; id++)
+	{
+		const char* name = generic_header_grammars[id].name;
+		GenericHeader* hdr = CreateGenericHeader(name, (uint32_t)strlen(name));
+		const char* sample = NULL;
+		for (size_t k = 0; k < sizeof(generic_samples) / sizeof(generic_samples[0]); k++)
+		{
+			if (generic_samples[k].id == id)
+			{
+				sample = generic_samples[k].value;
+			}
+		}
+		if (hdr == NULL || hdr->id != id || sample == NULL)
+		{
+			std::cout << "[FAIL] " << name << " has no parser or sample\n";
+			failed++;
+			delete hdr;
+			continue;
+		}
+		found++;
+		uint32_t length = (uint32_t)strlen(sample);
+		hdr->ParseHeader(sample, 0, length);
+		if (hdr->parsing_stat != PARSED_SUCCESSFULLY || !IsInBounds(*hdr, length) ||
+			hdr->WriteHeaderValue(buf, sizeof(buf)) != (int)length)
+		{
+			std::cout << "[FAIL] " << name << ": " << sample << " " << SipHeader::GetParsingStatInText(hdr->parsing_stat) << std::endl;
+			failed++;
+		}
+
+		/* every prefix of the sample, then random bytes replaced with delimiters */
+		for (uint32_t cut = 1; cut < length; cut++, runs++)
+		{
+			if (!ParseCopy(hdr, sample, cut))
+			{
+				std::cout << "[FAIL] " << name << " prefix " << cut << std::endl;
+				failed++;
+			}
+			parsed += (hdr->parsing_stat == PARSED_SUCCESSFULLY);
+		}
+		for (int k = 0; k < 64; k++, runs++)
+		{
+			std::string mutated(sample);
+			for (int m = 0; m < 3; m++)
+			{
+				seed = seed * 1103515245 + 12345;
+				mutated[(seed >> 8) % length] = mutations[(seed >> 20) % (sizeof(mutations) - 1)];
+			}
+			if (!ParseCopy(hdr, mutated.data(), length))
+			{
+				std::cout << "[FAIL] " << name << " mutation: " << mutated << std::endl;
+				failed++;
+			}
+			parsed += (hdr->parsing_stat == PARSED_SUCCESSFULLY);
+		}
+		delete hdr;
+	}
+	std::cout << "-- " << found << " headers, " << runs << " fuzzed values, " << parsed << " of them parsed" << std::endl;
+
+	RouteHeader rhdr;
+	rhdr.ParseHeader(route, 0, sizeof(route) - 1);
+	failed += ReportParamCheck(rhdr.num_elements == 2 && rhdr.GetParam(PARAM_LR) == NULL &&
+		std::string(route + rhdr.elements[0].value.start, rhdr.elements[0].value.length) == "sip:p1.example.com;lr", "Route URI of first route-param");
+	rhdr.elements[0].num_params = 0;
+	rhdr.SetModified();
+	int n = rhdr.WriteHeaderValue(buf, sizeof(buf));
+	failed += ReportParamCheck(std::string(buf, n > 0 ? n : 0) == "<sip:p1.example.com;lr>, <sip:p2.example.com>" &&
+		rhdr.GetHeaderValue() == "<sip:p1.example.com;lr>, <sip:p2.example.com>", "Route modified");
+
+	RetryAfterHeader rahdr;
+	rahdr.ParseHeader(retry, 0, sizeof(retry) - 1);
+	failed += ReportParamCheck(rahdr.GetNumber(&value) == 0 && value == 120 && rahdr.elements[0].num_params == 1 &&
+		rahdr.elements[0].comment.length == 25, "Retry-After with comment");
+
+	GenericHeader* hdr = CreateGenericHeader("x", 1);
+	failed += ReportParamCheck(hdr && hdr->id == GHDR_SESSION_EXPIRES, "compact form of Session-Expires");
+	delete hdr;
+
+	SupportedHeader shdr;
+	shdr.ParseHeader(" ", 0, 1);
+	failed += ReportParamCheck(shdr.parsing_stat == PARSED_SUCCESSFULLY && shdr.num_elements == 0, "empty Supported");
+
+	EventHeader ehdr;
+	ehdr.ParseHeader("presence, dialog", 0, 16);
+	failed += ReportParamCheck(ehdr.parsing_stat == PARSING_FAILED_UNEXPECTED_CHAR, "Event of two packages");
+
+	SubscriptionStateHeader sshdr;
+	sshdr.ParseHeader("active;expires=600", 0, 18);
+	failed += ReportParamCheck(sshdr.GetParamU32(PARAM_EXPIRES, &value) == 0 && value == 600, "Subscription-State expires");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static std::string HopHost(const RouteHeader& hdr, const char* value, uint32_t index)
+{
+	return std::string(value + hdr.GetHop(index).host.start, hdr.GetHop(index).host.length);
+}
+
+void TestForRouteHeader()
+{
+	static const char route[] = "<sip:p1.example.com;lr>, <sip:[2001:db8::1]:5070;transport=tcp;lr=on>;x=1, <sip:alice@p3.example.com:5080;maddr=p4.example.com>";
+	static const char user[] = "\"Gateway\" <sip:+1234;npdi@gw.example.com;lr?Subject=a@b>";
+	char buf[256];
+	int failed = 0;
+
+	std::cout << "----- Route Header Test -------\n";
+	RouteHeader rhdr;
+	rhdr.ParseHeader(route, 0, sizeof(route) - 1);
+	failed += ReportParamCheck(rhdr.num_elements == 3 && rhdr.rest.length == 0, "Route of three values");
+	failed += ReportParamCheck(HopHost(rhdr, route, 0) == "p1.example.com" && rhdr.GetHop(0).port == 0 && rhdr.IsLooseRouting(0), "Route host without port");
+	failed += ReportParamCheck(HopHost(rhdr, route, 1) == "[2001:db8::1]" && rhdr.GetHop(1).port == 5070 && rhdr.IsLooseRouting(1), "Route IPv6 reference, lr=on");
+	failed += ReportParamCheck(HopHost(rhdr, route, 2) == "p3.example.com" && rhdr.GetHop(2).port == 5080 && !rhdr.IsLooseRouting(2), "Route strict router");
+	failed += ReportParamCheck(!rhdr.IsLooseRouting(3), "Route lr of a missing value");
+
+	RouteHeader top;
+	top.ParseTop(route, 0, sizeof(route) - 1);
+	failed += ReportParamCheck(top.num_elements == 1 && top.IsLooseRouting() &&
+		std::string(route + top.rest.start, top.rest.length).compare(0, 19, "<sip:[2001:db8::1]:") == 0, "Route top only");
+	top.elements[0].value.length -= 3; /* drops ";lr" of the top route */
+	top.SetModified();
+	int n = top.WriteHeaderValue(buf, sizeof(buf));
+	failed += ReportParamCheck(n > 0 && std::string(buf, n) == std::string("<sip:p1.example.com>") + (route + 23), "Route modified top, others as received");
+
+	RecordRouteHeader rrhdr;
+	rrhdr.ParseHeader(user, 0, sizeof(user) - 1);
+	failed += ReportParamCheck(rrhdr.id == GHDR_RECORD_ROUTE && HopHost(rrhdr, user, 0) == "gw.example.com" && rrhdr.IsLooseRouting(), "Record-Route user parameters and headers");
+
+	rhdr.ParseHeader("<sip:p1.example.com;lr>,", 0, 24);
+	failed += ReportParamCheck(rhdr.parsing_stat != PARSED_SUCCESSFULLY, "Route trailing comma");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static std::string Md5Hex(const char* data)
+{
+	uint8_t digest[MD5_DIGEST_SIZE];
+	char hex[MD5_HEX_SIZE];
+	md5_ctx_t ctx;
+	md5_init(&ctx);
+	md5_update(&ctx, data, strlen(data));
+	md5_final(&ctx, digest);
+	md5_to_hex(digest, hex);
+	return std::string(hex, MD5_HEX_SIZE);
+}
+
+static void ParseAuth(AuthHeader& hdr, const char* value)
+{
+	hdr.ParseHeader(value, 0, (uint32_t)strlen(value));
+}
+
+void TestForAuthHeaders()
+{
+	/* examples of RFC 2617 3.5 and RFC 2069 2.4, response of the latter is
+	   recomputed as the one given in the RFC does not match its example */
+	static const char rfc2617[] = "Digest username=\"Mufasa\", realm=\"testrealm@host.com\", nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+		"uri=\"/dir/index.html\", qop=auth, nc=00000001, cnonce=\"0a4f113b\", response=\"6629FAE49393A05397450978507C4EF1\", "
+		"opaque=\"5ccc069c403ebaf9f0171e9517f40e41\"";
+	static const char rfc2069[] = "Digest       username=\"Mufasa\",  realm=\"testrealm@host.com\",  nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+		"uri=\"/dir/index.html\", response=\"1949323746fe6a43ef61f9606e7febea\", opaque=\"5ccc069c403ebaf9f0171e9517f40e41\"";
+	static const char challenge[] = "Digest  realm= \"studentlev1\"  , nonce=\"??????????\", stale=true , algorithm= MD5 ";
+	char ha1[MD5_HEX_SIZE];
+	char buf[512];
+	int failed = 0;
+
+	std::cout << "----- Auth Header Test -------\n";
+	failed += ReportParamCheck(Md5Hex("") == "d41d8cd98f00b204e9800998ecf8427e" && Md5Hex("abc") == "900150983cd24fb0d6963f7d28e17f72" &&
+		Md5Hex("12345678901234567890123456789012345678901234567890123456789012345678901234567890") == "57edf4a22be3c955ac49da2e2107b67a", "MD5 of RFC 1321");
+
+	AuthorizationHeader auth;
+	auth.ParseHeader(rfc2617, 0, sizeof(rfc2617) - 1);
+	const auth_param_t* param = auth.GetParam(AUTH_PARAM_CNONCE);
+	failed += ReportParamCheck(auth.parsing_stat == PARSED_SUCCESSFULLY && auth.IsDigest() && auth.num_params == 9 &&
+		param && param->quoted && std::string(rfc2617 + param->value.start, param->value.length) == "0a4f113b", "Authorization cnonce without quotes");
+	failed += ReportParamCheck(auth.IsParamValue(AUTH_PARAM_QOP, "auth") && auth.GetParam(AUTH_PARAM_ALGORITHM) == NULL, "Authorization qop");
+
+	digest_calc_ha1("Mufasa", "testrealm@host.com", "Circle Of Life", ha1);
+	failed += ReportParamCheck(auth.VerifyDigest(ha1, "GET", 3) == 0, "Authorization qop=auth response");
+	failed += ReportParamCheck(auth.VerifyDigest(ha1, "PUT", 3) != 0, "Authorization response of another method");
+
+	auth.ParseHeader(rfc2069, 0, sizeof(rfc2069) - 1);
+	digest_calc_ha1("Mufasa", "testrealm@host.com", "CircleOfLife", ha1);
+	failed += ReportParamCheck(auth.VerifyDigest(ha1, "GET", 3) == 0, "Authorization response without qop");
+	ha1[0] ^= 1;
+	failed += ReportParamCheck(auth.VerifyDigest(ha1, "GET", 3) != 0, "Authorization response of another HA1");
+
+	auth.params[auth.num_params - 1].value.length -= 2; /* drops "41" of opaque */
+	auth.SetModified();
+	int n = auth.WriteHeaderValue(buf, sizeof(buf));
+	failed += ReportParamCheck(n > 0 && std::string(buf, n) == "Digest username=\"Mufasa\", realm=\"testrealm@host.com\", nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+		"uri=\"/dir/index.html\", response=\"1949323746fe6a43ef61f9606e7febea\", opaque=\"5ccc069c403ebaf9f0171e9517f40e\"", "Authorization modified");
+
+	ParseAuth(auth, "Digest username=\"Mufasa\", realm=\"testrealm@host.com\", nonce=\"abc\", uri=\"sip:bob@b.com\", algorithm=MD5-sess, "
+		"qop=auth-int, nc=00000002, cnonce=\"xyz\", response=\"5b182b238d9c7f8adb4e7fa0040904b7\"");
+	digest_calc_ha1("Mufasa", "testrealm@host.com", "Circle Of Life", ha1);
+	failed += ReportParamCheck(auth.VerifyDigest(ha1, "INVITE", 6, "v=0\r\n", 5) == 0 && auth.VerifyDigest(ha1, "INVITE", 6) != 0, "Authorization MD5-sess, qop=auth-int response");
+
+	ParseAuth(auth, "Digest username=\"Mufasa\", realm=\"r\", nonce=\"n\"");
+	failed += ReportParamCheck(auth.parsing_stat == PARSING_FAILED_NO_DATA, "Authorization without uri and response");
+	ParseAuth(auth, "Digest username=\"Mufasa\", realm=\"r\",");
+	failed += ReportParamCheck(auth.parsing_stat != PARSED_SUCCESSFULLY, "Authorization trailing comma");
+
+	WwwAuthenticateHeader www(true);
+	www.ParseHeader(challenge, 0, sizeof(challenge) - 1);
+	param = www.GetParam(AUTH_PARAM_REALM);
+	failed += ReportParamCheck(www.parsing_stat == PARSED_SUCCESSFULLY && www.num_params == 4 && www.IsParamValue(AUTH_PARAM_ALGORITHM, "md5") &&
+		www.IsParamValue(AUTH_PARAM_STALE, "TRUE") && param && std::string(challenge + param->value.start, param->value.length) == "studentlev1", "Proxy-Authenticate LWS around EQUAL");
+	ParseAuth(www, "Digest realm=\"%$s..c,\\\"\", nonce=\"??????????\"");
+	param = www.GetParam(AUTH_PARAM_REALM);
+	failed += ReportParamCheck(www.parsing_stat == PARSED_SUCCESSFULLY && param && param->value.length == 9, "WWW-Authenticate quoted-pair");
+	ParseAuth(www, "Digest nonce=\"??????????\", algorithm=MD5");
+	failed += ReportParamCheck(www.parsing_stat == PARSING_FAILED_NO_DATA, "WWW-Authenticate without realm");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* keeps the message as on_message_complete() of MessageProcessor keeps it */
+static int OnMessageComplete(sip_parser* p)
+{
+	SipMessage* sipmsg = (SipMessage*)p->currmsg;
+	sipmsg->message_complete_cb_called = 1;
+	sipmsg->message_complete_pos = (*p->position - p->parsing_data) + sipmsg->bias;
+	return 0;
+}
+
+/* stops sip_parser_execute() after the first message as DatagramParser does */
+static int OnFirstMessageComplete(sip_parser* p)
+{
+	OnMessageComplete(p);
+	sip_parser_pause(p, 1);
+	return 0;
+}
+
+static bool SameSpan(const str_pos_t& a, const str_pos_t& b)
+{
+	return a.start == b.start && a.length == b.length;
+}
+
+static bool SameMessage(const SipMessage& a, const SipMessage& b)
+{
+	if (a.type != b.type || a.method != b.method || a.status_code != b.status_code ||
+		!SameSpan(a.response_status, b.response_status) || !SameSpan(a.request_method, b.request_method) ||
+		!SameSpan(a.request_url, b.request_url) || !SameSpan(a.msg_body, b.msg_body) || a.num_headers != b.num_headers ||
+		a.last_header_element != b.last_header_element || a.should_keep_alive != b.should_keep_alive ||
+		a.sip_major != b.sip_major || a.sip_minor != b.sip_minor ||
+		a.message_begin_cb_called != b.message_begin_cb_called || a.message_begin_pos != b.message_begin_pos ||
+		a.headers_complete_cb_called != b.headers_complete_cb_called || a.headers_complete_pos != b.headers_complete_pos ||
+		a.message_complete_cb_called != b.message_complete_cb_called || a.message_complete_pos != b.message_complete_pos ||
+		a.status_cb_called != b.status_cb_called || a.body_is_final != b.body_is_final || a.folded != b.folded)
+	{
+		return false;
+	}
+	for (uint32_t i = 0; i < a.num_headers; i++)
+	{
+		if (!SameSpan(a.headers[i].fieldpos, b.headers[i].fieldpos) || !SameSpan(a.headers[i].valuepos, b.headers[i].valuepos))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool ReadResFile(const std::string& path, std::vector<char>& data)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	char buf[4096];
+	size_t n;
+
+	if (file == NULL)
+	{
+		return false;
+	}
+	while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+	{
+		data.insert(data.end(), buf, buf + n);
+	}
+	fclose(file);
+	return true;
+}
+
+/* parses 'data' with both parsers, true if the results are the same */
+static bool CompareDatagram(DatagramParser& dparser, const sip_parser_settings* dsettings, const char* data, size_t length,
+	const sip_parser_limits* limits = NULL)
+{
+	SipMessage expected, parsed;
+	sip_parser parser;
+
+	expected.v1.assign(data, data + length);
+	parsed.v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	if (limits != NULL)
+	{
+		sip_parser_set_limits(&parser, limits);
+	}
+	dparser.SetLimits(limits);
+	parser.currmsg = &expected;
+	size_t nparsed = sip_parser_execute(&parser, dsettings, &expected.v1[0], length);
+	enum sip_errno err = (enum sip_errno)parser.sip_errno;
+	if (err == SPE_PAUSED)
+	{
+		err = SPE_OK;
+	}
+
+	return dparser.Execute(&parsed, &parsed.v1[0], length) == nparsed && dparser.sip_error == err &&
+		SameMessage(expected, parsed);
+}
+
+static const struct { const char* format; int count; } corpus[] = {
+	{ "sip%d", 97 }, { "sip-malformed%d", 20 }, { "sdp%d", 16 },
+	{ "torture_hgs", 1 }, { "torture_msgs2", 1 }, { "torture_sdps", 1 }
+};
+
+void TestForDatagramParser(const std::string& dir)
+{
+	static const char folded[] = "MESSAGE sip:bob@b.com SIP/2.0\r\nSubject: a\r\n  b\r\nl : 4\r\n\r\nabcdEXTRA";
+	static const char seps[] = "<sip:a@b.com;lr>, \"x,y\" <sip:c@d.com>;q=0.5\r\n";
+	MessageProcessor mproc;
+	sip_parser_settings dsettings = mproc.settings;
+	DatagramParser dparser;
+	int failed = 0;
+	int files = 0;
+	int expected = 0;
+	int differ = 0;
+
+	std::cout << "----- Datagram Parser Test -------\n";
+	dsettings.on_message_complete = OnFirstMessageComplete;
+
+	StructuralIndex index;
+	index.Build(seps, sizeof(seps) - 1);
+	uint32_t end = sizeof(seps) - 1;
+	failed += ReportParamCheck(index.Next(SC_SEMICOLON, 0, end) == 12 && index.Next(SC_COMMA, 0, end) == 16 &&
+		index.Next(SC_COMMA, 17, end) == 20 && index.Next(SC_RAQUOT, 17, end) == 36 && index.Next(SC_CTL, 0, end) == end &&
+		index.NextLineEnd(0, end) == 43 && index.Is(SC_DQUOTE, 18), "StructuralIndex separators");
+
+	SipMessage msg;
+	msg.v1.assign(folded, folded + sizeof(folded) - 1);
+	size_t nparsed = dparser.Execute(&msg, &msg.v1[0], msg.v1.size());
+	failed += ReportParamCheck(dparser.sip_error == SPE_OK && msg.message_complete_cb_called && nparsed == sizeof(folded) - 6 &&
+		msg.num_headers == 2 && std::string(&msg.v1[msg.headers[0].valuepos.start], msg.headers[0].valuepos.length) == "a\r\n  b" &&
+		msg.msg_body.length == 4, "Datagram folded header, bytes after Content-Length");
+	failed += ReportParamCheck(CompareDatagram(dparser, &dsettings, folded, sizeof(folded) - 1) &&
+		CompareDatagram(dparser, &dsettings, folded, 40) && CompareDatagram(dparser, &dsettings, "SIP/2.0 2000 OK\r\n\r\n", 19) &&
+		CompareDatagram(dparser, &dsettings, "FOO sip:a SIP/2.0\r\n\r\n", 21), "Datagram truncated and malformed");
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		expected += corpus[i].count;
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data))
+			{
+				std::cout << "[FAIL] " << name << " could not be read" << std::endl;
+				continue;
+			}
+			files++;
+			if (!data.empty() && !CompareDatagram(dparser, &dsettings, &data[0], data.size()))
+			{
+				std::cout << "[FAIL] " << name << " differs from sip_parser_execute()" << std::endl;
+				differ++;
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "DatagramParser same as sip_parser_execute() for " << files << " of " << expected << " corpus files";
+	failed += ReportParamCheck(files == expected && differ == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static bool SameSpan(const str_pos_t& a, const sip_span& b)
+{
+	return a.start == b.start && a.length == b.length;
+}
+
+static bool SameSpan(const sip_span& a, const sip_span& b)
+{
+	return a.start == b.start && a.length == b.length;
+}
+
+/* the parts kept by the callbacks of MessageProcessor in 'msg' and by sip_parser_pull() in 'result' */
+static bool SamePulled(const SipMessage& msg, const sip_parse_result& result)
+{
+	if (!SameSpan(msg.request_method, result.method) || !SameSpan(msg.request_url, result.url) ||
+		!SameSpan(msg.response_status, result.status) ||
+		!SameSpan(msg.msg_body, result.body) || msg.num_headers != result.num_headers ||
+		msg.message_begin_cb_called != ((result.flags & SR_MESSAGE_BEGIN) != 0) || msg.message_begin_pos != result.message_begin_pos ||
+		msg.headers_complete_cb_called != ((result.flags & SR_HEADERS_COMPLETE) != 0) || msg.headers_complete_pos != result.headers_complete_pos ||
+		msg.message_complete_cb_called != ((result.flags & SR_MESSAGE_COMPLETE) != 0) || msg.message_complete_pos != result.message_complete_pos ||
+		msg.status_cb_called != ((result.flags & SR_STATUS) != 0) || msg.body_is_final != ((result.flags & SR_BODY_FINAL) != 0))
+	{
+		return false;
+	}
+	for (uint32_t i = 0; i < msg.num_headers; i++)
+	{
+		if (!SameSpan(msg.headers[i].fieldpos, result.headers[i].field) || !SameSpan(msg.headers[i].valuepos, result.headers[i].value) ||
+			msg.folded[i] != (result.headers[i].folded != 0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool SameResult(const sip_parse_result& a, const sip_parse_result& b)
+{
+	if (a.flags != b.flags || a.message_begin_pos != b.message_begin_pos || a.headers_complete_pos != b.headers_complete_pos ||
+		a.message_complete_pos != b.message_complete_pos || !SameSpan(a.method, b.method) ||
+		!SameSpan(a.url, b.url) || !SameSpan(a.status, b.status) ||
+		!SameSpan(a.body, b.body) || a.num_headers != b.num_headers)
+	{
+		return false;
+	}
+	for (uint32_t i = 0; i < a.num_headers; i++)
+	{
+		if (!SameSpan(a.headers[i].field, b.headers[i].field) || !SameSpan(a.headers[i].value, b.headers[i].value) ||
+			a.headers[i].folded != b.headers[i].folded)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* pulls the first message of 'data' received in two parts, the first one is 'split' bytes */
+static size_t PullMessage(sip_parser* parser, sip_parse_result* result, sip_header_span* headers,
+	const char* data, size_t length, size_t split)
+{
+	sip_parser_init(parser, SIP_BOTH);
+	result->offset = 0;
+	sip_parse_result_init(result, headers, MAX_NUM_HEADERS);
+	size_t nparsed = sip_parser_pull(parser, result, data, split);
+	if (nparsed == split && parser->sip_errno == SPE_OK && !(result->flags & SR_MESSAGE_COMPLETE) && split < length)
+	{
+		result->offset = (uint32_t)split;
+		nparsed += sip_parser_pull(parser, result, data + split, length - split);
+	}
+	return nparsed;
+}
+
+/* compares sip_parser_pull() with sip_parser_execute() for 'data', then with
+   itself for 'data' received in two parts split at each of the first 'maxsplit'
+   bytes. Parts read before an error are reported as they are received, so only
+   the error is compared for a malformed message */
+static bool ComparePull(const sip_parser_settings* dsettings, const char* data, size_t length, size_t maxsplit)
+{
+	SipMessage expected;
+	sip_parser parser;
+	sip_header_span headers[MAX_NUM_HEADERS];
+	sip_header_span splitheaders[MAX_NUM_HEADERS];
+	sip_parse_result result, splitresult;
+
+	expected.v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &expected;
+	size_t nparsed = sip_parser_execute(&parser, dsettings, &expected.v1[0], length);
+	enum sip_errno err = (enum sip_errno)parser.sip_errno;
+	if (err == SPE_PAUSED)
+	{
+		err = SPE_OK;
+	}
+
+	if (PullMessage(&parser, &result, headers, data, length, length) != nparsed || parser.sip_errno != err ||
+		!SamePulled(expected, result))
+	{
+		return false;
+	}
+	for (size_t split = 1; split < length && split <= maxsplit; split++)
+	{
+		if (PullMessage(&parser, &splitresult, splitheaders, data, length, split) != nparsed || parser.sip_errno != err ||
+			(err == SPE_OK && !SameResult(result, splitresult)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestForPullParser(const std::string& dir)
+{
+	static const char twomsgs[] = "OPTIONS sip:a@b.com SIP/2.0\r\nl: 2\r\n\r\nabSIP/2.0 200 OK\r\nVia: x\r\n\r\n";
+	static const char folded[] = "MESSAGE sip:bob@b.com SIP/2.0\r\nSubject : a\r\n  b\r\nl : 4\r\n\r\nabcd";
+	MessageProcessor mproc;
+	sip_parser_settings dsettings = mproc.settings;
+	sip_parser parser;
+	sip_header_span headers[MAX_NUM_HEADERS];
+	sip_parse_result result;
+	int failed = 0;
+	int files = 0;
+	int differ = 0;
+
+	std::cout << "----- Pull Parser Test -------\n";
+	dsettings.on_message_complete = OnFirstMessageComplete;
+
+	/* each call stops at the end of a message */
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	result.offset = 0;
+	sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+	size_t first = sip_parser_pull(&parser, &result, twomsgs, sizeof(twomsgs) - 1);
+	bool firstok = first == 39 && (result.flags & SR_MESSAGE_COMPLETE) && parser.method == SIP_OPTIONS &&
+		result.url.start == 8 && result.url.length == 11 && result.body.start == 37 && result.body.length == 2 &&
+		result.num_headers == 1 && result.message_complete_pos == 38;
+	result.offset = (uint32_t)first;
+	sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+	size_t second = sip_parser_pull(&parser, &result, twomsgs + first, sizeof(twomsgs) - 1 - first);
+	failed += ReportParamCheck(firstok && first + second == sizeof(twomsgs) - 1 && parser.status_code == 200 &&
+		(result.flags & SR_MESSAGE_COMPLETE) && result.message_begin_pos == 39 && result.status.start == 51 &&
+		result.num_headers == 1 && result.headers[0].field.start == 55, "Pull stops after each message");
+
+	size_t nparsed = PullMessage(&parser, &result, headers, folded, sizeof(folded) - 1, 40);
+	failed += ReportParamCheck(nparsed == sizeof(folded) - 1 && parser.sip_errno == SPE_OK && result.num_headers == 2 &&
+		result.headers[0].field.length == 7 && std::string(folded + result.headers[0].value.start, result.headers[0].value.length) == "a\r\n  b" &&
+		(result.flags & SR_BODY_FINAL), "Pull folded header in two parts");
+
+	sip_parser_init(&parser, SIP_BOTH);
+	result.offset = 0;
+	sip_parse_result_init(&result, headers, 1);
+	sip_parser_pull(&parser, &result, folded, sizeof(folded) - 1);
+	failed += ReportParamCheck(parser.sip_errno == SPE_HEADER_OVERFLOW && result.num_headers == 1, "Pull header table full");
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data))
+			{
+				continue;
+			}
+			files++;
+			if (!data.empty() && !ComparePull(&dsettings, &data[0], data.size(), 1024))
+			{
+				std::cout << "[FAIL] " << name << " differs from sip_parser_execute()" << std::endl;
+				differ++;
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "sip_parser_pull() same as sip_parser_execute() for " << files << " corpus files";
+	failed += ReportParamCheck(files > 0 && differ == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* parses 'data' as a datagram with the parser variant of 'type' and 'lenient' */
+static size_t ExecuteVariant(SipMessage* msg, const sip_parser_settings* vsettings, enum sip_parser_type type,
+	int lenient, const char* data, size_t length, enum sip_errno* err)
+{
+	sip_parser parser;
+
+	msg->v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init_datagram(&parser, type);
+	parser.lenient_http_headers = lenient;
+	parser.currmsg = msg;
+	size_t nparsed = sip_parser_execute(&parser, vsettings, &msg->v1[0], length);
+	*err = (enum sip_errno)parser.sip_errno;
+	return nparsed;
+}
+
+/* compares the datagram variants with sip_parser_execute() stopped after the
+   first message, the ones of the message type and the lenient ones only for a
+   message parsed without error as they fail at other places */
+static bool CompareVariants(const sip_parser_settings* dsettings, const sip_parser_settings* vsettings,
+	const char* data, size_t length)
+{
+	SipMessage expected;
+	sip_parser parser;
+
+	expected.v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &expected;
+	size_t nparsed = sip_parser_execute(&parser, dsettings, &expected.v1[0], length);
+	enum sip_errno err = (enum sip_errno)parser.sip_errno;
+	if (err == SPE_PAUSED)
+	{
+		err = SPE_OK;
+	}
+	bool ok = err == SPE_OK;
+
+	enum sip_parser_type types[] = { SIP_BOTH, (enum sip_parser_type)parser.type };
+	for (int t = 0; t < (ok ? 2 : 1); t++)
+	{
+		for (int lenient = 0; lenient < (ok ? 2 : 1); lenient++)
+		{
+			SipMessage parsed;
+			enum sip_errno verr;
+			if (ExecuteVariant(&parsed, vsettings, types[t], lenient, data, length, &verr) != nparsed ||
+				verr != err || !SameMessage(expected, parsed))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void TestForParserVariants(const std::string& dir)
+{
+	static const char twomsgs[] = "OPTIONS sip:a@b.com SIP/2.0\r\nl: 2\r\n\r\nabSIP/2.0 200 OK\r\nVia: x\r\n\r\n";
+	static const char responses[] = "SIP/2.0 180 Ringing\r\nl: 0\r\n\r\nSIP/2.0 200 OK\r\nl: 0\r\n\r\n";
+	static const char ctlchar[] = "OPTIONS sip:a@b.com SIP/2.0\r\nSubject: a\x01" "b\r\nl: 0\r\n\r\n";
+	MessageProcessor mproc;
+	sip_parser_settings dsettings = mproc.settings;
+	sip_parser_settings vsettings = mproc.settings;
+	sip_parser parser;
+	sip_header_span headers[MAX_NUM_HEADERS];
+	sip_parse_result result;
+	int failed = 0;
+	int files = 0;
+	int differ = 0;
+
+	std::cout << "----- Parser Variants Test -------\n";
+	dsettings.on_message_complete = OnFirstMessageComplete;
+	vsettings.on_message_complete = OnMessageComplete;
+
+	/* a datagram stops after the message, the next one is a new message */
+	parser.data = NULL;
+	sip_parser_init_datagram(&parser, SIP_BOTH);
+	result.offset = 0;
+	sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+	size_t first = sip_parser_pull(&parser, &result, twomsgs, sizeof(twomsgs) - 1);
+	bool firstok = first == 39 && parser.sip_errno == SPE_OK && (result.flags & SR_MESSAGE_COMPLETE);
+	sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+	size_t truncated = sip_parser_pull(&parser, &result, twomsgs, 30);
+	bool truncatedok = truncated == 30 && parser.sip_errno == SPE_OK && !(result.flags & SR_MESSAGE_COMPLETE);
+	sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+	size_t second = sip_parser_pull(&parser, &result, twomsgs + first, sizeof(twomsgs) - 1 - first);
+	failed += ReportParamCheck(firstok && truncatedok && second == sizeof(twomsgs) - 1 - first && parser.sip_errno == SPE_OK &&
+		parser.status_code == 200 && (result.flags & SR_MESSAGE_COMPLETE) && result.num_headers == 1, "Datagram variant, one message each");
+
+	SipMessage msg;
+	enum sip_errno err;
+	size_t nparsed = ExecuteVariant(&msg, &vsettings, SIP_BOTH, 0, twomsgs, sizeof(twomsgs) - 1, &err);
+	failed += ReportParamCheck(nparsed == 39 && err == SPE_OK && msg.message_complete_cb_called && msg.msg_body.length == 2,
+		"Datagram variant, bytes after Content-Length");
+
+	SipMessage request, response;
+	sip_parser_init(&parser, SIP_REQUEST);
+	parser.currmsg = &request;
+	nparsed = sip_parser_execute(&parser, &vsettings, twomsgs, sizeof(twomsgs) - 1);
+	/* "SIP" is taken as an extension method up to the '/' */
+	bool requestok = nparsed == 42 && parser.sip_errno == SPE_INVALID_METHOD;
+	sip_parser_init(&parser, SIP_RESPONSE);
+	parser.currmsg = &response;
+	nparsed = sip_parser_execute(&parser, &vsettings, responses, sizeof(responses) - 1);
+	failed += ReportParamCheck(requestok && nparsed == sizeof(responses) - 1 && parser.sip_errno == SPE_OK && parser.status_code == 200,
+		"Request and response only variants");
+
+	SipMessage strictmsg, lenientmsg;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &strictmsg;
+	sip_parser_execute(&parser, &vsettings, ctlchar, sizeof(ctlchar) - 1);
+	enum sip_errno strict = (enum sip_errno)parser.sip_errno;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &lenientmsg;
+	parser.lenient_http_headers = 1;
+	sip_parser_execute(&parser, &vsettings, ctlchar, sizeof(ctlchar) - 1);
+	failed += ReportParamCheck(strict == SPE_INVALID_HEADER_TOKEN && parser.sip_errno == SPE_OK, "Lenient variant");
+
+	sip_parser_set_max_header_size(20);
+	SipMessage longmsg;
+	ExecuteVariant(&longmsg, &vsettings, SIP_BOTH, 0, twomsgs, sizeof(twomsgs) - 1, &err);
+	bool overflow = err == SPE_HEADER_OVERFLOW;
+	SipMessage shortmsg;
+	ExecuteVariant(&shortmsg, &vsettings, SIP_BOTH, 0, twomsgs, 18, &err);
+	sip_parser_set_max_header_size(SIP_MAX_HEADER_SIZE);
+	failed += ReportParamCheck(overflow && err == SPE_OK, "Datagram variant header size");
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data))
+			{
+				continue;
+			}
+			files++;
+			if (!data.empty() && !CompareVariants(&dsettings, &vsettings, &data[0], data.size()))
+			{
+				std::cout << "[FAIL] " << name << " differs from sip_parser_execute()" << std::endl;
+				differ++;
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "Datagram variants same as sip_parser_execute() for " << files << " corpus files";
+	failed += ReportParamCheck(files > 0 && differ == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* parses the request of 'method' received in two parts, the first one is 'split' bytes */
+static bool ParseMethod(const sip_parser_settings* msettings, SipMessage* msg, const char* method, size_t split)
+{
+	std::string data = std::string(method) + " sip:a@b.com SIP/2.0\r\nl: 0\r\n\r\n";
+	sip_parser parser;
+
+	msg->v1.assign(data.begin(), data.end());
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = msg;
+	size_t nparsed = sip_parser_execute(&parser, msettings, &msg->v1[0], split);
+	if (nparsed == split && parser.sip_errno == SPE_OK && split < data.size())
+	{
+		msg->bias = (uint32_t)split;
+		nparsed += sip_parser_execute(&parser, msettings, &msg->v1[split], data.size() - split);
+	}
+	return nparsed == data.size() && parser.sip_errno == SPE_OK && msg->message_complete_cb_called;
+}
+
+/* parses 'method' split at each of its bytes, true if it is always 'expected' */
+static bool SameMethodAtEachSplit(const sip_parser_settings* msettings, const char* method, enum sip_method expected)
+{
+	size_t length = strlen(method);
+
+	for (size_t split = 1; split <= length + 1; split++)
+	{
+		SipMessage msg;
+		if (!ParseMethod(msettings, &msg, method, split) || msg.method != expected ||
+			msg.request_method.start != 0 || msg.request_method.length != length)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestForRequestMethod()
+{
+	static const char* extensions[] = { "FOO-BAR", "INV", "INFOX", "REGISTERS", "SUBSCRIBED", "S", "SX", "publish", "x.1~" };
+	static const char foo[] = "SFOO-BAR sip:a@b.com SIP/2.0\r\nl: 0\r\n\r\n";
+	static const char invalid[] = "FO@O sip:a@b.com SIP/2.0\r\nl: 0\r\n\r\n";
+	MessageProcessor mproc;
+	sip_parser_settings msettings = mproc.settings;
+	sip_parser parser;
+	int failed = 0;
+	bool same = true;
+
+	std::cout << "----- Request Method Test -------\n";
+	msettings.on_message_complete = OnMessageComplete;
+
+	for (int m = SIP_ACK; m <= SIP_UPDATE; m++)
+	{
+		same = same && SameMethodAtEachSplit(&msettings, sip_method_str((enum sip_method)m), (enum sip_method)m);
+	}
+	failed += ReportParamCheck(same, "Known methods at each split");
+
+	same = true;
+	for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+	{
+		same = same && SameMethodAtEachSplit(&msettings, extensions[i], SIP_EXTENSION);
+	}
+	failed += ReportParamCheck(same, "Extension methods at each split");
+
+	SipMessage msg;
+	DatagramParser dparser;
+	size_t nparsed = dparser.Execute(&msg, foo, sizeof(foo) - 1);
+	failed += ReportParamCheck(nparsed == sizeof(foo) - 1 && dparser.sip_error == SPE_OK && msg.method == SIP_EXTENSION &&
+		msg.request_method.start == 0 && msg.request_method.length == 8, "Extension method of a datagram");
+
+	sip_header_span headers[MAX_NUM_HEADERS];
+	sip_parse_result result;
+	nparsed = PullMessage(&parser, &result, headers, foo, sizeof(foo) - 1, 1);
+	failed += ReportParamCheck(nparsed == sizeof(foo) - 1 && parser.sip_errno == SPE_OK && parser.method == SIP_EXTENSION &&
+		result.method.start == 0 && result.method.length == 8, "Extension method pulled");
+
+	SipMessage invalidmsg;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &invalidmsg;
+	nparsed = sip_parser_execute(&parser, &msettings, invalid, sizeof(invalid) - 1);
+	failed += ReportParamCheck(nparsed == 2 && parser.sip_errno == SPE_INVALID_METHOD, "Method not a token");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* parses 'data' received in two parts, the first one is 'split' bytes, with 'limits' */
+static size_t ExecuteLimited(const sip_parser_settings* msettings, const sip_parser_limits* limits, SipMessage* msg,
+	const char* data, size_t length, size_t split, enum sip_errno* err)
+{
+	sip_parser parser;
+
+	msg->v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	sip_parser_set_limits(&parser, limits);
+	parser.currmsg = msg;
+	size_t nparsed = sip_parser_execute(&parser, msettings, &msg->v1[0], split);
+	if (nparsed == split && parser.sip_errno == SPE_OK && split < length)
+	{
+		msg->bias = (uint32_t)split;
+		nparsed += sip_parser_execute(&parser, msettings, &msg->v1[split], length - split);
+	}
+	*err = (enum sip_errno)parser.sip_errno;
+	return nparsed;
+}
+
+void TestForParserLimits(const std::string& dir)
+{
+	static const char request[] = "INVITE sip:bob@biloxi.example.com SIP/2.0\r\nTo: b\r\nFrom: a\r\nl: 2\r\n\r\nab";
+	static const size_t urlend = 33; /* SP after the Request-URI of 26 bytes */
+	static const size_t thirdheader = 59;
+	static const size_t headersend = 66;
+	MessageProcessor mproc;
+	sip_parser_settings msettings = mproc.settings;
+	sip_parser_settings dsettings = mproc.settings;
+	sip_parser_limits tight, loose;
+	DatagramParser dparser;
+	enum sip_errno err, err2;
+	int failed = 0;
+	int files = 0;
+	int differ = 0;
+
+	std::cout << "----- Parser Limits Test -------\n";
+	msettings.on_message_complete = OnMessageComplete;
+	dsettings.on_message_complete = OnFirstMessageComplete;
+	sip_parser_limits_init(&loose);
+
+	/* a parser of its own limits next to one of the defaults */
+	tight = loose;
+	tight.max_header_size = 20;
+	SipMessage small, large;
+	size_t nsmall = ExecuteLimited(&msettings, &tight, &small, request, sizeof(request) - 1, sizeof(request) - 1, &err);
+	size_t nlarge = ExecuteLimited(&msettings, &loose, &large, request, sizeof(request) - 1, sizeof(request) - 1, &err2);
+	failed += ReportParamCheck(nsmall == 20 && err == SPE_HEADER_OVERFLOW && nlarge == sizeof(request) - 1 && err2 == SPE_OK,
+		"Header size of the parser");
+
+	bool same = true;
+	tight = loose;
+	tight.max_url_length = 25;
+	loose.max_url_length = 26;
+	for (size_t split = 1; split <= sizeof(request) - 1; split++)
+	{
+		SipMessage longurl, url;
+		same = same && ExecuteLimited(&msettings, &tight, &longurl, request, sizeof(request) - 1, split, &err) == urlend &&
+			err == SPE_URL_OVERFLOW &&
+			ExecuteLimited(&msettings, &loose, &url, request, sizeof(request) - 1, split, &err2) == sizeof(request) - 1 &&
+			err2 == SPE_OK && url.request_url.length == 26;
+	}
+	failed += ReportParamCheck(same, "Request-URI length at each split");
+
+	sip_parser_limits_init(&tight);
+	tight.max_headers = 2;
+	SipMessage headers;
+	size_t nparsed = ExecuteLimited(&msettings, &tight, &headers, request, sizeof(request) - 1, sizeof(request) - 1, &err);
+	SipMessage dheaders;
+	dparser.SetLimits(&tight);
+	size_t dparsed = dparser.Execute(&dheaders, request, sizeof(request) - 1);
+	failed += ReportParamCheck(nparsed == thirdheader && err == SPE_HEADER_OVERFLOW && headers.num_headers == 2 &&
+		dparsed == thirdheader && dparser.sip_error == SPE_HEADER_OVERFLOW, "Header lines");
+
+	sip_parser_limits_init(&tight);
+	tight.max_body_size = 1;
+	SipMessage body;
+	nparsed = ExecuteLimited(&msettings, &tight, &body, request, sizeof(request) - 1, sizeof(request) - 1, &err);
+	SipMessage dbody;
+	dparser.SetLimits(&tight);
+	dparsed = dparser.Execute(&dbody, request, sizeof(request) - 1);
+	failed += ReportParamCheck(nparsed == headersend && err == SPE_BODY_OVERFLOW && !body.headers_complete_cb_called &&
+		dparsed == headersend && dparser.sip_error == SPE_BODY_OVERFLOW, "Body size");
+
+	/* the header index of SipMessage is not overrun */
+	std::string many = "OPTIONS sip:a@b.com SIP/2.0\r\n";
+	for (int i = 0; i <= MAX_NUM_HEADERS; i++)
+	{
+		many += "X: 1\r\n";
+	}
+	many += "\r\n";
+	SipMessage manymsg;
+	ExecuteLimited(&msettings, &mproc.limits, &manymsg, many.data(), many.size(), many.size(), &err);
+	failed += ReportParamCheck(mproc.limits.max_headers == MAX_NUM_HEADERS && err == SPE_HEADER_OVERFLOW &&
+		manymsg.num_headers == MAX_NUM_HEADERS, "MessageProcessor headers");
+
+	sip_parser_limits_init(&tight);
+	tight.max_headers = 8;
+	tight.max_url_length = 32;
+	tight.max_body_size = 64;
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data))
+			{
+				continue;
+			}
+			files++;
+			if (!data.empty() && !CompareDatagram(dparser, &dsettings, &data[0], data.size(), &tight))
+			{
+				std::cout << "[FAIL] " << name << " differs from sip_parser_execute()" << std::endl;
+				differ++;
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "Datagram limits same as sip_parser_execute() for " << files << " corpus files";
+	failed += ReportParamCheck(files > 0 && differ == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+void TestForPrefilter(const std::string& dir)
+{
+	static const struct { const char* data; enum sip_errno reason; enum sip_parser_type type; } cases[] = {
+		{ "INVITE sip:a@b.com SIP/2.0\r\nTo: b\r\n\r\n", SPE_OK, SIP_REQUEST },
+		{ "SIGN sip:a@b.com SIP/2.0\r\nTo: b\r\n\r\n", SPE_OK, SIP_REQUEST },
+		{ "\r\nSIP/2.0 200 OK\nTo: b\n\nbody", SPE_OK, SIP_RESPONSE },
+		{ "\r\n\r\n", SPE_OK, SIP_BOTH },
+		{ "INV<TE sip:a@b.com SIP/2.0\r\n\r\n", SPE_INVALID_METHOD, SIP_BOTH },
+		{ "INVITE\r\n\r\n", SPE_INVALID_METHOD, SIP_BOTH },
+		{ "INVITE sip:a@b.com\r\n\r\n", SPE_INVALID_URL, SIP_BOTH },
+		{ "GET / HTTP/1.1\r\nHost: b.com\r\n\r\n", SPE_INVALID_CONSTANT, SIP_BOTH },
+		{ "INVITE sip:a@b.com SIP/3.0\r\n\r\n", SPE_INVALID_VERSION, SIP_BOTH },
+		{ "INVITE sip:a@b.com SIP/2.0 \r\n\r\n", SPE_INVALID_VERSION, SIP_BOTH },
+		{ "INVITE sip:a@b.com SIP/2.0\rTo: b\r\n\r\n", SPE_LF_EXPECTED, SIP_BOTH },
+		{ "SIX/2.0 200 OK\r\n\r\n", SPE_INVALID_METHOD, SIP_BOTH },
+		{ "SIP/2.0 20 OK\r\n\r\n", SPE_INVALID_STATUS, SIP_BOTH },
+		{ "INVITE sip:a@b.com SIP/2.0\r\nTo: b\r\n", SPE_INVALID_EOF_STATE, SIP_BOTH },
+		{ "SIP/2.0 200", SPE_INVALID_EOF_STATE, SIP_BOTH }
+	};
+	Prefilter prefilter;
+	DatagramParser dparser;
+	sip_parser_limits tight;
+	int failed = 0;
+	int files = 0;
+	int rejected = 0;
+	int dropped = 0;
+
+	std::cout << "----- Prefilter Test -------\n";
+	bool same = true;
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		enum sip_errno reason = prefilter.Check(cases[i].data, strlen(cases[i].data));
+		if (reason != cases[i].reason || prefilter.type != cases[i].type)
+		{
+			std::cout << "[FAIL] " << sip_errno_name(reason) << " for " << cases[i].data << std::endl;
+			same = false;
+		}
+	}
+	failed += ReportParamCheck(same, "Reasons of crafted datagrams");
+
+	static const char request[] = "OPTIONS sip:bob@biloxi.example.com SIP/2.0\r\nTo: b\r\n\r\n";
+	sip_parser_limits_init(&tight);
+	tight.max_url_length = 25;
+	prefilter.SetLimits(&tight);
+	enum sip_errno url = prefilter.Check(request, sizeof(request) - 1);
+	tight.max_url_length = 26;
+	enum sip_errno url2 = prefilter.Check(request, sizeof(request) - 1);
+	tight.max_header_size = sizeof(request) - 3;
+	enum sip_errno size = prefilter.Check(request, sizeof(request) - 1);
+	prefilter.SetLimits(NULL);
+	failed += ReportParamCheck(url == SPE_URL_OVERFLOW && url2 == SPE_OK && size == SPE_HEADER_OVERFLOW, "Limits");
+
+	/* messages the parser takes as SIP/2.0 are not dropped */
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data) || data.empty())
+			{
+				continue;
+			}
+			files++;
+			SipMessage msg;
+			dparser.Execute(&msg, &data[0], data.size());
+			enum sip_errno reason = prefilter.Check(&data[0], data.size());
+			if (reason != SPE_OK)
+			{
+				rejected++;
+			}
+			if (dparser.sip_error == SPE_OK && msg.message_complete_cb_called && msg.sip_major == 2 &&
+				msg.sip_minor == 0 && (reason != SPE_OK || prefilter.type != msg.type))
+			{
+				std::cout << "[FAIL] " << name << " dropped with " << sip_errno_name(reason) << std::endl;
+				dropped++;
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "No SIP/2.0 message dropped of " << files << " corpus files (" << rejected << " rejected)";
+	failed += ReportParamCheck(files > 0 && dropped == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static int keepalive_messages = 0;
+
+static int CountKeepAliveMessage(SipMessage* msg)
+{
+	keepalive_messages++;
+	delete msg;
+	return 0;
+}
+
+static int ReceiveText(MessageProcessor& mproc, const char* text, uint64_t now)
+{
+	return mproc.MessageReceived((unsigned char*)text, (long)strlen(text), now);
+}
+
+void TestForKeepAlive()
+{
+	static const char request[] = "OPTIONS sip:a@b.com SIP/2.0\r\nl: 0\r\n\r\n";
+	MessageProcessor mproc(&CountKeepAliveMessage);
+	int failed = 0;
+
+	std::cout << "----- Keep-Alive Test -------\n";
+	keepalive_messages = 0;
+	int nping = ReceiveText(mproc, "\r\n\r\n", 10);
+	failed += ReportParamCheck(nping == 4 && mproc.keepalive.pings == 1 && mproc.keepalive.pongs == 0 &&
+		mproc.keepalive.last_keepalive == 10 && mproc.parser == NULL, "Ping without a parser");
+
+	ReceiveText(mproc, "\r", 30);
+	ReceiveText(mproc, "\n\r", 31);
+	bool pong = mproc.keepalive.pings == 1 && mproc.keepalive.pongs == 1;
+	ReceiveText(mproc, "\n", 32);
+	failed += ReportParamCheck(pong && mproc.keepalive.pings == 2 && mproc.keepalive.pongs == 0 &&
+		mproc.keepalive.last_keepalive == 32, "Ping split over the reads");
+
+	mproc.queue_pongs = true;
+	ReceiveText(mproc, "\r\n\r\n\r\n\r\n", 40);
+	uint32_t pongs = mproc.TakePongs();
+	failed += ReportParamCheck(pongs == 2 && mproc.TakePongs() == 0 && mproc.keepalive.pings == 4, "Queued pongs");
+
+	/* pings before and after a message in the same read */
+	std::string text = std::string("\r\n\r\n") + request + "\r\n\r\n";
+	int nparsed = ReceiveText(mproc, text.c_str(), 50);
+	failed += ReportParamCheck(nparsed == (int)text.size() && keepalive_messages == 1 && mproc.keepalive.pings == 6 &&
+		mproc.TakePongs() == 2 && mproc.parser->currmsg == NULL && mproc.keepalive.last_message == 50,
+		"Pings around a message");
+
+	/* a CR/LF inside a message is not a keep-alive */
+	ReceiveText(mproc, "OPTIONS sip:a@b.com SIP/2.0\r\n", 60);
+	ReceiveText(mproc, "\r\n", 61);
+	failed += ReportParamCheck(keepalive_messages == 2 && mproc.keepalive.pings == 6 && mproc.keepalive.pongs == 0 &&
+		mproc.keepalive.last_keepalive == 50 && mproc.keepalive.last_message == 61, "CRLF of a message");
+
+	int npong = ReceiveText(mproc, "\r\n", 70);
+	failed += ReportParamCheck(npong == 2 && mproc.keepalive.pongs == 1 && mproc.keepalive.last_keepalive == 70 &&
+		mproc.TakePongs() == 0, "Pong");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* parses the first message of 'data' received in two parts, the first one is
+   'split' bytes; when 'migrate' is set the parsing is moved to another parser
+   and the message to another buffer between them */
+static size_t ParseInParts(const sip_parser_settings* dsettings, const char* data, size_t length, size_t split,
+	bool migrate, SipMessage* msg, enum sip_errno* err)
+{
+	sip_parser_state state;
+	sip_parser first, second;
+	sip_parser* parser = &first;
+	SipMessage* part = new SipMessage();
+
+	part->v1.assign(data, data + split);
+	first.data = NULL;
+	sip_parser_init(&first, SIP_BOTH);
+	first.currmsg = part;
+	size_t nparsed = sip_parser_execute(&first, dsettings, &part->v1[0], split);
+	*err = (enum sip_errno)first.sip_errno;
+	std::vector<char> received;
+	part->v1.swap(received);
+	*msg = *part;
+	delete part;
+	msg->v1.assign(data, data + length);
+	if (migrate)
+	{
+		/* nothing of the first parser and buffer is used after the snapshot */
+		sip_parser_snapshot(&first, &state);
+		memset(&first, 0x5A, sizeof(first));
+		memset(&received[0], 0x5A, received.size());
+		second.data = NULL;
+		sip_parser_init(&second, SIP_BOTH);
+		sip_parser_restore(&second, &state);
+		parser = &second;
+	}
+	if (nparsed != split || *err != SPE_OK || split == length)
+	{
+		return nparsed;
+	}
+
+	parser->currmsg = msg;
+	msg->bias = (int)split;
+	nparsed += sip_parser_execute(parser, dsettings, &msg->v1[split], length - split);
+	*err = (enum sip_errno)parser->sip_errno;
+	return nparsed;
+}
+
+static int migrated_messages = 0;
+
+static int CountMigratedMessage(SipMessage* msg)
+{
+	migrated_messages++;
+	delete msg;
+	return 0;
+}
+
+void TestForParserMigration(const std::string& dir)
+{
+	static const char request[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\nTo: b\r\nSubject: a\r\n b\r\nl: 4\r\n\r\nabcd";
+	MessageProcessor mproc;
+	sip_parser_settings dsettings = mproc.settings;
+	sip_header_span headers[MAX_NUM_HEADERS], pheaders[MAX_NUM_HEADERS];
+	int failed = 0;
+	int files = 0;
+	int differ = 0;
+
+	std::cout << "----- Parser Migration Test -------\n";
+	dsettings.on_message_complete = OnFirstMessageComplete;
+
+	/* the pointers to the parsed data are not kept */
+	sip_parser parser;
+	SipMessage msg;
+	msg.v1.assign(request, request + sizeof(request) - 1);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &msg;
+	sip_parser_execute(&parser, &dsettings, &msg.v1[0], 40);
+	failed += ReportParamCheck(parser.position == NULL && parser.parsing_data == NULL && parser.parsing_len == 0,
+		"No position after sip_parser_execute()");
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			std::vector<char> data;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, data) || data.empty())
+			{
+				continue;
+			}
+			files++;
+			/* the same as parsed in the same two parts without moving them */
+			for (size_t split = 1; split <= data.size(); split++)
+			{
+				SipMessage expected, migrated;
+				enum sip_errno experr, err;
+				size_t nexpected = ParseInParts(&dsettings, &data[0], data.size(), split, false, &expected, &experr);
+				size_t nparsed = ParseInParts(&dsettings, &data[0], data.size(), split, true, &migrated, &err);
+				if (nparsed != nexpected || err != experr || !SameMessage(expected, migrated))
+				{
+					std::cout << "[FAIL] " << name << " differs when migrated after " << split << " bytes" << std::endl;
+					differ++;
+					break;
+				}
+			}
+		}
+	}
+	std::ostringstream text;
+	text << "Migrated at each byte of " << files << " corpus files";
+	failed += ReportParamCheck(files > 0 && differ == 0, text.str().c_str());
+
+	/* sip_parser_pull() with the offsets of the result */
+	sip_parse_result expected, result;
+	sip_parser_init(&parser, SIP_BOTH);
+	expected.offset = 0;
+	sip_parse_result_init(&expected, pheaders, MAX_NUM_HEADERS);
+	sip_parser_pull(&parser, &expected, request, sizeof(request) - 1);
+	bool same = (expected.flags & SR_MESSAGE_COMPLETE) != 0;
+	for (size_t split = 1; split < sizeof(request) - 1; split++)
+	{
+		sip_parser_state state;
+		sip_parser second;
+		sip_parser_init(&parser, SIP_BOTH);
+		result.offset = 0;
+		sip_parse_result_init(&result, headers, MAX_NUM_HEADERS);
+		sip_parser_pull(&parser, &result, request, split);
+		sip_parser_snapshot(&parser, &state);
+		memset(&parser, 0x5A, sizeof(parser));
+		second.data = NULL;
+		sip_parser_init(&second, SIP_BOTH);
+		sip_parser_restore(&second, &state);
+		result.offset = (uint32_t)split;
+		std::string rest(request + split, sizeof(request) - 1 - split);
+		sip_parser_pull(&second, &result, rest.data(), rest.size());
+		same = same && SameResult(expected, result);
+	}
+	failed += ReportParamCheck(same, "Pulled at each split");
+
+	/* a connection moved to another MessageProcessor at each byte */
+	MessageProcessor from(&CountMigratedMessage), to(&CountMigratedMessage);
+	migrated_messages = 0;
+	same = true;
+	for (size_t split = 1; split < sizeof(request) - 1; split++)
+	{
+		MessageProcessor& first = (split & 1) ? from : to;
+		MessageProcessor& second = (split & 1) ? to : from;
+		first.MessageReceived((unsigned char*)request, (long)split);
+		first.MoveTo(second);
+		same = same && (first.parser == NULL || first.parser->currmsg == NULL) &&
+			second.MessageReceived((unsigned char*)request + split, (long)(sizeof(request) - 1 - split)) ==
+			(int)(sizeof(request) - 1 - split) && second.parser->currmsg == NULL;
+	}
+	failed += ReportParamCheck(same && migrated_messages == (int)sizeof(request) - 2, "MessageProcessor moved at each split");
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+static std::string NormalizedValue(SipMessage& msg, uint32_t index)
+{
+	RawData value;
+	if (msg.GetNormalizedValue(index, value) != 0)
+	{
+		return "-";
+	}
+	return std::string((const char*)value._data, value._length);
+}
+
+void TestForFoldedHeaders(const std::string& dir)
+{
+	static const char request[] = "MESSAGE sip:bob@b.com SIP/2.0\r\nSubject: a \t\r\n\t b\r\n  c\r\nTo: <sip:bob@b.com>\r\n"
+		"Contact: <sip:a@a.com>,\r\n <sip:b@b.com>\r\nl: 0\r\n\r\n";
+	MessageProcessor mproc;
+	sip_parser_settings dsettings = mproc.settings;
+	sip_header_span headers[MAX_NUM_HEADERS];
+	sip_parse_result result;
+	DatagramParser dparser;
+	int failed = 0;
+	int files = 0;
+	int folded = 0;
+	int differ = 0;
+
+	std::cout << "----- Folded Header Test -------\n";
+	dsettings.on_message_complete = OnFirstMessageComplete;
+
+	/* the bit is of each header, the same for all parsers and at each split */
+	sip_parser parser;
+	SipMessage msg;
+	msg.v1.assign(request, request + sizeof(request) - 1);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = &msg;
+	sip_parser_execute(&parser, &dsettings, &msg.v1[0], msg.v1.size());
+	bool same = true;
+	for (size_t split = 1; split < sizeof(request) - 1; split++)
+	{
+		SipMessage parts;
+		enum sip_errno err;
+		ParseInParts(&dsettings, request, sizeof(request) - 1, split, false, &parts, &err);
+		PullMessage(&parser, &result, headers, request, sizeof(request) - 1, split);
+		same = same && SameMessage(msg, parts) && SamePulled(msg, result);
+	}
+	SipMessage dmsg;
+	dmsg.v1 = msg.v1;
+	dparser.Execute(&dmsg, &dmsg.v1[0], dmsg.v1.size());
+	failed += ReportParamCheck(msg.message_complete_cb_called && msg.num_headers == 4 && msg.folded.count() == 2 &&
+		msg.folded[0] && !msg.folded[1] && msg.folded[2] && !msg.folded[3] && same && SameMessage(msg, dmsg),
+		"Folded bit of each header");
+
+	/* a header not folded is not copied, a folded one is normalized once */
+	RawData to, subject, again;
+	msg.GetNormalizedValue(1, to);
+	msg.GetNormalizedValue(0, subject);
+	std::string contact = NormalizedValue(msg, 2);
+	msg.GetNormalizedValue(0, again);
+	failed += ReportParamCheck(to._data == (unsigned char*)&msg.v1[msg.headers[1].valuepos.start] &&
+		std::string((const char*)subject._data, subject._length) == "a b c" && contact == "<sip:a@a.com>, <sip:b@b.com>" &&
+		again._data == subject._data && msg.unfolded_values.size() == 2 && NormalizedValue(msg, 4) == "-",
+		"Normalized view of folded headers");
+
+	/* no CR or LF in the normalized values, nor in the values not folded */
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		for (int j = 0; j < corpus[i].count; j++)
+		{
+			char name[64];
+			SipMessage cmsg;
+			snprintf(name, sizeof(name), corpus[i].format, j);
+			if (!ReadResFile(dir + name, cmsg.v1) || cmsg.v1.empty())
+			{
+				continue;
+			}
+			files++;
+			sip_parser_init(&parser, SIP_BOTH);
+			parser.currmsg = &cmsg;
+			sip_parser_execute(&parser, &dsettings, &cmsg.v1[0], cmsg.v1.size());
+			for (uint32_t h = 0; h < cmsg.num_headers; h++)
+			{
+				const str_pos_t& raw = cmsg.headers[h].valuepos;
+				std::string value = NormalizedValue(cmsg, h);
+				bool crlf = std::string(&cmsg.v1[raw.start], raw.length).find_first_of("\r\n") != std::string::npos;
+				if (value.find_first_of("\r\n") != std::string::npos || crlf != cmsg.folded[h])
+				{
+					std::cout << "[FAIL] " << name << " header " << h << " is not normalized" << std::endl;
+					differ++;
+					break;
+				}
+			}
+			folded += (int)cmsg.folded.count();
+		}
+	}
+	std::ostringstream text;
+	text << "Normalized values of " << files << " corpus files, " << folded << " headers folded";
+	failed += ReportParamCheck(files > 0 && folded > 0 && differ == 0, text.str().c_str());
+
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
 int PartialReceiveEmulation(char* data, long length, long partition)
 {
 	int part_count = 0;
@@ -509,6 +2090,335 @@ void BodyTest(SipMessage* currentmsg)
 	std::cout << msgbuf.str() << std::endl;
 }
 
+void TestForSdpBody(SipMessage* currentmsg)
+{
+	std::cout << "----- Body Test ------ SDP -------\n";
+	RawData rd;
+	currentmsg->GetBody(rd);
+	if (rd._length == 0)
+	{
+		std::cout << "-- Message has no body\n";
+		return;
+	}
+	SdpBody sdp;
+	const char* p = sdp.ParseBody((const char*)rd._data, 0, rd._length);
+	if (sdp.parsing_stat != PARSED_SUCCESSFULLY)
+	{
+		std::cout << "Parsing failed at position " << (p - (const char*)rd._data) << std::endl;
+	}
+	std::ostringstream buff;
+	sdp.PrintOut(buff);
+	std::cout << buff.str();
+	for (uint32_t i = 0; i < sdp.num_media; i++)
+	{
+		const sdp_conn_t* conn = sdp.GetConnection(i);
+		if (conn)
+		{
+			std::cout << "media[" << i << "] connection: " << sdp.GetString(conn->address) << std::endl;
+		}
+	}
+}
+
+/* parses 'data' as a whole message with the callbacks of MessageProcessor,
+   without the dump of the completed message */
+static bool ParseWholeMessage(SipMessage* msg, const char* data, size_t length)
+{
+	MessageProcessor mproc;
+	sip_parser_settings msettings = mproc.settings;
+	sip_parser parser;
+
+	msettings.on_message_complete = OnMessageComplete;
+	msg->v1.assign(data, data + length);
+	parser.data = NULL;
+	sip_parser_init(&parser, SIP_BOTH);
+	parser.currmsg = msg;
+	size_t nparsed = sip_parser_execute(&parser, &msettings, &msg->v1[0], length);
+	return nparsed == length && parser.sip_errno == SPE_OK && msg->message_complete_cb_called;
+}
+
+void TestForSdpRewriter(SipMessage* currentmsg)
+{
+	static const char head[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+		"Content-Type: application/sdp\r\nContent-Length: ";
+	static const char offer[] = "v=0\r\no=alice 2890844526 2890844526 IN IP4 pc33.atlanta.com\r\ns=-\r\n"
+		"c=IN IP4 192.0.2.101\r\nt=0 0\r\n"
+		"m=audio 49172 RTP/AVP 0\r\nc=IN IP4 192.0.2.102/127\r\na=rtpmap:0 PCMU/8000\r\n"
+		"m=video 51372 RTP/AVP 31\r\na=rtpmap:31 H261/90000\r\n";
+	static const char anchored[] = "v=0\r\no=alice 2890844526 2890844526 IN IP4 pc33.atlanta.com\r\ns=-\r\n"
+		"c=IN IP4 203.0.113.10\r\nt=0 0\r\n"
+		"m=audio 40000 RTP/AVP 0\r\nc=IN IP4 203.0.113.10/127\r\na=rtpmap:0 PCMU/8000\r\n"
+		"m=video 40002 RTP/AVP 31\r\na=rtpmap:31 H261/90000\r\n";
+	/* media anchoring: all c= lines point to relay and each media gets a relay port */
+	const char* relay = "203.0.113.10";
+	int failed = 0;
+
+	std::cout << "----- Body Test ------ SDP rewrite -------\n";
+	SdpBody sdp;
+	sdp.ParseBody(currentmsg);
+	if (sdp.parsing_stat != PARSED_SUCCESSFULLY)
+	{
+		std::cout << "-- Message has no SDP body\n";
+	}
+	else
+	{
+		SdpRewriter rewriter(sdp);
+		rewriter.SetConnectionAddress(SDP_SESSION_LEVEL, relay, (uint32_t)strlen(relay));
+		for (uint32_t i = 0; i < sdp.num_media; i++)
+		{
+			rewriter.SetConnectionAddress(i, relay, (uint32_t)strlen(relay));
+			rewriter.SetMediaPort(i, (uint16_t)(40000 + 2 * i));
+		}
+		std::vector<char> out(currentmsg->msg_body.start + rewriter.GetBodyLength() + 16);
+		int length = rewriter.WriteMessage(currentmsg, &out[0], (uint32_t)out.size());
+		std::cout << "-- " << rewriter.GetPatchCount() << " replacements, new body length " << rewriter.GetBodyLength() << std::endl;
+		if (length > 0)
+		{
+			std::cout << std::string(&out[0], length) << std::endl;
+		}
+	}
+
+	/* the same rewrite of a known offer, Content-Length grows with the longer addresses */
+	std::ostringstream request, expected;
+	request << head << sizeof(offer) - 1 << "\r\n\r\n" << offer;
+	expected << head << sizeof(anchored) - 1 << "\r\n\r\n" << anchored;
+	SipMessage msg;
+	failed += ReportParamCheck(ParseWholeMessage(&msg, request.str().c_str(), request.str().size()), "SDP rewrite offer parsed");
+	SdpBody offered;
+	offered.ParseBody(&msg);
+	SdpRewriter rewriter(offered);
+	failed += ReportParamCheck(offered.parsing_stat == PARSED_SUCCESSFULLY && offered.num_media == 2 &&
+		rewriter.SetConnectionAddress(SDP_SESSION_LEVEL, relay, (uint32_t)strlen(relay)) == 0 &&
+		rewriter.SetConnectionAddress(0, relay, (uint32_t)strlen(relay)) == 0 && rewriter.SetMediaPort(0, 40000) == 0 &&
+		rewriter.SetMediaPort(1, 40002) == 0 && rewriter.GetPatchCount() == 4, "SDP rewrite replacements");
+	std::vector<char> body(sizeof(anchored) - 1);
+	failed += ReportParamCheck(rewriter.GetBodyLength() == sizeof(anchored) - 1 &&
+		rewriter.WriteBody(&body[0], (uint32_t)body.size()) == (int)body.size() &&
+		std::string(&body[0], body.size()) == anchored, "SDP rewritten body");
+	std::vector<char> out(expected.str().size());
+	failed += ReportParamCheck(rewriter.WriteMessage(&msg, &out[0], (uint32_t)out.size()) == (int)out.size() &&
+		std::string(&out[0], out.size()) == expected.str() && rewriter.WriteMessage(&msg, &out[0], (uint32_t)out.size() - 1) == -1,
+		"SDP rewritten message with Content-Length updated");
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+void TestForSerializer(SipMessage* currentmsg)
+{
+	static const char request[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+		"Subject: lunch\r\n Friday\r\n"
+		"Max-Forwards: 70\r\nl: 0\r\n\r\n";
+	static const char expected[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP proxy.example.com;branch=z9hG4bK-serializer-test\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+		"Max-Forwards: 70\r\nl: 0\r\n\r\n";
+	const char* via = "Via: SIP/2.0/UDP proxy.example.com;branch=z9hG4bK-serializer-test\r\n";
+	io_segment_t segs[2 * MAX_NUM_MSG_EDITS + 1];
+	int failed = 0;
+
+	std::cout << "----- Serializer Test -------\n";
+	MessageSerializer serializer(currentmsg);
+	int idx = currentmsg->GetHeaderIndex("Via");
+	if (idx >= 0)
+	{
+		serializer.InsertLineBefore(idx, via, (uint32_t)strlen(via));
+	}
+	idx = currentmsg->GetHeaderIndex("Subject");
+	if (idx >= 0)
+	{
+		serializer.RemoveHeader(idx);
+	}
+	int count = serializer.GetSegments(segs, 2 * MAX_NUM_MSG_EDITS + 1);
+	std::cout << "-- " << serializer.GetEditCount() << " edits, " << count << " segments, length "
+		<< serializer.GetLength() << std::endl;
+	std::vector<char> out(serializer.GetLength());
+	if (out.size() && serializer.Flatten(&out[0], (uint32_t)out.size()) > 0)
+	{
+		std::cout << std::string(&out[0], out.size()) << std::endl;
+	}
+
+	/* the same edits on a known request */
+	SipMessage msg;
+	failed += ReportParamCheck(ParseWholeMessage(&msg, request, sizeof(request) - 1), "Serializer request parsed");
+	MessageSerializer edited(&msg);
+	failed += ReportParamCheck(edited.InsertLineBefore(msg.GetHeaderIndex("Via"), via, (uint32_t)strlen(via)) == 0 &&
+		edited.RemoveHeader(msg.GetHeaderIndex("Subject")) == 0 && edited.GetEditCount() == 2, "Serializer insert before Via, remove Subject");
+	count = edited.GetSegments(segs, 2 * MAX_NUM_MSG_EDITS + 1);
+	std::string joined;
+	for (int i = 0; i < count; i++)
+	{
+		joined.append(segs[i].data, segs[i].length);
+	}
+	/* the removed Subject leaves no segment, the unmodified parts are not copied */
+	failed += ReportParamCheck(count == 4 && (uint32_t)count <= edited.GetSegmentCount() && segs[0].data == &msg.v1[0] &&
+		segs[1].data == via && segs[2].data == &msg.v1[segs[0].length] &&
+		segs[3].data == &msg.v1[strstr(request, "Max-Forwards") - request] && joined == expected, "Serializer segments");
+	out.assign(sizeof(expected) - 1, 0);
+	failed += ReportParamCheck(edited.GetLength() == sizeof(expected) - 1 &&
+		edited.Flatten(&out[0], (uint32_t)out.size()) == (int)sizeof(expected) - 1 &&
+		std::string(&out[0], out.size()) == expected && edited.Flatten(&out[0], (uint32_t)out.size() - 1) == -1,
+		"Serializer flattened message");
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+/* branch of the Via added by ProxyForwarder for 'request', "" if not forwarded */
+static std::string ForwardedBranch(const char* request)
+{
+	static const proxy_identity_t identity = { "UDP", "proxy.example.com", 5060 };
+	DatagramParser dparser;
+	SipMessage msg;
+	msg.v1.assign(request, request + strlen(request));
+	dparser.Execute(&msg, &msg.v1[0], msg.v1.size());
+	if (dparser.sip_error != SPE_OK || !msg.message_complete_cb_called)
+	{
+		return "";
+	}
+	ProxyForwarder forwarder(&msg, identity);
+	return (forwarder.Forward() == 0) ? forwarder.GetBranch() : "";
+}
+
+void TestForForwarderBranch()
+{
+	static const char invite[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds , SIP/2.0/TCP p1.atlanta.com;branch=z9hG4bK1\r\n"
+		"Max-Forwards: 70\r\nCSeq: 1 INVITE\r\nl: 0\r\n\r\n";
+	static const char cancel[] = "CANCEL sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+		"Max-Forwards: 70\r\nCSeq: 1 CANCEL\r\nl: 0\r\n\r\n";
+	static const char lines[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\nv: SIP/2.0/TCP p1.atlanta.com;branch=z9hG4bK2\r\n"
+		"Max-Forwards: 70\r\nCSeq: 1 INVITE\r\nl: 0\r\n\r\n";
+	static const char other[] = "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+		"Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhdt, SIP/2.0/TCP p1.atlanta.com;branch=z9hG4bK1\r\n"
+		"Max-Forwards: 70\r\nCSeq: 1 INVITE\r\nl: 0\r\n\r\n";
+	int failed = 0;
+
+	std::cout << "----- Forwarder Branch Test -------\n";
+	std::string branch = ForwardedBranch(invite);
+	failed += ReportParamCheck(!branch.empty() && branch == ForwardedBranch(cancel),
+		"CANCEL branch same as of INVITE with more via-parms in the top Via");
+	failed += ReportParamCheck(branch == ForwardedBranch(lines) && branch != ForwardedBranch(other),
+		"Branch of the top via-parm only");
+	std::cout << "-- " << failed << " failed" << std::endl;
+}
+
+void TestForForwarder(SipMessage* currentmsg)
+{
+	std::cout << "----- Forwarder Test -------\n";
+	if (currentmsg->request_url.length == 0)
+	{
+		std::cout << "-- not a request\n";
+		return;
+	}
+	proxy_identity_t identity = { "UDP", "proxy.example.com", 5060 };
+	ProxyForwarder forwarder(currentmsg, identity);
+	int result = forwarder.Forward(true);
+	std::cout << "-- result " << result << ", branch " << forwarder.GetBranch() << ", "
+		<< forwarder.GetSerializer().GetEditCount() << " edits" << std::endl;
+	if (result == 0)
+	{
+		std::vector<char> out(forwarder.GetSerializer().GetLength());
+		if (out.size() && forwarder.Flatten(&out[0], (uint32_t)out.size()) > 0)
+		{
+			std::cout << std::string(&out[0], out.size()) << std::endl;
+		}
+	}
+}
+
+void TestForHeaderValue(SipMessage* currentmsg)
+{
+	RawData rd;
+	char buf[1024];
+
+	std::cout << "----- Header Value Test ------ Via -------\n";
+	if (currentmsg->GetHeaderValue((unsigned char*)"Via", rd, 0) != 0)
+	{
+		std::cout << "-- no Via header\n";
+		return;
+	}
+	ViaHeader vhdr;
+	vhdr.ParseHeader((const char*)rd._data, 0, rd._length);
+	if (vhdr.parsing_stat != PARSED_SUCCESSFULLY)
+	{
+		std::cout << "-- Via is not parsed\n";
+		return;
+	}
+	/* unmodified: received bytes, no copy */
+	RawData value;
+	int n = vhdr.WriteHeaderValue(buf, sizeof(buf));
+	std::cout << "[unmodified] " << ((vhdr.GetHeaderValue(value) == 0) ? "raw " : "no raw ")
+		<< std::string(buf, n > 0 ? n : 0) << std::endl;
+
+	/* drop the last parameter of the top via, re-formatted into 'buf' */
+	if (vhdr.via_parms[0].num_params)
+	{
+		vhdr.via_parms[0].num_params--;
+		vhdr.SetModified();
+	}
+	n = vhdr.WriteHeaderValue(buf, sizeof(buf));
+	std::cout << "[modified]   " << ((vhdr.GetHeaderValue(value) == 0) ? "raw " : "no raw ")
+		<< std::string(buf, n > 0 ? n : 0) << std::endl;
+	std::cout << "[std::string] " << vhdr.GetHeaderValue() << std::endl;
+}
+
+void TestForViaChain(SipMessage* currentmsg)
+{
+	ViaChain chain(currentmsg);
+	const char* data = &currentmsg->v1[0];
+	uint32_t hops = 0, parsed = 0;
+
+	std::cout << "----- Via Chain Test -------\n";
+	while (chain.Next())
+	{
+		hops++;
+		const via_param_t& hop = chain.GetHop();
+		std::cout << "[" << chain.GetHopIndex() << "] header " << chain.GetHeaderIndex() << ": "
+			<< std::string(data + hop.host.start, hop.host.length) << " branch "
+			<< std::string(data + hop.branch.start, hop.branch.length) << std::endl;
+	}
+	if (chain.parsing_stat != PARSED_SUCCESSFULLY)
+	{
+		std::cout << "-- stopped: " << SipHeader::GetParsingStatInText(chain.parsing_stat) << std::endl;
+	}
+
+	/* same hops as ViaHeader parsing of each line, as long as a line has no more than its limit */
+	for (int i = 0; ; i++)
+	{
+		int idx = currentmsg->GetHeaderIndex("Via", i);
+		if (idx < 0)
+		{
+			break;
+		}
+		const str_pos_t& value = currentmsg->headers[idx].valuepos;
+		ViaHeader vhdr;
+		vhdr.ParseHeader(data, value.start, value.start + value.length);
+		parsed += (vhdr.parsing_stat == PARSED_SUCCESSFULLY) ? vhdr.num_via_parms : 0;
+	}
+	std::cout << "-- " << hops << " hops, " << parsed << " by ViaHeader" << std::endl;
+}
+
+void TestForGenericHeader(SipMessage* currentmsg)
+{
+	const char* data = &currentmsg->v1[0];
+	std::ostringstream buf;
+
+	std::cout << "----- Generic Header Test ------ message -------\n";
+	for (uint32_t i = 0; i < currentmsg->num_headers; i++)
+	{
+		const str_pos_t& field = currentmsg->headers[i].fieldpos;
+		const str_pos_t& value = currentmsg->headers[i].valuepos;
+		GenericHeader* hdr = CreateGenericHeader(data + field.start, field.length);
+		if (hdr == NULL)
+		{
+			continue;
+		}
+		hdr->ParseHeader(data, value.start, value.start + value.length);
+		hdr->PrintOut(buf);
+		delete hdr;
+	}
+	std::cout << buf.str();
+}
+
 void usage(const char* name) {
 	fprintf(stderr,
 		//"Usage: %s $type $filename\n"
@@ -533,6 +2443,24 @@ int main(int argc, char* argv[]) {
 	int processing_type = 0; /* 0 : datagram, 1 : streaming */
 
 	TestForURI();
+	TestForUriCompare();
+	TestForParamLookup();
+	TestForGenericHeaders();
+	TestForRouteHeader();
+	TestForForwarderBranch();
+	TestForAuthHeaders();
+	/* corpus files are looked for next to the given message file */
+	std::string resdir = (argc > 1) ? argv[1] : "";
+	resdir.erase(resdir.find_last_of("/\\") + 1);
+	TestForDatagramParser(resdir);
+	TestForPullParser(resdir);
+	TestForParserVariants(resdir);
+	TestForRequestMethod();
+	TestForParserLimits(resdir);
+	TestForPrefilter(resdir);
+	TestForKeepAlive();
+	TestForParserMigration(resdir);
+	TestForFoldedHeaders(resdir);
 
 	if (argc <= 1) {
 		usage(argv[0]);
@@ -678,6 +2606,16 @@ int main(int argc, char* argv[]) {
 
 	BodyTest(currentmsg);
 
+	TestForSdpBody(currentmsg);
+
+	TestForSdpRewriter(currentmsg);
+
+	TestForSerializer(currentmsg);
+	TestForForwarder(currentmsg);
+	TestForHeaderValue(currentmsg);
+	TestForViaChain(currentmsg);
+	TestForGenericHeader(currentmsg);
+
 	std::cout << "......... REQ URI ...............\n";
 	RawData rd1;
 	currentmsg->GetRequestUrl(rd1);